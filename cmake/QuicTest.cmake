@@ -15,11 +15,17 @@ function(quic_add_test)
     return()
   endif()
 
-  set(options)
+  set(options LITE)
   set(one_value_args TARGET WORKING_DIRECTORY PREFIX)
   set(multi_value_args SOURCES DEPENDS INCLUDES EXTRA_ARGS)
   cmake_parse_arguments(PARSE_ARGV 0 QUIC_TEST "${options}" "${one_value_args}" "${multi_value_args}")
 
+  # Most tests exercise features MVFST_LITE compiles out, only the ones
+  # marked LITE are built for it.
+  if(MVFST_LITE AND NOT QUIC_TEST_LITE)
+    return()
+  endif()
+
   if(NOT QUIC_TEST_TARGET)
     message(FATAL_ERROR "The TARGET parameter is mandatory.")
   endif()
@@ -70,3 +76,50 @@ function(quic_add_test)
 
   set_tests_properties(${QUIC_TEST_CASES} PROPERTIES TIMEOUT 120)
 endfunction()
+
+# Benchmarks link the test utilities, so they are only built along with the
+# tests. They are not registered with CTest.
+function(quic_add_benchmark)
+  if(NOT BUILD_TESTS OR NOT MVFST_BUILD_BENCHMARKS)
+    return()
+  endif()
+
+  set(options)
+  set(one_value_args TARGET)
+  set(multi_value_args SOURCES DEPENDS INCLUDES)
+  cmake_parse_arguments(PARSE_ARGV 0 QUIC_BENCH "${options}" "${one_value_args}" "${multi_value_args}")
+
+  if(NOT QUIC_BENCH_TARGET)
+    message(FATAL_ERROR "The TARGET parameter is mandatory.")
+  endif()
+
+  if(NOT QUIC_BENCH_SOURCES)
+    set(QUIC_BENCH_SOURCES "${QUIC_BENCH_TARGET}.cpp")
+  endif()
+
+  add_executable(${QUIC_BENCH_TARGET} "${QUIC_BENCH_SOURCES}")
+
+  target_include_directories(${QUIC_BENCH_TARGET} PUBLIC
+    "${QUIC_BENCH_INCLUDES}"
+    ${LIBGMOCK_INCLUDE_DIR}
+    ${LIBGTEST_INCLUDE_DIRS}
+    ${QUIC_EXTRA_INCLUDE_DIRECTORIES}
+  )
+
+  target_compile_definitions(${QUIC_BENCH_TARGET} PUBLIC
+    ${LIBGMOCK_DEFINES}
+  )
+
+  target_link_libraries(${QUIC_BENCH_TARGET} PUBLIC
+    "${QUIC_BENCH_DEPENDS}"
+    Folly::follybenchmark
+    ${LIBGMOCK_LIBRARIES}
+    ${GLOG_LIBRARY}
+  )
+
+  target_compile_options(
+    ${QUIC_BENCH_TARGET} PRIVATE
+    ${_QUIC_BASE_COMPILE_OPTIONS}
+    "-Wno-sign-compare"
+  )
+endfunction()
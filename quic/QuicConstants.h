@@ -15,6 +15,7 @@
 #endif
 #endif // _WIN32
 
+#include <folly/Likely.h>
 #include <folly/chrono/Clock.h>
 #include <folly/io/Cursor.h>
 #include <folly/io/IOBuf.h>
@@ -57,8 +58,42 @@ using BufPtr = std::unique_ptr<Buf>;
 using AddressRange = folly::Range<folly::SocketAddress const*>;
 using BufEq = folly::IOBufEqualTo;
 using Cursor = folly::io::Cursor;
-using Clock = std::chrono::steady_clock;
-using TimePoint = std::chrono::time_point<Clock>;
+
+/**
+ * The clock the transport reads time from. It is the steady clock, except on
+ * threads where a virtual time has been installed with setThreadVirtualTime(),
+ * which replay tools use to drive the transport from recorded timestamps.
+ * Time points and durations are the steady clock's, so they mix freely.
+ */
+struct Clock {
+  using duration = std::chrono::steady_clock::duration;
+  using rep = duration::rep;
+  using period = duration::period;
+  using time_point = std::chrono::steady_clock::time_point;
+  static constexpr bool is_steady = true;
+
+  static time_point now() noexcept {
+    if (FOLLY_UNLIKELY(virtualNow_ != nullptr)) {
+      return *virtualNow_;
+    }
+    return std::chrono::steady_clock::now();
+  }
+
+  // Makes now() on this thread return *virtualNow until it is reset with
+  // nullptr. The pointee is owned by the caller and must outlive the setting.
+  static void setThreadVirtualTime(const time_point* virtualNow) noexcept {
+    virtualNow_ = virtualNow;
+  }
+
+  static const time_point* getThreadVirtualTime() noexcept {
+    return virtualNow_;
+  }
+
+ private:
+  static inline thread_local const time_point* virtualNow_{nullptr};
+};
+
+using TimePoint = Clock::time_point;
 using DurationRep = std::chrono::microseconds::rep;
 using PathIdType = uint32_t;
 using namespace std::chrono_literals;
@@ -172,7 +207,8 @@ BETTER_ENUM(
     CLIENT_SHUTDOWN,
     INVALID_SRC_PORT,
     UNKNOWN_CID_VERSION,
-    CANNOT_FORWARD_DATA)
+    CANNOT_FORWARD_DATA,
+    DUPLICATE_PACKET)
 
 BETTER_ENUM(
     TransportKnobParamId,
@@ -449,8 +485,16 @@ constexpr uint32_t kDefaultQuicMaxBatchSize = 16;
 // connection.
 constexpr uint64_t kDefaultMaxCryptoStreamBufferSize =
     static_cast<const uint64_t>(256 * 1024); // 256kB
+
+// Number of frames a crypto stream's retransmission buffer is sized for when
+// the stream is first written to. This covers a typical handshake flight.
+constexpr size_t kCryptoStreamReservedFrames = 8;
+
 constexpr uint32_t kQuicMaxBatchSizeLimit = 64;
 
+// Number of packets a server worker can have queued from other workers.
+constexpr size_t kDefaultWorkerHandoffQueueCapacity = 256;
+
 // rfc6298:
 constexpr int kRttAlpha = 8;
 constexpr int kRttBeta = 4;
@@ -490,6 +534,9 @@ constexpr std::chrono::microseconds kDefaultPacingTickInterval{1000};
 // triggering the pacing callbacks. For pacing to work accurately, this should
 // be reasonably smaller than kDefaultPacingTickInterval.
 constexpr std::chrono::microseconds kDefaultPacingTimerResolution{100};
+// Default upper bound on how long a corked stream can hold sub-packet data
+// before it is flushed.
+constexpr std::chrono::microseconds kDefaultCorkFlushTimeout{1000};
 // Fraction of RTT that is used to limit how long a write function can loop
 constexpr DurationRep kDefaultWriteLimitRttFraction = 25;
 
@@ -570,6 +617,13 @@ constexpr float kCubicTCPFriendlyEstimateIncreaseFactor =
 // Default flow control window for HTTP/2 + 1K for headers
 constexpr uint64_t kDefaultStreamFlowControlWindow = (64 + 1) * 1024;
 constexpr uint64_t kDefaultConnectionFlowControlWindow = 1024 * 1024;
+// With coalesced flow control updates, a window update is written right away
+// once the peer has less than 1 / kUrgentWindowUpdateFraction of the window
+// left.
+constexpr uint64_t kUrgentWindowUpdateFraction = 4;
+// Upper bound on the connection window sized from the drain rate, as a
+// multiple of the configured connection window.
+constexpr uint64_t kMaxDrainRateWindowMultiplier = 4;
 
 /* Stream Limits */
 constexpr uint64_t kDefaultMaxStreamsBidirectional = 2048;
@@ -40,6 +40,7 @@ quic::Expected<bool, QuicError> IOBufQuicBatch::write(
   }
 
   // try to append the new buffers
+  pendingPackets_++;
   if (batchWriter_->append(std::move(buf), encodedSize, peerAddress_, &sock_)) {
     // return if we get an error here
     return flush();
@@ -48,6 +49,15 @@ quic::Expected<bool, QuicError> IOBufQuicBatch::write(
   return true;
 }
 
+bool IOBufQuicBatch::deferHeaderProtection(
+    HeaderForm headerForm,
+    size_t headerLen,
+    size_t packetLen,
+    const PacketNumberCipher& headerCipher) {
+  return batchWriter_->deferHeaderProtection(
+      headerForm, headerLen, packetLen, headerCipher);
+}
+
 quic::Expected<bool, QuicError> IOBufQuicBatch::flush() {
   auto ret = flushInternal();
   reset();
@@ -57,6 +67,7 @@ quic::Expected<bool, QuicError> IOBufQuicBatch::flush() {
 
 void IOBufQuicBatch::reset() {
   batchWriter_->reset();
+  pendingPackets_ = 0;
 }
 
 bool IOBufQuicBatch::isRetriableError(int err) {
@@ -68,6 +79,11 @@ quic::Expected<bool, QuicError> IOBufQuicBatch::flushInternal() {
     return true;
   }
 
+  auto protectResult = batchWriter_->protectDeferredHeaders();
+  if (!protectResult.has_value()) {
+    return quic::make_unexpected(protectResult.error());
+  }
+
   bool written = false;
   Optional<int> firstSocketErrno;
   if (!happyEyeballsState_ || happyEyeballsState_->shouldWriteToFirstSocket) {
@@ -168,6 +184,7 @@ quic::Expected<bool, QuicError> IOBufQuicBatch::flushInternal() {
     return false; // done
   }
 
+  QUIC_STATS(statsCallback_, onPacketsBatchWritten, pendingPackets_);
   return true; // success, not done yet
 }
 } // namespace quic
@@ -36,6 +36,17 @@ class IOBufQuicBatch {
 
   [[nodiscard]] quic::Expected<bool, QuicError> flush();
 
+  /**
+   * Leaves the header protection of the packet passed to the next write()
+   * to the flush of its batch, if the batch writer supports it, see
+   * BatchWriter::deferHeaderProtection.
+   */
+  bool deferHeaderProtection(
+      HeaderForm headerForm,
+      size_t headerLen,
+      size_t packetLen,
+      const PacketNumberCipher& headerCipher);
+
   FOLLY_ALWAYS_INLINE uint64_t getPktSent() const {
     return result_.packetsSent;
   }
@@ -65,6 +76,8 @@ class IOBufQuicBatch {
   QuicTransportStatsCallback* statsCallback_{nullptr};
   QuicClientConnectionState::HappyEyeballsState* happyEyeballsState_;
   BufQuicBatchResult result_;
+  // Packets appended to the batch writer since it was last flushed.
+  uint32_t pendingPackets_{0};
   int lastRetryableErrno_{};
 };
 
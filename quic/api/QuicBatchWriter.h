@@ -50,6 +50,26 @@ class BatchWriter {
   virtual ssize_t write(
       QuicAsyncUDPSocket& sock,
       const folly::SocketAddress& address) = 0;
+
+  /* Leaves the header protection of the packet about to be appended, the
+   * last packetLen bytes of conn.bufAccessor, to
+   * protectDeferredHeaders(). Returns false if the writer doesn't defer
+   * header protection, in which case the caller protects the header before
+   * appending the packet.
+   */
+  virtual bool deferHeaderProtection(
+      HeaderForm /*headerForm*/,
+      size_t /*headerLen*/,
+      size_t /*packetLen*/,
+      const PacketNumberCipher& /*headerCipher*/) {
+    return false;
+  }
+
+  // protects the headers of the appended packets before they are written
+  [[nodiscard]] virtual quic::Expected<void, QuicError>
+  protectDeferredHeaders() {
+    return {};
+  }
 };
 
 class IOBufBatchWriter : public BatchWriter {
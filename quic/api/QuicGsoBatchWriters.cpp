@@ -86,13 +86,69 @@ ssize_t GSOPacketBatchWriter::write(
 GSOInplacePacketBatchWriter::GSOInplacePacketBatchWriter(
     QuicConnectionStateBase& conn,
     size_t maxPackets)
-    : conn_(conn), maxPackets_(maxPackets) {}
+    : conn_(conn), maxPackets_(maxPackets) {
+  deferredHeaders_.reserve(maxPackets_);
+}
 
 void GSOInplacePacketBatchWriter::reset() {
   lastPacketEnd_ = nullptr;
   prevSize_ = 0;
   numPackets_ = 0;
   nextPacketSize_ = 0;
+  deferredHeaders_.clear();
+}
+
+bool GSOInplacePacketBatchWriter::deferHeaderProtection(
+    HeaderForm headerForm,
+    size_t headerLen,
+    size_t packetLen,
+    const PacketNumberCipher& headerCipher) {
+  CHECK(!nextDeferredHeader_);
+  auto bufLength = conn_.bufAccessor->length();
+  CHECK_GE(bufLength, packetLen);
+  nextDeferredHeader_ = DeferredHeader{
+      headerForm, bufLength - packetLen, headerLen, packetLen, &headerCipher};
+  return true;
+}
+
+quic::Expected<void, QuicError>
+GSOInplacePacketBatchWriter::protectDeferredHeaders() {
+  if (deferredHeaders_.empty()) {
+    return {};
+  }
+  // The packets of a batch are usually protected with the same cipher, so
+  // the headers go to it in runs.
+  constexpr size_t kMaxHeadersPerCall = 64;
+  std::array<PacketNumberCipher::HeaderToEncrypt, kMaxHeadersPerCall> headers;
+  auto* bufData = conn_.bufAccessor->buf()->writableData();
+  size_t count = 0;
+  const PacketNumberCipher* runCipher = nullptr;
+  auto protectRun = [&]() -> quic::Expected<void, QuicError> {
+    if (count == 0) {
+      return {};
+    }
+    auto result = runCipher->encryptHeaders(headers.data(), count);
+    count = 0;
+    return result;
+  };
+  for (const auto& deferred : deferredHeaders_) {
+    if (deferred.headerCipher != runCipher || count == headers.size()) {
+      auto result = protectRun();
+      if (!result.has_value()) {
+        return result;
+      }
+      runCipher = deferred.headerCipher;
+    }
+    auto* header = bufData + deferred.offset;
+    headers[count++] = makeHeaderToEncrypt(
+        deferred.headerForm,
+        header,
+        deferred.headerLen,
+        header + deferred.headerLen,
+        deferred.packetLen - deferred.headerLen);
+  }
+  deferredHeaders_.clear();
+  return protectRun();
 }
 
 bool GSOInplacePacketBatchWriter::needsFlush(size_t size) {
@@ -110,6 +166,11 @@ bool GSOInplacePacketBatchWriter::append(
     QuicAsyncUDPSocket* /* sock */) {
   CHECK(!needsFlush(size));
   auto& buf = conn_.bufAccessor->buf();
+  if (nextDeferredHeader_) {
+    CHECK_EQ(nextDeferredHeader_->offset + size, buf->length());
+    deferredHeaders_.push_back(*nextDeferredHeader_);
+    nextDeferredHeader_.reset();
+  }
   if (!lastPacketEnd_) {
     CHECK(prevSize_ == 0 && numPackets_ == 0);
     prevSize_ = size;
@@ -137,6 +198,7 @@ ssize_t GSOInplacePacketBatchWriter::write(
     QuicAsyncUDPSocket& sock,
     const folly::SocketAddress& address) {
   CHECK(lastPacketEnd_);
+  CHECK(deferredHeaders_.empty()) << "Headers left unprotected";
   auto& buf = conn_.bufAccessor->buf();
   CHECK(!buf->isChained());
   CHECK(lastPacketEnd_ >= buf->data() && lastPacketEnd_ <= buf->tail())
@@ -186,7 +248,12 @@ ssize_t GSOInplacePacketBatchWriter::write(
         << "bufLength=" << bufLength << ", pktLimit=" << conn_.udpSendPacketLen
         << ", nextPacketSize_=" << nextPacketSize_;
     CHECK(0 == buf->headroom()) << "headroom=" << buf->headroom();
+    if (nextDeferredHeader_) {
+      CHECK_EQ(nextDeferredHeader_->offset, diffToStart);
+      nextDeferredHeader_->offset = 0;
+    }
   } else {
+    CHECK(!nextDeferredHeader_);
     buf->clear();
   }
   reset();
@@ -67,13 +67,35 @@ class GSOInplacePacketBatchWriter : public BatchWriter {
     txTime_ = txTime;
   }
 
+  bool deferHeaderProtection(
+      HeaderForm headerForm,
+      size_t headerLen,
+      size_t packetLen,
+      const PacketNumberCipher& headerCipher) override;
+  [[nodiscard]] quic::Expected<void, QuicError> protectDeferredHeaders()
+      override;
+
  private:
+  struct DeferredHeader {
+    HeaderForm headerForm;
+    // Offset of the packet from the start of the buffer.
+    size_t offset;
+    size_t headerLen;
+    size_t packetLen;
+    const PacketNumberCipher* headerCipher;
+  };
+
   QuicConnectionStateBase& conn_;
   size_t maxPackets_;
   const uint8_t* lastPacketEnd_{nullptr};
   size_t prevSize_{0};
   size_t numPackets_{0};
   std::chrono::microseconds txTime_{0us};
+  // Headers of the appended packets that are still unprotected.
+  std::vector<DeferredHeader> deferredHeaders_;
+  // Header of the packet about to be appended. It survives a flush, which
+  // moves the packet to the start of the buffer.
+  Optional<DeferredHeader> nextDeferredHeader_;
 
   /**
    * If we flush the batch due to the next packet being larger than current GSO
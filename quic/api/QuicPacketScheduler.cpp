@@ -362,6 +362,21 @@ FrameScheduler::scheduleFramesForPacket(
         }
       }
     }
+    if (shortHeader && conn_.transportSettings.gsoTrainScheduling &&
+        trainPacketsLeft_ > 1 && streamFrameScheduler_ &&
+        streamFrameScheduler_->hasPendingData()) {
+      // More stream data, within flow control, follows this packet in the
+      // same train, so fill it up to keep the GSO segments the same size.
+      // Only the last packet of the train is left short, which GSO allows.
+      size_t paddingIncrement = wrapper.remainingSpaceInPkt();
+      for (size_t i = 0; i < paddingIncrement; i++) {
+        auto writeRes = writeFrame(PaddingFrame(), builder);
+        if (!writeRes.has_value()) {
+          return quic::make_unexpected(writeRes.error());
+        }
+      }
+      shortHeaderPadding += paddingIncrement;
+    }
     if (shortHeader) {
       size_t paddingModulo = conn_.transportSettings.paddingModulo;
       if (paddingModulo > 0) {
@@ -615,6 +630,10 @@ quic::Expected<void, QuicError> StreamFrameScheduler::writeStreams(
     PacketBuilderInterface& builder) {
   DCHECK(conn_.streamManager->hasWritable());
   uint64_t connWritableBytes = getSendConnFlowControlBytesWire(conn_);
+  // When planning GSO trains, a stream that runs out of data must not leave
+  // the rest of the packet empty, so the next stream tops it up instead.
+  const bool streamPerPacket = conn_.transportSettings.streamFramePerPacket &&
+      !conn_.transportSettings.gsoTrainScheduling;
   // Write the control streams first as a naive binary priority mechanism.
   const auto& controlWriteQueue = conn_.streamManager->controlWriteQueue();
   if (!controlWriteQueue.empty()) {
@@ -623,7 +642,7 @@ quic::Expected<void, QuicError> StreamFrameScheduler::writeStreams(
         controlWriteQueue,
         conn_.schedulingState.nextScheduledControlStream,
         connWritableBytes,
-        conn_.transportSettings.streamFramePerPacket);
+        streamPerPacket);
     if (!result.has_value()) {
       return quic::make_unexpected(result.error());
     }
@@ -637,7 +656,7 @@ quic::Expected<void, QuicError> StreamFrameScheduler::writeStreams(
           builder,
           *oldWriteQueue,
           connWritableBytes,
-          conn_.transportSettings.streamFramePerPacket);
+          streamPerPacket);
       if (!result.has_value()) {
         return quic::make_unexpected(result.error());
       }
@@ -651,7 +670,7 @@ quic::Expected<void, QuicError> StreamFrameScheduler::writeStreams(
           builder,
           writeQueue,
           connWritableBytes,
-          conn_.transportSettings.streamFramePerPacket);
+          streamPerPacket);
       if (!result.has_value()) {
         return quic::make_unexpected(result.error());
       }
@@ -868,6 +887,9 @@ quic::Expected<bool, QuicError> DatagramFrameScheduler::writeDatagramFrames(
       CHECK_GT(res.value(), 0);
       QUIC_STATS(conn_.statsCallback, onDatagramWrite, len);
       conn_.datagramState.writeBuffer.pop_front();
+      if (conn_.datagramState.writeBuffer.empty()) {
+        conn_.pendingEvents.clearPendingWrite(PendingWriteReason::DATAGRAM);
+      }
       sent = true;
     }
     if (conn_.transportSettings.datagramConfig.framePerPacket) {
@@ -63,6 +63,13 @@ class QuicPacketScheduler {
    */
   virtual bool hasData() const = 0;
 
+  /**
+   * Sets how many packets, including the next one, the current write can
+   * still send in this GSO train, as limited by the congestion window, the
+   * packet limit and the batch size.
+   */
+  virtual void setTrainPacketsLeft(uint64_t /* packetsLeft */) {}
+
   /**
    * Returns the name of the scheduler.
    */
@@ -339,6 +346,10 @@ class FrameScheduler : public QuicPacketScheduler {
 
   [[nodiscard]] folly::StringPiece name() const override;
 
+  void setTrainPacketsLeft(uint64_t packetsLeft) override {
+    trainPacketsLeft_ = packetsLeft;
+  }
+
  private:
   Optional<StreamFrameScheduler> streamFrameScheduler_;
   Optional<AckScheduler> ackScheduler_;
@@ -353,6 +364,8 @@ class FrameScheduler : public QuicPacketScheduler {
   Optional<PathValidationFrameScheduler> pathValidationFrameScheduler_;
   folly::StringPiece name_;
   QuicConnectionStateBase& conn_;
+  // Unlimited unless the write loop plans a GSO train.
+  uint64_t trainPacketsLeft_{std::numeric_limits<uint64_t>::max()};
 };
 
 /**
@@ -387,6 +400,10 @@ class CloningScheduler : public QuicPacketScheduler {
 
   folly::StringPiece name() const override;
 
+  void setTrainPacketsLeft(uint64_t packetsLeft) override {
+    frameScheduler_.setTrainPacketsLeft(packetsLeft);
+  }
+
  private:
   FrameScheduler& frameScheduler_;
   QuicConnectionStateBase& conn_;
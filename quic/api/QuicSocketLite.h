@@ -752,6 +752,23 @@ class QuicSocketLite {
       StreamId id,
       PriorityQueue::Priority pri) = 0;
 
+  /**
+   * Cork or uncork a stream. While a stream is corked, buffered data smaller
+   * than TransportSettings::corkMinFillBytes is not sent in an underfilled
+   * packet. It is held until more data is written, a FIN is written, the
+   * stream is uncorked or TransportSettings::corkFlushTimeout expires.
+   */
+  virtual quic::Expected<void, LocalErrorCode> setStreamCorked(
+      StreamId id,
+      bool corked) = 0;
+
+  /**
+   * Cork or uncork every non-control stream on the connection. The same
+   * packetization policy as setStreamCorked applies.
+   */
+  virtual quic::Expected<void, LocalErrorCode> setConnectionCorked(
+      bool corked) = 0;
+
   /**
    * Sets the maximum pacing rate in Bytes per second to be used
    * if pacing is enabled
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/api/QuicStreamCoro.h>
+
+#if FOLLY_HAS_COROUTINES
+
+#include <folly/coro/Baton.h>
+
+namespace quic {
+
+namespace {
+
+class BatonStreamWaiter : public QuicStreamWaiter {
+ public:
+  explicit BatonStreamWaiter(QuicTransportBaseLite& transport)
+      : transport_(transport) {}
+
+  // The coroutine frame, and the waiter with it, can go away while
+  // suspended. A transport that closed already has let go of the waiter.
+  ~BatonStreamWaiter() override {
+    if (isWaiting()) {
+      transport_.cancelStreamWait(this);
+    }
+  }
+
+  BatonStreamWaiter(const BatonStreamWaiter&) = delete;
+  BatonStreamWaiter& operator=(const BatonStreamWaiter&) = delete;
+
+  void onStreamReady(StreamId /* id */) noexcept override {
+    baton.post();
+  }
+
+  void onStreamWaitError(StreamId /* id */, QuicError err) noexcept override {
+    error = std::move(err);
+    baton.post();
+  }
+
+  folly::coro::Baton baton;
+  Optional<QuicError> error;
+
+ private:
+  QuicTransportBaseLite& transport_;
+};
+
+class BatonDeliveryCallback : public ByteEventCallback {
+ public:
+  void onByteEvent(ByteEvent byteEvent) override {
+    srtt = byteEvent.srtt;
+    baton.post();
+  }
+
+  void onByteEventCanceled(ByteEventCancellation /* cancellation */) override {
+    baton.post();
+  }
+
+  folly::coro::Baton baton;
+  Optional<std::chrono::microseconds> srtt;
+};
+
+} // namespace
+
+folly::coro::Task<quic::Expected<std::pair<BufPtr, bool>, QuicError>>
+co_readStream(QuicTransportBaseLite& transport, StreamId id, size_t maxLen) {
+  BatonStreamWaiter waiter(transport);
+  auto waitResult = transport.waitForReadable(id, &waiter);
+  if (!waitResult.has_value()) {
+    co_return quic::make_unexpected(QuicError(waitResult.error()));
+  }
+  co_await waiter.baton;
+  if (waiter.error) {
+    co_return quic::make_unexpected(std::move(*waiter.error));
+  }
+  auto readResult = transport.read(id, maxLen);
+  if (!readResult.has_value()) {
+    co_return quic::make_unexpected(QuicError(readResult.error()));
+  }
+  co_return std::move(readResult).value();
+}
+
+folly::coro::Task<quic::Expected<void, QuicError>> co_writeStream(
+    QuicTransportBaseLite& transport,
+    StreamId id,
+    BufPtr data,
+    bool eof) {
+  BatonStreamWaiter waiter(transport);
+  auto waitResult = transport.waitForWritable(id, &waiter);
+  if (!waitResult.has_value()) {
+    co_return quic::make_unexpected(QuicError(waitResult.error()));
+  }
+  co_await waiter.baton;
+  if (waiter.error) {
+    co_return quic::make_unexpected(std::move(*waiter.error));
+  }
+  auto writeResult = transport.writeChain(id, std::move(data), eof);
+  if (!writeResult.has_value()) {
+    co_return quic::make_unexpected(QuicError(writeResult.error()));
+  }
+  co_return quic::Expected<void, QuicError>{};
+}
+
+folly::coro::Task<quic::Expected<std::chrono::microseconds, QuicError>>
+co_awaitDelivery(
+    QuicTransportBaseLite& transport,
+    StreamId id,
+    uint64_t offset) {
+  BatonDeliveryCallback callback;
+  auto registerResult =
+      transport.registerDeliveryCallback(id, offset, &callback);
+  if (!registerResult.has_value()) {
+    co_return quic::make_unexpected(QuicError(registerResult.error()));
+  }
+  co_await callback.baton;
+  if (!callback.srtt) {
+    co_return quic::make_unexpected(QuicError(LocalErrorCode::STREAM_CLOSED));
+  }
+  co_return *callback.srtt;
+}
+
+} // namespace quic
+
+#endif // FOLLY_HAS_COROUTINES
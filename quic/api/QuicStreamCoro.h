@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/coro/Coroutine.h>
+
+#if FOLLY_HAS_COROUTINES
+
+#include <folly/coro/Task.h>
+#include <quic/api/QuicTransportBaseLite.h>
+
+namespace quic {
+
+/**
+ * Coroutine stream API built on the transport's stream waiters.
+ *
+ * Each call parks one waiter, which lives in the coroutine frame, on the
+ * stream and suspends until the transport readies it. Only the suspended
+ * coroutines are resumed, and their resumption is scheduled on the awaiting
+ * task's executor rather than run from inside the transport.
+ *
+ * These must be awaited on the transport's event base thread. Resetting the
+ * stream or closing the transport wakes them up with an error. A suspended
+ * read or write can be dropped, destroying its frame unparks the waiter.
+ */
+
+/**
+ * Read up to maxLen bytes from the stream (all available bytes if maxLen is
+ * 0), suspending until there is data or EOF to read. Returns the stream's
+ * read error if it has one.
+ */
+folly::coro::Task<quic::Expected<std::pair<BufPtr, bool>, QuicError>>
+co_readStream(QuicTransportBaseLite& transport, StreamId id, size_t maxLen = 0);
+
+/**
+ * Write data to the stream once stream and connection flow control allow
+ * writing to it. The data is buffered by the transport as with writeChain(),
+ * so this only applies backpressure, it doesn't wait for the data to be sent.
+ */
+folly::coro::Task<quic::Expected<void, QuicError>> co_writeStream(
+    QuicTransportBaseLite& transport,
+    StreamId id,
+    BufPtr data,
+    bool eof);
+
+/**
+ * Suspend until the peer has acknowledged all data on the stream up to and
+ * including offset. Returns the smoothed RTT at the time of the ACK.
+ */
+folly::coro::Task<quic::Expected<std::chrono::microseconds, QuicError>>
+co_awaitDelivery(
+    QuicTransportBaseLite& transport,
+    StreamId id,
+    uint64_t offset);
+
+} // namespace quic
+
+#endif // FOLLY_HAS_COROUTINES
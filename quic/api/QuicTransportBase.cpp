@@ -508,6 +508,7 @@ void QuicTransportBase::sendPing(std::chrono::milliseconds pingTimeout) {
 
   // Step 1: Send a simple ping frame
   conn_->pendingEvents.sendPing = true;
+  conn_->pendingEvents.markPendingWrite(PendingWriteReason::PING);
   updateWriteLooper(true);
 
   // Step 2: Schedule the timeout on event base
@@ -625,6 +626,7 @@ quic::Expected<void, LocalErrorCode> QuicTransportBase::writeDatagram(
     }
   }
   conn_->datagramState.writeBuffer.emplace_back(std::move(buf));
+  conn_->pendingEvents.markPendingWrite(PendingWriteReason::DATAGRAM);
   updateWriteLooper(true);
   return {};
 }
@@ -13,6 +13,7 @@
 #include <quic/congestion_control/TokenlessPacer.h>
 #include <quic/flowcontrol/QuicFlowController.h>
 #include <quic/loss/QuicLossFunctions.h>
+#include <quic/mvfst-features.h>
 #include <quic/state/QuicPacingFunctions.h>
 #include <quic/state/QuicStreamFunctions.h>
 #include <quic/state/stream/StreamSendHandlers.h>
@@ -62,6 +63,7 @@ QuicTransportBaseLite::QuicTransportBaseLite(
       pathValidationTimeout_(this),
       drainTimeout_(this),
       pingTimeout_(this),
+      corkFlushTimeout_(this),
       writeLooper_(new FunctionLooper(
           evb_,
           [this]() { pacedWriteDataToSocket(); },
@@ -372,6 +374,7 @@ QuicSocketLite::WriteResult QuicTransportBaseLite::writeChain(
     if (wasAppLimitedOrIdle && conn_->pacer) {
       conn_->pacer->reset();
     }
+    scheduleCorkFlushTimeout();
     updateWriteLooper(true);
   } catch (const QuicTransportException& ex) {
     VLOG(4) << __func__ << " streamId=" << id << " " << ex.what() << " "
@@ -454,6 +457,81 @@ QuicTransportBaseLite::unregisterStreamWriteCallback(StreamId id) {
   return {};
 }
 
+quic::Expected<void, LocalErrorCode> QuicTransportBaseLite::waitForReadable(
+    StreamId id,
+    QuicStreamWaiter* waiter) {
+  if (isSendingStream(conn_->nodeType, id)) {
+    return quic::make_unexpected(LocalErrorCode::INVALID_OPERATION);
+  }
+  if (closeState_ != CloseState::OPEN) {
+    return quic::make_unexpected(LocalErrorCode::CONNECTION_CLOSED);
+  }
+  if (!conn_->streamManager->streamExists(id)) {
+    return quic::make_unexpected(LocalErrorCode::STREAM_NOT_EXISTS);
+  }
+  if (waiter == nullptr) {
+    return quic::make_unexpected(LocalErrorCode::INVALID_OPERATION);
+  }
+  auto stream = CHECK_NOTNULL(
+      conn_->streamManager->getStream(id).value_or(nullptr));
+  if (stream->readWaiter || waiter->isWaiting()) {
+    return quic::make_unexpected(LocalErrorCode::CALLBACK_ALREADY_INSTALLED);
+  }
+  waiter->streamId_ = id;
+  stream->readWaiter = waiter;
+  readWaiters_.push_back(*waiter);
+  conn_->streamManager->queueReadyReadWaiter(*stream);
+  updateReadLooper();
+  return {};
+}
+
+quic::Expected<void, LocalErrorCode> QuicTransportBaseLite::waitForWritable(
+    StreamId id,
+    QuicStreamWaiter* waiter) {
+  if (isReceivingStream(conn_->nodeType, id)) {
+    return quic::make_unexpected(LocalErrorCode::INVALID_OPERATION);
+  }
+  if (closeState_ != CloseState::OPEN) {
+    return quic::make_unexpected(LocalErrorCode::CONNECTION_CLOSED);
+  }
+  if (!conn_->streamManager->streamExists(id)) {
+    return quic::make_unexpected(LocalErrorCode::STREAM_NOT_EXISTS);
+  }
+  if (waiter == nullptr) {
+    return quic::make_unexpected(LocalErrorCode::INVALID_OPERATION);
+  }
+  auto stream = CHECK_NOTNULL(
+      conn_->streamManager->getStream(id).value_or(nullptr));
+  if (stream->writeWaiter || waiter->isWaiting()) {
+    return quic::make_unexpected(LocalErrorCode::CALLBACK_ALREADY_INSTALLED);
+  }
+  waiter->streamId_ = id;
+  stream->writeWaiter = waiter;
+  writeWaiters_.push_back(*waiter);
+  if (!stream->writable() || maxWritableOnStream(*stream) != 0) {
+    // Don't ready the waiter inline, the caller may still be setting up.
+    runOnEvbAsync([](auto self) { self->resumeWritableWaiters(); });
+  }
+  return {};
+}
+
+void QuicTransportBaseLite::cancelStreamWait(
+    QuicStreamWaiter* waiter) noexcept {
+  if (!waiter || !waiter->isWaiting()) {
+    return;
+  }
+  auto stream = conn_->streamManager->findStream(waiter->streamId_);
+  if (stream) {
+    if (stream->readWaiter == waiter) {
+      stream->readWaiter = nullptr;
+    } else if (stream->writeWaiter == waiter) {
+      stream->writeWaiter = nullptr;
+    }
+  }
+  waiter->hook_.unlink();
+  waiter->readyHook_.unlink();
+}
+
 quic::Expected<void, LocalErrorCode> QuicTransportBaseLite::resetStream(
     StreamId id,
     ApplicationErrorCode errorCode) {
@@ -811,6 +889,10 @@ QuicTransportBaseLite::read(StreamId id, size_t maxLen) {
 }
 
 void QuicTransportBaseLite::setQLogger(std::shared_ptr<QLogger> qLogger) {
+  if constexpr (!kQLogEnabled) {
+    VLOG(4) << "Ignoring qlogger, qlog is compiled out";
+    return;
+  }
   // setQLogger can be called multiple times for the same connection and with
   // the same qLogger we track the number of times it gets set and the number
   // of times it gets reset, and only stop qlog collection when the number of
@@ -872,6 +954,38 @@ quic::Expected<void, LocalErrorCode> QuicTransportBaseLite::setStreamPriority(
   return {};
 }
 
+quic::Expected<void, LocalErrorCode> QuicTransportBaseLite::setStreamCorked(
+    StreamId id,
+    bool corked) {
+  if (closeState_ != CloseState::OPEN) {
+    return quic::make_unexpected(LocalErrorCode::CONNECTION_CLOSED);
+  }
+  if (!conn_->streamManager->streamExists(id)) {
+    return quic::make_unexpected(LocalErrorCode::STREAM_NOT_EXISTS);
+  }
+  auto stream = conn_->streamManager->getStream(id).value_or(nullptr);
+  if (!stream) {
+    return quic::make_unexpected(LocalErrorCode::STREAM_NOT_EXISTS);
+  }
+  conn_->streamManager->setStreamCorked(
+      id, corked, getSendConnFlowControlBytesWire(*conn_) > 0);
+  scheduleCorkFlushTimeout();
+  updateWriteLooper(true);
+  return {};
+}
+
+quic::Expected<void, LocalErrorCode> QuicTransportBaseLite::setConnectionCorked(
+    bool corked) {
+  if (closeState_ != CloseState::OPEN) {
+    return quic::make_unexpected(LocalErrorCode::CONNECTION_CLOSED);
+  }
+  conn_->streamManager->setConnectionCorked(
+      corked, getSendConnFlowControlBytesWire(*conn_) > 0);
+  scheduleCorkFlushTimeout();
+  updateWriteLooper(true);
+  return {};
+}
+
 quic::Expected<void, LocalErrorCode> QuicTransportBaseLite::setMaxPacingRate(
     uint64_t maxRateBytesPerSec) {
   if (conn_->pacer) {
@@ -1089,7 +1203,7 @@ void QuicTransportBaseLite::updateReadLooper() {
   if (iter != conn_->streamManager->readableStreams().end() ||
       unidirIter !=
           conn_->streamManager->readableUnidirectionalStreams().end() ||
-      !conn_->datagramState.readBuffer.empty()) {
+      hasReadyReadWaiter() || !conn_->datagramState.readBuffer.empty()) {
     VLOG(10) << "Scheduling read looper " << *this;
     readLooper_->run();
   } else {
@@ -1176,6 +1290,12 @@ void QuicTransportBaseLite::checkForClosedStream() {
   if (closeState_ == CloseState::CLOSED) {
     return;
   }
+  // Waiters on reaped streams are failed once we're done walking the closed
+  // streams, since they may reenter the transport.
+  QuicStreamWaiter::List orphanedWaiters;
+  SCOPE_EXIT {
+    failWaiters(orphanedWaiters, QuicError(LocalErrorCode::STREAM_CLOSED));
+  };
   auto itr = conn_->streamManager->closedStreams().begin();
   while (itr != conn_->streamManager->closedStreams().end()) {
     const auto& streamId = *itr;
@@ -1227,6 +1347,22 @@ void QuicTransportBaseLite::checkForClosedStream() {
       continue;
     }
 
+    // A read waiter still has an EOF or error to pick up.
+    auto stream = conn_->streamManager->findStream(*itr);
+    if (stream && stream->readWaiter &&
+        stream->readWaiter->readyHook_.is_linked()) {
+      VLOG(10) << "Not closing stream=" << *itr
+               << " because it has a pending read waiter";
+      ++itr;
+      continue;
+    }
+    if (stream && stream->readWaiter) {
+      orphanedWaiters.push_back(detachWaiter(stream->readWaiter));
+    }
+    if (stream && stream->writeWaiter) {
+      orphanedWaiters.push_back(detachWaiter(stream->writeWaiter));
+    }
+
     VLOG(10) << "Closing stream=" << *itr;
     if (conn_->qLogger) {
       conn_->qLogger->addTransportStateUpdate(
@@ -1357,6 +1493,9 @@ quic::Expected<void, QuicError> QuicTransportBaseLite::writeSocketData() {
       conn_->appLimitedTracker.setNotAppLimited();
       notifyStartWritingFromAppRateLimited();
     }
+    // Stream limit updates deferred by maybeSendStreamLimitUpdates go out
+    // with whatever this write carries.
+    sendStreamLimitUpdates(*conn_);
     auto result = writeData();
     if (!result.has_value()) {
       return result;
@@ -1451,6 +1590,7 @@ quic::Expected<void, QuicError> QuicTransportBaseLite::writeSocketData() {
   // effect.
   scheduleAckTimeout();
   schedulePathValidationTimeout();
+  scheduleCorkFlushTimeout();
   updateWriteLooper(false);
   return {};
 }
@@ -1586,6 +1726,7 @@ void QuicTransportBaseLite::closeImpl(
   cancelTimeout(&keepaliveTimeout_);
   cancelTimeout(&pingTimeout_);
   cancelTimeout(&excessWriteTimeout_);
+  cancelTimeout(&corkFlushTimeout_);
 
   VLOG(10) << "Stopping read looper due to immediate close " << *this;
   readLooper_->stop();
@@ -1793,6 +1934,10 @@ quic::Expected<void, LocalErrorCode> QuicTransportBaseLite::resetStreamInternal(
         }));
 
     pendingWriteCallbacks_.erase(id);
+    if (stream->writeWaiter) {
+      // The write can't succeed anymore, let the waiter find out.
+      runOnEvbAsync([](auto self) { self->resumeWritableWaiters(); });
+    }
     QUIC_STATS(conn_->statsCallback, onQuicStreamReset, errorCode);
   } catch (const QuicTransportException& ex) {
     VLOG(4) << __func__ << " streamId=" << id << " " << ex.what() << " "
@@ -1932,7 +2077,7 @@ void QuicTransportBaseLite::handlePingCallbacks() {
 }
 
 void QuicTransportBaseLite::handleKnobCallbacks() {
-  if (!conn_->transportSettings.advertisedKnobFrameSupport) {
+  if (!kKnobsEnabled || !conn_->transportSettings.advertisedKnobFrameSupport) {
     VLOG(4) << "Received knob frames without advertising support";
     conn_->pendingEvents.knobs.clear();
     return;
@@ -2073,6 +2218,14 @@ void QuicTransportBaseLite::handleStreamFlowControlUpdatedCallbacks(
         conn_->streamManager->getStream(streamId).value_or(nullptr));
     if (!stream->writable()) {
       pendingWriteCallbacks_.erase(streamId);
+      if (stream->writeWaiter) {
+        QuicStreamWaiter::List ready;
+        ready.push_back(detachWaiter(stream->writeWaiter));
+        resumeWaiters(ready);
+        if (closeState_ != CloseState::OPEN) {
+          return;
+        }
+      }
       continue;
     }
     connCallback_->onFlowControlUpdate(streamId);
@@ -2083,6 +2236,17 @@ void QuicTransportBaseLite::handleStreamFlowControlUpdatedCallbacks(
     stream = CHECK_NOTNULL(
         conn_->streamManager->getStream(streamId).value_or(nullptr));
     auto maxStreamWritable = maxWritableOnStream(*stream);
+    if (maxStreamWritable != 0 && stream->writeWaiter) {
+      // The waiter sits on the stream itself, no lookup needed.
+      QuicStreamWaiter::List ready;
+      ready.push_back(detachWaiter(stream->writeWaiter));
+      resumeWaiters(ready);
+      if (closeState_ != CloseState::OPEN) {
+        return;
+      }
+      stream = CHECK_NOTNULL(
+          conn_->streamManager->getStream(streamId).value_or(nullptr));
+    }
     if (maxStreamWritable != 0 && !pendingWriteCallbacks_.empty()) {
       auto pendingWriteIt = pendingWriteCallbacks_.find(stream->id);
       if (pendingWriteIt != pendingWriteCallbacks_.end()) {
@@ -2144,6 +2308,8 @@ void QuicTransportBaseLite::handleConnWritable() {
         }
       }
     }
+
+    resumeWritableWaiters();
   }
 }
 
@@ -2359,6 +2525,7 @@ void QuicTransportBaseLite::idleTimeoutExpired(bool drain) noexcept {
 void QuicTransportBaseLite::keepaliveTimeoutExpired() noexcept {
   [[maybe_unused]] auto self = sharedGuard();
   conn_->pendingEvents.sendPing = true;
+  conn_->pendingEvents.markPendingWrite(PendingWriteReason::PING);
   updateWriteLooper(true);
 }
 
@@ -2390,6 +2557,14 @@ void QuicTransportBaseLite::pingTimeoutExpired() noexcept {
   }
 }
 
+void QuicTransportBaseLite::corkFlushTimeoutExpired() noexcept {
+  [[maybe_unused]] auto self = sharedGuard();
+  VLOG(10) << __func__ << " " << *this;
+  conn_->streamManager->flushCorkedStreams(
+      getSendConnFlowControlBytesWire(*conn_) > 0);
+  updateWriteLooper(true);
+}
+
 bool QuicTransportBaseLite::processCancelCode(const QuicError& cancelCode) {
   bool noError = false;
   switch (cancelCode.code.type()) {
@@ -2491,6 +2666,17 @@ void QuicTransportBaseLite::cancelAllAppCallbacks(
     pendingWriteCallbacks_.erase(wcb.first);
     wcb.second->onStreamWriteError(wcb.first, err);
   }
+
+  VLOG(4) << "Clearing stream waiters";
+  QuicStreamWaiter::List waiters;
+  for (auto parked : {&readWaiters_, &writeWaiters_}) {
+    while (!parked->empty()) {
+      auto& waiter = parked->front();
+      cancelStreamWait(&waiter);
+      waiters.push_back(waiter);
+    }
+  }
+  failWaiters(waiters, err);
 }
 
 void QuicTransportBaseLite::scheduleTimeout(
@@ -2613,6 +2799,95 @@ bool QuicTransportBaseLite::isTimeoutScheduled(
   return callback->isTimerCallbackScheduled();
 }
 
+QuicStreamWaiter& QuicTransportBaseLite::detachWaiter(
+    QuicStreamWaiter*& slot) noexcept {
+  auto waiter = std::exchange(slot, nullptr);
+  waiter->hook_.unlink();
+  waiter->readyHook_.unlink();
+  return *waiter;
+}
+
+void QuicTransportBaseLite::resumeWaiters(
+    QuicStreamWaiter::List& ready) noexcept {
+  // A waiter may cancel or destroy other waiters on the list while being
+  // resumed, which unlinks them, so always pop from the front.
+  while (!ready.empty()) {
+    auto& waiter = ready.front();
+    ready.pop_front();
+    if (closeState_ == CloseState::OPEN) {
+      waiter.onStreamReady(waiter.streamId_);
+    } else {
+      waiter.onStreamWaitError(
+          waiter.streamId_, QuicError(LocalErrorCode::CONNECTION_CLOSED));
+    }
+  }
+}
+
+void QuicTransportBaseLite::failWaiters(
+    QuicStreamWaiter::List& waiters,
+    const QuicError& err) noexcept {
+  while (!waiters.empty()) {
+    auto& waiter = waiters.front();
+    waiters.pop_front();
+    waiter.onStreamWaitError(waiter.streamId_, err);
+  }
+}
+
+bool QuicTransportBaseLite::hasReadyReadWaiter() {
+  return !conn_->streamManager->readyReadWaiters().empty();
+}
+
+void QuicTransportBaseLite::resumeReadableWaiters() {
+  // The stream manager links a read waiter into its ready list when the
+  // waiter's stream becomes readable, so only those waiters are visited.
+  auto& readyReadWaiters = conn_->streamManager->readyReadWaiters();
+  QuicStreamWaiter::List ready;
+  QuicStreamWaiter::List errored;
+  while (!readyReadWaiters.empty()) {
+    auto& waiter = readyReadWaiters.front();
+    auto stream =
+        CHECK_NOTNULL(conn_->streamManager->findStream(waiter.streamId_));
+    DCHECK_EQ(stream->readWaiter, &waiter);
+    // As with read callbacks, a reliable reset is only surfaced once all of
+    // the reliable data has been read.
+    if (stream->streamReadError &&
+        (!stream->reliableSizeFromPeer ||
+         *stream->reliableSizeFromPeer <= stream->currentReadOffset)) {
+      errored.push_back(detachWaiter(stream->readWaiter));
+    } else {
+      ready.push_back(detachWaiter(stream->readWaiter));
+    }
+  }
+  while (!errored.empty()) {
+    auto& waiter = errored.front();
+    errored.pop_front();
+    auto stream = conn_->streamManager->findStream(waiter.streamId_);
+    waiter.onStreamWaitError(
+        waiter.streamId_,
+        stream && stream->streamReadError
+            ? QuicError(*stream->streamReadError)
+            : QuicError(LocalErrorCode::STREAM_CLOSED));
+  }
+  resumeWaiters(ready);
+}
+
+void QuicTransportBaseLite::resumeWritableWaiters() {
+  if (writeWaiters_.empty() || closeState_ != CloseState::OPEN) {
+    return;
+  }
+  QuicStreamWaiter::List ready;
+  auto it = writeWaiters_.begin();
+  while (it != writeWaiters_.end()) {
+    auto& waiter = *it++;
+    auto stream =
+        CHECK_NOTNULL(conn_->streamManager->findStream(waiter.streamId_));
+    if (!stream->writable() || maxWritableOnStream(*stream) != 0) {
+      ready.push_back(detachWaiter(stream->writeWaiter));
+    }
+  }
+  resumeWaiters(ready);
+}
+
 void QuicTransportBaseLite::invokeReadDataAndCallbacks(
     bool updateLoopersAndCheckForClosedStream) {
   auto self = sharedGuard();
@@ -2623,30 +2898,39 @@ void QuicTransportBaseLite::invokeReadDataAndCallbacks(
       self->updateWriteLooper(true);
     }
   };
-  // Need a copy since the set can change during callbacks.
+  self->resumeReadableWaiters();
+  if (self->closeState_ != CloseState::OPEN) {
+    return;
+  }
+
+  // Need a copy since the set can change during callbacks. Streams that are
+  // only read through waiters don't need one.
   std::vector<StreamId> readableStreamsCopy;
 
   const auto& readableStreams = self->conn_->streamManager->readableStreams();
   const auto& readableUnidirectionalStreams =
       self->conn_->streamManager->readableUnidirectionalStreams();
 
-  readableStreamsCopy.reserve(
-      readableStreams.size() + readableUnidirectionalStreams.size());
+  if (!self->readCallbacks_.empty()) {
+    readableStreamsCopy.reserve(
+        readableStreams.size() + readableUnidirectionalStreams.size());
+
+    if (self->conn_->transportSettings
+            .unidirectionalStreamsReadCallbacksFirst) {
+      std::copy(
+          readableUnidirectionalStreams.begin(),
+          readableUnidirectionalStreams.end(),
+          std::back_inserter(readableStreamsCopy));
+    }
 
-  if (self->conn_->transportSettings.unidirectionalStreamsReadCallbacksFirst) {
     std::copy(
-        readableUnidirectionalStreams.begin(),
-        readableUnidirectionalStreams.end(),
+        readableStreams.begin(),
+        readableStreams.end(),
         std::back_inserter(readableStreamsCopy));
-  }
 
-  std::copy(
-      readableStreams.begin(),
-      readableStreams.end(),
-      std::back_inserter(readableStreamsCopy));
-
-  if (self->conn_->transportSettings.orderedReadCallbacks) {
-    std::sort(readableStreamsCopy.begin(), readableStreamsCopy.end());
+    if (self->conn_->transportSettings.orderedReadCallbacks) {
+      std::sort(readableStreamsCopy.begin(), readableStreamsCopy.end());
+    }
   }
 
   for (StreamId streamId : readableStreamsCopy) {
@@ -2663,14 +2947,7 @@ void QuicTransportBaseLite::invokeReadDataAndCallbacks(
          *stream->reliableSizeFromPeer <= stream->currentReadOffset)) {
       // If we got a reliable reset from the peer, we don't fire the readError
       // callback and remove it until we've read all of the reliable data.
-      if (self->conn_->transportSettings
-              .unidirectionalStreamsReadCallbacksFirst &&
-          isUnidirectionalStream(streamId)) {
-        self->conn_->streamManager->readableUnidirectionalStreams().erase(
-            streamId);
-      } else {
-        self->conn_->streamManager->readableStreams().erase(streamId);
-      }
+      self->conn_->streamManager->removeFromReadableStreams(*stream);
       readCallbacks_.erase(callback);
       // if there is an error on the stream - it's not readable anymore, so
       // we cannot peek into it as well.
@@ -3132,7 +3409,7 @@ quic::Expected<void, LocalErrorCode> QuicTransportBaseLite::setKnob(
 }
 
 bool QuicTransportBaseLite::isKnobSupported() const {
-  return conn_->peerAdvertisedKnobFrameSupport;
+  return kKnobsEnabled && conn_->peerAdvertisedKnobFrameSupport;
 }
 
 void QuicTransportBaseLite::validateCongestionAndPacing(
@@ -3316,6 +3593,27 @@ void QuicTransportBaseLite::scheduleAckTimeout() {
   }
 }
 
+void QuicTransportBaseLite::scheduleCorkFlushTimeout() {
+  if (closeState_ == CloseState::CLOSED) {
+    return;
+  }
+  if (!conn_->streamManager->hasCorkHeldStreams()) {
+    if (isTimeoutScheduled(&corkFlushTimeout_)) {
+      cancelTimeout(&corkFlushTimeout_);
+    }
+    return;
+  }
+  if (!isTimeoutScheduled(&corkFlushTimeout_)) {
+    auto timeoutMs = timeMax(
+        folly::chrono::ceil<std::chrono::milliseconds>(
+            conn_->transportSettings.corkFlushTimeout),
+        evb_->getTimerTickInterval());
+    VLOG(10) << __func__ << " timeout=" << timeoutMs.count() << "ms "
+             << *this;
+    scheduleTimeout(&corkFlushTimeout_, timeoutMs);
+  }
+}
+
 void QuicTransportBaseLite::schedulePathValidationTimeout() {
   if (closeState_ == CloseState::CLOSED) {
     return;
@@ -3366,6 +3664,8 @@ QuicSocketLite::TransportInfo QuicTransportBaseLite::getTransportInfo() const {
   }
   TransportInfo transportInfo;
   transportInfo.connectionTime = conn_->connectionTime;
+  transportInfo.totalAppLimitedTime =
+      conn_->appLimitedTracker.getTotalAppLimitedTime();
   transportInfo.srtt = conn_->lossState.srtt;
   transportInfo.rttvar = conn_->lossState.rttvar;
   transportInfo.lrtt = conn_->lossState.lrtt;
@@ -3406,6 +3706,8 @@ QuicSocketLite::TransportInfo QuicTransportBaseLite::getTransportInfo() const {
   transportInfo.totalStreamBytesSent = conn_->lossState.totalStreamBytesSent;
   transportInfo.totalNewStreamBytesSent =
       conn_->lossState.totalNewStreamBytesSent;
+  transportInfo.controlFrameOnlyPacketsSent =
+      conn_->numControlFrameOnlyPacketsSent;
   transportInfo.ptoCount = conn_->lossState.ptoCount;
   transportInfo.totalPTOCount = conn_->lossState.totalPTOCount;
   transportInfo.largestPacketAckedByPeer =
@@ -3413,6 +3715,9 @@ QuicSocketLite::TransportInfo QuicTransportBaseLite::getTransportInfo() const {
   transportInfo.largestPacketSent = conn_->lossState.largestSent;
   transportInfo.usedZeroRtt = conn_->usedZeroRtt;
   transportInfo.maybeCCState = maybeCCState;
+  if (auto stageProfile = conn_->getWriteStageProfile()) {
+    transportInfo.writeStageCycles = stageProfile->total;
+  }
   return transportInfo;
 }
 
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <quic/api/QuicSocketLite.h>
+#include <quic/state/QuicStreamWaiter.h>
 #include <quic/api/QuicTransportFunctions.h>
 #include <quic/common/FunctionLooper.h>
 
@@ -91,6 +92,31 @@ class QuicTransportBaseLite : virtual public QuicSocketLite,
   quic::Expected<void, LocalErrorCode> unregisterStreamWriteCallback(
       StreamId id) override;
 
+  /**
+   * Park a waiter on the stream until it has data or EOF to deliver, or
+   * fails with the stream's read error. The waiter is readied from the read
+   * looper like a read callback, but without a per-stream callback lookup. A
+   * stream can have at most one read waiter, and it shouldn't also have a
+   * read callback consuming it.
+   */
+  quic::Expected<void, LocalErrorCode> waitForReadable(
+      StreamId id,
+      QuicStreamWaiter* waiter);
+
+  /**
+   * Park a waiter on the stream until a write won't block on flow control,
+   * or can no longer succeed. Readiness is checked asynchronously if the
+   * stream is writable already. A stream can have at most one write waiter.
+   */
+  quic::Expected<void, LocalErrorCode> waitForWritable(
+      StreamId id,
+      QuicStreamWaiter* waiter);
+
+  /**
+   * Unpark a waiter without notifying it. Does nothing if it isn't waiting.
+   */
+  void cancelStreamWait(QuicStreamWaiter* waiter) noexcept;
+
   quic::Expected<void, LocalErrorCode> resetStream(
       StreamId id,
       ApplicationErrorCode errorCode) override;
@@ -225,6 +251,13 @@ class QuicTransportBaseLite : virtual public QuicSocketLite,
       StreamId id,
       PriorityQueue::Priority priority) override;
 
+  quic::Expected<void, LocalErrorCode> setStreamCorked(
+      StreamId id,
+      bool corked) override;
+
+  quic::Expected<void, LocalErrorCode> setConnectionCorked(
+      bool corked) override;
+
   /**
    * Sets the maximum pacing rate in Bytes per second to be used
    * if pacing is enabled.
@@ -414,6 +447,26 @@ class QuicTransportBaseLite : virtual public QuicSocketLite,
     QuicTransportBaseLite* transport_;
   };
 
+  class CorkFlushTimeout : public QuicTimerCallback {
+   public:
+    ~CorkFlushTimeout() override = default;
+
+    explicit CorkFlushTimeout(QuicTransportBaseLite* transport)
+        : transport_(transport) {}
+
+    void timeoutExpired() noexcept override {
+      transport_->corkFlushTimeoutExpired();
+    }
+
+    void callbackCanceled() noexcept override {
+      // ignore, as this happens only when event base dies
+      return;
+    }
+
+   private:
+    QuicTransportBaseLite* transport_;
+  };
+
   // DrainTimeout holds a raw pointer to the transport. This is fine because the
   // DrainTimeout is owned by the transport, and destroying the DrainTimeout
   // cancels it. I.e., destroying the transport destroys the DrainTimeout, which
@@ -704,9 +757,21 @@ class QuicTransportBaseLite : virtual public QuicSocketLite,
   void pathValidationTimeoutExpired() noexcept;
   void drainTimeoutExpired() noexcept;
   void pingTimeoutExpired() noexcept;
+  void corkFlushTimeoutExpired() noexcept;
 
   bool isTimeoutScheduled(QuicTimerCallback* callback) const;
 
+  // Readies the waiters parked on readable streams or on streams that can be
+  // written to, respectively.
+  void resumeReadableWaiters();
+  void resumeWritableWaiters();
+  bool hasReadyReadWaiter();
+  void resumeWaiters(QuicStreamWaiter::List& ready) noexcept;
+  void failWaiters(
+      QuicStreamWaiter::List& waiters,
+      const QuicError& err) noexcept;
+  static QuicStreamWaiter& detachWaiter(QuicStreamWaiter*& slot) noexcept;
+
   void invokeReadDataAndCallbacks(bool updateLoopersAndCheckForClosedStream);
   void invokePeekDataAndCallbacks();
 
@@ -759,6 +824,7 @@ class QuicTransportBaseLite : virtual public QuicSocketLite,
   void setIdleTimer();
   void scheduleAckTimeout();
   void schedulePathValidationTimeout();
+  void scheduleCorkFlushTimeout();
 
   void resetConnectionCallbacks() {
     connSetupCallback_ = nullptr;
@@ -827,6 +893,11 @@ class QuicTransportBaseLite : virtual public QuicSocketLite,
   ConnectionWriteCallback* connWriteCallback_{nullptr};
   std::map<StreamId, StreamWriteCallback*> pendingWriteCallbacks_;
 
+  // Every parked waiter is on exactly one of these lists, and in the matching
+  // slot of its stream.
+  QuicStreamWaiter::List readWaiters_;
+  QuicStreamWaiter::List writeWaiters_;
+
   struct ByteEventDetail {
     ByteEventDetail(uint64_t offsetIn, ByteEventCallback* callbackIn)
         : offset(offsetIn), callback(callbackIn) {}
@@ -851,6 +922,7 @@ class QuicTransportBaseLite : virtual public QuicSocketLite,
   PathValidationTimeout pathValidationTimeout_;
   DrainTimeout drainTimeout_;
   PingTimeout pingTimeout_;
+  CorkFlushTimeout corkFlushTimeout_;
 
   FunctionLooper::Ptr writeLooper_;
   FunctionLooper::Ptr readLooper_;
@@ -18,7 +18,7 @@
 #include <quic/common/StringUtils.h>
 #include <quic/flowcontrol/QuicFlowController.h>
 #include <quic/happyeyeballs/QuicHappyEyeballsFunctions.h>
-
+#include <quic/mvfst-features.h>
 #include <quic/state/AckHandlers.h>
 #include <quic/state/QuicAckFrequencyFunctions.h>
 #include <quic/state/QuicStateFunctions.h>
@@ -224,6 +224,16 @@ quic::Expected<WriteQuicDataResult, QuicError> writeQuicDataToSocketImpl(
   return result;
 }
 
+bool shouldSampleWriteStages(
+    WriteStageProfile& stageProfile,
+    const TransportSettings& transportSettings) {
+  auto sampleInterval = transportSettings.writeStageSampleInterval;
+  if (sampleInterval == 0) {
+    return false;
+  }
+  return stageProfile.writeCount++ % sampleInterval == 0;
+}
+
 void updateErrnoCount(
     QuicConnectionStateBase& connection,
     IOBufQuicBatch& ioBufBatch) {
@@ -262,8 +272,11 @@ continuousMemoryBuildScheduleEncrypt(
       getAckState(connection, pnSpace).largestAckedByPeer.value_or(0));
   pktBuilder.accountForCipherOverhead(cipherOverhead);
   CHECK(scheduler.hasData());
+  auto* stageProfile = connection.getWriteStageProfile();
+  auto stageStart = writeStageStart(stageProfile);
   auto result =
       scheduler.scheduleFramesForPacket(std::move(pktBuilder), writableBytes);
+  writeStageEnd(stageProfile, WriteStage::Schedule, stageStart);
   if (!result.has_value()) {
     return quic::make_unexpected(result.error());
   }
@@ -307,8 +320,10 @@ continuousMemoryBuildScheduleEncrypt(
   connection.bufAccessor->trimStart(prevSize + headerLen);
   // buf and packetBuf is actually the same.
   auto buf = connection.bufAccessor->obtain();
+  stageStart = writeStageStart(stageProfile);
   auto encryptResult =
       aead.inplaceEncrypt(std::move(buf), &packet->header, packetNum);
+  writeStageEnd(stageProfile, WriteStage::Encrypt, stageStart);
   if (!encryptResult.has_value()) {
     return quic::make_unexpected(encryptResult.error());
   }
@@ -318,25 +333,30 @@ continuousMemoryBuildScheduleEncrypt(
   packetBuf->prepend(headerLen);
 
   HeaderForm headerForm = packet->packet.header.getHeaderForm();
-  auto headerEncryptResult = encryptPacketHeader(
-      headerForm,
-      packetBuf->writableData(),
-      headerLen,
-      packetBuf->data() + headerLen,
-      packetBuf->length() - headerLen,
-      headerCipher);
-  if (!headerEncryptResult.has_value()) {
-    return quic::make_unexpected(headerEncryptResult.error());
-  }
-  if (!headerEncryptResult.has_value()) {
-    return quic::make_unexpected(headerEncryptResult.error());
-  }
   CHECK(!packetBuf->isChained());
   auto encodedSize = packetBuf->length();
   auto encodedBodySize = encodedSize - headerLen;
+  auto protectHeader = [&](uint8_t* header) {
+    auto headerStageStart = writeStageStart(stageProfile);
+    auto headerEncryptResult = encryptPacketHeader(
+        headerForm,
+        header,
+        headerLen,
+        header + headerLen,
+        encodedBodySize,
+        headerCipher);
+    writeStageEnd(
+        stageProfile, WriteStage::HeaderProtection, headerStageStart);
+    return headerEncryptResult;
+  };
   // Include previous packets back.
   packetBuf->prepend(prevSize);
   if (connection.transportSettings.isPriming && packetBuf) {
+    auto headerEncryptResult =
+        protectHeader(packetBuf->writableData() + prevSize);
+    if (!headerEncryptResult.has_value()) {
+      return quic::make_unexpected(headerEncryptResult.error());
+    }
     packetBuf->coalesce();
     connection.bufAccessor->release(BufHelpers::create(packetBuf->capacity()));
     connection.primingData.emplace_back(std::move(packetBuf));
@@ -344,13 +364,25 @@ continuousMemoryBuildScheduleEncrypt(
         true, std::move(result.value()), encodedSize, encodedBodySize);
   }
   connection.bufAccessor->release(std::move(packetBuf));
+  // Batch writers that send from the buffer in place protect the headers of
+  // a whole batch at once when they flush it.
+  if (!ioBufBatch.deferHeaderProtection(
+          headerForm, headerLen, encodedSize, headerCipher)) {
+    auto headerEncryptResult = protectHeader(
+        connection.bufAccessor->buf()->writableData() + prevSize);
+    if (!headerEncryptResult.has_value()) {
+      return quic::make_unexpected(headerEncryptResult.error());
+    }
+  }
   if (encodedSize > connection.udpSendPacketLen) {
     VLOG(3) << "Quic sending pkt larger than limit, encodedSize="
             << encodedSize;
   }
   // TODO: I think we should add an API that doesn't need a buffer.
+  stageStart = writeStageStart(stageProfile);
   auto writeResult =
       ioBufBatch.write(nullptr /* no need to pass buf */, encodedSize);
+  writeStageEnd(stageProfile, WriteStage::SocketWrite, stageStart);
   if (!writeResult.has_value()) {
     return quic::make_unexpected(writeResult.error());
   }
@@ -380,8 +412,11 @@ iobufChainBasedBuildScheduleEncrypt(
       getAckState(connection, pnSpace).largestAckedByPeer.value_or(0));
   // It's the scheduler's job to invoke encode header
   pktBuilder.accountForCipherOverhead(cipherOverhead);
+  auto* stageProfile = connection.getWriteStageProfile();
+  auto stageStart = writeStageStart(stageProfile);
   auto result =
       scheduler.scheduleFramesForPacket(std::move(pktBuilder), writableBytes);
+  writeStageEnd(stageProfile, WriteStage::Schedule, stageStart);
   if (!result.has_value()) {
     return quic::make_unexpected(result.error());
   }
@@ -420,8 +455,10 @@ iobufChainBasedBuildScheduleEncrypt(
   CHECK(bodyCursor.tryPull(unencrypted->writableData() + headerLen, bodyLen));
   unencrypted->advance(headerLen);
   unencrypted->append(bodyLen);
+  stageStart = writeStageStart(stageProfile);
   auto encryptResult =
       aead.inplaceEncrypt(std::move(unencrypted), &packet->header, packetNum);
+  writeStageEnd(stageProfile, WriteStage::Encrypt, stageStart);
   if (!encryptResult.has_value()) {
     return quic::make_unexpected(encryptResult.error());
   }
@@ -434,6 +471,7 @@ iobufChainBasedBuildScheduleEncrypt(
   packetBuf->append(headerLen + bodyLen + aead.getCipherOverhead());
 
   HeaderForm headerForm = packet->packet.header.getHeaderForm();
+  stageStart = writeStageStart(stageProfile);
   auto headerEncryptResult = encryptPacketHeader(
       headerForm,
       packetBuf->writableData(),
@@ -441,6 +479,7 @@ iobufChainBasedBuildScheduleEncrypt(
       packetBuf->data() + headerLen,
       packetBuf->length() - headerLen,
       headerCipher);
+  writeStageEnd(stageProfile, WriteStage::HeaderProtection, stageStart);
   if (!headerEncryptResult.has_value()) {
     return quic::make_unexpected(headerEncryptResult.error());
   }
@@ -456,7 +495,9 @@ iobufChainBasedBuildScheduleEncrypt(
     return DataPathResult::makeWriteResult(
         true, std::move(result.value()), encodedSize, encodedBodySize);
   }
+  stageStart = writeStageStart(stageProfile);
   auto writeResult = ioBufBatch.write(std::move(packetBuf), encodedSize);
+  writeStageEnd(stageProfile, WriteStage::SocketWrite, stageStart);
   if (!writeResult.has_value()) {
     return quic::make_unexpected(writeResult.error());
   }
@@ -468,10 +509,73 @@ iobufChainBasedBuildScheduleEncrypt(
       encodedBodySize);
 }
 
+// Whether the packet only carries flow control and stream limit frames, i.e.
+// it was written for a window update rather than for ACKs or data.
+bool isControlFrameOnlyPacket(const RegularQuicWritePacket& packet) {
+  bool hasControlFrame = false;
+  for (const auto& frame : packet.frames) {
+    switch (frame.type()) {
+      case QuicWriteFrame::Type::MaxDataFrame:
+      case QuicWriteFrame::Type::MaxStreamDataFrame:
+      case QuicWriteFrame::Type::DataBlockedFrame:
+      case QuicWriteFrame::Type::StreamDataBlockedFrame:
+        hasControlFrame = true;
+        break;
+      case QuicWriteFrame::Type::QuicSimpleFrame:
+        if (frame.asQuicSimpleFrame()->type() !=
+            QuicSimpleFrame::Type::MaxStreamsFrame) {
+          return false;
+        }
+        hasControlFrame = true;
+        break;
+      case QuicWriteFrame::Type::PaddingFrame:
+        break;
+      default:
+        return false;
+    }
+  }
+  return hasControlFrame;
+}
+
+// Whether the pending event behind reason still has data to write.
+bool hasPendingWriteEvent(
+    const quic::QuicConnectionStateBase& conn,
+    quic::PendingWriteReason reason) {
+  const auto& events = conn.pendingEvents;
+  switch (reason) {
+    case quic::PendingWriteReason::RESET:
+      return !events.resets.empty();
+    case quic::PendingWriteReason::CONN_WINDOW_UPDATE:
+      return events.connWindowUpdate;
+    case quic::PendingWriteReason::SIMPLE_FRAME:
+      return !events.frames.empty();
+    case quic::PendingWriteReason::PATH_VALIDATION:
+      return !events.pathChallenges.empty() || !events.pathResponses.empty();
+    case quic::PendingWriteReason::PING:
+      return events.sendPing;
+    case quic::PendingWriteReason::DATAGRAM:
+      return !conn.datagramState.writeBuffer.empty();
+  }
+  folly::assume_unreachable();
+}
+
+// Whether the event behind reason has data to write, per the bitmask. Debug
+// builds cross-check the bit against the event.
+bool hasPendingWrite(
+    const quic::QuicConnectionStateBase& conn,
+    quic::PendingWriteReason reason) {
+  bool pending = conn.pendingEvents.hasPendingWrite(reason);
+  DCHECK_EQ(pending, hasPendingWriteEvent(conn, reason))
+      << "Pending write bit out of sync, reason=" << static_cast<int>(reason)
+      << " " << conn;
+  return pending;
+}
+
 } // namespace
 
 namespace quic {
 
+#if MVFST_ENABLE_DSR
 void handleNewStreamBufMetaWritten(
     QuicStreamState& stream,
     uint64_t frameLen,
@@ -483,6 +587,7 @@ void handleRetransmissionBufMetaWritten(
     uint64_t frameLen,
     bool frameFin,
     const decltype(stream.lossBufMetas)::iterator lossBufMetaIter);
+#endif
 
 bool writeLoopTimeLimit(
     TimePoint loopBeginTime,
@@ -517,6 +622,7 @@ void handleNewStreamDataWritten(
             .second);
 }
 
+#if MVFST_ENABLE_DSR
 void handleNewStreamBufMetaWritten(
     QuicStreamState& stream,
     uint64_t frameLen,
@@ -538,6 +644,7 @@ void handleNewStreamBufMetaWritten(
                 std::forward_as_tuple(bufMetaSplit))
             .second);
 }
+#endif
 
 void handleRetransmissionWritten(
     QuicStreamLike& stream,
@@ -572,6 +679,7 @@ void handleRetransmissionWritten(
   }
 }
 
+#if MVFST_ENABLE_DSR
 void handleRetransmissionBufMetaWritten(
     QuicStreamState& stream,
     uint64_t frameOffset,
@@ -597,6 +705,7 @@ void handleRetransmissionBufMetaWritten(
                         .build()))
             .second);
 }
+#endif
 
 /**
  * Update the connection and stream state after stream data is written and deal
@@ -672,6 +781,14 @@ bool handleStreamBufMetaWritten(
     bool frameFin,
     PacketNum packetNum,
     PacketNumberSpace packetNumberSpace) {
+#if !MVFST_ENABLE_DSR
+  // Only the DSR scheduler writes buffer metas.
+  LOG(DFATAL) << "Buffer meta written with DSR compiled out, stream="
+              << stream.id << " offset=" << frameOffset << " len=" << frameLen
+              << " fin=" << frameFin << " packetNum=" << packetNum
+              << " space=" << packetNumberSpace << " " << conn;
+  return false;
+#else
   auto writtenNewData = false;
   // Handle new data first
   if (stream.writeBufMeta.offset > 0 &&
@@ -706,6 +823,7 @@ bool handleStreamBufMetaWritten(
            << " packetNum=" << packetNum << " " << conn;
   QUIC_STATS(conn.statsCallback, onPacketRetransmission);
   return false;
+#endif
 }
 
 quic::Expected<void, QuicError> updateConnection(
@@ -732,7 +850,7 @@ quic::Expected<void, QuicError> updateConnection(
            << " in space=" << packetNumberSpace << " size=" << encodedSize
            << " bodySize: " << encodedBodySize << " isDSR=" << isDSRPacket
            << " " << conn;
-  if (conn.qLogger) {
+  if (kQLogEnabled && conn.qLogger) {
     conn.qLogger->addPacket(packet, encodedSize);
   }
   FOLLY_SDT(quic, update_connection_num_frames, packet.frames.size());
@@ -838,6 +956,9 @@ quic::Expected<void, QuicError> updateConnection(
         // start to treat RST_STREAM in the same way we treat window update?
         if (resetIter != conn.pendingEvents.resets.end()) {
           conn.pendingEvents.resets.erase(resetIter);
+          if (conn.pendingEvents.resets.empty()) {
+            conn.pendingEvents.clearPendingWrite(PendingWriteReason::RESET);
+          }
         } else {
           DCHECK(clonedPacketIdentifier.has_value())
               << " reset missing from pendingEvents for non-clone packet";
@@ -897,6 +1018,7 @@ quic::Expected<void, QuicError> updateConnection(
       }
       case QuicWriteFrame::Type::PingFrame:
         conn.pendingEvents.sendPing = false;
+        conn.pendingEvents.clearPendingWrite(PendingWriteReason::PING);
         isPing = true;
         retransmittable = true;
         conn.numPingFramesSent++;
@@ -962,6 +1084,10 @@ quic::Expected<void, QuicError> updateConnection(
   conn.lossState.totalPacketsSent++;
   conn.lossState.totalStreamBytesSent += streamBytesSent;
   conn.lossState.totalNewStreamBytesSent += newStreamBytesSent;
+  if (isControlFrameOnlyPacket(packet)) {
+    ++conn.numControlFrameOnlyPacketsSent;
+    QUIC_STATS(conn.statsCallback, onControlFrameOnlyPacketSent);
+  }
 
   // Count the number of packets sent in the current phase.
   // This is used to initiate key updates if enabled.
@@ -1635,6 +1761,33 @@ quic::Expected<void, QuicError> encryptPacketHeader(
   return {};
 }
 
+quic::Expected<void, QuicError> encryptPacketHeaders(
+    const PacketHeaderToEncrypt* packets,
+    size_t numPackets,
+    const PacketNumberCipher& headerCipher) {
+  // Headers are handed to the cipher this many at a time, so the scratch
+  // space stays on the stack. 64 covers a full GSO batch.
+  constexpr size_t kMaxHeadersPerCall = 64;
+  std::array<PacketNumberCipher::HeaderToEncrypt, kMaxHeadersPerCall> headers;
+  for (size_t first = 0; first < numPackets; first += kMaxHeadersPerCall) {
+    auto count = std::min(numPackets - first, kMaxHeadersPerCall);
+    for (size_t i = 0; i < count; ++i) {
+      const auto& packet = packets[first + i];
+      headers[i] = makeHeaderToEncrypt(
+          packet.headerForm,
+          packet.header,
+          packet.headerLen,
+          packet.encryptedBody,
+          packet.bodyLen);
+    }
+    auto result = headerCipher.encryptHeaders(headers.data(), count);
+    if (!result.has_value()) {
+      return result;
+    }
+  }
+  return {};
+}
+
 /**
  * If, after the write, the stream buffers will be below the min threshold,
  * we posit that the end of the streams is near and it's worth sending the
@@ -1819,7 +1972,23 @@ quic::Expected<WriteQuicDataResult, QuicError> writeConnectionDataToSocket(
   uint64_t bytesWritten = 0;
   uint64_t shortHeaderPadding = 0;
   uint64_t shortHeaderPaddingCount = 0;
+  auto* stageProfile = connection.getWriteStageProfile();
+  if (stageProfile) {
+    stageProfile->sampled =
+        shouldSampleWriteStages(*stageProfile, connection.transportSettings);
+  }
   SCOPE_EXIT {
+    if (stageProfile && stageProfile->sampled) {
+      stageProfile->sampled = false;
+      if (!stageProfile->pending.empty()) {
+        QUIC_STATS(
+            connection.statsCallback,
+            onWriteStageCycles,
+            stageProfile->pending);
+        stageProfile->total.add(stageProfile->pending);
+        stageProfile->pending.clear();
+      }
+    }
     auto nSent = ioBufBatch.getPktSent();
     if (nSent > 0) {
       QUIC_STATS(connection.statsCallback, onPacketsSent, nSent);
@@ -1846,8 +2015,27 @@ quic::Expected<WriteQuicDataResult, QuicError> writeConnectionDataToSocket(
           writeLoopTimeLimit(writeLoopBeginTime, connection))) {
     auto packetNum = getNextPacketNum(connection, pnSpace);
     auto header = builder(srcConnId, dstConnId, packetNum, version, token);
-    uint32_t writableBytes = std::min<uint64_t>(
-        connection.udpSendPacketLen, writableBytesFunc(connection));
+    auto connWritableBytes = writableBytesFunc(connection);
+    uint32_t writableBytes =
+        std::min<uint64_t>(connection.udpSendPacketLen, connWritableBytes);
+    if (connection.transportSettings.gsoTrainScheduling) {
+      // The train ends at whichever comes first: the window running out, the
+      // packet limit, or the batch being flushed. Its last packet may be
+      // short.
+      uint64_t pktSent = ioBufBatch.getPktSent();
+      uint64_t packetsLeft = packetLimit - pktSent;
+      if (batchSize > 0) {
+        packetsLeft =
+            std::min<uint64_t>(packetsLeft, batchSize - pktSent % batchSize);
+      }
+      uint64_t packetLen = connection.udpSendPacketLen;
+      if (packetLen > 0) {
+        uint64_t windowPackets = connWritableBytes / packetLen +
+            (connWritableBytes % packetLen != 0 ? 1 : 0);
+        packetsLeft = std::min(packetsLeft, windowPackets);
+      }
+      scheduler.setTrainPacketsLeft(packetsLeft);
+    }
     uint64_t cipherOverhead = aead.getCipherOverhead();
     if (writableBytes < cipherOverhead) {
       writableBytes = 0;
@@ -1909,6 +2097,7 @@ quic::Expected<WriteQuicDataResult, QuicError> writeConnectionDataToSocket(
     // write queue that have already been removed in QuicPacketScheduler.
     // Removing non-existent streams can be O(N), consider passing the
     // transaction set to skip this step
+    auto stageStart = writeStageStart(stageProfile);
     auto updateConnResult = updateConnection(
         connection,
         *pathInfo,
@@ -1918,6 +2107,7 @@ quic::Expected<WriteQuicDataResult, QuicError> writeConnectionDataToSocket(
         static_cast<uint32_t>(ret->encodedSize),
         static_cast<uint32_t>(ret->encodedBodySize),
         false /* isDSRPacket */);
+    writeStageEnd(stageProfile, WriteStage::UpdateConnection, stageStart);
     if (!updateConnResult.has_value()) {
       return quic::make_unexpected(updateConnResult.error());
     }
@@ -1951,7 +2141,9 @@ quic::Expected<WriteQuicDataResult, QuicError> writeConnectionDataToSocket(
   }
 
   // Ensure that the buffer is flushed before returning
+  auto stageStart = writeStageStart(stageProfile);
   auto flushResult = ioBufBatch.flush();
+  writeStageEnd(stageProfile, WriteStage::SocketWrite, stageStart);
   if (!flushResult.has_value()) {
     return quic::make_unexpected(flushResult.error());
   }
@@ -2031,6 +2223,7 @@ quic::Expected<WriteQuicDataResult, QuicError> writeProbingDataToSocket(
       probeSchedulerBuilder.immediateAckFrames();
     } else {
       connection.pendingEvents.sendPing = true;
+      connection.pendingEvents.markPendingWrite(PendingWriteReason::PING);
       probeSchedulerBuilder.pingFrames();
     }
     auto probeScheduler = std::move(probeSchedulerBuilder).build();
@@ -2101,6 +2294,9 @@ WriteDataReason shouldWriteData(/*const*/ QuicConnectionStateBase& conn) {
 
 bool hasAlternatePathValidationDataToWrite(
     const QuicConnectionStateBase& conn) {
+  if (!hasPendingWrite(conn, PendingWriteReason::PATH_VALIDATION)) {
+    return false;
+  }
   // Check path challenges
   for (const auto& [pathId, _] : conn.pendingEvents.pathChallenges) {
     if (pathId != conn.currentPathId &&
@@ -2159,14 +2355,16 @@ WriteDataReason hasNonAckDataToWrite(const QuicConnectionStateBase& conn) {
     // be written.
     return WriteDataReason::NO_WRITE;
   }
-  if (!conn.pendingEvents.resets.empty()) {
+  if (hasPendingWrite(conn, PendingWriteReason::RESET)) {
     return WriteDataReason::RESET;
   }
-  if (conn.streamManager->hasWindowUpdates()) {
-    return WriteDataReason::STREAM_WINDOW_UPDATE;
-  }
-  if (conn.pendingEvents.connWindowUpdate) {
-    return WriteDataReason::CONN_WINDOW_UPDATE;
+  if (!shouldDeferFlowControlUpdates(conn)) {
+    if (conn.streamManager->hasWindowUpdates()) {
+      return WriteDataReason::STREAM_WINDOW_UPDATE;
+    }
+    if (hasPendingWrite(conn, PendingWriteReason::CONN_WINDOW_UPDATE)) {
+      return WriteDataReason::CONN_WINDOW_UPDATE;
+    }
   }
   if (conn.streamManager->hasBlocked()) {
     return WriteDataReason::BLOCKED;
@@ -2177,27 +2375,49 @@ WriteDataReason hasNonAckDataToWrite(const QuicConnectionStateBase& conn) {
        conn.streamManager->hasWritable())) {
     return WriteDataReason::STREAM;
   }
-  if (!conn.pendingEvents.frames.empty()) {
+  if (hasPendingWrite(conn, PendingWriteReason::SIMPLE_FRAME)) {
     return WriteDataReason::SIMPLE;
   }
-  if ((conn.pendingEvents.pathChallenges.find(conn.currentPathId) !=
-       conn.pendingEvents.pathChallenges.end())) {
-    return WriteDataReason::PATH_VALIDATION;
-  }
-  if ((conn.pendingEvents.pathResponses.find(conn.currentPathId) !=
-       conn.pendingEvents.pathResponses.end())) {
-    return WriteDataReason::PATH_VALIDATION;
+  if (hasPendingWrite(conn, PendingWriteReason::PATH_VALIDATION)) {
+    if ((conn.pendingEvents.pathChallenges.find(conn.currentPathId) !=
+         conn.pendingEvents.pathChallenges.end())) {
+      return WriteDataReason::PATH_VALIDATION;
+    }
+    if ((conn.pendingEvents.pathResponses.find(conn.currentPathId) !=
+         conn.pendingEvents.pathResponses.end())) {
+      return WriteDataReason::PATH_VALIDATION;
+    }
   }
-  if (conn.pendingEvents.sendPing) {
+  if (hasPendingWrite(conn, PendingWriteReason::PING)) {
     return WriteDataReason::PING;
   }
-  if (!conn.datagramState.writeBuffer.empty()) {
+  if (hasPendingWrite(conn, PendingWriteReason::DATAGRAM)) {
     return WriteDataReason::DATAGRAM;
   }
   return WriteDataReason::NO_WRITE;
 }
 
+bool shouldDeferFlowControlUpdates(const QuicConnectionStateBase& conn) {
+  if (!conn.transportSettings.coalesceFlowControlUpdates ||
+      conn.pendingEvents.urgentWindowUpdate) {
+    return false;
+  }
+  // The peer is owed an ACK, which is written no later than the ACK timeout
+  // and has room for the updates.
+  const auto& ackState = conn.ackStates.appDataAckState;
+  return ackState.needsToSendAckImmediately || ackState.numRxPacketsRecvd > 0;
+}
+
 void maybeSendStreamLimitUpdates(QuicConnectionStateBase& conn) {
+  if (shouldDeferFlowControlUpdates(conn)) {
+    // The stream manager keeps the latest limits, they're sent on the next
+    // write.
+    return;
+  }
+  sendStreamLimitUpdates(conn);
+}
+
+void sendStreamLimitUpdates(QuicConnectionStateBase& conn) {
   auto update = conn.streamManager->remoteBidirectionalStreamLimitUpdate();
   if (update) {
     sendSimpleFrame(conn, (MaxStreamsFrame(*update, true)));
@@ -302,6 +302,30 @@ quic::Expected<void, QuicError> encryptPacketHeader(
     size_t bodyLen,
     const PacketNumberCipher& headerCipher);
 
+/**
+ * A packet for encryptPacketHeaders. The fields mean the same as the
+ * arguments of encryptPacketHeader.
+ */
+struct PacketHeaderToEncrypt {
+  HeaderForm headerForm;
+  uint8_t* header;
+  size_t headerLen;
+  const uint8_t* encryptedBody;
+  size_t bodyLen;
+};
+
+/**
+ * Encrypts the headers of a batch of packets in place, e.g. the packets of
+ * a GSO batch once the AEAD has run on all of them. This does the same as
+ * calling encryptPacketHeader on each packet, through
+ * PacketNumberCipher::encryptHeaders, which lets the cipher compute the
+ * masks of the whole batch at once.
+ */
+quic::Expected<void, QuicError> encryptPacketHeaders(
+    const PacketHeaderToEncrypt* packets,
+    size_t numPackets,
+    const PacketNumberCipher& headerCipher);
+
 /**
  * Increases packetLimit and sets the conn.imminentStreamCompletion if
  * necessary.
@@ -353,8 +377,24 @@ writeProbingDataToSocket(
 HeaderBuilder LongHeaderBuilder(LongHeader::Types packetType);
 HeaderBuilder ShortHeaderBuilder(ProtectionType keyPhase);
 
+/**
+ * Whether pending flow control and stream limit updates should wait for a
+ * packet that is written for some other reason (see
+ * TransportSettings::coalesceFlowControlUpdates).
+ */
+bool shouldDeferFlowControlUpdates(const QuicConnectionStateBase& conn);
+
+/**
+ * Queues MAX_STREAMS frames for stream limits raised by closed peer streams,
+ * unless they can be deferred to the next write.
+ */
 void maybeSendStreamLimitUpdates(QuicConnectionStateBase& conn);
 
+/**
+ * Queues MAX_STREAMS frames for any stream limit updates not yet sent.
+ */
+void sendStreamLimitUpdates(QuicConnectionStateBase& conn);
+
 void implicitAckCryptoStream(
     QuicConnectionStateBase& conn,
     EncryptionLevel encryptionLevel);
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <quic/common/Optional.h>
+#include <quic/common/WriteStageProfiler.h>
 #include <quic/congestion_control/CongestionController.h>
 
 namespace quic {
@@ -18,6 +19,8 @@ namespace quic {
 struct TransportInfo {
   // Time when the connection started.
   std::chrono::time_point<std::chrono::steady_clock> connectionTime;
+  // Time the connection spent application limited since it started.
+  std::chrono::microseconds totalAppLimitedTime{0us};
   std::chrono::microseconds srtt{0us};
   std::chrono::microseconds rttvar{0us};
   std::chrono::microseconds lrtt{0us};
@@ -60,6 +63,9 @@ struct TransportInfo {
   // Total number of 'new' stream bytes sent on this connection.
   // Does not include retransmissions of stream bytes.
   uint64_t totalNewStreamBytesSent{0};
+  // Number of packets sent that only carried flow control and stream limit
+  // frames.
+  uint64_t controlFrameOnlyPacketsSent{0};
   uint32_t ptoCount{0};
   uint32_t totalPTOCount{0};
   Optional<uint64_t> largestPacketAckedByPeer;
@@ -67,6 +73,9 @@ struct TransportInfo {
   bool usedZeroRtt{false};
   // State from congestion control module, if one is installed.
   Optional<CongestionController::State> maybeCCState;
+  // Cycles spent in each write loop stage over all sampled writes. Empty
+  // unless write stage profiling is compiled in and sampling is enabled.
+  WriteStageCycles writeStageCycles;
 };
 
 } // namespace quic
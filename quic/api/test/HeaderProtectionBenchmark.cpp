@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/portability/GFlags.h>
+#include <quic/api/QuicTransportFunctions.h>
+#include <quic/fizz/handshake/FizzCryptoFactory.h>
+
+#include <vector>
+
+using namespace quic;
+
+/**
+ * Compares header protection of a 64 packet GSO batch done one packet at a
+ * time through encryptPacketHeader with encryptPacketHeaders, which masks
+ * the whole batch in one cipher call. The packets are short header 1-RTT
+ * packets of kDefaultUDPSendPacketLen bytes with 4 byte packet numbers,
+ * laid out back to back as in the continuous memory write path. Each pass
+ * resets the first byte so the packet number length stays 4 and protects
+ * the rest again as is, since the cost doesn't depend on the bytes.
+ */
+
+namespace {
+
+constexpr size_t kBatchPackets = 64;
+constexpr size_t kHeaderLen = 1 + kDefaultConnectionIdSize + 4;
+
+struct Batch {
+  explicit Batch(fizz::CipherSuite suite)
+      : buf(kBatchPackets * kDefaultUDPSendPacketLen) {
+    auto cipherResult = FizzCryptoFactory().makePacketNumberCipher(suite);
+    CHECK(cipherResult.has_value());
+    headerCipher = std::move(cipherResult.value());
+    std::vector<uint8_t> key(headerCipher->keyLength(), 0x42);
+    CHECK(headerCipher->setKey(ByteRange(key.data(), key.size())).has_value());
+    for (size_t i = 0; i < buf.size(); i++) {
+      buf[i] = static_cast<uint8_t>(i * 7);
+    }
+    for (size_t i = 0; i < kBatchPackets; i++) {
+      auto* packet = buf.data() + i * kDefaultUDPSendPacketLen;
+      packet[0] = 0x43;
+      packets.push_back(
+          {HeaderForm::Short,
+           packet,
+           kHeaderLen,
+           packet + kHeaderLen,
+           kDefaultUDPSendPacketLen - kHeaderLen});
+    }
+  }
+
+  std::vector<uint8_t> buf;
+  std::vector<PacketHeaderToEncrypt> packets;
+  std::unique_ptr<PacketNumberCipher> headerCipher;
+};
+
+void perPacket(size_t iters, fizz::CipherSuite suite) {
+  Optional<Batch> batch;
+  BENCHMARK_SUSPEND {
+    batch.emplace(suite);
+  }
+  for (size_t i = 0; i < iters; i++) {
+    for (auto& packet : batch->packets) {
+      // Keep the packet number length the same from one pass to the next.
+      packet.header[0] = 0x43;
+      CHECK(encryptPacketHeader(
+                packet.headerForm,
+                packet.header,
+                packet.headerLen,
+                packet.encryptedBody,
+                packet.bodyLen,
+                *batch->headerCipher)
+                .has_value());
+    }
+  }
+  folly::doNotOptimizeAway(batch->buf.data());
+}
+
+void batched(size_t iters, fizz::CipherSuite suite) {
+  Optional<Batch> batch;
+  BENCHMARK_SUSPEND {
+    batch.emplace(suite);
+  }
+  for (size_t i = 0; i < iters; i++) {
+    for (auto& packet : batch->packets) {
+      packet.header[0] = 0x43;
+    }
+    CHECK(encryptPacketHeaders(
+              batch->packets.data(),
+              batch->packets.size(),
+              *batch->headerCipher)
+              .has_value());
+  }
+  folly::doNotOptimizeAway(batch->buf.data());
+}
+
+} // namespace
+
+BENCHMARK_NAMED_PARAM(
+    perPacket,
+    aes128_64pkts,
+    fizz::CipherSuite::TLS_AES_128_GCM_SHA256)
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    batched,
+    aes128_64pkts,
+    fizz::CipherSuite::TLS_AES_128_GCM_SHA256)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM(
+    perPacket,
+    aes256_64pkts,
+    fizz::CipherSuite::TLS_AES_256_GCM_SHA384)
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    batched,
+    aes256_64pkts,
+    fizz::CipherSuite::TLS_AES_256_GCM_SHA384)
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
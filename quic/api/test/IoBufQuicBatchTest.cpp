@@ -13,6 +13,7 @@
 #include <quic/common/test/TestUtils.h>
 #include <quic/common/udpsocket/FollyQuicAsyncUDPSocket.h>
 #include <quic/fizz/client/handshake/FizzClientQuicHandshakeContext.h>
+#include <quic/state/test/MockQuicStats.h>
 
 constexpr const auto kNumLoops = 64;
 constexpr const auto kMaxBufs = 10;
@@ -60,4 +61,36 @@ TEST(QuicBatch, TestBatchingNoFlush) {
 TEST(QuicBatch, TestBatching) {
   RunTest(kMaxBufs);
 }
+
+TEST(QuicBatch, TestBatchSizeReported) {
+  folly::EventBase evb;
+  std::shared_ptr<FollyQuicEventBase> qEvb =
+      std::make_shared<FollyQuicEventBase>(&evb);
+  FollyQuicAsyncUDPSocket sock(qEvb);
+
+  auto batchWriter = BatchWriterPtr(new test::TestPacketBatchWriter(kMaxBufs));
+  folly::SocketAddress peerAddress{"127.0.0.1", 1234};
+  ::testing::StrictMock<MockQuicStats> quicStats;
+
+  IOBufQuicBatch ioBufBatch(
+      std::move(batchWriter),
+      sock,
+      peerAddress,
+      &quicStats,
+      nullptr /* happyEyeballsState */);
+
+  // Full batches are flushed as they fill up, the rest on the final flush.
+  EXPECT_CALL(quicStats, onPacketsBatchWritten(kMaxBufs))
+      .Times(kNumLoops / kMaxBufs);
+  EXPECT_CALL(quicStats, onPacketsBatchWritten(kNumLoops % kMaxBufs));
+
+  std::string strTest("Test");
+  for (size_t i = 0; i < kNumLoops; i++) {
+    auto buf = folly::IOBuf::copyBuffer(strTest.c_str(), strTest.length());
+    CHECK(ioBufBatch.write(std::move(buf), strTest.length()));
+  }
+  CHECK(ioBufBatch.flush());
+  // Nothing is reported for an empty batch.
+  CHECK(ioBufBatch.flush());
+}
 } // namespace quic::testing
@@ -131,6 +131,14 @@ class MockQuicSocket : public QuicSocket {
       (quic::Expected<void, LocalErrorCode>),
       setStreamPriority,
       (StreamId, PriorityQueue::Priority));
+  MOCK_METHOD(
+      (quic::Expected<void, LocalErrorCode>),
+      setStreamCorked,
+      (StreamId, bool));
+  MOCK_METHOD(
+      (quic::Expected<void, LocalErrorCode>),
+      setConnectionCorked,
+      (bool));
   MOCK_METHOD(
       (quic::Expected<void, LocalErrorCode>),
       setPriorityQueue,
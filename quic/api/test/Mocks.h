@@ -13,6 +13,7 @@
 #include <quic/api/LoopDetectorCallback.h>
 #include <quic/api/QuicCallbacks.h>
 #include <quic/api/QuicSocket.h>
+#include <quic/state/QuicStreamWaiter.h>
 #include <quic/codec/QuicConnectionId.h>
 #include <quic/common/NetworkData.h>
 #include <quic/common/events/FollyQuicEventBase.h>
@@ -87,6 +88,13 @@ class MockWriteCallback : public QuicSocket::WriteCallback {
   MOCK_METHOD((void), onConnectionWriteError, (QuicError), (noexcept));
 };
 
+class MockStreamWaiter : public QuicStreamWaiter {
+ public:
+  ~MockStreamWaiter() override = default;
+  MOCK_METHOD((void), onStreamReady, (StreamId), (noexcept));
+  MOCK_METHOD((void), onStreamWaitError, (StreamId, QuicError), (noexcept));
+};
+
 class MockConnectionSetupCallback : public QuicSocket::ConnectionSetupCallback {
  public:
   ~MockConnectionSetupCallback() override = default;
@@ -1218,6 +1218,111 @@ TEST_F(QuicBatchWriterTest, InplaceWriterBufResidueCheck) {
   EXPECT_EQ(0, Buf->headroom());
 }
 
+namespace {
+
+// Masks every header bit it's allowed to.
+class AllOnesPacketNumberCipher : public PacketNumberCipher {
+ public:
+  quic::Expected<void, QuicError> setKey(ByteRange /* key */) override {
+    return {};
+  }
+
+  quic::Expected<HeaderProtectionMask, QuicError> mask(
+      ByteRange /* sample */) const override {
+    HeaderProtectionMask allOnes;
+    allOnes.fill(0xff);
+    return allOnes;
+  }
+
+  size_t keyLength() const override {
+    return 0;
+  }
+
+  const BufPtr& getKey() const override {
+    return key_;
+  }
+
+ private:
+  BufPtr key_;
+};
+
+// A short header packet with a 1 byte packet number and no connection id.
+void appendShortHeaderPacket(
+    BufAccessor& bufAccessor,
+    size_t packetLen,
+    uint8_t packetNum) {
+  auto buf = bufAccessor.obtain();
+  auto* packet = buf->writableTail();
+  memset(packet, 0, packetLen);
+  packet[0] = 0x40;
+  packet[1] = packetNum;
+  buf->append(packetLen);
+  bufAccessor.release(std::move(buf));
+}
+
+} // namespace
+
+TEST_F(QuicBatchWriterTest, InplaceWriterDeferredHeadersSurviveEarlyFlush) {
+  folly::EventBase evb;
+  std::shared_ptr<FollyQuicEventBase> qEvb =
+      std::make_shared<FollyQuicEventBase>(&evb);
+  quic::test::MockAsyncUDPSocket sock(qEvb);
+  uint32_t batchSize = 20;
+  auto bufAccessor =
+      std::make_unique<BufAccessor>(conn_.udpSendPacketLen * batchSize);
+  conn_.bufAccessor = bufAccessor.get();
+  gsoSupported_ = true;
+  auto batchWriter = quic::BatchWriterFactory::makeBatchWriter(
+      quic::QuicBatchingMode::BATCHING_MODE_GSO,
+      batchSize,
+      false, /* enable backpressure */
+      DataPathType::ContinuousMemory,
+      conn_,
+      gsoSupported_);
+  AllOnesPacketNumberCipher headerCipher;
+  constexpr size_t kHeaderLen = 2;
+  constexpr uint8_t kProtectedInitialByte = 0x40 ^ ShortHeader::kTypeBitsMask;
+  for (uint8_t i = 0; i < 3; i++) {
+    appendShortHeaderPacket(*bufAccessor, 700, i);
+    ASSERT_TRUE(batchWriter->deferHeaderProtection(
+        HeaderForm::Short, kHeaderLen, 700, headerCipher));
+    ASSERT_FALSE(
+        batchWriter->append(nullptr, 700, folly::SocketAddress(), nullptr));
+  }
+  // The next packet is too big for the batch, so it's flushed early.
+  appendShortHeaderPacket(*bufAccessor, 1000, 3);
+  ASSERT_TRUE(batchWriter->deferHeaderProtection(
+      HeaderForm::Short, kHeaderLen, 1000, headerCipher));
+  EXPECT_TRUE(batchWriter->needsFlush(1000));
+
+  ASSERT_FALSE(batchWriter->protectDeferredHeaders().hasError());
+  EXPECT_CALL(sock, writeGSO(_, _, _, _))
+      .Times(1)
+      .WillOnce(Invoke([&](const auto& /* addr */,
+                           const struct iovec* vec,
+                           size_t,
+                           QuicAsyncUDPSocket::WriteOptions /* options */) {
+        EXPECT_EQ(3 * 700, vec[0].iov_len);
+        auto* data = static_cast<const uint8_t*>(vec[0].iov_base);
+        for (uint8_t i = 0; i < 3; i++) {
+          EXPECT_EQ(kProtectedInitialByte, data[i * 700]);
+          EXPECT_EQ(i ^ 0xff, data[i * 700 + 1]);
+        }
+        return 3 * 700;
+      }));
+  EXPECT_EQ(3 * 700, batchWriter->write(sock, folly::SocketAddress()));
+
+  // The early flush moved the next packet to the start of the buffer, still
+  // unprotected. Its header is protected at its offset there.
+  ASSERT_EQ(1000, bufAccessor->length());
+  EXPECT_EQ(0x40, bufAccessor->data()[0]);
+  ASSERT_FALSE(
+      batchWriter->append(nullptr, 1000, folly::SocketAddress(), nullptr));
+  ASSERT_FALSE(batchWriter->protectDeferredHeaders().hasError());
+  EXPECT_EQ(kProtectedInitialByte, bufAccessor->data()[0]);
+  EXPECT_EQ(3 ^ 0xff, bufAccessor->data()[1]);
+}
+
 class SinglePacketInplaceBatchWriterTest : public ::testing::Test {
  public:
   SinglePacketInplaceBatchWriterTest()
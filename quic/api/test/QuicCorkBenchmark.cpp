@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/portability/GFlags.h>
+#include <quic/server/test/QuicServerTransportTestUtil.h>
+
+using namespace quic;
+using namespace quic::test;
+
+/**
+ * Serves responses that the application produces in small pieces, one per
+ * event loop iteration, the way a proxy relays an upstream body. Each request
+ * writes kChunksPerRequest chunks of kChunkSize bytes with the write looper
+ * running after every chunk, and ends when the application is done with the
+ * response. Uncorked, every chunk goes out in its own packet. Corked, the
+ * stream is uncorked at the end of the response, which sends what is left.
+ *
+ * Besides time per request, reports the packets sent per 1000 requests.
+ * Congestion control is disabled and flow control is kept open, so only
+ * packetization decides how many packets are sent.
+ */
+
+namespace {
+
+constexpr size_t kChunkSize = 150;
+constexpr size_t kChunksPerRequest = 8;
+// Requests served on one transport before it is replaced, which bounds the
+// unacked data the benchmark keeps around.
+constexpr size_t kRequestsPerTransport = 1000;
+
+class CorkBench : public QuicServerTransportAfterStartTestBase {
+ public:
+  void TestBody() override {}
+
+  // Disables congestion control and pacing and opens the response stream.
+  StreamId startServing() {
+    auto& conn = getNonConstConn();
+    conn.congestionController = nullptr;
+    conn.pacer = nullptr;
+    return server->createBidirectionalStream().value();
+  }
+
+  void openFlowControl(StreamId id) {
+    auto& conn = getNonConstConn();
+    conn.flowControlState.peerAdvertisedMaxOffset =
+        conn.flowControlState.sumCurWriteOffset + kChunkSize * 1000;
+    auto stream = CHECK_NOTNULL(
+        conn.streamManager->getStream(id).value_or(nullptr));
+    stream->flowControlState.peerAdvertisedMaxOffset =
+        stream->currentWriteOffset + kChunkSize * 1000;
+  }
+
+  uint64_t packetsSent() const {
+    return server->getConn().lossState.totalPacketsSent;
+  }
+
+  void serveRequest(StreamId id, const BufPtr& chunk, bool cork) {
+    if (cork) {
+      CHECK(server->setStreamCorked(id, true).has_value());
+    }
+    for (size_t i = 0; i < kChunksPerRequest; i++) {
+      CHECK(server->writeChain(id, chunk->clone(), false).has_value());
+      loopForWrites();
+    }
+    if (cork) {
+      CHECK(server->setStreamCorked(id, false).has_value());
+      loopForWrites();
+    }
+  }
+};
+
+void runRequests(folly::UserCounters& counters, size_t iters, bool cork) {
+  folly::BenchmarkSuspender suspender;
+  auto chunk = folly::IOBuf::create(kChunkSize);
+  chunk->append(kChunkSize);
+
+  std::unique_ptr<CorkBench> bench;
+  StreamId id = 0;
+  uint64_t packets = 0;
+  for (size_t i = 0; i < iters; i++) {
+    if (i % kRequestsPerTransport == 0) {
+      bench = std::make_unique<CorkBench>();
+      bench->SetUp();
+      id = bench->startServing();
+    }
+    bench->openFlowControl(id);
+    auto before = bench->packetsSent();
+    suspender.dismissing([&] { bench->serveRequest(id, chunk, cork); });
+    packets += bench->packetsSent() - before;
+  }
+  bench.reset();
+  counters["pkts_per_1k_req"] =
+      static_cast<int64_t>(iters > 0 ? packets * 1000 / iters : 0);
+}
+
+} // namespace
+
+BENCHMARK_COUNTERS(uncorkedResponses, counters, iters) {
+  runRequests(counters, iters, false /* cork */);
+}
+
+BENCHMARK_COUNTERS(corkedResponses, counters, iters) {
+  runRequests(counters, iters, true /* cork */);
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/portability/GFlags.h>
+#include <quic/api/QuicTransportFunctions.h>
+#include <quic/state/QuicStreamFunctions.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace quic;
+
+using FlightWriteFn = void (*)(QuicCryptoStream&, BufPtr);
+
+/**
+ * Runs the crypto stream side of a server handshake flight: the handshake
+ * hands over EncryptedExtensions, Certificate, CertificateVerify and Finished,
+ * they go out as CRYPTO frames and get acked, and the peer reassembles them
+ * and reads them back for its handshake. Packet building and TLS aren't part
+ * of the measurement.
+ *
+ * Besides time, reports the operator new calls made per flight, and prints
+ * the calls of one flight written the way it was before the crypto stream
+ * reserved its retransmission buffer and the way it is now.
+ */
+
+namespace {
+
+uint64_t gNumAllocations{0};
+
+constexpr size_t kFrameSize = 1150;
+
+std::vector<BufPtr> makeFlightMessages() {
+  std::vector<BufPtr> messages;
+  for (size_t size : {90, 3200, 260, 36}) {
+    auto buf = folly::IOBuf::create(size);
+    buf->append(size);
+    messages.push_back(std::move(buf));
+  }
+  return messages;
+}
+
+BufPtr chainMessages(const std::vector<BufPtr>& messages) {
+  BufPtr flight;
+  for (const auto& message : messages) {
+    auto clone = message->clone();
+    if (flight) {
+      flight->appendToChain(std::move(clone));
+    } else {
+      flight = std::move(clone);
+    }
+  }
+  return flight;
+}
+
+// The flight as written before the crypto stream reserved its retransmission
+// buffer.
+void writeWithoutReserve(QuicCryptoStream& stream, BufPtr data) {
+  stream.pendingWrites.append(data);
+  stream.writeBuffer.append(std::move(data));
+}
+
+void writeWithReserve(QuicCryptoStream& stream, BufPtr data) {
+  writeDataToQuicStream(stream, std::move(data));
+}
+
+size_t sendAndAck(QuicCryptoStream& stream) {
+  std::vector<std::pair<uint64_t, uint64_t>> frames;
+  while (stream.pendingWrites.chainLength() > 0) {
+    auto offset = stream.currentWriteOffset;
+    auto len =
+        std::min<uint64_t>(kFrameSize, stream.pendingWrites.chainLength());
+    handleNewStreamDataWritten(stream, len, false /* fin */);
+    frames.emplace_back(offset, len);
+  }
+  for (const auto& [offset, len] : frames) {
+    processCryptoStreamAck(stream, offset, len);
+  }
+  return frames.size();
+}
+
+size_t receiveAndRead(QuicCryptoStream& stream, BufPtr flight) {
+  folly::IOBufQueue queue{folly::IOBufQueue::cacheChainLength()};
+  queue.append(std::move(flight));
+  uint64_t offset = 0;
+  while (!queue.empty()) {
+    auto frame = queue.splitAtMost(kFrameSize);
+    auto len = frame->computeChainDataLength();
+    auto result =
+        appendDataToReadBuffer(stream, StreamBuffer(std::move(frame), offset));
+    CHECK(!result.hasError());
+    offset += len;
+  }
+  auto data = readDataFromCryptoStream(stream);
+  return data ? data->computeChainDataLength() : 0;
+}
+
+// Returns the operator new calls made by the flight.
+uint64_t runFlight(FlightWriteFn write, BufPtr sent, BufPtr received) {
+  auto before = gNumAllocations;
+  {
+    QuicCryptoState cryptoState;
+    write(cryptoState.handshakeStream, std::move(sent));
+    folly::doNotOptimizeAway(sendAndAck(cryptoState.handshakeStream));
+    folly::doNotOptimizeAway(
+        receiveAndRead(cryptoState.handshakeStream, std::move(received)));
+  }
+  return gNumAllocations - before;
+}
+
+void runFlights(
+    folly::UserCounters& counters,
+    size_t iters,
+    FlightWriteFn write) {
+  std::vector<BufPtr> messages;
+  BENCHMARK_SUSPEND {
+    messages = makeFlightMessages();
+  }
+  uint64_t allocations = 0;
+  for (size_t i = 0; i < iters; i++) {
+    BufPtr sent;
+    BufPtr received;
+    BENCHMARK_SUSPEND {
+      sent = chainMessages(messages);
+      received = chainMessages(messages);
+    }
+    allocations += runFlight(write, std::move(sent), std::move(received));
+  }
+  counters["allocs"] =
+      static_cast<int64_t>(iters > 0 ? allocations / iters : 0);
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+  gNumAllocations++;
+  if (auto p = std::malloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+BENCHMARK_COUNTERS(handshakeFlightWithoutReserve, counters, iters) {
+  runFlights(counters, iters, writeWithoutReserve);
+}
+
+BENCHMARK_COUNTERS(handshakeFlight, counters, iters) {
+  runFlights(counters, iters, writeWithReserve);
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  auto messages = makeFlightMessages();
+  auto before = runFlight(
+      writeWithoutReserve, chainMessages(messages), chainMessages(messages));
+  auto after = runFlight(
+      writeWithReserve, chainMessages(messages), chainMessages(messages));
+  printf(
+      "operator new calls per handshake flight: before=%llu after=%llu\n",
+      static_cast<unsigned long long>(before),
+      static_cast<unsigned long long>(after));
+  return 0;
+}
@@ -1637,6 +1637,145 @@ TEST_P(QuicPacketSchedulerTest, StreamFrameSchedulerRoundRobinStreamPerPacket) {
   verifyStreamFrames(*builder2, {f1});
 }
 
+TEST_P(QuicPacketSchedulerTest, StreamFrameSchedulerGsoTrainFillsPacket) {
+  auto connPtr = createConn(10, 100000, 100000, GetParam());
+  auto& conn = *connPtr;
+  conn.transportSettings.streamFramePerPacket = true;
+  conn.transportSettings.gsoTrainScheduling = true;
+  StreamFrameScheduler scheduler(conn);
+
+  auto stream1 = createStream(conn);
+  auto stream2 = createStream(conn);
+  auto stream3 = createStream(conn);
+
+  auto f1 = writeDataToStream(conn, stream1, "some data");
+  auto f2 = writeDataToStream(conn, stream2, "some data");
+  auto f3 = writeDataToStream(conn, stream3, "some data");
+
+  // Streams running out of data don't end the packet early.
+  auto builder = setupMockPacketBuilder();
+  ASSERT_FALSE(scheduler.writeStreams(*builder).hasError());
+  verifyStreamFrames(*builder, {f1, f2, f3});
+}
+
+TEST_P(QuicPacketSchedulerTest, GsoTrainSchedulingPadsPacketMidTrain) {
+  auto connPtr = createConn(10, 100000, 100000, GetParam());
+  auto& conn = *connPtr;
+  conn.transportSettings.paddingModulo = 0;
+  conn.transportSettings.gsoTrainScheduling = true;
+  auto stream = createStream(conn);
+  writeDataToStream(
+      conn, stream, createLargeBuffer(conn.udpSendPacketLen * 2));
+
+  FrameScheduler scheduler = std::move(
+                                 FrameScheduler::Builder(
+                                     conn,
+                                     EncryptionLevel::AppData,
+                                     PacketNumberSpace::AppData,
+                                     "streamScheduler")
+                                     .streamFrames())
+                                 .build();
+  auto makeBuilder = [&]() {
+    ShortHeader shortHeader(
+        ProtectionType::KeyPhaseZero,
+        getTestConnectionId(),
+        getNextPacketNum(conn, PacketNumberSpace::AppData));
+    return RegularQuicPacketBuilder(
+        conn.udpSendPacketLen,
+        std::move(shortHeader),
+        conn.ackStates.appDataAckState.largestAckedByPeer.value_or(0));
+  };
+
+  // Size a datagram so that it leaves one byte in the packet, which is too
+  // little for a stream frame.
+  auto probe = makeBuilder();
+  ASSERT_FALSE(probe.encodePacketHeader().hasError());
+  size_t datagramLength = probe.remainingSpaceInPkt() - 4;
+  ASSERT_FALSE(
+      writeFrame(
+          DatagramFrame(
+              datagramLength, buildRandomInputData(datagramLength)),
+          probe)
+          .hasError());
+  ASSERT_EQ(probe.remainingSpaceInPkt(), 1);
+
+  auto builder = makeBuilder();
+  ASSERT_FALSE(
+      writeFrame(
+          DatagramFrame(
+              datagramLength, buildRandomInputData(datagramLength)),
+          builder)
+          .hasError());
+  auto result = scheduler.scheduleFramesForPacket(
+      std::move(builder), conn.udpSendPacketLen);
+  ASSERT_FALSE(result.hasError());
+
+  // The stream still has data for the next packet of the train, so this one
+  // is padded to full size.
+  EXPECT_EQ(result.value().shortHeaderPadding, 1);
+  auto& packet = *result.value().packet;
+  EXPECT_EQ(
+      packet.header.computeChainDataLength() +
+          packet.body.computeChainDataLength(),
+      conn.udpSendPacketLen);
+}
+
+TEST_P(QuicPacketSchedulerTest, GsoTrainSchedulingLeavesLastPacketShort) {
+  auto connPtr = createConn(10, 100000, 100000, GetParam());
+  auto& conn = *connPtr;
+  conn.transportSettings.paddingModulo = 0;
+  conn.transportSettings.gsoTrainScheduling = true;
+  auto stream = createStream(conn);
+  writeDataToStream(
+      conn, stream, createLargeBuffer(conn.udpSendPacketLen * 2));
+
+  FrameScheduler scheduler = std::move(
+                                 FrameScheduler::Builder(
+                                     conn,
+                                     EncryptionLevel::AppData,
+                                     PacketNumberSpace::AppData,
+                                     "streamScheduler")
+                                     .streamFrames())
+                                 .build();
+  // The window only fits this packet, so it ends the train even though the
+  // stream still has data.
+  scheduler.setTrainPacketsLeft(1);
+  auto makeBuilder = [&]() {
+    ShortHeader shortHeader(
+        ProtectionType::KeyPhaseZero,
+        getTestConnectionId(),
+        getNextPacketNum(conn, PacketNumberSpace::AppData));
+    return RegularQuicPacketBuilder(
+        conn.udpSendPacketLen,
+        std::move(shortHeader),
+        conn.ackStates.appDataAckState.largestAckedByPeer.value_or(0));
+  };
+
+  // Leave one byte in the packet, too little for a stream frame.
+  auto probe = makeBuilder();
+  ASSERT_FALSE(probe.encodePacketHeader().hasError());
+  size_t datagramLength = probe.remainingSpaceInPkt() - 4;
+
+  auto builder = makeBuilder();
+  ASSERT_FALSE(
+      writeFrame(
+          DatagramFrame(
+              datagramLength, buildRandomInputData(datagramLength)),
+          builder)
+          .hasError());
+  auto result = scheduler.scheduleFramesForPacket(
+      std::move(builder), conn.udpSendPacketLen);
+  ASSERT_FALSE(result.hasError());
+
+  EXPECT_TRUE(scheduler.hasData());
+  EXPECT_EQ(result.value().shortHeaderPadding, 0);
+  auto& packet = *result.value().packet;
+  EXPECT_EQ(
+      packet.header.computeChainDataLength() +
+          packet.body.computeChainDataLength(),
+      conn.udpSendPacketLen - 1);
+}
+
 TEST_P(
     QuicPacketSchedulerTest,
     StreamFrameSchedulerRoundRobinStreamPerPacketHitsDsr) {
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/portability/GFlags.h>
+#include <quic/server/test/QuicServerTransportTestUtil.h>
+#include <quic/state/QuicStreamFunctions.h>
+
+using namespace quic;
+using namespace quic::test;
+
+/**
+ * Compares read readiness delivery through read callbacks with stream
+ * waiters on a server with many open streams, of which only a few become
+ * readable on each pass of the read looper. Data is appended to the streams
+ * directly, so packet processing isn't part of the measurement.
+ */
+
+namespace {
+
+constexpr size_t kReadableStreamsPerPass = 16;
+
+class DrainingReadCallback : public QuicSocketLite::ReadCallback {
+ public:
+  explicit DrainingReadCallback(QuicSocketLite& transport)
+      : transport_(transport) {}
+
+  void readAvailable(StreamId id) noexcept override {
+    CHECK(transport_.read(id, 0).has_value());
+  }
+
+  void readError(StreamId /* id */, QuicError /* error */) noexcept override {}
+
+ private:
+  QuicSocketLite& transport_;
+};
+
+class DrainingStreamWaiter : public QuicStreamWaiter {
+ public:
+  explicit DrainingStreamWaiter(QuicTransportBaseLite& transport)
+      : transport_(transport) {}
+
+  void onStreamReady(StreamId id) noexcept override {
+    CHECK(transport_.read(id, 0).has_value());
+    CHECK(transport_.waitForReadable(id, this).has_value());
+  }
+
+  void onStreamWaitError(StreamId /* id */, QuicError /* error */) noexcept
+      override {}
+
+ private:
+  QuicTransportBaseLite& transport_;
+};
+
+class StreamReadinessBench : public QuicServerTransportAfterStartTestBase {
+ public:
+  void TestBody() override {}
+
+  std::vector<StreamId> openPeerStreams(size_t numStreams) {
+    std::vector<StreamId> ids;
+    ids.reserve(numStreams);
+    for (size_t i = 0; i < numStreams; i++) {
+      // Client initiated bidirectional streams.
+      StreamId id = i * 4;
+      CHECK(getNonConstConn().streamManager->getStream(id).has_value());
+      ids.push_back(id);
+    }
+    return ids;
+  }
+
+  // Makes the next few streams readable, as a packet carrying data for them
+  // would.
+  void makeReadable(const std::vector<StreamId>& ids, size_t pass) {
+    static const std::array<uint8_t, 16> kData{};
+    auto& streamManager = *getNonConstConn().streamManager;
+    for (size_t i = 0; i < kReadableStreamsPerPass; i++) {
+      auto id = ids[(pass * kReadableStreamsPerPass + i) % ids.size()];
+      auto stream =
+          CHECK_NOTNULL(streamManager.getStream(id).value_or(nullptr));
+      CHECK(!appendDataToReadBuffer(
+                 *stream,
+                 StreamBuffer(
+                     BufHelpers::copyBuffer(kData.data(), kData.size()),
+                     stream->currentReadOffset))
+                 .hasError());
+      streamManager.updateReadableStreams(*stream);
+    }
+  }
+
+  void runReadPass() {
+    server->readLooper()->runLoopCallback();
+  }
+};
+
+void runReadinessBenchmark(
+    uint32_t iters,
+    size_t numStreams,
+    bool useWaiters) {
+  folly::BenchmarkSuspender suspender;
+  // Declared ahead of the transport, which notifies them when it goes away.
+  std::unique_ptr<DrainingReadCallback> readCallback;
+  std::vector<std::unique_ptr<DrainingStreamWaiter>> waiters;
+
+  auto bench = std::make_unique<StreamReadinessBench>();
+  bench->SetUp();
+  auto& transport = *bench->getTestTransport();
+  auto ids = bench->openPeerStreams(numStreams);
+  readCallback = std::make_unique<DrainingReadCallback>(transport);
+  for (auto id : ids) {
+    if (useWaiters) {
+      waiters.push_back(std::make_unique<DrainingStreamWaiter>(transport));
+      CHECK(transport.waitForReadable(id, waiters.back().get()).has_value());
+    } else {
+      CHECK(transport.setReadCallback(id, readCallback.get()).has_value());
+    }
+  }
+
+  for (uint32_t i = 0; i < iters; i++) {
+    bench->makeReadable(ids, i);
+    suspender.dismissing([&] { bench->runReadPass(); });
+  }
+  bench.reset();
+}
+
+void readCallbacks(uint32_t iters, size_t numStreams) {
+  runReadinessBenchmark(iters, numStreams, false /* useWaiters */);
+}
+
+void streamWaiters(uint32_t iters, size_t numStreams) {
+  runReadinessBenchmark(iters, numStreams, true /* useWaiters */);
+}
+
+} // namespace
+
+BENCHMARK_NAMED_PARAM(readCallbacks, 100_streams, 100)
+BENCHMARK_RELATIVE_NAMED_PARAM(streamWaiters, 100_streams, 100)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM(readCallbacks, 1000_streams, 1000)
+BENCHMARK_RELATIVE_NAMED_PARAM(streamWaiters, 1000_streams, 1000)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM(readCallbacks, 2000_streams, 2000)
+BENCHMARK_RELATIVE_NAMED_PARAM(streamWaiters, 2000_streams, 2000)
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -3227,6 +3227,159 @@ TEST_P(QuicTransportImplTestClose, TestNotifyPendingWriteOnCloseWithError) {
   qEvb->loopOnce();
 }
 
+TEST_P(QuicTransportImplTestBase, ReadWaiterReadiedOnData) {
+  auto stream1 = transport->createBidirectionalStream().value();
+  auto stream2 = transport->createBidirectionalStream().value();
+  auto sendOnly = transport->createUnidirectionalStream().value();
+  NiceMock<MockStreamWaiter> waiter1;
+  NiceMock<MockStreamWaiter> waiter2;
+  EXPECT_EQ(
+      transport->waitForReadable(sendOnly, &waiter1).error(),
+      LocalErrorCode::INVALID_OPERATION);
+  ASSERT_TRUE(transport->waitForReadable(stream1, &waiter1).has_value());
+  ASSERT_TRUE(transport->waitForReadable(stream2, &waiter2).has_value());
+  EXPECT_EQ(
+      transport->waitForReadable(stream1, &waiter2).error(),
+      LocalErrorCode::CALLBACK_ALREADY_INSTALLED);
+
+  EXPECT_CALL(waiter1, onStreamReady(stream1)).WillOnce(Invoke([&](auto) {
+    auto data = transport->read(stream1, 0);
+    ASSERT_TRUE(data.has_value());
+    EXPECT_EQ(data->first->computeChainDataLength(), 18);
+  }));
+  EXPECT_CALL(waiter2, onStreamReady(_)).Times(0);
+  transport->addDataToStream(
+      stream1, StreamBuffer(folly::IOBuf::copyBuffer("actual stream data"), 0));
+  transport->driveReadCallbacks();
+  EXPECT_FALSE(waiter1.isWaiting());
+  EXPECT_EQ(waiter2.waitingOn(), stream2);
+
+  transport->cancelStreamWait(&waiter2);
+  EXPECT_FALSE(waiter2.isWaiting());
+  EXPECT_FALSE(transport->getStream(stream2)->readWaiter);
+  transport.reset();
+}
+
+TEST_P(QuicTransportImplTestBase, ReadWaiterIgnoresOtherReadableStreams) {
+  auto stream1 = transport->createBidirectionalStream().value();
+  auto stream2 = transport->createBidirectionalStream().value();
+  NiceMock<MockStreamWaiter> waiter;
+  ASSERT_TRUE(transport->waitForReadable(stream1, &waiter).has_value());
+
+  // Data on a stream without a waiter doesn't ready the waiter.
+  EXPECT_CALL(waiter, onStreamReady(_)).Times(0);
+  transport->addDataToStream(
+      stream2, StreamBuffer(folly::IOBuf::copyBuffer("other data"), 0));
+  transport->driveReadCallbacks();
+  EXPECT_EQ(waiter.waitingOn(), stream1);
+  Mock::VerifyAndClearExpectations(&waiter);
+
+  EXPECT_CALL(waiter, onStreamReady(stream1));
+  transport->addDataToStream(
+      stream1, StreamBuffer(folly::IOBuf::copyBuffer("own data"), 0));
+  transport->driveReadCallbacks();
+  EXPECT_FALSE(waiter.isWaiting());
+  transport.reset();
+}
+
+TEST_P(QuicTransportImplTestBase, ReadWaiterOnReadableStream) {
+  auto stream1 = transport->createBidirectionalStream().value();
+  auto stream2 = transport->createBidirectionalStream().value();
+  auto& readyReadWaiters =
+      transport->getConnectionState().streamManager->readyReadWaiters();
+  transport->addDataToStream(
+      stream1, StreamBuffer(folly::IOBuf::copyBuffer("early data"), 0));
+  transport->addDataToStream(
+      stream2, StreamBuffer(folly::IOBuf::copyBuffer("early data"), 0));
+  EXPECT_TRUE(readyReadWaiters.empty());
+
+  // Waiters parked on streams that are already readable are ready at once.
+  NiceMock<MockStreamWaiter> waiter1;
+  NiceMock<MockStreamWaiter> waiter2;
+  ASSERT_TRUE(transport->waitForReadable(stream1, &waiter1).has_value());
+  ASSERT_TRUE(transport->waitForReadable(stream2, &waiter2).has_value());
+  EXPECT_EQ(readyReadWaiters.size(), 2);
+
+  // A cancelled waiter leaves the ready list.
+  transport->cancelStreamWait(&waiter2);
+  EXPECT_EQ(readyReadWaiters.size(), 1);
+
+  EXPECT_CALL(waiter1, onStreamReady(stream1)).WillOnce(Invoke([&](auto id) {
+    EXPECT_TRUE(transport->read(id, 0).has_value());
+  }));
+  EXPECT_CALL(waiter2, onStreamReady(_)).Times(0);
+  transport->driveReadCallbacks();
+  EXPECT_FALSE(waiter1.isWaiting());
+  EXPECT_TRUE(readyReadWaiters.empty());
+
+  // Once drained, the stream is no longer readable and its waiter waits.
+  ASSERT_TRUE(transport->waitForReadable(stream1, &waiter1).has_value());
+  EXPECT_TRUE(readyReadWaiters.empty());
+  EXPECT_EQ(waiter1.waitingOn(), stream1);
+  transport.reset();
+}
+
+TEST_P(QuicTransportImplTestBase, NullStreamWaiter) {
+  auto stream = transport->createBidirectionalStream().value();
+  EXPECT_EQ(
+      transport->waitForReadable(stream, nullptr).error(),
+      LocalErrorCode::INVALID_OPERATION);
+  EXPECT_EQ(
+      transport->waitForWritable(stream, nullptr).error(),
+      LocalErrorCode::INVALID_OPERATION);
+  transport.reset();
+}
+
+TEST_P(QuicTransportImplTestBase, ReadWaiterGetsStreamReadError) {
+  auto stream = transport->createBidirectionalStream().value();
+  NiceMock<MockStreamWaiter> waiter;
+  ASSERT_TRUE(transport->waitForReadable(stream, &waiter).has_value());
+
+  EXPECT_CALL(waiter, onStreamReady(_)).Times(0);
+  EXPECT_CALL(
+      waiter, onStreamWaitError(stream, IsError(LocalErrorCode::NO_ERROR)));
+  transport->addStreamReadError(stream, LocalErrorCode::NO_ERROR);
+  transport->driveReadCallbacks();
+  EXPECT_FALSE(waiter.isWaiting());
+  transport.reset();
+}
+
+TEST_P(QuicTransportImplTestBase, WriteWaiterReadiedAsync) {
+  auto stream = transport->createBidirectionalStream().value();
+  NiceMock<MockStreamWaiter> waiter;
+  EXPECT_CALL(waiter, onStreamReady(stream)).Times(0);
+  ASSERT_TRUE(transport->waitForWritable(stream, &waiter).has_value());
+  Mock::VerifyAndClearExpectations(&waiter);
+
+  EXPECT_CALL(waiter, onStreamReady(stream));
+  qEvb->loopOnce();
+  EXPECT_FALSE(waiter.isWaiting());
+  EXPECT_FALSE(transport->getStream(stream)->writeWaiter);
+}
+
+TEST_P(QuicTransportImplTestBase, StreamWaitersFailedOnClose) {
+  auto stream = transport->createBidirectionalStream().value();
+  NiceMock<MockStreamWaiter> readWaiter;
+  NiceMock<MockStreamWaiter> writeWaiter;
+  ASSERT_TRUE(transport->waitForReadable(stream, &readWaiter).has_value());
+  ASSERT_TRUE(transport->waitForWritable(stream, &writeWaiter).has_value());
+
+  EXPECT_CALL(readWaiter, onStreamReady(_)).Times(0);
+  EXPECT_CALL(writeWaiter, onStreamReady(_)).Times(0);
+  EXPECT_CALL(
+      readWaiter,
+      onStreamWaitError(
+          stream, IsError(GenericApplicationErrorCode::NO_ERROR)));
+  EXPECT_CALL(
+      writeWaiter,
+      onStreamWaitError(
+          stream, IsError(GenericApplicationErrorCode::NO_ERROR)));
+  transport->close(std::nullopt);
+  qEvb->loopOnce();
+  EXPECT_FALSE(readWaiter.isWaiting());
+  EXPECT_FALSE(writeWaiter.isWaiting());
+}
+
 TEST_P(QuicTransportImplTestBase, TestTransportCloseWithMaxPacketNumber) {
   transport->setServerConnectionId();
   transport->transportConn->pendingEvents.closeTransport = false;
@@ -16,6 +16,7 @@
 #include <quic/logging/FileQLogger.h>
 #include <quic/logging/QLoggerConstants.h>
 #include <quic/server/state/ServerStateMachine.h>
+#include <quic/state/SimpleFrameFunctions.h>
 #include <quic/state/test/MockQuicStats.h>
 #include <quic/state/test/Mocks.h>
 
@@ -1059,6 +1060,7 @@ TEST_F(QuicTransportFunctionsTest, TestUpdateConnectionPureAckCounter) {
 
   conn->pendingEvents.resets.emplace(
       1, RstStreamFrame(1, GenericApplicationErrorCode::UNKNOWN, 0));
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::RESET);
   auto packet2 = buildEmptyPacket(*conn, PacketNumberSpace::Handshake);
   RstStreamFrame rstFrame(1, GenericApplicationErrorCode::UNKNOWN, 0);
   packet2.packet.frames.push_back(std::move(rstFrame));
@@ -1754,6 +1756,7 @@ TEST_F(QuicTransportFunctionsTest, TestUpdateConnectionWithCloneResult) {
   auto maxDataAmt = 1000 + conn->flowControlState.advertisedMaxOffset;
   MaxDataFrame maxDataFrame(maxDataAmt);
   conn->pendingEvents.connWindowUpdate = true;
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::CONN_WINDOW_UPDATE);
   writePacket.frames.push_back(std::move(maxDataFrame));
   ClonedPacketIdentifier clonedPacketIdentifier(PacketNumberSpace::AppData, 1);
   conn->outstandings.clonedPacketIdentifiers.insert(clonedPacketIdentifier);
@@ -1850,6 +1853,7 @@ TEST_F(QuicTransportFunctionsTest, TestUpdateConnectionConnWindowUpdate) {
   conn->qLogger = std::make_shared<quic::FileQLogger>(VantagePoint::Client);
   auto packet = buildEmptyPacket(*conn, PacketNumberSpace::Handshake);
   conn->pendingEvents.connWindowUpdate = true;
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::CONN_WINDOW_UPDATE);
   MaxDataFrame connWindowUpdate(conn->flowControlState.advertisedMaxOffset);
   packet.packet.frames.push_back(std::move(connWindowUpdate));
   auto result = updateConnection(
@@ -4152,12 +4156,14 @@ TEST_F(
   // There are writable bytes and a challenge.
   conn->pendingEvents.pathChallenges.emplace(
       pathInfo.id, PathChallengeFrame(12345));
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   EXPECT_EQ(WriteDataReason::PATH_VALIDATION, shouldWriteData(*conn));
 
   // There are writable bytes and a response.
   conn->pendingEvents.pathChallenges.clear();
   conn->pendingEvents.pathResponses.emplace(
       pathInfo.id, PathResponseFrame(12345));
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   EXPECT_EQ(WriteDataReason::PATH_VALIDATION, shouldWriteData(*conn));
 
   // There is a reponse but no writable bytes
@@ -4169,6 +4175,7 @@ TEST_F(
   conn->pendingEvents.pathResponses.clear();
   conn->pendingEvents.pathChallenges.emplace(
       pathInfo.id, PathChallengeFrame(12345));
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   EXPECT_EQ(WriteDataReason::NO_WRITE, shouldWriteData(*conn));
 }
 
@@ -4334,9 +4341,149 @@ TEST_F(QuicTransportFunctionsTest, HasDatagramsToWrite) {
   EXPECT_EQ(WriteDataReason::NO_WRITE, hasNonAckDataToWrite(*conn));
   conn->datagramState.writeBuffer.emplace_back(
       folly::IOBuf::copyBuffer("I'm an unreliable Datagram"));
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::DATAGRAM);
   EXPECT_EQ(WriteDataReason::DATAGRAM, hasNonAckDataToWrite(*conn));
 }
 
+TEST_F(QuicTransportFunctionsTest, PendingWriteReasonsTrackQueuedEvents) {
+  auto conn = createConn();
+  conn->oneRttWriteCipher = test::createNoOpAead();
+  EXPECT_EQ(0, conn->pendingEvents.pendingWriteReasons);
+
+  onConnWindowUpdateLost(*conn);
+  EXPECT_TRUE(conn->pendingEvents.hasPendingWrite(
+      PendingWriteReason::CONN_WINDOW_UPDATE));
+  EXPECT_EQ(WriteDataReason::CONN_WINDOW_UPDATE, shouldWriteData(*conn));
+
+  // Sending the update clears its bit.
+  onConnWindowUpdateSent(
+      *conn, generateMaxDataFrame(*conn).maximumData, Clock::now());
+  EXPECT_EQ(0, conn->pendingEvents.pendingWriteReasons);
+  EXPECT_EQ(WriteDataReason::NO_WRITE, shouldWriteData(*conn));
+
+  // A simple frame stays marked until the last queued one is sent.
+  sendSimpleFrame(*conn, HandshakeDoneFrame());
+  sendSimpleFrame(*conn, MaxStreamsFrame(100, true));
+  EXPECT_EQ(WriteDataReason::SIMPLE, hasNonAckDataToWrite(*conn));
+  updateSimpleFrameOnPacketSent(
+      *conn, conn->currentPathId, QuicSimpleFrame(HandshakeDoneFrame()));
+  EXPECT_TRUE(
+      conn->pendingEvents.hasPendingWrite(PendingWriteReason::SIMPLE_FRAME));
+  updateSimpleFrameOnPacketSent(
+      *conn, conn->currentPathId, QuicSimpleFrame(MaxStreamsFrame(100, true)));
+  EXPECT_EQ(0, conn->pendingEvents.pendingWriteReasons);
+  EXPECT_EQ(WriteDataReason::NO_WRITE, hasNonAckDataToWrite(*conn));
+
+  // So does a path challenge, until the path validation events drain.
+  conn->pendingEvents.pathChallenges.emplace(
+      conn->currentPathId, PathChallengeFrame(123));
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
+  EXPECT_EQ(WriteDataReason::PATH_VALIDATION, hasNonAckDataToWrite(*conn));
+  conn->pendingEvents.pathChallenges.clear();
+  conn->pendingEvents.maybeClearPathValidationWrite();
+  EXPECT_EQ(0, conn->pendingEvents.pendingWriteReasons);
+  EXPECT_EQ(WriteDataReason::NO_WRITE, hasNonAckDataToWrite(*conn));
+}
+
+TEST_F(QuicTransportFunctionsTest, CoalescedWindowUpdatesWaitForAck) {
+  auto conn = createConn();
+  conn->oneRttWriteCipher = test::createNoOpAead();
+  conn->transportSettings.coalesceFlowControlUpdates = true;
+  conn->pendingEvents.connWindowUpdate = true;
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::CONN_WINDOW_UPDATE);
+  conn->streamManager->queueWindowUpdate(1);
+  EXPECT_EQ(
+      WriteDataReason::STREAM_WINDOW_UPDATE, hasNonAckDataToWrite(*conn));
+
+  // An ACK is owed to the peer, the updates wait for it.
+  conn->ackStates.appDataAckState.numRxPacketsRecvd = 1;
+  EXPECT_TRUE(shouldDeferFlowControlUpdates(*conn));
+  EXPECT_EQ(WriteDataReason::NO_WRITE, hasNonAckDataToWrite(*conn));
+
+  conn->pendingEvents.urgentWindowUpdate = true;
+  EXPECT_FALSE(shouldDeferFlowControlUpdates(*conn));
+  EXPECT_EQ(
+      WriteDataReason::STREAM_WINDOW_UPDATE, hasNonAckDataToWrite(*conn));
+
+  conn->pendingEvents.urgentWindowUpdate = false;
+  conn->transportSettings.coalesceFlowControlUpdates = false;
+  EXPECT_EQ(
+      WriteDataReason::STREAM_WINDOW_UPDATE, hasNonAckDataToWrite(*conn));
+}
+
+TEST_F(QuicTransportFunctionsTest, CoalescedStreamLimitUpdatesWaitForWrite) {
+  auto conn = createConn();
+  conn->transportSettings.coalesceFlowControlUpdates = true;
+  conn->transportSettings.advertisedInitialMaxStreamsBidi = 10;
+  ASSERT_FALSE(
+      conn->streamManager->refreshTransportSettings(conn->transportSettings)
+          .hasError());
+  conn->streamManager->setStreamLimitWindowingFraction(1);
+  conn->ackStates.appDataAckState.numRxPacketsRecvd = 1;
+  for (int i = 0; i < 10; i++) {
+    auto streamResult =
+        conn->streamManager->getStream(i * detail::kStreamIncrement);
+    ASSERT_FALSE(streamResult.hasError());
+    auto* stream = streamResult.value();
+    stream->sendState = StreamSendState::Closed;
+    stream->recvState = StreamRecvState::Closed;
+    ASSERT_FALSE(
+        conn->streamManager->removeClosedStream(stream->id).hasError());
+    maybeSendStreamLimitUpdates(*conn);
+  }
+  // The update waits for the write that carries the owed ACK.
+  EXPECT_TRUE(conn->pendingEvents.frames.empty());
+
+  sendStreamLimitUpdates(*conn);
+  ASSERT_EQ(conn->pendingEvents.frames.size(), 1);
+  auto maxStreamsFrame = conn->pendingEvents.frames.front().asMaxStreamsFrame();
+  ASSERT_NE(maxStreamsFrame, nullptr);
+  EXPECT_EQ(maxStreamsFrame->maxStreams, 20);
+  EXPECT_TRUE(maxStreamsFrame->isForBidirectionalStream());
+}
+
+TEST_F(QuicTransportFunctionsTest, UpdateConnectionControlFrameOnlyPackets) {
+  auto conn = createConn();
+  auto packet = buildEmptyPacket(*conn, PacketNumberSpace::AppData);
+  conn->pendingEvents.connWindowUpdate = true;
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::CONN_WINDOW_UPDATE);
+  packet.packet.frames.emplace_back(
+      MaxDataFrame(conn->flowControlState.advertisedMaxOffset));
+  packet.packet.frames.emplace_back(PaddingFrame());
+  EXPECT_CALL(*quicStats_, onControlFrameOnlyPacketSent()).Times(1);
+  ASSERT_FALSE(updateConnection(
+                   *conn,
+                   *currentPathInfo_,
+                   std::nullopt,
+                   packet.packet,
+                   TimePoint(),
+                   getEncodedSize(packet),
+                   getEncodedBodySize(packet),
+                   false /* isDSRPacket */)
+                   .hasError());
+  EXPECT_EQ(conn->numControlFrameOnlyPacketsSent, 1);
+
+  // A window update riding along with a PING doesn't count.
+  auto packet2 = buildEmptyPacket(*conn, PacketNumberSpace::AppData);
+  conn->pendingEvents.connWindowUpdate = true;
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::CONN_WINDOW_UPDATE);
+  packet2.packet.frames.emplace_back(
+      MaxDataFrame(conn->flowControlState.advertisedMaxOffset));
+  packet2.packet.frames.emplace_back(PingFrame());
+  EXPECT_CALL(*quicStats_, onControlFrameOnlyPacketSent()).Times(0);
+  ASSERT_FALSE(updateConnection(
+                   *conn,
+                   *currentPathInfo_,
+                   std::nullopt,
+                   packet2.packet,
+                   TimePoint(),
+                   getEncodedSize(packet2),
+                   getEncodedBodySize(packet2),
+                   false /* isDSRPacket */)
+                   .hasError());
+  EXPECT_EQ(conn->numControlFrameOnlyPacketsSent, 1);
+}
+
 TEST_F(QuicTransportFunctionsTest, UpdateConnectionCloneCounterAppData) {
   auto conn = createConn();
   ASSERT_EQ(
@@ -4345,6 +4492,7 @@ TEST_F(QuicTransportFunctionsTest, UpdateConnectionCloneCounterAppData) {
   auto connWindowUpdate =
       MaxDataFrame(conn->flowControlState.advertisedMaxOffset);
   conn->pendingEvents.connWindowUpdate = true;
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::CONN_WINDOW_UPDATE);
   packet.packet.frames.emplace_back(connWindowUpdate);
   ClonedPacketIdentifier clonedPacketIdentifier(
       PacketNumberSpace::AppData, 100);
@@ -4375,6 +4523,7 @@ TEST_F(QuicTransportFunctionsTest, UpdateConnectionCloneCounterHandshake) {
   auto connWindowUpdate =
       MaxDataFrame(conn->flowControlState.advertisedMaxOffset);
   conn->pendingEvents.connWindowUpdate = true;
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::CONN_WINDOW_UPDATE);
   packet.packet.frames.emplace_back(connWindowUpdate);
   ClonedPacketIdentifier clonedPacketIdentifier(
       PacketNumberSpace::AppData, 100);
@@ -4405,6 +4554,7 @@ TEST_F(QuicTransportFunctionsTest, UpdateConnectionCloneCounterInitial) {
   auto connWindowUpdate =
       MaxDataFrame(conn->flowControlState.advertisedMaxOffset);
   conn->pendingEvents.connWindowUpdate = true;
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::CONN_WINDOW_UPDATE);
   packet.packet.frames.emplace_back(connWindowUpdate);
   ClonedPacketIdentifier clonedPacketIdentifier(
       PacketNumberSpace::AppData, 100);
@@ -4483,6 +4633,7 @@ TEST_F(QuicTransportFunctionsTest, TwoConnWindowUpdateWillCrash) {
   packet.packet.frames.emplace_back(connWindowUpdate);
   packet.packet.frames.emplace_back(connWindowUpdate);
   conn->pendingEvents.connWindowUpdate = true;
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::CONN_WINDOW_UPDATE);
   EXPECT_DEATH(
       (void)updateConnection(
           *conn,
@@ -4528,6 +4679,7 @@ TEST_F(QuicTransportFunctionsTest, ClearRstFromPendingEvents) {
       stream->id, GenericApplicationErrorCode::UNKNOWN, 0);
   packet.packet.frames.push_back(rstStreamFrame);
   conn->pendingEvents.resets.emplace(stream->id, rstStreamFrame);
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::RESET);
   ASSERT_FALSE(updateConnection(
                    *conn,
                    *currentPathInfo_,
@@ -5560,4 +5712,131 @@ TEST_F(QuicTransportFunctionsTest, CongestionControlWithImminentStream) {
   EXPECT_FALSE(conn->imminentStreamCompletion);
 }
 
+TEST_F(QuicTransportFunctionsTest, EncryptPacketHeadersMatchesSingle) {
+  FizzCryptoFactory cryptoFactory;
+  auto cipherResult = cryptoFactory.makePacketNumberCipher(
+      fizz::CipherSuite::TLS_AES_128_GCM_SHA256);
+  ASSERT_FALSE(cipherResult.hasError());
+  auto headerCipher = std::move(cipherResult.value());
+  std::vector<uint8_t> key(headerCipher->keyLength(), 0x5a);
+  ASSERT_FALSE(headerCipher->setKey(ByteRange(key.data(), key.size()))
+                   .hasError());
+
+  // More packets than encryptPacketHeaders masks at once, with every header
+  // form and packet number length.
+  constexpr size_t kNumPackets = 70;
+  constexpr size_t kPacketLen = 64;
+  constexpr size_t kHeaderPrefixLen = 10;
+  std::vector<uint8_t> batch(kNumPackets * kPacketLen);
+  std::vector<PacketHeaderToEncrypt> packets;
+  for (size_t i = 0; i < kNumPackets; i++) {
+    auto* packet = batch.data() + i * kPacketLen;
+    for (size_t j = 0; j < kPacketLen; j++) {
+      packet[j] = static_cast<uint8_t>(i * 31 + j * 7);
+    }
+    size_t packetNumberLength = i % kMaxPacketNumEncodingSize + 1;
+    auto headerForm = i % 2 ? HeaderForm::Short : HeaderForm::Long;
+    packet[0] = (headerForm == HeaderForm::Short ? 0x40 : 0xc0) |
+        static_cast<uint8_t>(packetNumberLength - 1);
+    size_t headerLen = kHeaderPrefixLen + packetNumberLength;
+    packets.push_back(
+        {headerForm,
+         packet,
+         headerLen,
+         packet + headerLen,
+         kPacketLen - headerLen});
+  }
+  auto original = batch;
+  auto expected = batch;
+  for (size_t i = 0; i < kNumPackets; i++) {
+    auto offset = i * kPacketLen;
+    ASSERT_FALSE(encryptPacketHeader(
+                     packets[i].headerForm,
+                     expected.data() + offset,
+                     packets[i].headerLen,
+                     expected.data() + offset + packets[i].headerLen,
+                     packets[i].bodyLen,
+                     *headerCipher)
+                     .hasError());
+  }
+  ASSERT_FALSE(
+      encryptPacketHeaders(packets.data(), packets.size(), *headerCipher)
+          .hasError());
+  EXPECT_EQ(batch, expected);
+  EXPECT_NE(batch, original);
+}
+
+namespace {
+
+// Protects headers by counting them, so tests can see which entry points
+// the batch goes through.
+class CountingPacketNumberCipher : public PacketNumberCipher {
+ public:
+  quic::Expected<void, QuicError> setKey(ByteRange /* key */) override {
+    return {};
+  }
+
+  quic::Expected<HeaderProtectionMask, QuicError> mask(
+      ByteRange /* sample */) const override {
+    ADD_FAILURE() << "Masks must come from the header overrides";
+    return HeaderProtectionMask{};
+  }
+
+  quic::Expected<void, QuicError> encryptLongHeader(
+      ByteRange /* sample */,
+      MutableByteRange /* initialByte */,
+      MutableByteRange /* packetNumberBytes */) const override {
+    longHeaders++;
+    return {};
+  }
+
+  quic::Expected<void, QuicError> encryptShortHeader(
+      ByteRange /* sample */,
+      MutableByteRange /* initialByte */,
+      MutableByteRange /* packetNumberBytes */) const override {
+    shortHeaders++;
+    return {};
+  }
+
+  size_t keyLength() const override {
+    return 0;
+  }
+
+  const BufPtr& getKey() const override {
+    return key_;
+  }
+
+  mutable size_t longHeaders{0};
+  mutable size_t shortHeaders{0};
+
+ private:
+  BufPtr key_;
+};
+
+} // namespace
+
+TEST_F(QuicTransportFunctionsTest, EncryptPacketHeadersUsesCipherOverrides) {
+  constexpr size_t kPacketLen = 64;
+  constexpr size_t kHeaderLen = 5;
+  std::vector<uint8_t> batch(3 * kPacketLen);
+  std::vector<PacketHeaderToEncrypt> packets;
+  for (size_t i = 0; i < 3; i++) {
+    auto* packet = batch.data() + i * kPacketLen;
+    auto headerForm = i == 0 ? HeaderForm::Long : HeaderForm::Short;
+    packet[0] = headerForm == HeaderForm::Short ? 0x40 : 0xc0;
+    packets.push_back(
+        {headerForm,
+         packet,
+         kHeaderLen,
+         packet + kHeaderLen,
+         kPacketLen - kHeaderLen});
+  }
+  CountingPacketNumberCipher headerCipher;
+  ASSERT_FALSE(
+      encryptPacketHeaders(packets.data(), packets.size(), headerCipher)
+          .hasError());
+  EXPECT_EQ(headerCipher.longHeaders, 1);
+  EXPECT_EQ(headerCipher.shortHeaders, 2);
+}
+
 } // namespace quic::test
@@ -2559,6 +2559,7 @@ TEST_F(QuicTransportTest, SendPathChallenge) {
   ASSERT_FALSE(pathChallengeData.hasError());
   PathChallengeFrame pathChallenge(pathChallengeData.value());
   conn.pendingEvents.pathChallenges.emplace(conn.currentPathId, pathChallenge);
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   transport_->updateWriteLooper(true);
 
   ASSERT_FALSE(conn.pendingEvents.schedulePathValidationTimeout);
@@ -2615,6 +2616,7 @@ TEST_F(QuicTransportTest, PathValidationTimeoutExpired) {
   ASSERT_FALSE(pathChallengeData.hasError());
   PathChallengeFrame pathChallenge(pathChallengeData.value());
   conn.pendingEvents.pathChallenges.emplace(conn.currentPathId, pathChallenge);
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   transport_->updateWriteLooper(true);
 
   ASSERT_FALSE(conn.pendingEvents.schedulePathValidationTimeout);
@@ -2658,6 +2660,7 @@ TEST_F(QuicTransportTest, SendPathChallengeWhileThereIsOutstandingOne) {
   ASSERT_FALSE(pathChallengeData.hasError());
   PathChallengeFrame pathChallenge(pathChallengeData.value());
   conn.pendingEvents.pathChallenges.emplace(conn.currentPathId, pathChallenge);
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   transport_->updateWriteLooper(true);
 
   ASSERT_FALSE(conn.pendingEvents.schedulePathValidationTimeout);
@@ -2677,6 +2680,7 @@ TEST_F(QuicTransportTest, SendPathChallengeWhileThereIsOutstandingOne) {
   // Resending the same path challenge due to loss/clone should not reset the
   // path validation timeout
   conn.pendingEvents.pathChallenges.emplace(conn.currentPathId, pathChallenge);
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   transport_->updateWriteLooper(true);
   loopForWrites();
   ASSERT_EQ(conn.pathManager->getEarliestChallengeTimeout().value(), timeout);
@@ -2687,6 +2691,7 @@ TEST_F(QuicTransportTest, SendPathChallengeWhileThereIsOutstandingOne) {
   ASSERT_FALSE(pathChallengeData2.hasError());
   PathChallengeFrame pathChallenge2(pathChallengeData2.value());
   conn.pendingEvents.pathChallenges.emplace(conn.currentPathId, pathChallenge2);
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   transport_->updateWriteLooper(true);
   loopForWrites();
   EXPECT_NE(conn.pathManager->getEarliestChallengeTimeout().value(), timeout);
@@ -2724,6 +2729,7 @@ TEST_F(QuicTransportTest, ClonePathChallengeOnCurrentValidatingPath) {
   ASSERT_FALSE(pathChallengeData.hasError());
   PathChallengeFrame pathChallenge(pathChallengeData.value());
   conn.pendingEvents.pathChallenges.emplace(conn.currentPathId, pathChallenge);
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   transport_->updateWriteLooper(true);
   loopForWrites();
   EXPECT_EQ(path->status, PathStatus::Validating);
@@ -2770,6 +2776,7 @@ TEST_F(QuicTransportTest, DoNotCloneOldPathChallengeOnCurrentValidatingPath) {
   ASSERT_FALSE(pathChallengeData.hasError());
   PathChallengeFrame pathChallenge(pathChallengeData.value());
   conn.pendingEvents.pathChallenges.emplace(conn.currentPathId, pathChallenge);
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   transport_->updateWriteLooper(true);
   loopForWrites();
   EXPECT_EQ(path->status, PathStatus::Validating);
@@ -2816,6 +2823,7 @@ TEST_F(QuicTransportTest, DoNotClonePathChallengeOnCurrentValidatedPath) {
   ASSERT_FALSE(pathChallengeData.hasError());
   PathChallengeFrame pathChallenge(pathChallengeData.value());
   conn.pendingEvents.pathChallenges.emplace(conn.currentPathId, pathChallenge);
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   transport_->updateWriteLooper(true);
   loopForWrites();
 
@@ -2861,6 +2869,7 @@ TEST_F(QuicTransportTest, DoNotClonePathChallengeOnAlternatePath) {
   ASSERT_FALSE(pathChallengeData.hasError());
   PathChallengeFrame pathChallenge(pathChallengeData.value());
   conn.pendingEvents.pathChallenges.emplace(path->id, pathChallenge);
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
 
   transport_->updateWriteLooper(true);
   loopForWrites();
@@ -2909,6 +2918,7 @@ TEST_F(QuicTransportTest, ResendPathChallengeOnLossForCurrentValidatingPath) {
   ASSERT_FALSE(pathChallengeData.hasError());
   PathChallengeFrame pathChallenge(pathChallengeData.value());
   conn.pendingEvents.pathChallenges.emplace(conn.currentPathId, pathChallenge);
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   transport_->updateWriteLooper(true);
   loopForWrites();
   EXPECT_EQ(path->status, PathStatus::Validating);
@@ -2956,6 +2966,7 @@ TEST_F(
   ASSERT_FALSE(pathChallengeData.hasError());
   PathChallengeFrame pathChallenge(pathChallengeData.value());
   conn.pendingEvents.pathChallenges.emplace(conn.currentPathId, pathChallenge);
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   transport_->updateWriteLooper(true);
   loopForWrites();
 
@@ -2988,6 +2999,7 @@ TEST_F(QuicTransportTest, SendPathResponse) {
   EXPECT_EQ(conn.pendingEvents.frames.size(), 0);
   PathResponseFrame pathResponse(123);
   conn.pendingEvents.pathResponses.emplace(conn.currentPathId, pathResponse);
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   EXPECT_EQ(conn.pendingEvents.pathResponses.size(), 1);
   transport_->updateWriteLooper(true);
   loopForWrites();
@@ -3058,6 +3070,7 @@ TEST_F(QuicTransportTest, ClonePathResponse) {
   EXPECT_EQ(conn.pendingEvents.frames.size(), 0);
   PathResponseFrame pathResponse(123);
   conn.pendingEvents.pathResponses.emplace(conn.currentPathId, pathResponse);
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   transport_->updateWriteLooper(true);
   loopForWrites();
   EXPECT_EQ(conn.pendingEvents.pathResponses.size(), 0);
@@ -3083,6 +3096,7 @@ TEST_F(QuicTransportTest, ResendPathResponseOnLossValidPath) {
 
   conn.pendingEvents.pathResponses.emplace(
       conn.currentPathId, PathResponseFrame(folly::Random::rand64()));
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   transport_->updateWriteLooper(true);
   loopForWrites();
 
@@ -3121,6 +3135,7 @@ TEST_F(QuicTransportTest, ResendPathResponseOnLossNotValidPath) {
 
   conn.pendingEvents.pathResponses.emplace(
       conn.currentPathId, PathResponseFrame(folly::Random::rand64()));
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   transport_->updateWriteLooper(true);
   loopForWrites();
 
@@ -3167,6 +3182,7 @@ TEST_F(QuicTransportTest, ResendPathResponseOnLossValidatingPath) {
 
   conn.pendingEvents.pathResponses.emplace(
       conn.currentPathId, PathResponseFrame(folly::Random::rand64()));
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
   transport_->updateWriteLooper(true);
   loopForWrites();
 
@@ -3659,6 +3675,7 @@ TEST_F(QuicTransportTest, WriteWindowUpdate) {
   conn.flowControlState.windowSize = 100;
   conn.flowControlState.advertisedMaxOffset = 0;
   conn.pendingEvents.connWindowUpdate = true;
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::CONN_WINDOW_UPDATE);
   EXPECT_CALL(*socket_, write(_, _, _))
       .WillOnce(testing::WithArgs<1, 2>(Invoke(getTotalIovecLen)));
   auto res = writeQuicDataToSocket(
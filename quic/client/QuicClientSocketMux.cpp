@@ -0,0 +1,1056 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/client/QuicClientSocketMux.h>
+
+#include <folly/Random.h>
+#include <quic/codec/Decode.h>
+#include <quic/common/ContiguousCursor.h>
+
+#include <algorithm>
+
+namespace quic {
+
+namespace {
+
+constexpr socklen_t kAddrLen = sizeof(sockaddr_storage);
+
+// Rounds of the Feistel network that permutes connection ids. Four rounds of
+// a pseudorandom function make a strong pseudorandom permutation.
+constexpr uint8_t kConnectionIdRounds = 4;
+
+QuicError muxError(std::string message) {
+  return QuicError(
+      QuicErrorCode(LocalErrorCode::INTERNAL_ERROR), std::move(message));
+}
+
+size_t iovecLength(const struct iovec* vec, size_t iovecLen) {
+  size_t len = 0;
+  for (size_t i = 0; i < iovecLen; i++) {
+    len += vec[i].iov_len;
+  }
+  return len;
+}
+
+} // namespace
+
+QuicClientSocketMux::QuicClientSocketMux(
+    std::shared_ptr<QuicEventBase> evb,
+    std::unique_ptr<QuicAsyncUDPSocket> socket,
+    std::unique_ptr<PacketNumberCipher> connectionIdCipher,
+    Options options)
+    : evb_(std::move(evb)),
+      socket_(std::move(socket)),
+      connectionIdCipher_(std::move(connectionIdCipher)),
+      options_(std::move(options)) {
+  CHECK(connectionIdCipher_);
+  CHECK_GE(options_.connectionIdSize, kMinConnectionIdSize);
+  CHECK_LE(options_.connectionIdSize, kMaxConnectionIdSize);
+  CHECK_GT(options_.numPacketsPerRead, 0);
+  CHECK_GT(options_.maxWriteBatchSize, 0);
+  CHECK_GT(options_.maxAggregatedWriteSize, 0);
+  nextRoutingKey_ = folly::Random::rand32();
+}
+
+QuicClientSocketMux::~QuicClientSocketMux() {
+  // Connection sockets keep the mux alive, so none can be left here.
+  DCHECK(connections_.empty());
+  if (socket_ && socket_->isBound()) {
+    flushWrites();
+    socket_->pauseWrite();
+    socket_->pauseRead();
+    (void)socket_->close();
+  }
+}
+
+quic::Expected<void, QuicError> QuicClientSocketMux::bind(
+    const folly::SocketAddress& localAddress) {
+  auto result = socket_->init(localAddress.getFamily());
+  if (!result.has_value()) {
+    return result;
+  }
+  result = socket_->bind(localAddress);
+  if (!result.has_value()) {
+    return result;
+  }
+  // never fragment, always turn off PMTU
+  result = socket_->setDFAndTurnOffPMTU();
+  if (!result.has_value()) {
+    return result;
+  }
+  if (options_.recvTos) {
+    result = socket_->setRecvTos(true);
+    if (!result.has_value()) {
+      return result;
+    }
+  }
+  readBufferSize_ = kDefaultUDPReadBufferSize;
+  if (options_.numGROBuffers > kDefaultNumGROBuffers) {
+    // Not a fatal error, just read single packets without GRO.
+    auto setResult = socket_->setGRO(true);
+    if (!setResult.has_value()) {
+      LOG(WARNING) << "Failed to enable GRO: " << setResult.error().message;
+    } else if (auto gro = socket_->getGRO(); gro.has_value() && *gro > 0) {
+      readBufferSize_ *= std::min(options_.numGROBuffers, kMaxNumGROBuffers);
+    }
+  }
+  socket_->resumeRead(this);
+  return {};
+}
+
+void QuicClientSocketMux::close() {
+  flushWrites();
+  socket_->pauseWrite();
+  socket_->pauseRead();
+  (void)socket_->close();
+  onReadClosed();
+}
+
+std::unique_ptr<QuicClientSocketMux::ConnectionSocket>
+QuicClientSocketMux::makeConnectionSocket() {
+  // Keys are handed out sequentially from a random start, skipping the ones
+  // still in use after wrapping around.
+  while (connections_.count(nextRoutingKey_)) {
+    nextRoutingKey_++;
+  }
+  auto key = nextRoutingKey_++;
+  auto sock = std::make_unique<ConnectionSocket>(shared_from_this(), key);
+  connections_.emplace(key, sock.get());
+  return sock;
+}
+
+void QuicClientSocketMux::onReadClosed() noexcept {
+  auto self = shared_from_this();
+  std::vector<ReadCallback*> callbacks;
+  for (auto& [key, sock] : connections_) {
+    if (sock->readCallback_) {
+      callbacks.push_back(sock->readCallback_);
+    }
+  }
+  for (auto* cb : callbacks) {
+    cb->onReadClosed();
+  }
+}
+
+void QuicClientSocketMux::onReadError(
+    const folly::AsyncSocketException& ex) noexcept {
+  auto self = shared_from_this();
+  // The shared socket failed, so every connection on it did.
+  std::vector<ReadCallback*> callbacks;
+  for (auto& [key, sock] : connections_) {
+    if (sock->readCallback_) {
+      callbacks.push_back(sock->readCallback_);
+    }
+  }
+  for (auto* cb : callbacks) {
+    cb->onReadError(ex);
+  }
+}
+
+void QuicClientSocketMux::getReadBuffer(
+    void** /* buf */,
+    size_t* /* len */) noexcept {
+  folly::terminate_with<std::runtime_error>("getReadBuffer unsupported");
+}
+
+void QuicClientSocketMux::onDataAvailable(
+    const folly::SocketAddress& /* peer */,
+    size_t /* len */,
+    bool /* truncated */,
+    OnDataAvailableParams /* params */) noexcept {
+  folly::terminate_with<std::runtime_error>("onDataAvailable unsupported");
+}
+
+void QuicClientSocketMux::onNotifyDataAvailable(
+    QuicAsyncUDPSocket& /* sock */) noexcept {
+  auto self = shared_from_this();
+  readPackets();
+  notifyConnections();
+}
+
+void QuicClientSocketMux::onSocketWritable() noexcept {
+  auto self = shared_from_this();
+  if (!flushWrites()) {
+    // Still blocked, flushWrites() waits for the socket again.
+    return;
+  }
+  writeBlocked_ = false;
+  socket_->pauseWrite();
+  // Waiters may close, or wait again, while being notified.
+  auto waiters = std::move(writeWaiters_);
+  writeWaiters_.clear();
+  for (auto* sock : waiters) {
+    if (sock && sock->writeCallback_) {
+      sock->writeCallback_->onSocketWritable();
+    }
+  }
+}
+
+void QuicClientSocketMux::runLoopCallback() noexcept {
+  auto self = shared_from_this();
+  notifyConnections();
+  if (!writeBlocked_) {
+    flushWrites();
+  }
+}
+
+void QuicClientSocketMux::readPackets() {
+  auto numPackets = options_.numPacketsPerRead;
+  recvmmsgStorage_.resize(numPackets);
+  auto& msgs = recvmmsgStorage_.msgs;
+  int flags = 0;
+#if defined(FOLLY_HAVE_MSG_ERRQUEUE)
+  auto gro = socket_->getGRO();
+  bool useGRO = gro.has_value() && *gro > 0;
+  bool checkCmsgs = useGRO || options_.recvTos;
+  auto& controlVec = recvmmsgStorage_.control;
+
+  // we need to consider MSG_TRUNC too
+  if (useGRO) {
+    flags |= MSG_TRUNC;
+  }
+#endif
+  auto family = socket_->addressRef().getFamily();
+  for (uint16_t i = 0; i < numPackets; ++i) {
+    auto& addr = recvmmsgStorage_.impl_[i].addr;
+    auto& readBuffer = recvmmsgStorage_.impl_[i].readBuffer;
+    auto& iovec = recvmmsgStorage_.impl_[i].iovec;
+    struct msghdr* msg = &msgs[i].msg_hdr;
+
+    if (!readBuffer) {
+      readBuffer = BufHelpers::createCombined(readBufferSize_);
+      iovec.iov_base = readBuffer->writableData();
+      iovec.iov_len = readBufferSize_;
+      msg->msg_iov = &iovec;
+      msg->msg_iovlen = 1;
+    }
+
+    auto* rawAddr = reinterpret_cast<sockaddr*>(&addr);
+    rawAddr->sa_family = family;
+    msg->msg_name = rawAddr;
+    msg->msg_namelen = kAddrLen;
+#if defined(FOLLY_HAVE_MSG_ERRQUEUE)
+    if (checkCmsgs) {
+      ::memset(controlVec[i].data(), 0, controlVec[i].size());
+      msg->msg_control = controlVec[i].data();
+      msg->msg_controllen = controlVec[i].size();
+    } else {
+      msg->msg_control = nullptr;
+      msg->msg_controllen = 0;
+    }
+#endif
+  }
+
+  int numMsgsRecvd = socket_->recvmmsg(msgs.data(), numPackets, flags, nullptr);
+  if (numMsgsRecvd < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      VLOG(4) << "recvmmsg() failed on shared socket, errno=" << errno;
+    }
+    return;
+  }
+
+  CHECK_LE(numMsgsRecvd, numPackets);
+  for (uint16_t i = 0; i < static_cast<uint16_t>(numMsgsRecvd); ++i) {
+    auto& addr = recvmmsgStorage_.impl_[i].addr;
+    auto& readBuffer = recvmmsgStorage_.impl_[i].readBuffer;
+    auto& msg = msgs[i];
+
+    size_t bytesRead = msg.msg_len;
+    if (bytesRead == 0) {
+      continue;
+    }
+    QuicAsyncUDPSocket::ReadCallback::OnDataAvailableParams params;
+#if defined(FOLLY_HAVE_MSG_ERRQUEUE)
+    if (checkCmsgs) {
+      QuicAsyncUDPSocket::fromMsg(params, msg.msg_hdr);
+
+      // truncated
+      if (bytesRead > readBufferSize_) {
+        bytesRead = readBufferSize_;
+        if (params.gro > 0) {
+          bytesRead = bytesRead - bytesRead % params.gro;
+        }
+      }
+    }
+#endif
+    folly::SocketAddress peer;
+    peer.setFromSockaddr(reinterpret_cast<sockaddr*>(&addr), kAddrLen);
+    readBuffer->append(bytesRead);
+    if (params.gro > 0) {
+      size_t offset = 0;
+      while (bytesRead - offset > static_cast<size_t>(params.gro)) {
+        auto tmp = readBuffer->cloneOne();
+        tmp->trimStart(offset);
+        tmp->trimEnd(bytesRead - offset - params.gro);
+        DCHECK_EQ(tmp->length(), params.gro);
+        offset += params.gro;
+        routePacket(peer, std::move(tmp), params.tos);
+      }
+      // do not clone the last packet
+      readBuffer->trimStart(offset);
+    }
+    routePacket(peer, std::move(readBuffer), params.tos);
+  }
+}
+
+void QuicClientSocketMux::routePacket(
+    const folly::SocketAddress& peer,
+    BufPtr buf,
+    uint8_t tos) {
+  ContiguousReadCursor cursor(buf->data(), buf->length());
+  uint8_t initialByte = 0;
+  if (!cursor.tryReadBE(initialByte)) {
+    stats_.packetsUnroutable++;
+    return;
+  }
+  Optional<ConnectionId> dstConnId;
+  if (getHeaderForm(initialByte) == HeaderForm::Short) {
+    auto shortHeader = parseShortHeaderInvariants(
+        initialByte, cursor, options_.connectionIdSize);
+    if (shortHeader.has_value()) {
+      dstConnId = std::move(shortHeader->destinationConnId);
+    }
+  } else {
+    auto longHeader = parseLongHeaderInvariant(initialByte, cursor);
+    if (longHeader.has_value()) {
+      dstConnId = std::move(longHeader->invariant.dstConnId);
+    }
+  }
+  if (!dstConnId) {
+    stats_.packetsUnroutable++;
+    return;
+  }
+  auto key = decodeRoutingKey(*dstConnId);
+  auto it = key ? connections_.find(*key) : connections_.end();
+  if (it == connections_.end()) {
+    if (getHeaderForm(initialByte) == HeaderForm::Short &&
+        buf->length() >= kMinStatelessPacketSize && routeByPeer(peer, buf)) {
+      return;
+    }
+    VLOG(4) << "Dropping packet for unknown connection id "
+            << dstConnId->hex() << " from " << peer;
+    stats_.packetsUnroutable++;
+    return;
+  }
+  stats_.packetsRouted++;
+  enqueuePacket(it->second, peer, std::move(buf), tos);
+}
+
+void QuicClientSocketMux::enqueuePacket(
+    ConnectionSocket* sock,
+    const folly::SocketAddress& peer,
+    BufPtr buf,
+    uint8_t tos) {
+  if (sock->readQueue_.size() >= options_.maxPacketsPerConnection) {
+    stats_.packetsDropped++;
+    return;
+  }
+  sock->readQueue_.push_back({std::move(buf), peer, tos});
+  markPending(sock);
+}
+
+bool QuicClientSocketMux::routeByPeer(
+    const folly::SocketAddress& peer,
+    const BufPtr& buf) {
+  auto it = connectionsByPeer_.find(peer);
+  if (it == connectionsByPeer_.end() || it->second.empty()) {
+    return false;
+  }
+  // Transports decrypt in place, so every connection gets its own copy. This
+  // is rare enough not to matter.
+  for (auto* sock : it->second) {
+    stats_.packetsRoutedByPeer++;
+    enqueuePacket(
+        sock, peer, BufHelpers::copyBuffer(buf->data(), buf->length()), 0);
+  }
+  return true;
+}
+
+void QuicClientSocketMux::markPending(ConnectionSocket* sock) {
+  if (!sock->notifyPending_ && sock->readCallback_) {
+    sock->notifyPending_ = true;
+    pendingNotify_.push_back(sock);
+  }
+}
+
+void QuicClientSocketMux::notifyConnections() {
+  // Connections can be closed, and more packets routed, while notifying, so
+  // index into the list. Closed connections clear their entry.
+  for (size_t i = 0; i < pendingNotify_.size(); i++) {
+    auto* sock = pendingNotify_[i];
+    if (sock && sock->readCallback_ && !sock->readQueue_.empty()) {
+      sock->readCallback_->onNotifyDataAvailable(*sock);
+    }
+  }
+  // A connection stops reading after its read batch limit, give the ones
+  // with packets left another turn in the next loop.
+  size_t numLeft = 0;
+  for (auto* sock : pendingNotify_) {
+    if (!sock) {
+      continue;
+    }
+    if (sock->readCallback_ && !sock->readQueue_.empty()) {
+      pendingNotify_[numLeft++] = sock;
+    } else {
+      sock->notifyPending_ = false;
+    }
+  }
+  pendingNotify_.resize(numLeft);
+  if (!pendingNotify_.empty()) {
+    scheduleLoopCallback();
+  }
+}
+
+void QuicClientSocketMux::removeConnection(ConnectionSocket* sock) {
+  connections_.erase(sock->routingKey_);
+  clearPeerAddress(sock);
+  if (sock->notifyPending_) {
+    std::replace(pendingNotify_.begin(), pendingNotify_.end(), sock, nullptr);
+    sock->notifyPending_ = false;
+  }
+  // The entry stays after pauseWrite(), so look regardless of the callback.
+  std::replace(writeWaiters_.begin(), writeWaiters_.end(), sock, nullptr);
+  sock->writeCallback_ = nullptr;
+}
+
+void QuicClientSocketMux::setPeerAddress(
+    ConnectionSocket* sock,
+    const folly::SocketAddress& address) {
+  if (sock->peerAddress_ && *sock->peerAddress_ == address) {
+    return;
+  }
+  clearPeerAddress(sock);
+  sock->peerAddress_ = address;
+  connectionsByPeer_[address].push_back(sock);
+}
+
+void QuicClientSocketMux::clearPeerAddress(ConnectionSocket* sock) {
+  if (!sock->peerAddress_) {
+    return;
+  }
+  auto it = connectionsByPeer_.find(*sock->peerAddress_);
+  if (it != connectionsByPeer_.end()) {
+    auto& socks = it->second;
+    socks.erase(std::remove(socks.begin(), socks.end(), sock), socks.end());
+    if (socks.empty()) {
+      connectionsByPeer_.erase(it);
+    }
+  }
+  sock->peerAddress_.reset();
+}
+
+bool QuicClientSocketMux::permuteConnectionId(
+    MutableByteRange connId,
+    bool inverse) const {
+  // An unbalanced Feistel network over the two halves of the connection id,
+  // with the cipher's single block encryption as the round function. Each
+  // round masks one half with the encryption of the round number, the length
+  // and the other half.
+  auto leftLen = connId.size() / 2;
+  auto left = connId.subpiece(0, leftLen);
+  auto right = connId.subpiece(leftLen);
+  for (uint8_t i = 0; i < kConnectionIdRounds; i++) {
+    uint8_t round = inverse ? kConnectionIdRounds - 1 - i : i;
+    auto& src = round % 2 == 0 ? right : left;
+    auto& dst = round % 2 == 0 ? left : right;
+    HeaderProtectionMask block{};
+    block[0] = round;
+    block[1] = static_cast<uint8_t>(connId.size());
+    memcpy(block.data() + 2, src.data(), src.size());
+    auto mask =
+        connectionIdCipher_->mask(ByteRange(block.data(), block.size()));
+    if (!mask.has_value()) {
+      return false;
+    }
+    for (size_t j = 0; j < dst.size(); j++) {
+      dst[j] ^= (*mask)[j];
+    }
+  }
+  return true;
+}
+
+quic::Expected<ConnectionId, QuicError>
+QuicClientSocketMux::encodeConnectionId(uint32_t key) const {
+  std::vector<uint8_t> connIdData(options_.connectionIdSize);
+  // The key is read back in network byte order by decodeRoutingKey().
+  for (size_t i = 0; i < kRoutingKeySize; i++) {
+    connIdData[i] =
+        static_cast<uint8_t>(key >> (8 * (kRoutingKeySize - 1 - i)));
+  }
+  folly::Random::secureRandom(
+      connIdData.data() + kRoutingKeySize,
+      connIdData.size() - kRoutingKeySize);
+  if (!permuteConnectionId(
+          MutableByteRange(connIdData.data(), connIdData.size()),
+          false /* inverse */)) {
+    return quic::make_unexpected(
+        muxError("Failed to encrypt the routing key"));
+  }
+  return ConnectionId::create(connIdData);
+}
+
+Optional<uint32_t> QuicClientSocketMux::decodeRoutingKey(
+    const ConnectionId& connId) const {
+  if (connId.size() != options_.connectionIdSize) {
+    return std::nullopt;
+  }
+  std::array<uint8_t, kMaxConnectionIdSize> connIdData;
+  memcpy(connIdData.data(), connId.data(), connId.size());
+  if (!permuteConnectionId(
+          MutableByteRange(connIdData.data(), connId.size()),
+          true /* inverse */)) {
+    return std::nullopt;
+  }
+  ContiguousReadCursor keyCursor(connIdData.data(), connId.size());
+  uint32_t key = 0;
+  CHECK(keyCursor.tryReadBE(key));
+  return key;
+}
+
+void QuicClientSocketMux::scheduleLoopCallback() {
+  if (!isLoopCallbackScheduled()) {
+    evb_->runInLoop(this);
+  }
+}
+
+ssize_t QuicClientSocketMux::connectionWrite(
+    ConnectionSocket* sock,
+    const folly::SocketAddress& address,
+    const struct iovec* vec,
+    size_t iovecLen,
+    const QuicAsyncUDPSocket::WriteOptions& options,
+    bool useGSO) {
+  setPeerAddress(sock, address);
+  if (writeBlocked_) {
+    errno = EAGAIN;
+    return -1;
+  }
+  auto len = iovecLength(vec, iovecLen);
+  if (options_.aggregateWrites && len <= options_.maxAggregatedWriteSize) {
+    return bufferWrite(address, vec, iovecLen, len, options);
+  }
+  // Keep the connection's packets in order behind the pending batch.
+  if (!flushWrites()) {
+    errno = EAGAIN;
+    return -1;
+  }
+  if (useGSO) {
+    return socket_->writeGSO(address, vec, iovecLen, options);
+  }
+  return socket_->write(address, vec, iovecLen);
+}
+
+ssize_t QuicClientSocketMux::bufferWrite(
+    const folly::SocketAddress& address,
+    const struct iovec* vec,
+    size_t iovecLen,
+    size_t len,
+    const QuicAsyncUDPSocket::WriteOptions& options) {
+  auto& pending = pendingWrites_;
+  if (!pending.data) {
+    pending.data = BufHelpers::create(
+        options_.maxWriteBatchSize * options_.maxAggregatedWriteSize);
+  }
+  // The caller reuses its buffers once the write returns, so the batch needs
+  // its own copy. A full batch always has room for one more packet.
+  DCHECK_GE(pending.data->tailroom(), len);
+  auto* start = pending.data->writableTail();
+  for (size_t i = 0; i < iovecLen; i++) {
+    memcpy(pending.data->writableTail(), vec[i].iov_base, vec[i].iov_len);
+    pending.data->append(vec[i].iov_len);
+  }
+  pending.addrs.push_back(address);
+  pending.iovecs.push_back({start, len});
+  pending.numIovecs.push_back(1);
+  pending.options.push_back(options);
+  if (pending.addrs.size() >= options_.maxWriteBatchSize) {
+    // The packet is in the batch either way, if the socket blocks it goes
+    // out once writable.
+    flushWrites();
+  } else {
+    scheduleLoopCallback();
+  }
+  return static_cast<ssize_t>(len);
+}
+
+bool QuicClientSocketMux::flushWrites() {
+  auto& pending = pendingWrites_;
+  auto count = pending.addrs.size();
+  if (count == 0) {
+    return true;
+  }
+  size_t written = 0;
+  bool blocked = false;
+  while (written < count) {
+    auto ret = socket_->writemGSO(
+        folly::range(
+            pending.addrs.data() + written, pending.addrs.data() + count),
+        pending.iovecs.data() + written,
+        pending.numIovecs.data() + written,
+        count - written,
+        pending.options.data() + written);
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      blocked = true;
+      break;
+    }
+    if (ret <= 0) {
+      // The connections were told the write succeeded, so their loss
+      // recovery retransmits what's dropped here.
+      VLOG(4) << "writemGSO() failed on shared socket, errno=" << errno;
+      stats_.writeErrors += count - written;
+      break;
+    }
+    written += ret;
+  }
+  stats_.writeBatches++;
+  stats_.packetsWritten += written;
+  if (blocked) {
+    // Keep the rest in place, the buffer isn't appended to until the batch
+    // is out.
+    pending.addrs.erase(
+        pending.addrs.begin(), pending.addrs.begin() + written);
+    pending.iovecs.erase(
+        pending.iovecs.begin(), pending.iovecs.begin() + written);
+    pending.numIovecs.erase(
+        pending.numIovecs.begin(), pending.numIovecs.begin() + written);
+    pending.options.erase(
+        pending.options.begin(), pending.options.begin() + written);
+    stats_.writesBlocked++;
+    writeBlocked_ = true;
+    auto result = socket_->resumeWrite(this);
+    if (!result.has_value()) {
+      LOG(ERROR) << "Failed to wait for the shared socket to be writable: "
+                 << result.error().message;
+    }
+    return false;
+  }
+  pending.data->clear();
+  pending.addrs.clear();
+  pending.iovecs.clear();
+  pending.numIovecs.clear();
+  pending.options.clear();
+  return true;
+}
+
+quic::Expected<void, QuicError> QuicClientSocketMux::waitForWritable(
+    ConnectionSocket* sock) {
+  if (!sock->writeCallback_) {
+    return {};
+  }
+  if (std::find(writeWaiters_.begin(), writeWaiters_.end(), sock) ==
+      writeWaiters_.end()) {
+    writeWaiters_.push_back(sock);
+  }
+  return socket_->resumeWrite(this);
+}
+
+void QuicClientSocketMux::RecvmmsgStorage::resize(size_t numPackets) {
+  if (msgs.size() != numPackets) {
+    msgs.resize(numPackets);
+    impl_.resize(numPackets);
+    control.resize(numPackets);
+  }
+}
+
+QuicClientSocketMux::ConnectionSocket::ConnectionSocket(
+    std::shared_ptr<QuicClientSocketMux> mux,
+    uint32_t key)
+    : mux_(std::move(mux)), routingKey_(key) {}
+
+QuicClientSocketMux::ConnectionSocket::~ConnectionSocket() {
+  (void)close();
+}
+
+QuicClientTransportLite::ConnectionIdGenerator
+QuicClientSocketMux::ConnectionSocket::makeConnectionIdGenerator() const {
+  return [mux = mux_, key = routingKey_]() {
+    return mux->encodeConnectionId(key);
+  };
+}
+
+quic::Expected<void, QuicError> QuicClientSocketMux::ConnectionSocket::init(
+    sa_family_t family) {
+  auto address = mux_->socket_->address();
+  if (!address.has_value()) {
+    return quic::make_unexpected(address.error());
+  }
+  if (family != AF_UNSPEC && family != address->getFamily()) {
+    return quic::make_unexpected(
+        muxError("Address family differs from the shared socket"));
+  }
+  return {};
+}
+
+quic::Expected<void, QuicError> QuicClientSocketMux::ConnectionSocket::bind(
+    const folly::SocketAddress& /* address */) {
+  // The shared socket is already bound.
+  return {};
+}
+
+bool QuicClientSocketMux::ConnectionSocket::isBound() const {
+  return !closed_;
+}
+
+quic::Expected<void, QuicError> QuicClientSocketMux::ConnectionSocket::connect(
+    const folly::SocketAddress& /* address */) {
+  // Connecting the shared socket would cut off every other peer.
+  return {};
+}
+
+quic::Expected<void, QuicError>
+QuicClientSocketMux::ConnectionSocket::close() {
+  if (closed_) {
+    return {};
+  }
+  closed_ = true;
+  readCallback_ = nullptr;
+  readQueue_.clear();
+  mux_->removeConnection(this);
+  return {};
+}
+
+void QuicClientSocketMux::ConnectionSocket::resumeRead(ReadCallback* cb) {
+  CHECK(cb->shouldOnlyNotify());
+  readCallback_ = cb;
+  if (!readQueue_.empty()) {
+    mux_->markPending(this);
+    mux_->scheduleLoopCallback();
+  }
+}
+
+void QuicClientSocketMux::ConnectionSocket::pauseRead() {
+  readCallback_ = nullptr;
+}
+
+bool QuicClientSocketMux::ConnectionSocket::isReadPaused() const {
+  return readCallback_ == nullptr;
+}
+
+quic::Expected<void, QuicError>
+QuicClientSocketMux::ConnectionSocket::resumeWrite(WriteCallback* cb) {
+  if (closed_) {
+    return quic::make_unexpected(muxError("Socket is closed"));
+  }
+  writeCallback_ = cb;
+  return mux_->waitForWritable(this);
+}
+
+void QuicClientSocketMux::ConnectionSocket::pauseWrite() {
+  // The entry in the mux's waiters is skipped once the callback is cleared.
+  writeCallback_ = nullptr;
+}
+
+bool QuicClientSocketMux::ConnectionSocket::isWritableCallbackSet() const {
+  return writeCallback_ != nullptr;
+}
+
+ssize_t QuicClientSocketMux::ConnectionSocket::write(
+    const folly::SocketAddress& address,
+    const struct iovec* vec,
+    size_t iovecLen) {
+  return mux_->connectionWrite(
+      this, address, vec, iovecLen, WriteOptions(), false /* useGSO */);
+}
+
+int QuicClientSocketMux::ConnectionSocket::writem(
+    folly::Range<folly::SocketAddress const*> addrs,
+    iovec* iov,
+    size_t* numIovecsInBuffer,
+    size_t count) {
+  return writemGSO(addrs, iov, numIovecsInBuffer, count, nullptr);
+}
+
+ssize_t QuicClientSocketMux::ConnectionSocket::writeGSO(
+    const folly::SocketAddress& address,
+    const struct iovec* vec,
+    size_t iovecLen,
+    WriteOptions options) {
+  return mux_->connectionWrite(
+      this, address, vec, iovecLen, options, true /* useGSO */);
+}
+
+int QuicClientSocketMux::ConnectionSocket::writemGSO(
+    folly::Range<folly::SocketAddress const*> addrs,
+    const BufPtr* bufs,
+    size_t count,
+    const WriteOptions* options) {
+  if (!mux_->options_.aggregateWrites) {
+    if (count > 0) {
+      mux_->setPeerAddress(this, addrs[0]);
+    }
+    return mux_->socket_->writemGSO(addrs, bufs, count, options);
+  }
+  for (size_t i = 0; i < count; i++) {
+    const auto& address = addrs.size() == 1 ? addrs[0] : addrs[i];
+    auto iovec = bufs[i]->getIov();
+    auto ret = mux_->connectionWrite(
+        this,
+        address,
+        iovec.data(),
+        iovec.size(),
+        options ? options[i] : WriteOptions(),
+        options != nullptr /* useGSO */);
+    if (ret < 0) {
+      return i > 0 ? static_cast<int>(i) : -1;
+    }
+  }
+  return static_cast<int>(count);
+}
+
+int QuicClientSocketMux::ConnectionSocket::writemGSO(
+    folly::Range<folly::SocketAddress const*> addrs,
+    iovec* iov,
+    size_t* numIovecsInBuffer,
+    size_t count,
+    const WriteOptions* options) {
+  if (!mux_->options_.aggregateWrites) {
+    if (count > 0) {
+      mux_->setPeerAddress(this, addrs[0]);
+    }
+    if (!options) {
+      return mux_->socket_->writem(addrs, iov, numIovecsInBuffer, count);
+    }
+    return mux_->socket_->writemGSO(
+        addrs, iov, numIovecsInBuffer, count, options);
+  }
+  size_t iovecOffset = 0;
+  for (size_t i = 0; i < count; i++) {
+    const auto& address = addrs.size() == 1 ? addrs[0] : addrs[i];
+    auto ret = mux_->connectionWrite(
+        this,
+        address,
+        iov + iovecOffset,
+        numIovecsInBuffer[i],
+        options ? options[i] : WriteOptions(),
+        options != nullptr /* useGSO */);
+    if (ret < 0) {
+      return i > 0 ? static_cast<int>(i) : -1;
+    }
+    iovecOffset += numIovecsInBuffer[i];
+  }
+  return static_cast<int>(count);
+}
+
+ssize_t QuicClientSocketMux::ConnectionSocket::recvmsg(
+    struct msghdr* msg,
+    int /* flags */) {
+  if (readQueue_.empty()) {
+    errno = EAGAIN;
+    return -1;
+  }
+  auto packet = std::move(readQueue_.front());
+  readQueue_.pop_front();
+
+  msg->msg_flags = 0;
+  size_t len = packet.buf->length();
+  size_t copied = 0;
+  for (size_t i = 0; i < msg->msg_iovlen && copied < len; i++) {
+    auto toCopy = std::min(msg->msg_iov[i].iov_len, len - copied);
+    memcpy(msg->msg_iov[i].iov_base, packet.buf->data() + copied, toCopy);
+    copied += toCopy;
+  }
+  if (copied < len) {
+    msg->msg_flags |= MSG_TRUNC;
+  }
+  if (msg->msg_name) {
+    msg->msg_namelen = packet.peerAddress.getAddress(
+        reinterpret_cast<sockaddr_storage*>(msg->msg_name));
+  }
+#if defined(FOLLY_HAVE_MSG_ERRQUEUE)
+  // Hand the TOS to the transport the way the kernel would, everything else
+  // the mux read from its own cmsgs is already consumed.
+  if (msg->msg_control && mux_->options_.recvTos &&
+      msg->msg_controllen >= CMSG_SPACE(sizeof(uint8_t))) {
+    auto* cmsg = CMSG_FIRSTHDR(msg);
+    bool isV6 = packet.peerAddress.getFamily() == AF_INET6;
+    cmsg->cmsg_level = isV6 ? SOL_IPV6 : SOL_IP;
+    cmsg->cmsg_type = isV6 ? IPV6_TCLASS : IP_TOS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+    *CMSG_DATA(cmsg) = packet.tos;
+    msg->msg_controllen = CMSG_SPACE(sizeof(uint8_t));
+  } else {
+    msg->msg_controllen = 0;
+  }
+#endif
+  return static_cast<ssize_t>(copied);
+}
+
+int QuicClientSocketMux::ConnectionSocket::recvmmsg(
+    struct mmsghdr* msgvec,
+    unsigned int vlen,
+    unsigned int flags,
+    struct timespec* /* timeout */) {
+  unsigned int numMsgs = 0;
+  while (numMsgs < vlen && !readQueue_.empty()) {
+    auto ret = recvmsg(&msgvec[numMsgs].msg_hdr, static_cast<int>(flags));
+    msgvec[numMsgs].msg_len = static_cast<unsigned int>(ret);
+    numMsgs++;
+  }
+  if (numMsgs == 0) {
+    errno = EAGAIN;
+    return -1;
+  }
+  return static_cast<int>(numMsgs);
+}
+
+quic::Expected<QuicAsyncUDPSocket::RecvResult, QuicError>
+QuicClientSocketMux::ConnectionSocket::recvmmsgNetworkData(
+    uint64_t /* readBufferSize */,
+    uint16_t numPackets,
+    NetworkData& networkData,
+    Optional<folly::SocketAddress>& peerAddress,
+    size_t& totalData) {
+  if (readQueue_.empty()) {
+    return RecvResult(NoReadReason::RETRIABLE_ERROR);
+  }
+  // The queued packets are handed over without copying. NetworkData has a
+  // single peer address, so stop at the first packet from another peer.
+  for (uint16_t i = 0; i < numPackets && !readQueue_.empty(); i++) {
+    auto& packet = readQueue_.front();
+    if (!peerAddress) {
+      peerAddress = packet.peerAddress;
+    } else if (*peerAddress != packet.peerAddress) {
+      break;
+    }
+    totalData += packet.buf->length();
+    networkData.addPacket(ReceivedUdpPacket(
+        std::move(packet.buf), ReceivedUdpPacket::Timings(), packet.tos));
+    readQueue_.pop_front();
+  }
+  return RecvResult();
+}
+
+quic::Expected<int, QuicError>
+QuicClientSocketMux::ConnectionSocket::getGSO() {
+  return mux_->socket_->getGSO();
+}
+
+quic::Expected<int, QuicError>
+QuicClientSocketMux::ConnectionSocket::getGRO() {
+  return 0;
+}
+
+quic::Expected<void, QuicError> QuicClientSocketMux::ConnectionSocket::setGRO(
+    bool /* bVal */) {
+  return {};
+}
+
+quic::Expected<void, QuicError>
+QuicClientSocketMux::ConnectionSocket::setRecvTos(bool recvTos) {
+  // TOS is only read on the shared socket if the mux was set up for it.
+  if (recvTos && !mux_->options_.recvTos) {
+    return quic::make_unexpected(
+        muxError("Receiving TOS is not enabled on the shared socket"));
+  }
+  return {};
+}
+
+quic::Expected<bool, QuicError>
+QuicClientSocketMux::ConnectionSocket::getRecvTos() {
+  return mux_->options_.recvTos;
+}
+
+quic::Expected<void, QuicError>
+QuicClientSocketMux::ConnectionSocket::setTosOrTrafficClass(uint8_t /* tos */) {
+  return {};
+}
+
+quic::Expected<folly::SocketAddress, QuicError>
+QuicClientSocketMux::ConnectionSocket::address() const {
+  return mux_->socket_->address();
+}
+
+const folly::SocketAddress& QuicClientSocketMux::ConnectionSocket::addressRef()
+    const {
+  return mux_->socket_->addressRef();
+}
+
+void QuicClientSocketMux::ConnectionSocket::attachEventBase(
+    std::shared_ptr<QuicEventBase> evb) {
+  CHECK_EQ(evb.get(), mux_->evb_.get())
+      << "Connections on a mux must use the mux's event base";
+}
+
+void QuicClientSocketMux::ConnectionSocket::detachEventBase() {}
+
+std::shared_ptr<QuicEventBase>
+QuicClientSocketMux::ConnectionSocket::getEventBase() const {
+  return mux_->evb_;
+}
+
+quic::Expected<void, QuicError> QuicClientSocketMux::ConnectionSocket::setCmsgs(
+    const folly::SocketCmsgMap& /* cmsgs */) {
+  return {};
+}
+
+quic::Expected<void, QuicError>
+QuicClientSocketMux::ConnectionSocket::appendCmsgs(
+    const folly::SocketCmsgMap& /* cmsgs */) {
+  return {};
+}
+
+quic::Expected<void, QuicError>
+QuicClientSocketMux::ConnectionSocket::setAdditionalCmsgsFunc(
+    std::function<Optional<folly::SocketCmsgMap>()>&& /* cmsgsFunc */) {
+  return {};
+}
+
+quic::Expected<int, QuicError>
+QuicClientSocketMux::ConnectionSocket::getTimestamping() {
+  return 0;
+}
+
+quic::Expected<void, QuicError>
+QuicClientSocketMux::ConnectionSocket::setReuseAddr(bool /* reuseAddr */) {
+  return {};
+}
+
+quic::Expected<void, QuicError>
+QuicClientSocketMux::ConnectionSocket::setDFAndTurnOffPMTU() {
+  return {};
+}
+
+quic::Expected<void, QuicError>
+QuicClientSocketMux::ConnectionSocket::setErrMessageCallback(
+    ErrMessageCallback* /* errMessageCallback */) {
+  return {};
+}
+
+quic::Expected<void, QuicError>
+QuicClientSocketMux::ConnectionSocket::applyOptions(
+    const folly::SocketOptionMap& /* options */,
+    folly::SocketOptionKey::ApplyPos /* pos */) {
+  return {};
+}
+
+quic::Expected<void, QuicError>
+QuicClientSocketMux::ConnectionSocket::setReusePort(bool /* reusePort */) {
+  return {};
+}
+
+quic::Expected<void, QuicError>
+QuicClientSocketMux::ConnectionSocket::setRcvBuf(int /* rcvBuf */) {
+  return {};
+}
+
+quic::Expected<void, QuicError>
+QuicClientSocketMux::ConnectionSocket::setSndBuf(int /* sndBuf */) {
+  return {};
+}
+
+quic::Expected<void, QuicError> QuicClientSocketMux::ConnectionSocket::setFD(
+    int /* fd */,
+    FDOwnership /* ownership */) {
+  return quic::make_unexpected(
+      muxError("Connections on a mux can't use their own fd"));
+}
+
+int QuicClientSocketMux::ConnectionSocket::getFD() {
+  return mux_->socket_->getFD();
+}
+
+} // namespace quic
@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/container/F14Map.h>
+#include <quic/QuicConstants.h>
+#include <quic/client/QuicClientTransportLite.h>
+#include <quic/codec/PacketNumberCipher.h>
+#include <quic/common/events/QuicEventBase.h>
+#include <quic/common/udpsocket/QuicAsyncUDPSocket.h>
+
+#include <array>
+#include <deque>
+
+namespace quic {
+
+/**
+ * Shares one bound UDP socket between many client connections.
+ *
+ * Each connection gets a ConnectionSocket from makeConnectionSocket(), which
+ * is handed to the client transport in place of its own socket. The mux
+ * assigns every connection a routing key, and the connection ids issued by
+ * the connection carry that key, so ingress read in recvmmsg batches (and GRO
+ * split) is routed to the connection by the destination connection id.
+ *
+ * The key is not visible on the wire: each connection id is the key followed
+ * by a random nonce, put through a keyed permutation built from
+ * connectionIdCipher. An observer can't link connection ids of the same
+ * connection, or tell which connections share the mux, without the cipher's
+ * key. The caller keys the cipher, typically with a random secret per mux.
+ *
+ * Egress is either written straight through, or, with aggregateWrites, small
+ * packets are copied into one batch per event loop iteration that is written
+ * with a single writemGSO call. Writes the shared socket can't take right now
+ * fail with EAGAIN, and connections waiting with resumeWrite() are told when
+ * the socket is writable again.
+ *
+ * Usage:
+ *   auto cipher = cryptoFactory.makePacketNumberCipher(randomSecret);
+ *   auto mux = std::make_shared<QuicClientSocketMux>(
+ *       evb, std::move(sock), std::move(cipher).value());
+ *   mux->bind(localAddress);
+ *   auto connSock = mux->makeConnectionSocket();
+ *   auto generator = connSock->makeConnectionIdGenerator();
+ *   auto client = std::make_shared<QuicClientTransport>(
+ *       evb, std::move(connSock), handshakeFactory);
+ *   client->setConnectionIdGenerator(std::move(generator));
+ *
+ * The shared socket is never connected, and socket wide options (TOS, cmsgs,
+ * buffer sizes, ...) set by a transport on its ConnectionSocket are ignored;
+ * set them on the shared socket before handing it to the mux instead. Happy
+ * eyeballs needs a socket per address family, so it must be off for
+ * connections using the mux.
+ *
+ * Stateless resets can't be routed by connection id, their connection id
+ * field is random. Short header packets with an unknown connection id that
+ * are long enough to be a reset are handed to every connection that last
+ * wrote to the packet's peer, each of which checks the reset token and drops
+ * the packet if it isn't theirs. Resets from a peer address a connection
+ * hasn't written to are dropped, and that connection only learns about the
+ * reset through idle timeout. Other packets with an unknown connection id
+ * are dropped.
+ *
+ * The mux must be created with std::make_shared, and must be used from the
+ * thread of its event base.
+ */
+class QuicClientSocketMux
+    : public QuicAsyncUDPSocket::ReadCallback,
+      public QuicAsyncUDPSocket::WriteCallback,
+      public QuicEventBaseLoopCallback,
+      public std::enable_shared_from_this<QuicClientSocketMux> {
+ public:
+  // Length of the routing key carried by each connection id.
+  static constexpr size_t kRoutingKeySize = sizeof(uint32_t);
+  // Connection ids need room for the key and a nonce of at least 4 bytes, so
+  // that ids of the same connection don't repeat.
+  static constexpr size_t kMinConnectionIdSize = kRoutingKeySize + 4;
+
+  struct Options {
+    // Length of the connection ids issued by connections on the mux, needed
+    // to parse short headers. Must be at least kMinConnectionIdSize.
+    size_t connectionIdSize{kDefaultConnectionIdSize};
+    // Max number of datagrams read by one recvmmsg call.
+    uint16_t numPacketsPerRead{kDefaultQuicMaxBatchSize};
+    // Number of packets to read per datagram when the kernel supports GRO.
+    uint16_t numGROBuffers{kDefaultNumGROBuffers};
+    // Read the TOS of ingress packets, for connections reading ECN marks.
+    bool recvTos{false};
+    // Packets queued for a connection that hasn't read them yet. Further
+    // packets are dropped.
+    size_t maxPacketsPerConnection{kDefaultQuicMaxBatchSize * 4};
+    // Copy small writes from all connections into one batch written at the
+    // end of the event loop iteration. When the socket would block, the rest
+    // of the batch is kept until it is writable, and writes fail with EAGAIN
+    // meanwhile. Other write errors are not reported to the connections,
+    // their packets are dropped and count as lost.
+    bool aggregateWrites{false};
+    // Max number of packets in an aggregated batch, a full batch is written
+    // immediately.
+    size_t maxWriteBatchSize{kDefaultQuicMaxBatchSize * 4};
+    // Writes larger than this, such as GSO trains a connection batched
+    // itself, are not copied and go straight to the socket after the
+    // pending batch.
+    size_t maxAggregatedWriteSize{kDefaultMaxUDPPayload};
+  };
+
+  struct Stats {
+    uint64_t packetsRouted{0};
+    uint64_t packetsUnroutable{0};
+    // Copies of possible stateless resets handed to connections by peer
+    // address.
+    uint64_t packetsRoutedByPeer{0};
+    // Routed packets dropped because the connection's queue was full.
+    uint64_t packetsDropped{0};
+    uint64_t writeBatches{0};
+    uint64_t packetsWritten{0};
+    uint64_t writeErrors{0};
+    // Times the shared socket would block on an aggregated batch.
+    uint64_t writesBlocked{0};
+  };
+
+  class ConnectionSocket;
+
+  QuicClientSocketMux(
+      std::shared_ptr<QuicEventBase> evb,
+      std::unique_ptr<QuicAsyncUDPSocket> socket,
+      std::unique_ptr<PacketNumberCipher> connectionIdCipher,
+      Options options = Options());
+
+  ~QuicClientSocketMux() override;
+
+  /**
+   * Binds the shared socket and starts reading from it.
+   */
+  [[nodiscard]] quic::Expected<void, QuicError> bind(
+      const folly::SocketAddress& localAddress);
+
+  /**
+   * Stops reading and closes the shared socket. Connections still on the mux
+   * get onReadClosed().
+   */
+  void close();
+
+  /**
+   * Returns a socket for a new connection. The socket keeps the mux alive.
+   */
+  std::unique_ptr<ConnectionSocket> makeConnectionSocket();
+
+  [[nodiscard]] const Stats& getStats() const {
+    return stats_;
+  }
+
+  [[nodiscard]] size_t numConnections() const {
+    return connections_.size();
+  }
+
+  // QuicAsyncUDPSocket::ReadCallback
+  void onReadClosed() noexcept override;
+  void onReadError(const folly::AsyncSocketException& ex) noexcept override;
+  void getReadBuffer(void** buf, size_t* len) noexcept override;
+  void onDataAvailable(
+      const folly::SocketAddress& peer,
+      size_t len,
+      bool truncated,
+      OnDataAvailableParams params) noexcept override;
+  bool shouldOnlyNotify() override {
+    return true;
+  }
+  void onNotifyDataAvailable(QuicAsyncUDPSocket& sock) noexcept override;
+
+  // QuicAsyncUDPSocket::WriteCallback
+  void onSocketWritable() noexcept override;
+
+  // QuicEventBaseLoopCallback
+  void runLoopCallback() noexcept override;
+
+ private:
+  friend class ConnectionSocket;
+
+  struct RecvmmsgStorage {
+    struct impl_ {
+      struct sockaddr_storage addr;
+      struct iovec iovec;
+      // Buffers we pass to recvmmsg.
+      BufPtr readBuffer;
+    };
+
+    // Storage for the recvmmsg system call.
+    std::vector<struct mmsghdr> msgs;
+    std::vector<struct impl_> impl_;
+    std::vector<std::array<
+        char,
+        QuicAsyncUDPSocket::ReadCallback::OnDataAvailableParams::kCmsgSpace>>
+        control;
+    void resize(size_t numPackets);
+  };
+
+  // Aggregated packets, copied back to back into one buffer that is only
+  // reused once the whole batch is written.
+  struct PendingWrites {
+    BufPtr data;
+    std::vector<folly::SocketAddress> addrs;
+    std::vector<struct iovec> iovecs;
+    // One iovec per packet, as writemGSO() wants it.
+    std::vector<size_t> numIovecs;
+    std::vector<QuicAsyncUDPSocket::WriteOptions> options;
+  };
+
+  void readPackets();
+  void routePacket(const folly::SocketAddress& peer, BufPtr buf, uint8_t tos);
+  void enqueuePacket(
+      ConnectionSocket* sock,
+      const folly::SocketAddress& peer,
+      BufPtr buf,
+      uint8_t tos);
+  // Hands a possible stateless reset to the connections talking to peer.
+  // Returns false if there are none.
+  bool routeByPeer(const folly::SocketAddress& peer, const BufPtr& buf);
+  void notifyConnections();
+  void markPending(ConnectionSocket* sock);
+  void removeConnection(ConnectionSocket* sock);
+  void scheduleLoopCallback();
+
+  // Runs the keyed permutation over a connection id in place, or its inverse.
+  [[nodiscard]] bool permuteConnectionId(MutableByteRange connId, bool inverse)
+      const;
+  [[nodiscard]] quic::Expected<ConnectionId, QuicError> encodeConnectionId(
+      uint32_t key) const;
+  [[nodiscard]] Optional<uint32_t> decodeRoutingKey(
+      const ConnectionId& connId) const;
+
+  void setPeerAddress(
+      ConnectionSocket* sock,
+      const folly::SocketAddress& address);
+  void clearPeerAddress(ConnectionSocket* sock);
+
+  ssize_t connectionWrite(
+      ConnectionSocket* sock,
+      const folly::SocketAddress& address,
+      const struct iovec* vec,
+      size_t iovecLen,
+      const QuicAsyncUDPSocket::WriteOptions& options,
+      bool useGSO);
+  ssize_t bufferWrite(
+      const folly::SocketAddress& address,
+      const struct iovec* vec,
+      size_t iovecLen,
+      size_t len,
+      const QuicAsyncUDPSocket::WriteOptions& options);
+  // Returns false if part of the batch is left because the socket would
+  // block.
+  bool flushWrites();
+  quic::Expected<void, QuicError> waitForWritable(ConnectionSocket* sock);
+
+  std::shared_ptr<QuicEventBase> evb_;
+  std::unique_ptr<QuicAsyncUDPSocket> socket_;
+  std::unique_ptr<PacketNumberCipher> connectionIdCipher_;
+  Options options_;
+  Stats stats_;
+  uint64_t readBufferSize_{kDefaultUDPReadBufferSize};
+  uint32_t nextRoutingKey_{0};
+  folly::F14FastMap<uint32_t, ConnectionSocket*> connections_;
+  // Connections with packets queued that haven't been notified yet.
+  std::vector<ConnectionSocket*> pendingNotify_;
+  // Connections by the peer address they last wrote to, for stateless
+  // resets.
+  folly::F14FastMap<folly::SocketAddress, std::vector<ConnectionSocket*>>
+      connectionsByPeer_;
+  // Connections waiting for the shared socket to be writable. Closed
+  // connections clear their entry.
+  std::vector<ConnectionSocket*> writeWaiters_;
+  // The shared socket would block, an aggregated batch is waiting for it.
+  bool writeBlocked_{false};
+  RecvmmsgStorage recvmmsgStorage_;
+  PendingWrites pendingWrites_;
+};
+
+/**
+ * The socket of a single connection on a QuicClientSocketMux. Reads return the
+ * packets routed to the connection, writes go to the shared socket.
+ */
+class QuicClientSocketMux::ConnectionSocket : public QuicAsyncUDPSocket {
+ public:
+  ConnectionSocket(std::shared_ptr<QuicClientSocketMux> mux, uint32_t key);
+
+  ~ConnectionSocket() override;
+
+  /**
+   * Returns a generator of connection ids routed to this socket, to be set
+   * on the transport with setConnectionIdGenerator().
+   */
+  QuicClientTransportLite::ConnectionIdGenerator makeConnectionIdGenerator()
+      const;
+
+  [[nodiscard]] uint32_t getRoutingKey() const {
+    return routingKey_;
+  }
+
+  [[nodiscard]] quic::Expected<void, QuicError> init(
+      sa_family_t family) override;
+  [[nodiscard]] quic::Expected<void, QuicError> bind(
+      const folly::SocketAddress& address) override;
+  [[nodiscard]] bool isBound() const override;
+  [[nodiscard]] quic::Expected<void, QuicError> connect(
+      const folly::SocketAddress& address) override;
+  [[nodiscard]] quic::Expected<void, QuicError> close() override;
+
+  void resumeRead(ReadCallback* cb) override;
+  void pauseRead() override;
+  [[nodiscard]] bool isReadPaused() const override;
+
+  [[nodiscard]] quic::Expected<void, QuicError> resumeWrite(
+      WriteCallback* cb) override;
+  void pauseWrite() override;
+  [[nodiscard]] bool isWritableCallbackSet() const override;
+
+  ssize_t write(
+      const folly::SocketAddress& address,
+      const struct iovec* vec,
+      size_t iovecLen) override;
+  int writem(
+      folly::Range<folly::SocketAddress const*> addrs,
+      iovec* iov,
+      size_t* numIovecsInBuffer,
+      size_t count) override;
+  ssize_t writeGSO(
+      const folly::SocketAddress& address,
+      const struct iovec* vec,
+      size_t iovecLen,
+      WriteOptions options) override;
+  int writemGSO(
+      folly::Range<folly::SocketAddress const*> addrs,
+      const BufPtr* bufs,
+      size_t count,
+      const WriteOptions* options) override;
+  int writemGSO(
+      folly::Range<folly::SocketAddress const*> addrs,
+      iovec* iov,
+      size_t* numIovecsInBuffer,
+      size_t count,
+      const WriteOptions* options) override;
+
+  ssize_t recvmsg(struct msghdr* msg, int flags) override;
+  int recvmmsg(
+      struct mmsghdr* msgvec,
+      unsigned int vlen,
+      unsigned int flags,
+      struct timespec* timeout) override;
+  [[nodiscard]] quic::Expected<RecvResult, QuicError> recvmmsgNetworkData(
+      uint64_t readBufferSize,
+      uint16_t numPackets,
+      NetworkData& networkData,
+      Optional<folly::SocketAddress>& peerAddress,
+      size_t& totalData) override;
+
+  [[nodiscard]] quic::Expected<int, QuicError> getGSO() override;
+  // GRO batches are split by the mux, reads always return single packets.
+  [[nodiscard]] quic::Expected<int, QuicError> getGRO() override;
+  [[nodiscard]] quic::Expected<void, QuicError> setGRO(bool bVal) override;
+  [[nodiscard]] quic::Expected<void, QuicError> setRecvTos(
+      bool recvTos) override;
+  [[nodiscard]] quic::Expected<bool, QuicError> getRecvTos() override;
+  [[nodiscard]] quic::Expected<void, QuicError> setTosOrTrafficClass(
+      uint8_t tos) override;
+
+  [[nodiscard]] quic::Expected<folly::SocketAddress, QuicError> address()
+      const override;
+  [[nodiscard]] const folly::SocketAddress& addressRef() const override;
+
+  void attachEventBase(std::shared_ptr<QuicEventBase> evb) override;
+  void detachEventBase() override;
+  [[nodiscard]] std::shared_ptr<QuicEventBase> getEventBase() const override;
+
+  [[nodiscard]] quic::Expected<void, QuicError> setCmsgs(
+      const folly::SocketCmsgMap& cmsgs) override;
+  [[nodiscard]] quic::Expected<void, QuicError> appendCmsgs(
+      const folly::SocketCmsgMap& cmsgs) override;
+  [[nodiscard]] quic::Expected<void, QuicError> setAdditionalCmsgsFunc(
+      std::function<Optional<folly::SocketCmsgMap>()>&& additionalCmsgsFunc)
+      override;
+
+  [[nodiscard]] quic::Expected<int, QuicError> getTimestamping() override;
+  [[nodiscard]] quic::Expected<void, QuicError> setReuseAddr(
+      bool reuseAddr) override;
+  [[nodiscard]] quic::Expected<void, QuicError> setDFAndTurnOffPMTU() override;
+  [[nodiscard]] quic::Expected<void, QuicError> setErrMessageCallback(
+      ErrMessageCallback* errMessageCallback) override;
+  [[nodiscard]] quic::Expected<void, QuicError> applyOptions(
+      const folly::SocketOptionMap& options,
+      folly::SocketOptionKey::ApplyPos pos) override;
+  [[nodiscard]] quic::Expected<void, QuicError> setReusePort(
+      bool reusePort) override;
+  [[nodiscard]] quic::Expected<void, QuicError> setRcvBuf(int rcvBuf) override;
+  [[nodiscard]] quic::Expected<void, QuicError> setSndBuf(int sndBuf) override;
+  [[nodiscard]] quic::Expected<void, QuicError> setFD(
+      int fd,
+      FDOwnership ownership) override;
+  int getFD() override;
+
+ private:
+  friend class QuicClientSocketMux;
+
+  struct QueuedPacket {
+    BufPtr buf;
+    folly::SocketAddress peerAddress;
+    uint8_t tos{0};
+  };
+
+  std::shared_ptr<QuicClientSocketMux> mux_;
+  uint32_t routingKey_;
+  bool closed_{false};
+  // Whether the socket is in the mux's pendingNotify_ list.
+  bool notifyPending_{false};
+  ReadCallback* readCallback_{nullptr};
+  WriteCallback* writeCallback_{nullptr};
+  // Peer the connection last wrote to, see connectionsByPeer_.
+  Optional<folly::SocketAddress> peerAddress_;
+  std::deque<QueuedPacket> readQueue_;
+};
+
+} // namespace quic
@@ -10,6 +10,7 @@
 #include <quic/api/QuicTransportBase.h>
 #include <quic/client/QuicClientTransportLite.h>
 #include <quic/common/Expected.h>
+#include <quic/mvfst-features.h>
 
 namespace quic {
 
@@ -32,9 +33,10 @@ class QuicClientTransport : public QuicTransportBase,
             nullptr,
             std::move(handshakeFactory),
             connectionIdSize,
-            useConnectionEndWithErrorCallback),
-        wrappedObserverContainer_(this) {
+            useConnectionEndWithErrorCallback) {
+#if MVFST_ENABLE_OBSERVERS
     conn_->observerContainer = wrappedObserverContainer_.getWeakPtr();
+#endif
   }
 
   // Testing only API:
@@ -59,9 +61,10 @@ class QuicClientTransport : public QuicTransportBase,
             std::move(handshakeFactory),
             connectionIdSize,
             startingPacketNum,
-            useConnectionEndWithErrorCallback),
-        wrappedObserverContainer_(this) {
+            useConnectionEndWithErrorCallback) {
+#if MVFST_ENABLE_OBSERVERS
     conn_->observerContainer = wrappedObserverContainer_.getWeakPtr();
+#endif
   }
 
   virtual ~QuicClientTransport() override;
@@ -99,7 +102,11 @@ class QuicClientTransport : public QuicTransportBase,
   // From QuicSocket
   [[nodiscard]] virtual SocketObserverContainer* getSocketObserverContainer()
       const override {
+#if MVFST_ENABLE_OBSERVERS
     return wrappedObserverContainer_.getPtr();
+#else
+    return nullptr;
+#endif
   }
 
   [[nodiscard]] quic::Expected<void, QuicError> readWithRecvmmsgWrapper(
@@ -124,7 +131,9 @@ class QuicClientTransport : public QuicTransportBase,
   // first, before any other members are destroyed. This ensures that observers
   // can inspect any socket / transport state available through public methods
   // when destruction of the transport begins.
-  const WrappedSocketObserverContainer wrappedObserverContainer_;
+#if MVFST_ENABLE_OBSERVERS
+  const WrappedSocketObserverContainer wrappedObserverContainer_{this};
+#endif
 };
 
 } // namespace quic
@@ -22,6 +22,7 @@
 #include <quic/happyeyeballs/QuicHappyEyeballsFunctions.h>
 #include <quic/logging/QLoggerConstants.h>
 #include <quic/loss/QuicLossFunctions.h>
+#include <quic/mvfst-features.h>
 #include <quic/state/AckHandlers.h>
 #include <quic/state/DatagramHandlers.h>
 #include <quic/state/QuicPacingFunctions.h>
@@ -380,8 +381,9 @@ quic::Expected<void, QuicError> QuicClientTransportLite::processUdpPacketData(
       protectionLevel == ProtectionType::KeyPhaseOne;
 
   auto& regularPacket = *regularOptional;
-  if (conn_->qLogger) {
-    conn_->qLogger->addPacket(regularPacket, packetSize);
+  if (kQLogEnabled && conn_->qLogger) {
+    conn_->qLogger->addPacket(
+        regularPacket, packetSize, udpPacket.timings.receiveTimePoint);
   }
   if (!isProtectedPacket) {
     for (auto& quicFrame : regularPacket.frames) {
@@ -1919,6 +1921,7 @@ void QuicClientTransportLite::
 void QuicClientTransportLite::start(
     ConnectionSetupCallback* connSetupCb,
     ConnectionCallback* connCb) {
+  started_ = true;
   if (happyEyeballsEnabled_) {
     // TODO Supply v4 delay amount from somewhere when we want to tune this
     startHappyEyeballs(
@@ -2019,6 +2022,31 @@ void QuicClientTransportLite::setLocalAddress(
   conn_->localAddress = std::move(localAddress);
 }
 
+quic::Expected<void, QuicError>
+QuicClientTransportLite::setConnectionIdGenerator(
+    ConnectionIdGenerator generator) {
+  if (!generator) {
+    return quic::make_unexpected(QuicError(
+        LocalErrorCode::INVALID_OPERATION, "Empty connection id generator"));
+  }
+  // Only the initial connection id has been chosen before start(), after it
+  // the peer may already know it.
+  if (started_ || conn_->selfConnectionIds.size() != 1) {
+    return quic::make_unexpected(QuicError(
+        LocalErrorCode::INVALID_OPERATION,
+        "Connection id generator must be set before start()"));
+  }
+  auto srcConnId = generator();
+  if (!srcConnId.has_value()) {
+    return quic::make_unexpected(srcConnId.error());
+  }
+  conn_->clientConnectionId = *srcConnId;
+  conn_->readCodec->setClientConnectionId(*srcConnId);
+  conn_->selfConnectionIds.front().connId = *srcConnId;
+  connectionIdGenerator_ = std::move(generator);
+  return {};
+}
+
 void QuicClientTransportLite::setHappyEyeballsEnabled(
     bool happyEyeballsEnabled) {
   happyEyeballsEnabled_ = happyEyeballsEnabled;
@@ -2212,6 +2240,7 @@ quic::Expected<PathIdType, QuicError> QuicClientTransportLite::startPathProbe(
   }
   conn_->pendingEvents.pathChallenges.emplace(
       pathId, PathChallengeFrame(pathChallengeDataResult.value()));
+  conn_->pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
 
   // Assign it a new connection id to use. This is done as the last step to
   // avoid assigning a connection id then returning an error leaving a
@@ -2281,6 +2310,7 @@ quic::Expected<void, QuicError> QuicClientTransportLite::migrateConnection(
 
   // Write something to trigger the migration.
   conn_->pendingEvents.sendPing = true;
+  conn_->pendingEvents.markPendingWrite(PendingWriteReason::PING);
   updateWriteLooper(true);
 
   return {};
@@ -2340,8 +2370,9 @@ QuicClientTransportLite::maybeIssueConnectionIds() {
     // Make sure size of selfConnectionIds is not larger than maximumIdsToIssue
     for (size_t i = conn_->selfConnectionIds.size(); i < maximumIdsToIssue;
          ++i) {
-      auto newConnIdRes =
-          ConnectionId::createRandom(conn_->clientConnectionId->size());
+      auto newConnIdRes = connectionIdGenerator_
+          ? connectionIdGenerator_()
+          : ConnectionId::createRandom(conn_->clientConnectionId->size());
       if (newConnIdRes.hasError()) {
         return quic::make_unexpected(newConnIdRes.error());
       }
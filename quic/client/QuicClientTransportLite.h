@@ -91,6 +91,19 @@ class QuicClientTransportLite
    * optional. If not called, INADDR_ANY will be used.
    */
   void setLocalAddress(folly::SocketAddress localAddress);
+
+  using ConnectionIdGenerator =
+      std::function<quic::Expected<ConnectionId, QuicError>()>;
+
+  /**
+   * Supplies the generator for the connection ids issued by this client, in
+   * place of random ones of connectionIdSize. This lets a socket shared by
+   * many connections route packets by connection id (see
+   * QuicClientSocketMux). Returns an error after start().
+   */
+  [[nodiscard]] quic::Expected<void, QuicError> setConnectionIdGenerator(
+      ConnectionIdGenerator generator);
+
   void addNewSocket(std::unique_ptr<QuicAsyncUDPSocket> socket);
   void setHappyEyeballsEnabled(bool happyEyeballsEnabled);
   virtual void setHappyEyeballsCachedFamily(sa_family_t cachedFamily);
@@ -425,6 +438,8 @@ class QuicClientTransportLite
   quic::Expected<void, QuicError> maybeSendTransportKnobs();
 
   bool replaySafeNotified_{false};
+  // Whether start() was called.
+  bool started_{false};
   // Set it QuicClientTransportLite is in a self owning mode. This will be
   // cleaned up when the caller invokes a terminal call to the transport.
   std::shared_ptr<QuicClientTransportLite> selfOwning_;
@@ -432,6 +447,7 @@ class QuicClientTransportLite
   sa_family_t happyEyeballsCachedFamily_{AF_UNSPEC};
   std::vector<TransportParameter> customTransportParameters_;
   folly::SocketOptionMap socketOptions_;
+  ConnectionIdGenerator connectionIdGenerator_;
   std::shared_ptr<QuicTransportStatsCallback> statsCallback_;
   // We will only send transport knobs once, this flag keeps track of it
   bool transportKnobsSent_{false};
@@ -0,0 +1,432 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <quic/client/QuicClientSocketMux.h>
+#include <quic/common/events/test/QuicEventBaseMock.h>
+#include <quic/common/udpsocket/test/QuicAsyncUDPSocketMock.h>
+#include <quic/handshake/test/Mocks.h>
+
+using namespace ::testing;
+
+namespace quic::test {
+
+namespace {
+
+// Stands in for the block cipher, any deterministic mixing of the whole
+// sample will do for the tests.
+HeaderProtectionMask testMask(ByteRange sample) {
+  HeaderProtectionMask mask{};
+  uint64_t hash = 0xcbf29ce484222325;
+  for (auto& byte : mask) {
+    for (auto in : sample) {
+      hash = (hash ^ in) * 0x100000001b3;
+    }
+    byte = static_cast<uint8_t>(hash >> 24);
+  }
+  return mask;
+}
+
+class MockWriteCallback : public QuicAsyncUDPSocket::WriteCallback {
+ public:
+  MOCK_METHOD(void, onSocketWritable, (), (noexcept));
+};
+
+} // namespace
+
+class QuicClientSocketMuxTest : public Test {
+ public:
+  void SetUp() override {
+    evb_ = std::make_shared<NiceMock<QuicEventBaseMock>>();
+    auto socket = std::make_unique<NiceMock<QuicAsyncUDPSocketMock>>();
+    sockPtr_ = socket.get();
+    ON_CALL(*socket, init(_))
+        .WillByDefault(Return(quic::Expected<void, QuicError>{}));
+    ON_CALL(*socket, bind(_))
+        .WillByDefault(Return(quic::Expected<void, QuicError>{}));
+    ON_CALL(*socket, setDFAndTurnOffPMTU())
+        .WillByDefault(Return(quic::Expected<void, QuicError>{}));
+    ON_CALL(*socket, close())
+        .WillByDefault(Return(quic::Expected<void, QuicError>{}));
+    ON_CALL(*socket, isBound()).WillByDefault(Return(true));
+    ON_CALL(*socket, getGRO()).WillByDefault(Return(0));
+    ON_CALL(*socket, getGSO()).WillByDefault(Return(0));
+    ON_CALL(*socket, address()).WillByDefault(Return(localAddress_));
+    ON_CALL(*socket, addressRef()).WillByDefault(ReturnRef(localAddress_));
+    socket_ = std::move(socket);
+  }
+
+  void makeMux(QuicClientSocketMux::Options options) {
+    auto cipher = std::make_unique<NiceMock<MockPacketNumberCipher>>();
+    ON_CALL(*cipher, mask(_)).WillByDefault(Invoke(testMask));
+    mux_ = std::make_shared<QuicClientSocketMux>(
+        evb_, std::move(socket_), std::move(cipher), options);
+    EXPECT_CALL(*sockPtr_, resumeRead(mux_.get()));
+    ASSERT_FALSE(mux_->bind(localAddress_).hasError());
+  }
+
+  ConnectionId makeConnectionId(
+      QuicClientSocketMux::ConnectionSocket& sock) {
+    auto connId = sock.makeConnectionIdGenerator()();
+    CHECK(connId.has_value());
+    return *connId;
+  }
+
+  // Returns a short header packet with the given destination connection id,
+  // followed by the payload.
+  static BufPtr makeShortHeaderPacket(
+      const ConnectionId& dstConnId,
+      const std::string& payload) {
+    auto buf = BufHelpers::create(1 + dstConnId.size() + payload.size());
+    *buf->writableTail() = ShortHeader::kFixedBitMask;
+    buf->append(1);
+    memcpy(buf->writableTail(), dstConnId.data(), dstConnId.size());
+    buf->append(dstConnId.size());
+    memcpy(buf->writableTail(), payload.data(), payload.size());
+    buf->append(payload.size());
+    return buf;
+  }
+
+  // Makes the shared socket's next recvmmsg return the given datagrams.
+  void expectRecvmmsg(std::vector<BufPtr> datagrams) {
+    EXPECT_CALL(*sockPtr_, recvmmsg(_, _, _, _))
+        .WillOnce(Invoke([this, datagrams = std::move(datagrams)](
+                             struct mmsghdr* msgs,
+                             unsigned int vlen,
+                             unsigned int,
+                             struct timespec*) {
+          CHECK_LE(datagrams.size(), vlen);
+          for (size_t i = 0; i < datagrams.size(); i++) {
+            auto& msg = msgs[i].msg_hdr;
+            auto data = datagrams[i]->coalesce();
+            CHECK_LE(data.size(), msg.msg_iov[0].iov_len);
+            memcpy(msg.msg_iov[0].iov_base, data.data(), data.size());
+            msgs[i].msg_len = data.size();
+            msg.msg_namelen = peerAddress_.getAddress(
+                reinterpret_cast<sockaddr_storage*>(msg.msg_name));
+          }
+          return static_cast<int>(datagrams.size());
+        }));
+  }
+
+  static std::string iovecString(const struct iovec& vec) {
+    return std::string(static_cast<const char*>(vec.iov_base), vec.iov_len);
+  }
+
+  // Strips the short header added by makeShortHeaderPacket.
+  static std::string payload(const std::string& packet) {
+    return packet.substr(1 + kDefaultConnectionIdSize);
+  }
+
+  // Reads one packet from a connection socket the way the client does.
+  std::string readPacket(QuicAsyncUDPSocket& sock) {
+    std::array<char, kDefaultUDPReadBufferSize> buf{};
+    struct sockaddr_storage addrStorage{};
+    struct iovec vec{buf.data(), buf.size()};
+    struct msghdr msg{};
+    msg.msg_name = &addrStorage;
+    msg.msg_namelen = sizeof(addrStorage);
+    msg.msg_iov = &vec;
+    msg.msg_iovlen = 1;
+    auto ret = sock.recvmsg(&msg, 0);
+    if (ret < 0) {
+      return "";
+    }
+    folly::SocketAddress peer;
+    peer.setFromSockaddr(
+        reinterpret_cast<sockaddr*>(&addrStorage), msg.msg_namelen);
+    EXPECT_EQ(peer, peerAddress_);
+    return std::string(buf.data(), ret);
+  }
+
+  folly::SocketAddress localAddress_{"127.0.0.1", 4433};
+  folly::SocketAddress peerAddress_{"127.0.0.2", 443};
+  std::shared_ptr<NiceMock<QuicEventBaseMock>> evb_;
+  std::unique_ptr<QuicAsyncUDPSocket> socket_;
+  QuicAsyncUDPSocketMock* sockPtr_{nullptr};
+  std::shared_ptr<QuicClientSocketMux> mux_;
+};
+
+TEST_F(QuicClientSocketMuxTest, RoutesPacketsByConnectionId) {
+  makeMux(QuicClientSocketMux::Options());
+  auto sock1 = mux_->makeConnectionSocket();
+  auto sock2 = mux_->makeConnectionSocket();
+  EXPECT_NE(sock1->getRoutingKey(), sock2->getRoutingKey());
+  EXPECT_EQ(mux_->numConnections(), 2);
+
+  NiceMock<MockUDPReadCallback> readCb1;
+  NiceMock<MockUDPReadCallback> readCb2;
+  ON_CALL(readCb1, shouldOnlyNotify()).WillByDefault(Return(true));
+  ON_CALL(readCb2, shouldOnlyNotify()).WillByDefault(Return(true));
+  sock1->resumeRead(&readCb1);
+  sock2->resumeRead(&readCb2);
+
+  auto unknownConnId = ConnectionId::createRandom(kDefaultConnectionIdSize);
+  ASSERT_FALSE(unknownConnId.hasError());
+  std::vector<BufPtr> datagrams;
+  datagrams.push_back(makeShortHeaderPacket(makeConnectionId(*sock1), "one"));
+  datagrams.push_back(makeShortHeaderPacket(makeConnectionId(*sock2), "two"));
+  datagrams.push_back(makeShortHeaderPacket(*unknownConnId, "reset"));
+  datagrams.push_back(makeShortHeaderPacket(makeConnectionId(*sock1), "three"));
+  expectRecvmmsg(std::move(datagrams));
+
+  std::vector<std::string> read1;
+  std::vector<std::string> read2;
+  EXPECT_CALL(readCb1, onNotifyDataAvailable_(Ref(*sock1)))
+      .WillOnce(Invoke([&](QuicAsyncUDPSocket& sock) {
+        for (auto packet = readPacket(sock); !packet.empty();
+             packet = readPacket(sock)) {
+          read1.push_back(std::move(packet));
+        }
+      }));
+  EXPECT_CALL(readCb2, onNotifyDataAvailable_(Ref(*sock2)))
+      .WillOnce(Invoke([&](QuicAsyncUDPSocket& sock) {
+        read2.push_back(readPacket(sock));
+      }));
+  mux_->onNotifyDataAvailable(*sockPtr_);
+
+  ASSERT_EQ(read1.size(), 2);
+  EXPECT_EQ(payload(read1[0]), "one");
+  EXPECT_EQ(payload(read1[1]), "three");
+  ASSERT_EQ(read2.size(), 1);
+  EXPECT_EQ(payload(read2[0]), "two");
+  EXPECT_EQ(mux_->getStats().packetsRouted, 3);
+  EXPECT_EQ(mux_->getStats().packetsUnroutable, 1);
+
+  // A closed connection no longer gets packets.
+  auto connId2 = makeConnectionId(*sock2);
+  sock2.reset();
+  EXPECT_EQ(mux_->numConnections(), 1);
+  datagrams.clear();
+  datagrams.push_back(makeShortHeaderPacket(connId2, "four"));
+  expectRecvmmsg(std::move(datagrams));
+  mux_->onNotifyDataAvailable(*sockPtr_);
+  EXPECT_EQ(mux_->getStats().packetsUnroutable, 2);
+}
+
+TEST_F(QuicClientSocketMuxTest, ConnectionIdsHideRoutingKey) {
+  makeMux(QuicClientSocketMux::Options());
+  auto sock = mux_->makeConnectionSocket();
+  auto key = sock->getRoutingKey();
+  std::array<uint8_t, QuicClientSocketMux::kRoutingKeySize> plainKey{
+      static_cast<uint8_t>(key >> 24),
+      static_cast<uint8_t>(key >> 16),
+      static_cast<uint8_t>(key >> 8),
+      static_cast<uint8_t>(key)};
+  auto connId1 = makeConnectionId(*sock);
+  auto connId2 = makeConnectionId(*sock);
+  EXPECT_EQ(connId1.size(), kDefaultConnectionIdSize);
+  EXPECT_NE(connId1, connId2);
+  for (const auto& connId : {connId1, connId2}) {
+    EXPECT_NE(memcmp(connId.data(), plainKey.data(), plainKey.size()), 0);
+  }
+  // Ids of the same connection share no prefix that would link them.
+  EXPECT_NE(
+      memcmp(
+          connId1.data(),
+          connId2.data(),
+          QuicClientSocketMux::kRoutingKeySize),
+      0);
+}
+
+TEST_F(QuicClientSocketMuxTest, StatelessResetRoutedByPeer) {
+  makeMux(QuicClientSocketMux::Options());
+  auto sock1 = mux_->makeConnectionSocket();
+  auto sock2 = mux_->makeConnectionSocket();
+  NiceMock<MockUDPReadCallback> readCb1;
+  NiceMock<MockUDPReadCallback> readCb2;
+  ON_CALL(readCb1, shouldOnlyNotify()).WillByDefault(Return(true));
+  ON_CALL(readCb2, shouldOnlyNotify()).WillByDefault(Return(true));
+  sock1->resumeRead(&readCb1);
+  sock2->resumeRead(&readCb2);
+
+  // Only sock1 talks to the peer sending the reset.
+  folly::SocketAddress otherPeer("127.0.0.3", 443);
+  EXPECT_CALL(*sockPtr_, write(_, _, _)).WillRepeatedly(Return(1));
+  std::string data = "x";
+  struct iovec vec{data.data(), data.size()};
+  EXPECT_EQ(sock1->write(peerAddress_, &vec, 1), 1);
+  EXPECT_EQ(sock2->write(otherPeer, &vec, 1), 1);
+
+  auto unknownConnId = ConnectionId::createRandom(kDefaultConnectionIdSize);
+  ASSERT_FALSE(unknownConnId.hasError());
+  std::string resetPayload(kMinStatelessPacketSize, 'r');
+  std::vector<BufPtr> datagrams;
+  datagrams.push_back(makeShortHeaderPacket(*unknownConnId, resetPayload));
+  // Too short to be a reset.
+  datagrams.push_back(makeShortHeaderPacket(*unknownConnId, "short"));
+  expectRecvmmsg(std::move(datagrams));
+
+  std::vector<std::string> read1;
+  EXPECT_CALL(readCb1, onNotifyDataAvailable_(Ref(*sock1)))
+      .WillOnce(Invoke([&](QuicAsyncUDPSocket& sock) {
+        read1.push_back(readPacket(sock));
+      }));
+  EXPECT_CALL(readCb2, onNotifyDataAvailable_(_)).Times(0);
+  mux_->onNotifyDataAvailable(*sockPtr_);
+  ASSERT_EQ(read1.size(), 1);
+  EXPECT_EQ(payload(read1[0]), resetPayload);
+  EXPECT_EQ(mux_->getStats().packetsRoutedByPeer, 1);
+  EXPECT_EQ(mux_->getStats().packetsUnroutable, 1);
+
+  // Once sock1 is gone nobody gets the reset.
+  sock1.reset();
+  datagrams.clear();
+  datagrams.push_back(makeShortHeaderPacket(*unknownConnId, resetPayload));
+  expectRecvmmsg(std::move(datagrams));
+  mux_->onNotifyDataAvailable(*sockPtr_);
+  EXPECT_EQ(mux_->getStats().packetsRoutedByPeer, 1);
+  EXPECT_EQ(mux_->getStats().packetsUnroutable, 2);
+}
+
+TEST_F(QuicClientSocketMuxTest, UnreadPacketsNotifiedInNextLoop) {
+  makeMux(QuicClientSocketMux::Options());
+  auto sock = mux_->makeConnectionSocket();
+  NiceMock<MockUDPReadCallback> readCb;
+  ON_CALL(readCb, shouldOnlyNotify()).WillByDefault(Return(true));
+  sock->resumeRead(&readCb);
+
+  std::vector<BufPtr> datagrams;
+  datagrams.push_back(makeShortHeaderPacket(makeConnectionId(*sock), "one"));
+  datagrams.push_back(makeShortHeaderPacket(makeConnectionId(*sock), "two"));
+  expectRecvmmsg(std::move(datagrams));
+
+  // The connection reads one packet per notification, as if it hit its read
+  // batch limit, so the mux comes back for the rest in the next loop.
+  std::vector<std::string> read;
+  EXPECT_CALL(readCb, onNotifyDataAvailable_(Ref(*sock)))
+      .Times(2)
+      .WillRepeatedly(Invoke(
+          [&](QuicAsyncUDPSocket& s) { read.push_back(readPacket(s)); }));
+  EXPECT_CALL(*evb_, runInLoopWithCbPtr(mux_.get(), _));
+  mux_->onNotifyDataAvailable(*sockPtr_);
+  ASSERT_EQ(read.size(), 1);
+
+  mux_->runLoopCallback();
+  ASSERT_EQ(read.size(), 2);
+  EXPECT_EQ(payload(read[0]), "one");
+  EXPECT_EQ(payload(read[1]), "two");
+}
+
+TEST_F(QuicClientSocketMuxTest, AggregatedWritesFlushedOnce) {
+  QuicClientSocketMux::Options options;
+  options.aggregateWrites = true;
+  makeMux(options);
+  auto sock1 = mux_->makeConnectionSocket();
+  auto sock2 = mux_->makeConnectionSocket();
+
+  // Writes are buffered until the end of the loop.
+  EXPECT_CALL(*sockPtr_, write(_, _, _)).Times(0);
+  EXPECT_CALL(*evb_, runInLoopWithCbPtr(mux_.get(), _)).Times(AtLeast(1));
+  std::string data1 = "hello";
+  std::string data2 = "world!";
+  struct iovec vec1{data1.data(), data1.size()};
+  struct iovec vec2{data2.data(), data2.size()};
+  EXPECT_EQ(sock1->write(peerAddress_, &vec1, 1), data1.size());
+  EXPECT_EQ(
+      sock2->writeGSO(
+          peerAddress_, &vec2, 1, QuicAsyncUDPSocket::WriteOptions(3, false)),
+      data2.size());
+  // The batch owns a copy of the data.
+  data1.assign(data1.size(), 'x');
+
+  EXPECT_CALL(*sockPtr_, writemGSO(_, Matcher<iovec*>(_), _, 2, _))
+      .WillOnce(Invoke(
+          [&](folly::Range<folly::SocketAddress const*> addrs,
+              iovec* iov,
+              size_t* numIovecs,
+              size_t count,
+              const QuicAsyncUDPSocket::WriteOptions* writeOptions) {
+            EXPECT_EQ(addrs.size(), count);
+            EXPECT_EQ(addrs[0], peerAddress_);
+            EXPECT_EQ(numIovecs[0], 1);
+            EXPECT_EQ(numIovecs[1], 1);
+            EXPECT_EQ(iovecString(iov[0]), "hello");
+            EXPECT_EQ(iovecString(iov[1]), "world!");
+            EXPECT_EQ(writeOptions[0].gso, 0);
+            EXPECT_EQ(writeOptions[1].gso, 3);
+            return static_cast<int>(count);
+          }));
+  mux_->runLoopCallback();
+  EXPECT_EQ(mux_->getStats().writeBatches, 1);
+  EXPECT_EQ(mux_->getStats().packetsWritten, 2);
+  EXPECT_EQ(mux_->getStats().writeErrors, 0);
+}
+
+TEST_F(QuicClientSocketMuxTest, AggregatedWritesWaitForWritableSocket) {
+  QuicClientSocketMux::Options options;
+  options.aggregateWrites = true;
+  makeMux(options);
+  auto sock = mux_->makeConnectionSocket();
+  std::string data1 = "one";
+  std::string data2 = "two";
+  struct iovec vec1{data1.data(), data1.size()};
+  struct iovec vec2{data2.data(), data2.size()};
+  EXPECT_EQ(sock->write(peerAddress_, &vec1, 1), data1.size());
+  EXPECT_EQ(sock->write(peerAddress_, &vec2, 1), data2.size());
+
+  // The socket takes the first packet and then would block.
+  EXPECT_CALL(*sockPtr_, writemGSO(_, Matcher<iovec*>(_), _, 2, _))
+      .WillOnce(Return(1));
+  EXPECT_CALL(*sockPtr_, writemGSO(_, Matcher<iovec*>(_), _, 1, _))
+      .WillOnce(Invoke([](auto&&...) {
+        errno = EAGAIN;
+        return -1;
+      }))
+      .WillOnce(Invoke(
+          [&](folly::Range<folly::SocketAddress const*>,
+              iovec* iov,
+              size_t*,
+              size_t count,
+              const QuicAsyncUDPSocket::WriteOptions*) {
+            EXPECT_EQ(iovecString(iov[0]), "two");
+            return static_cast<int>(count);
+          }))
+      // The last write, flushed when the mux goes away.
+      .WillOnce(Return(1));
+  EXPECT_CALL(*sockPtr_, resumeWrite(mux_.get()))
+      .WillRepeatedly(Return(quic::Expected<void, QuicError>{}));
+  mux_->runLoopCallback();
+  EXPECT_EQ(mux_->getStats().packetsWritten, 1);
+  EXPECT_EQ(mux_->getStats().writesBlocked, 1);
+  EXPECT_EQ(mux_->getStats().writeErrors, 0);
+
+  // The connection sees EAGAIN until the socket is writable again.
+  EXPECT_EQ(sock->write(peerAddress_, &vec1, 1), -1);
+  EXPECT_EQ(errno, EAGAIN);
+  MockWriteCallback writeCb;
+  EXPECT_FALSE(sock->resumeWrite(&writeCb).hasError());
+  EXPECT_TRUE(sock->isWritableCallbackSet());
+
+  EXPECT_CALL(*sockPtr_, pauseWrite());
+  EXPECT_CALL(writeCb, onSocketWritable()).WillOnce(Invoke([&]() {
+    sock->pauseWrite();
+  }));
+  mux_->onSocketWritable();
+  EXPECT_EQ(mux_->getStats().packetsWritten, 2);
+  EXPECT_FALSE(sock->isWritableCallbackSet());
+  EXPECT_EQ(sock->write(peerAddress_, &vec1, 1), data1.size());
+}
+
+TEST_F(QuicClientSocketMuxTest, ConnectionSocketLeavesSharedSocketAlone) {
+  makeMux(QuicClientSocketMux::Options());
+  auto sock = mux_->makeConnectionSocket();
+  EXPECT_CALL(*sockPtr_, connect(_)).Times(0);
+  EXPECT_CALL(*sockPtr_, bind(_)).Times(0);
+  EXPECT_CALL(*sockPtr_, setTosOrTrafficClass(_)).Times(0);
+  EXPECT_FALSE(sock->init(AF_INET).hasError());
+  EXPECT_TRUE(sock->init(AF_INET6).hasError());
+  EXPECT_TRUE(sock->isBound());
+  EXPECT_FALSE(sock->connect(peerAddress_).hasError());
+  EXPECT_FALSE(sock->setTosOrTrafficClass(0x02).hasError());
+  EXPECT_EQ(sock->address().value(), localAddress_);
+  EXPECT_FALSE(sock->close().hasError());
+  EXPECT_EQ(mux_->numConnections(), 0);
+  EXPECT_FALSE(sock->isBound());
+}
+
+} // namespace quic::test
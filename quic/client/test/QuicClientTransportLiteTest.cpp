@@ -239,6 +239,59 @@ TEST_F(QuicClientTransportLiteTest, TestMaybeIssueConnectionIdsSuccess) {
   }
 }
 
+TEST_F(QuicClientTransportLiteTest, TestConnectionIdGenerator) {
+  auto conn = quicClient_->getConn();
+  uint8_t nextByte = 0;
+  auto result = quicClient_->setConnectionIdGenerator([&nextByte]() {
+    return ConnectionId::create({0xab, 0xcd, nextByte++, 0x00});
+  });
+  ASSERT_FALSE(result.hasError());
+
+  // The initial connection id is replaced by a generated one.
+  auto expectedInitial = ConnectionId::create({0xab, 0xcd, 0x00, 0x00});
+  ASSERT_FALSE(expectedInitial.hasError());
+  EXPECT_EQ(*conn->clientConnectionId, *expectedInitial);
+  ASSERT_EQ(conn->selfConnectionIds.size(), 1);
+  EXPECT_EQ(conn->selfConnectionIds[0].connId, *expectedInitial);
+  EXPECT_EQ(conn->selfConnectionIds[0].sequenceNumber, 0);
+
+  // Connection ids issued later come from the generator too.
+  conn->oneRttWriteCipher = test::createNoOpAead();
+  EXPECT_FALSE(quicClient_->testMaybeIssueConnectionIds().hasError());
+  EXPECT_EQ(conn->selfConnectionIds.size(), maximumConnectionIdsToIssue(*conn));
+  for (size_t i = 0; i < conn->selfConnectionIds.size(); ++i) {
+    const auto& connId = conn->selfConnectionIds[i].connId;
+    ASSERT_EQ(connId.size(), 4);
+    EXPECT_EQ(connId.data()[0], 0xab);
+    EXPECT_EQ(connId.data()[1], 0xcd);
+    EXPECT_EQ(connId.data()[2], i);
+  }
+}
+
+TEST_F(QuicClientTransportLiteTest, TestConnectionIdGeneratorRejected) {
+  auto conn = quicClient_->getConn();
+  auto empty = quicClient_->setConnectionIdGenerator(nullptr);
+  ASSERT_TRUE(empty.hasError());
+  EXPECT_EQ(
+      *empty.error().code.asLocalErrorCode(),
+      LocalErrorCode::INVALID_OPERATION);
+
+  auto generator = []() { return ConnectionId::createRandom(8); };
+  ASSERT_FALSE(quicClient_->setConnectionIdGenerator(generator).hasError());
+  conn->oneRttWriteCipher = test::createNoOpAead();
+  EXPECT_FALSE(quicClient_->testMaybeIssueConnectionIds().hasError());
+  ASSERT_GT(conn->selfConnectionIds.size(), 1);
+
+  // Once more connection ids are issued the generator can't change.
+  auto initialConnId = *conn->clientConnectionId;
+  auto result = quicClient_->setConnectionIdGenerator(generator);
+  ASSERT_TRUE(result.hasError());
+  EXPECT_EQ(
+      *result.error().code.asLocalErrorCode(),
+      LocalErrorCode::INVALID_OPERATION);
+  EXPECT_EQ(*conn->clientConnectionId, initialConnId);
+}
+
 TEST_F(QuicClientTransportLiteTest, TestMaybeIssueConnectionIdsAlreadyAtMax) {
   // Test: No additional CIDs when already at maximum
   auto conn = quicClient_->getConn();
@@ -442,6 +495,7 @@ TEST_F(QuicClientTransportLiteTest, RetirePeerConnectionId_Success) {
 
   // Clear pending frames
   conn->pendingEvents.frames.clear();
+  conn->pendingEvents.clearPendingWrite(PendingWriteReason::SIMPLE_FRAME);
 
   // Retire the CID
   conn->retirePeerConnectionId(cidToRetire);
@@ -472,6 +526,7 @@ TEST_F(QuicClientTransportLiteTest, RetirePeerConnectionId_ZeroLength) {
 
   // Clear pending frames
   conn->pendingEvents.frames.clear();
+  conn->pendingEvents.clearPendingWrite(PendingWriteReason::SIMPLE_FRAME);
 
   // Try to retire zero-length CID - should be a no-op
   auto zeroCid = ConnectionId::createZeroLength();
@@ -490,6 +545,7 @@ TEST_F(QuicClientTransportLiteTest, RetirePeerConnectionId_NonExistent) {
 
   // Clear pending frames
   conn->pendingEvents.frames.clear();
+  conn->pendingEvents.clearPendingWrite(PendingWriteReason::SIMPLE_FRAME);
 
   // Try to retire non-existent CID - should be a no-op
   auto nonExistentCid = ConnectionId::createAndMaybeCrash({99, 99, 99, 99});
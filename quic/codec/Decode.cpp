@@ -1336,6 +1336,53 @@ parseLongHeaderInvariant(uint8_t initialByte, ContiguousReadCursor& cursor) {
       bytesRead);
 }
 
+quic::Expected<ParsedLongHeaderInvariant, TransportErrorCode>
+parseLongHeaderInvariant(
+    uint8_t initialByte,
+    ContiguousReadCursor& cursor,
+    const PacketRoutingDescriptor& descriptor) {
+  if (!descriptor.longHeader || cursor.getCurrentPosition() != 1 ||
+      !cursor.canAdvance(descriptor.invariantLength)) {
+    return parseLongHeaderInvariant(initialByte, cursor);
+  }
+  // The worker validated these bytes when it made the descriptor, so the
+  // connection ids are copied out without reading the lengths again.
+  const uint8_t* packet = cursor.data() - 1;
+  DCHECK_EQ(packet[descriptor.dstConnIdOffset - 1], descriptor.dstConnIdLength);
+  DCHECK_EQ(packet[descriptor.srcConnIdOffset - 1], descriptor.srcConnIdLength);
+  cursor.skip(descriptor.dstConnIdOffset - 1);
+  auto destConnIdResult =
+      ConnectionId::create(cursor, descriptor.dstConnIdLength);
+  cursor.skip(1);
+  auto srcConnIdResult =
+      ConnectionId::create(cursor, descriptor.srcConnIdLength);
+  if (destConnIdResult.hasError() || srcConnIdResult.hasError()) {
+    return quic::make_unexpected(TransportErrorCode::FRAME_ENCODING_ERROR);
+  }
+  return ParsedLongHeaderInvariant(
+      initialByte,
+      LongHeaderInvariant(
+          descriptor.version,
+          std::move(srcConnIdResult.value()),
+          std::move(destConnIdResult.value())),
+      descriptor.invariantLength);
+}
+
+PacketRoutingDescriptor makePacketRoutingDescriptor(
+    const ParsedLongHeaderInvariant& parsedInvariant) {
+  PacketRoutingDescriptor descriptor;
+  descriptor.longHeader = true;
+  descriptor.version = parsedInvariant.invariant.version;
+  // After the initial byte, the version and the length byte.
+  descriptor.dstConnIdOffset = 1 + sizeof(QuicVersionType) + 1;
+  descriptor.dstConnIdLength = parsedInvariant.invariant.dstConnId.size();
+  descriptor.srcConnIdOffset =
+      descriptor.dstConnIdOffset + descriptor.dstConnIdLength + 1;
+  descriptor.srcConnIdLength = parsedInvariant.invariant.srcConnId.size();
+  descriptor.invariantLength = parsedInvariant.invariantLength;
+  return descriptor;
+}
+
 LongHeader::Types parseLongHeaderType(uint8_t initialByte) {
   return static_cast<LongHeader::Types>(
       (initialByte & LongHeader::kPacketTypeMask) >> LongHeader::kTypeShift);
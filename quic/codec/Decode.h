@@ -205,6 +205,24 @@ parsePlaintextRetryOrNewToken(ContiguousReadCursor& cursor);
 [[nodiscard]] quic::Expected<ParsedLongHeaderInvariant, TransportErrorCode>
 parseLongHeaderInvariant(uint8_t initalByte, ContiguousReadCursor& cursor);
 
+/**
+ * Same as above, but takes the fields from the routing descriptor of the
+ * packet instead of parsing them. Parses them if the descriptor is unset or
+ * the packet is too short for it.
+ */
+[[nodiscard]] quic::Expected<ParsedLongHeaderInvariant, TransportErrorCode>
+parseLongHeaderInvariant(
+    uint8_t initialByte,
+    ContiguousReadCursor& cursor,
+    const PacketRoutingDescriptor& routingDescriptor);
+
+/**
+ * Describes a long header packet whose invariant fields were parsed from the
+ * start of a datagram.
+ */
+PacketRoutingDescriptor makePacketRoutingDescriptor(
+    const ParsedLongHeaderInvariant& parsedInvariant);
+
 struct PacketLength {
   // The length of the packet payload (including packet number)
   uint64_t packetLength;
@@ -11,8 +11,26 @@
 
 #include <quic/codec/Types.h>
 
+#include <algorithm>
+
 namespace quic {
 
+quic::Expected<void, QuicError> PacketNumberCipher::maskBatch(
+    ByteRange samples,
+    MutableByteRange masks) const {
+  constexpr size_t kSampleSize = sizeof(Sample);
+  CHECK_EQ(samples.size() % kSampleSize, 0);
+  CHECK_EQ(samples.size(), masks.size());
+  for (size_t offset = 0; offset < samples.size(); offset += kSampleSize) {
+    auto maskResult = mask(ByteRange(samples.data() + offset, kSampleSize));
+    if (maskResult.hasError()) {
+      return quic::make_unexpected(maskResult.error());
+    }
+    memcpy(masks.data() + offset, maskResult->data(), kSampleSize);
+  }
+  return {};
+}
+
 quic::Expected<void, QuicError> PacketNumberCipher::decipherHeader(
     ByteRange sample,
     MutableByteRange initialByte,
@@ -48,10 +66,75 @@ quic::Expected<void, QuicError> PacketNumberCipher::cipherHeader(
   HeaderProtectionMask headerMask = std::move(maskResult.value());
   // Mask size should be > packet number length + 1.
   DCHECK_GE(headerMask.size(), kMaxPacketNumEncodingSize + 1);
+  applyHeaderMask(
+      headerMask.data(), initialByte, packetNumberBytes, initialByteMask);
+  return {};
+}
+
+void PacketNumberCipher::applyHeaderMask(
+    const uint8_t* headerMask,
+    MutableByteRange initialByte,
+    MutableByteRange packetNumberBytes,
+    uint8_t initialByteMask) {
+  // The packet number length has to be read before the initial byte is
+  // masked.
   size_t packetNumLength = parsePacketNumberLength(*initialByte.data());
-  initialByte.data()[0] ^= headerMask.data()[0] & initialByteMask;
+  initialByte.data()[0] ^= headerMask[0] & initialByteMask;
   for (size_t i = 0; i < packetNumLength; ++i) {
-    packetNumberBytes.data()[i] ^= headerMask.data()[i + 1];
+    packetNumberBytes.data()[i] ^= headerMask[i + 1];
+  }
+}
+
+quic::Expected<void, QuicError> PacketNumberCipher::encryptHeaders(
+    const HeaderToEncrypt* headers,
+    size_t numHeaders) const {
+  for (size_t i = 0; i < numHeaders; ++i) {
+    const auto& header = headers[i];
+    auto result = header.headerForm == HeaderForm::Short
+        ? encryptShortHeader(
+              header.sample, header.initialByte, header.packetNumberBytes)
+        : encryptLongHeader(
+              header.sample, header.initialByte, header.packetNumberBytes);
+    if (!result.has_value()) {
+      return result;
+    }
+  }
+  return {};
+}
+
+quic::Expected<void, QuicError>
+PacketNumberCipher::encryptHeadersWithMaskBatch(
+    const HeaderToEncrypt* headers,
+    size_t numHeaders) const {
+  // Masks are computed this many headers at a time, so the scratch space
+  // stays on the stack. 64 covers a full GSO batch.
+  constexpr size_t kMaxHeadersPerMaskBatch = 64;
+  constexpr size_t kSampleSize = sizeof(Sample);
+  std::array<uint8_t, kMaxHeadersPerMaskBatch * kSampleSize> samples;
+  std::array<uint8_t, kMaxHeadersPerMaskBatch * kSampleSize> masks;
+  for (size_t first = 0; first < numHeaders;
+       first += kMaxHeadersPerMaskBatch) {
+    auto count = std::min(numHeaders - first, kMaxHeadersPerMaskBatch);
+    for (size_t i = 0; i < count; ++i) {
+      const auto& sample = headers[first + i].sample;
+      CHECK_EQ(sample.size(), kSampleSize);
+      memcpy(samples.data() + i * kSampleSize, sample.data(), kSampleSize);
+    }
+    auto maskResult = maskBatch(
+        ByteRange(samples.data(), count * kSampleSize),
+        MutableByteRange(masks.data(), count * kSampleSize));
+    if (!maskResult.has_value()) {
+      return maskResult;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      const auto& header = headers[first + i];
+      applyHeaderMask(
+          masks.data() + i * kSampleSize,
+          header.initialByte,
+          header.packetNumberBytes,
+          header.headerForm == HeaderForm::Short ? ShortHeader::kTypeBitsMask
+                                                 : LongHeader::kTypeBitsMask);
+    }
   }
   return {};
 }
@@ -104,4 +187,23 @@ quic::Expected<void, QuicError> PacketNumberCipher::encryptShortHeader(
       ShortHeader::kPacketNumLenMask);
 }
 
+PacketNumberCipher::HeaderToEncrypt makeHeaderToEncrypt(
+    HeaderForm headerForm,
+    uint8_t* header,
+    size_t headerLen,
+    const uint8_t* encryptedBody,
+    size_t bodyLen) {
+  auto packetNumberLength = parsePacketNumberLength(*header);
+  // If there were less than 4 bytes in the packet number, some of the
+  // payload bytes are also skipped when sampling.
+  size_t sampleBytesToUse = kMaxPacketNumEncodingSize - packetNumberLength;
+  CHECK_GE(bodyLen, sampleBytesToUse + sizeof(Sample));
+  return PacketNumberCipher::HeaderToEncrypt{
+      headerForm,
+      ByteRange(encryptedBody + sampleBytesToUse, sizeof(Sample)),
+      MutableByteRange(header, 1),
+      MutableByteRange(
+          header + headerLen - packetNumberLength, packetNumberLength)};
+}
+
 } // namespace quic
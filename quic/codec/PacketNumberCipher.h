@@ -10,6 +10,7 @@
 #include <folly/Unit.h>
 #include <quic/QuicConstants.h>
 #include <quic/QuicException.h>
+#include <quic/codec/Types.h>
 #include <quic/common/BufUtil.h>
 #include <quic/common/Expected.h>
 #include <quic/common/Optional.h>
@@ -29,6 +30,16 @@ class PacketNumberCipher {
   [[nodiscard]] virtual quic::Expected<HeaderProtectionMask, QuicError> mask(
       ByteRange sample) const = 0;
 
+  /**
+   * Computes the masks of a batch of samples, laid out back to back in
+   * samples, into masks, which must be the same size. The default calls
+   * mask() once per sample; ciphers that can run many blocks in one call
+   * should override it.
+   */
+  [[nodiscard]] virtual quic::Expected<void, QuicError> maskBatch(
+      ByteRange samples,
+      MutableByteRange masks) const;
+
   /**
    * Decrypts a long header from a sample.
    * sample should be 16 bytes long.
@@ -71,6 +82,26 @@ class PacketNumberCipher {
       MutableByteRange initialByte,
       MutableByteRange packetNumberBytes) const;
 
+  /**
+   * A header for encryptHeaders(). The ranges mean the same as the
+   * arguments of encryptLongHeader and encryptShortHeader.
+   */
+  struct HeaderToEncrypt {
+    HeaderForm headerForm;
+    ByteRange sample;
+    MutableByteRange initialByte;
+    MutableByteRange packetNumberBytes;
+  };
+
+  /**
+   * Encrypts a batch of headers. The default calls encryptLongHeader or
+   * encryptShortHeader on each header; ciphers whose maskBatch() runs many
+   * blocks in one call override it with encryptHeadersWithMaskBatch().
+   */
+  [[nodiscard]] virtual quic::Expected<void, QuicError> encryptHeaders(
+      const HeaderToEncrypt* headers,
+      size_t numHeaders) const;
+
   /**
    * Returns the length of key needed for the pn cipher.
    */
@@ -82,6 +113,24 @@ class PacketNumberCipher {
   [[nodiscard]] virtual const BufPtr& getKey() const = 0;
 
  protected:
+  /**
+   * encryptHeaders() with the masks of many headers at a time coming from
+   * one maskBatch() call.
+   */
+  [[nodiscard]] quic::Expected<void, QuicError> encryptHeadersWithMaskBatch(
+      const HeaderToEncrypt* headers,
+      size_t numHeaders) const;
+
+  /**
+   * Masks the initial byte and the packet number of a header that isn't
+   * protected yet.
+   */
+  static void applyHeaderMask(
+      const uint8_t* headerMask,
+      MutableByteRange initialByte,
+      MutableByteRange packetNumberBytes,
+      uint8_t initialByteMask);
+
   [[nodiscard]] virtual quic::Expected<void, QuicError> cipherHeader(
       ByteRange sample,
       MutableByteRange initialByte,
@@ -97,4 +146,15 @@ class PacketNumberCipher {
       uint8_t packetNumLengthMask) const;
 };
 
+/**
+ * The header to encrypt of a packet, see encryptHeaders(). header and
+ * encryptedBody are the packet's header and its body after the AEAD ran.
+ */
+PacketNumberCipher::HeaderToEncrypt makeHeaderToEncrypt(
+    HeaderForm headerForm,
+    uint8_t* header,
+    size_t headerLen,
+    const uint8_t* encryptedBody,
+    size_t bodyLen);
+
 } // namespace quic
@@ -42,12 +42,15 @@ Optional<VersionNegotiationPacket> QuicReadCodec::tryParsingVersionNegotiation(
 
 quic::Expected<ParsedLongHeader, TransportErrorCode> tryParseLongHeader(
     ContiguousReadCursor& cursor,
-    QuicNodeType nodeType) {
+    QuicNodeType nodeType,
+    const PacketRoutingDescriptor* routingDescriptor) {
   uint8_t initialByte = 0;
   if (!cursor.tryReadBE(initialByte)) {
     return quic::make_unexpected(TransportErrorCode::PROTOCOL_VIOLATION);
   }
-  auto longHeaderInvariant = parseLongHeaderInvariant(initialByte, cursor);
+  auto longHeaderInvariant = routingDescriptor
+      ? parseLongHeaderInvariant(initialByte, cursor, *routingDescriptor)
+      : parseLongHeaderInvariant(initialByte, cursor);
   if (!longHeaderInvariant) {
     VLOG(4) << "Dropping packet, failed to parse invariant";
     // We've failed to parse the long header, so we have no idea where this
@@ -94,11 +97,12 @@ static PacketDropReason getDecryptErrorReason(ProtectionType protectionType) {
 
 quic::Expected<CodecResult, QuicError> QuicReadCodec::parseLongHeaderPacket(
     BufQueue& queue,
-    const AckStates& ackStates) {
+    const AckStates& ackStates,
+    const PacketRoutingDescriptor* routingDescriptor) {
   ContiguousReadCursor cursor(queue.front()->data(), queue.front()->length());
   const uint8_t initialByte = *cursor.peekBytes().data();
 
-  auto res = tryParseLongHeader(cursor, nodeType_);
+  auto res = tryParseLongHeader(cursor, nodeType_, routingDescriptor);
   if (res.hasError()) {
     VLOG(4) << "Failed to parse long header " << connIdToHex();
     queue.move();
@@ -191,26 +195,22 @@ quic::Expected<CodecResult, QuicError> QuicReadCodec::parseLongHeaderPacket(
   }
 
   PacketNum expectedNextPacketNum = 0;
-  Optional<PacketNum> largestRecvdPacketNum;
+  const AckState* ackState = nullptr;
   switch (longHeaderTypeToProtectionType(type)) {
     case ProtectionType::Initial:
-      largestRecvdPacketNum = ackStates.initialAckState->largestRecvdPacketNum;
-
+      ackState = ackStates.initialAckState.get();
       break;
     case ProtectionType::Handshake:
-      largestRecvdPacketNum =
-          ackStates.handshakeAckState->largestRecvdPacketNum;
-
+      ackState = ackStates.handshakeAckState.get();
       break;
     case ProtectionType::ZeroRtt:
-      largestRecvdPacketNum = ackStates.appDataAckState.largestRecvdPacketNum;
-
+      ackState = &ackStates.appDataAckState;
       break;
     default:
       folly::assume_unreachable();
   }
-  if (largestRecvdPacketNum) {
-    expectedNextPacketNum = 1 + *largestRecvdPacketNum;
+  if (ackState->largestRecvdPacketNum) {
+    expectedNextPacketNum = 1 + *ackState->largestRecvdPacketNum;
   }
   MutableByteRange initialByteRange(currentPacketData->writableData(), 1);
   MutableByteRange packetNumberByteRange(
@@ -227,6 +227,10 @@ quic::Expected<CodecResult, QuicError> QuicReadCodec::parseLongHeaderPacket(
   std::pair<PacketNum, size_t> packetNum = parsePacketNumber(
       initialByteRange.data()[0], packetNumberByteRange, expectedNextPacketNum);
 
+  if (isDuplicatePacket(*ackState, packetNum.first)) {
+    return CodecResult(Nothing(PacketDropReason::DUPLICATE_PACKET));
+  }
+
   longHeader.setPacketNumber(packetNum.first);
   BufQueue decryptQueue;
   decryptQueue.append(std::move(currentPacketData));
@@ -307,6 +311,9 @@ quic::Expected<CodecResult, QuicError> QuicReadCodec::tryParseShortHeaderPacket(
     VLOG(10) << "Dropping packet, cannot parse " << connIdToHex();
     return CodecResult(Nothing());
   }
+  if (isDuplicatePacket(ackStates.appDataAckState, packetNum.first)) {
+    return CodecResult(Nothing(PacketDropReason::DUPLICATE_PACKET));
+  }
   shortHeader->setPacketNumber(packetNum.first);
   bool peerKeyUpdateAttempt = false;
   auto oneRttReadCipherToUse = [&]() -> Aead* {
@@ -412,7 +419,8 @@ quic::Expected<CodecResult, QuicError> QuicReadCodec::tryParseShortHeaderPacket(
 CodecResult QuicReadCodec::parsePacket(
     BufQueue& queue,
     const AckStates& ackStates,
-    size_t dstConnIdSize) {
+    size_t dstConnIdSize,
+    const PacketRoutingDescriptor* routingDescriptor) {
   if (queue.empty()) {
     return CodecResult(Nothing());
   }
@@ -424,7 +432,7 @@ CodecResult QuicReadCodec::parsePacket(
   }
   auto headerForm = getHeaderForm(initialByte);
   if (headerForm == HeaderForm::Long) {
-    auto result = parseLongHeaderPacket(queue, ackStates);
+    auto result = parseLongHeaderPacket(queue, ackStates, routingDescriptor);
     if (result.hasError()) {
       return CodecResult(CodecError(std::move(result.error())));
     }
@@ -471,6 +479,18 @@ CodecResult QuicReadCodec::parsePacket(
   return std::move(result.value());
 }
 
+bool QuicReadCodec::isDuplicatePacket(
+    const AckState& ackState,
+    PacketNum packetNum) {
+  if (!ackState.recvdPacketWindow.contains(packetNum)) {
+    return false;
+  }
+  VLOG(10) << "Dropping duplicate packet=" << packetNum << " "
+           << connIdToHex();
+  QUIC_STATS(statsCallback_, onDuplicatedPacketReceived);
+  return true;
+}
+
 bool QuicReadCodec::canInitiateKeyUpdate() const {
   if (!nextOneRttReadCipher_ || !currentOneRttReadPhaseStartPacketNum_) {
     // We haven't received any packets in the current oneRtt phase yet.
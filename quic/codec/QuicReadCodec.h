@@ -97,10 +97,13 @@ struct CodecResult {
 /**
  * Reads given data and returns parsed long header.
  * Returns an error if parsing is unsuccessful.
+ * If the packet was routed by a server worker, its routing descriptor saves
+ * decoding the invariant fields again.
  */
 quic::Expected<ParsedLongHeader, TransportErrorCode> tryParseLongHeader(
     ContiguousReadCursor& cursor,
-    QuicNodeType nodeType);
+    QuicNodeType nodeType,
+    const PacketRoutingDescriptor* routingDescriptor = nullptr);
 
 class QuicReadCodec {
  public:
@@ -115,11 +118,14 @@ class QuicReadCodec {
    * cipher unavailable structure. The caller can then retry when the cipher is
    * available. A client should call tryParsingVersionNegotiation
    * before the version is negotiated to detect VN.
+   * routingDescriptor, if set, must describe the packet at the front of the
+   * queue, i.e. only be passed for the first packet in a datagram.
    */
   virtual CodecResult parsePacket(
       BufQueue& queue,
       const AckStates& ackStates,
-      size_t dstConnIdSize = kDefaultConnectionIdSize);
+      size_t dstConnIdSize = kDefaultConnectionIdSize,
+      const PacketRoutingDescriptor* routingDescriptor = nullptr);
 
   /**
    * Tries to parse the packet and returns whether or not
@@ -205,7 +211,12 @@ class QuicReadCodec {
       ContiguousReadCursor& cursor);
   quic::Expected<CodecResult, QuicError> parseLongHeaderPacket(
       BufQueue& queue,
-      const AckStates& ackStates);
+      const AckStates& ackStates,
+      const PacketRoutingDescriptor* routingDescriptor);
+
+  // Whether the packet number was recently received in the ack state's
+  // packet number space, in which case the packet is dropped undecrypted.
+  bool isDuplicatePacket(const AckState& ackState, PacketNum packetNum);
 
   [[nodiscard]] std::string connIdToHex() const;
 
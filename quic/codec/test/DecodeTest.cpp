@@ -261,6 +261,68 @@ TEST_F(DecodeTest, DifferentCIDLength) {
   EXPECT_EQ(versionPacket->versions, versions);
 }
 
+TEST_F(DecodeTest, LongHeaderInvariantFromRoutingDescriptor) {
+  ConnectionId srcConnId = getTestConnectionId(0);
+  ConnectionId dstConnId =
+      ConnectionId::createAndMaybeCrash({1, 2, 3, 4, 5, 6});
+  auto buf = folly::IOBuf::create(64);
+  folly::io::Appender appender(buf.get(), 64);
+  uint8_t initialByte = kHeaderFormMask | LongHeader::kFixedBitMask;
+  appender.writeBE<uint8_t>(initialByte);
+  appender.writeBE<QuicVersionType>(
+      static_cast<QuicVersionType>(QuicVersion::MVFST));
+  appender.writeBE<uint8_t>(dstConnId.size());
+  appender.push(dstConnId.data(), dstConnId.size());
+  appender.writeBE<uint8_t>(srcConnId.size());
+  appender.push(srcConnId.data(), srcConnId.size());
+  // The first byte after the invariant fields.
+  appender.writeBE<uint8_t>(0xab);
+
+  auto parse = [&](const PacketRoutingDescriptor* descriptor, size_t len) {
+    ContiguousReadCursor cursor(buf->data(), len);
+    uint8_t byte = 0;
+    EXPECT_TRUE(cursor.tryReadBE(byte));
+    return descriptor ? parseLongHeaderInvariant(byte, cursor, *descriptor)
+                      : parseLongHeaderInvariant(byte, cursor);
+  };
+
+  auto parsed = parse(nullptr, buf->length());
+  ASSERT_TRUE(parsed.has_value());
+  auto descriptor = makePacketRoutingDescriptor(*parsed);
+  EXPECT_TRUE(descriptor.longHeader);
+  EXPECT_EQ(descriptor.version, QuicVersion::MVFST);
+  EXPECT_EQ(buf->data()[descriptor.dstConnIdOffset], 1);
+  EXPECT_EQ(descriptor.dstConnIdLength, dstConnId.size());
+  EXPECT_EQ(
+      ConnectionId::createAndMaybeCrash(std::vector<uint8_t>(
+          buf->data() + descriptor.srcConnIdOffset,
+          buf->data() + descriptor.srcConnIdOffset +
+              descriptor.srcConnIdLength)),
+      srcConnId);
+
+  ContiguousReadCursor cursor(buf->data(), buf->length());
+  uint8_t byte = 0;
+  ASSERT_TRUE(cursor.tryReadBE(byte));
+  auto fromDescriptor = parseLongHeaderInvariant(byte, cursor, descriptor);
+  ASSERT_TRUE(fromDescriptor.has_value());
+  EXPECT_EQ(fromDescriptor->invariant.version, QuicVersion::MVFST);
+  EXPECT_EQ(fromDescriptor->invariant.dstConnId, dstConnId);
+  EXPECT_EQ(fromDescriptor->invariant.srcConnId, srcConnId);
+  EXPECT_EQ(fromDescriptor->invariantLength, parsed->invariantLength);
+  // The cursor is left after the invariant fields, as when parsing them.
+  uint8_t next = 0;
+  EXPECT_TRUE(cursor.tryReadBE(next));
+  EXPECT_EQ(next, 0xab);
+
+  // An unset descriptor, or one that the packet is too short for, isn't used.
+  PacketRoutingDescriptor unset;
+  auto fromUnset = parse(&unset, buf->length());
+  ASSERT_TRUE(fromUnset.has_value());
+  EXPECT_EQ(fromUnset->invariant.srcConnId, srcConnId);
+  auto truncated = parse(&descriptor, descriptor.invariantLength);
+  EXPECT_FALSE(truncated.has_value());
+}
+
 TEST_F(DecodeTest, VersionNegotiationPacketBadPacketTest) {
   ConnectionId connId = getTestConnectionId();
   QuicVersionType version = static_cast<QuicVersionType>(QuicVersion::MVFST);
@@ -341,6 +341,35 @@ TEST_F(QuicReadCodecTest, PacketDecryptFail) {
   EXPECT_FALSE(parseSuccess(std::move(packet)));
 }
 
+TEST_F(QuicReadCodecTest, DuplicatePacketDroppedBeforeDecrypt) {
+  auto connId = getTestConnectionId();
+  PacketNum packetNum = 12321;
+  StreamId streamId = 2;
+
+  auto aead = std::make_unique<MockAead>();
+  EXPECT_CALL(*aead, _tryDecrypt(_, _, _)).Times(0);
+  auto data = folly::IOBuf::copyBuffer("hello");
+  auto streamPacket = createStreamPacket(
+      connId,
+      connId,
+      packetNum,
+      streamId,
+      *data,
+      0 /* cipherOverhead */,
+      0 /* largestAcked */);
+
+  AckStates ackStates;
+  ackStates.appDataAckState.largestRecvdPacketNum = packetNum + 1;
+  ackStates.appDataAckState.recvdPacketWindow.insert(packetNum);
+  ackStates.appDataAckState.recvdPacketWindow.insert(packetNum + 1);
+  auto packetQueue = bufToQueue(packetToBuf(streamPacket));
+  auto packet = makeEncryptedCodec(connId, std::move(aead))
+                    ->parsePacket(packetQueue, ackStates);
+  EXPECT_EQ(
+      packet.nothing()->reason,
+      PacketDropReason(PacketDropReason::DUPLICATE_PACKET));
+}
+
 TEST_F(QuicReadCodecTest, ShortOneRttPacketWithZeroRttCipher) {
   auto connId = getTestConnectionId();
   PacketNum packetNum = 12321;
@@ -20,6 +20,20 @@ IntervalSet<T, Unit, Container>::IntervalSet(
 template <typename T, T Unit, template <typename... I> class Container>
 void IntervalSet<T, Unit, Container>::insert(
     const Interval<T, Unit>& interval) {
+  // Fast path for intervals that only touch the end of the set, e.g. packet
+  // numbers received in order. These skip the search for intersections.
+  if (!container_type::empty() &&
+      interval.start >= container_type::back().start) {
+    auto& last = container_type::back();
+    if (interval.start > last.end + interval_type::unitValue()) {
+      insertVersion_++;
+      container_type::push_back(interval);
+    } else if (interval.end > last.end) {
+      insertVersion_++;
+      last.end = interval.end;
+    }
+    return;
+  }
   auto intersectionRange = intersectingRange(interval);
   auto firstIt = intersectionRange.first;
   auto endIt = intersectionRange.second;
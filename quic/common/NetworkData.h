@@ -12,11 +12,32 @@
 #include <quic/common/Optional.h>
 #include <quic/common/TimePoints.h>
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
 namespace quic {
 
+/**
+ * The invariant fields of a long header packet at the start of a datagram,
+ * as parsed by the server worker to route the datagram. The transport takes
+ * them from here instead of parsing the same fields again.
+ *
+ * Offsets are from the start of the datagram.
+ */
+struct PacketRoutingDescriptor {
+  // Header form of the packet. The other fields are only set for long
+  // headers.
+  bool longHeader{false};
+  QuicVersion version{QuicVersion::MVFST_INVALID};
+  uint8_t dstConnIdOffset{0};
+  uint8_t dstConnIdLength{0};
+  uint8_t srcConnIdOffset{0};
+  uint8_t srcConnIdLength{0};
+  // Length of the invariant fields after the initial byte.
+  uint16_t invariantLength{0};
+};
+
 /**
  * Received UDP packet with timings.
  *
@@ -84,6 +105,9 @@ struct ReceivedUdpPacket {
 
   // ToS / TClass value
   uint8_t tosValue{0};
+
+  // Set by the server worker for datagrams that start with a long header.
+  PacketRoutingDescriptor routingDescriptor;
 };
 
 struct NetworkData {
@@ -141,6 +165,18 @@ struct NetworkData {
     totalData_ += packets_.back().buf.chainLength();
   }
 
+  /**
+   * Adds a packet that keeps its own timings, e.g. one that was buffered and
+   * is handed over later. The receive time of the data becomes the latest
+   * receive time of its packets.
+   */
+  void addPacketWithTimings(ReceivedUdpPacket&& packetIn) {
+    receiveTimePoint_ =
+        std::max(receiveTimePoint_, packetIn.timings.receiveTimePoint);
+    packets_.emplace_back(std::move(packetIn));
+    totalData_ += packets_.back().buf.chainLength();
+  }
+
   [[nodiscard]] const std::vector<ReceivedUdpPacket>& getPackets() const {
     return packets_;
   }
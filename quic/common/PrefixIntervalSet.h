@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/common/IntervalSet.h>
+
+#include <memory>
+#include <vector>
+
+namespace quic {
+
+/*
+ * A set of non-negative values stored as sorted disjoint intervals, for sets
+ * that mostly grow contiguously from zero, e.g. the acked byte ranges of a
+ * stream.
+ *
+ * The interval starting at zero is stored as its end alone. Intervals past a
+ * gap are kept in an IntervalSet that is only allocated while there is a gap,
+ * and are merged back into the prefix once the gap is filled. A set that is
+ * only ever extended in order never allocates.
+ *
+ * Only the accessors needed to track acked data are provided.
+ */
+template <typename T, T Unit = (T)1>
+class PrefixIntervalSet {
+ public:
+  using interval_type = Interval<T, Unit>;
+
+  PrefixIntervalSet() = default;
+
+  PrefixIntervalSet(const PrefixIntervalSet& other)
+      : prefixEnd_(other.prefixEnd_),
+        rest_(
+            other.rest_ ? std::make_unique<RestSet>(*other.rest_) : nullptr),
+        insertVersion_(other.insertVersion_) {}
+
+  PrefixIntervalSet& operator=(const PrefixIntervalSet& other) {
+    if (this != &other) {
+      prefixEnd_ = other.prefixEnd_;
+      rest_ = other.rest_ ? std::make_unique<RestSet>(*other.rest_) : nullptr;
+      insertVersion_ = other.insertVersion_;
+    }
+    return *this;
+  }
+
+  PrefixIntervalSet(PrefixIntervalSet&&) noexcept = default;
+  PrefixIntervalSet& operator=(PrefixIntervalSet&&) noexcept = default;
+
+  void insert(const T& start, const T& end) {
+    interval_type interval(start, end);
+    if (start > prefixEnd_) {
+      if (!rest_) {
+        rest_ = std::make_unique<RestSet>();
+      }
+      auto restVersion = rest_->insertVersion();
+      rest_->insert(interval);
+      if (rest_->insertVersion() != restVersion) {
+        insertVersion_++;
+      }
+      return;
+    }
+    if (end < prefixEnd_) {
+      return;
+    }
+    prefixEnd_ = end + Unit;
+    insertVersion_++;
+    // Pull in the intervals the prefix now reaches.
+    while (rest_ && rest_->front().start <= prefixEnd_) {
+      auto reached = rest_->front();
+      prefixEnd_ = std::max(prefixEnd_, reached.end + Unit);
+      rest_->withdraw(reached);
+      if (rest_->empty()) {
+        rest_.reset();
+      }
+    }
+  }
+
+  [[nodiscard]] Expected<void, IntervalSetError> tryInsert(
+      const T& start,
+      const T& end) {
+    auto interval = interval_type::tryCreate(start, end);
+    if (!interval.has_value()) {
+      return quic::make_unexpected(interval.error());
+    }
+    insert(start, end);
+    return {};
+  }
+
+  [[nodiscard]] bool empty() const {
+    return prefixEnd_ == 0 && !rest_;
+  }
+
+  [[nodiscard]] size_t size() const {
+    return (prefixEnd_ > 0 ? 1 : 0) + (rest_ ? rest_->size() : 0);
+  }
+
+  [[nodiscard]] interval_type front() const {
+    if (prefixEnd_ > 0) {
+      return interval_type(0, prefixEnd_ - Unit);
+    }
+    CHECK(rest_) << "front() on an empty set";
+    return rest_->front();
+  }
+
+  /**
+   * The version changes whenever an insert adds values to the set.
+   */
+  [[nodiscard]] uint64_t insertVersion() const {
+    return insertVersion_;
+  }
+
+ private:
+  using RestSet = IntervalSet<T, Unit, std::vector>;
+
+  // All values below this are in the set.
+  T prefixEnd_{0};
+  // Intervals past the first gap, if there is one. Never empty when set.
+  std::unique_ptr<RestSet> rest_;
+  uint64_t insertVersion_{kDefaultIntervalSetVersion};
+};
+
+} // namespace quic
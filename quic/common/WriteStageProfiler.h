@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/chrono/Hardware.h>
+#include <quic/common/EnumArray.h>
+#include <quic/mvfst-features.h>
+
+#include <cstdint>
+
+// MVFST_WRITE_STAGE_PROFILING compiles in the write loop stage counters.
+// When 0, the stage helpers below compile to nothing.
+
+namespace quic {
+
+constexpr bool kWriteStageProfilingEnabled = MVFST_WRITE_STAGE_PROFILING;
+
+// Stages of building and sending a packet in the write loop.
+enum class WriteStage : uint8_t {
+  // FrameScheduler::scheduleFramesForPacket, which also encodes the frames.
+  Schedule = 0,
+  // Aead::inplaceEncrypt
+  Encrypt = 1,
+  // encryptPacketHeader. Headers whose protection the batch writer defers to
+  // its flush are counted under SocketWrite.
+  HeaderProtection = 2,
+  // updateConnection, i.e. outstanding packet bookkeeping.
+  UpdateConnection = 3,
+  // Handing packets to the batch writer and flushing it to the socket.
+  SocketWrite = 4,
+  MAX = SocketWrite
+};
+
+/**
+ * Cycle counts (TSC ticks where available) spent in each write stage, and how
+ * many times each stage was measured.
+ */
+struct WriteStageCycles {
+  EnumArray<WriteStage, uint64_t> cycles{};
+  EnumArray<WriteStage, uint64_t> samples{};
+
+  void add(WriteStage stage, uint64_t numCycles) {
+    cycles[stage] += numCycles;
+    samples[stage]++;
+  }
+
+  void add(const WriteStageCycles& other) {
+    for (auto stage : cycles.keys()) {
+      cycles[stage] += other.cycles[stage];
+      samples[stage] += other.samples[stage];
+    }
+  }
+
+  [[nodiscard]] bool empty() const {
+    for (auto stage : samples.keys()) {
+      if (samples[stage]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void clear() {
+    cycles.fill(0);
+    samples.fill(0);
+  }
+};
+
+/**
+ * Per-connection profiling state. Connections only carry one when stage
+ * profiling is compiled in.
+ */
+struct WriteStageProfile {
+  // Whether the current writeConnectionDataToSocket call is being measured.
+  bool sampled{false};
+  // Number of writeConnectionDataToSocket calls considered for sampling.
+  uint64_t writeCount{0};
+  // Stages measured in the current call, reported when it returns.
+  WriteStageCycles pending;
+  // Stages measured over the lifetime of the connection.
+  WriteStageCycles total;
+};
+
+/**
+ * Start timing a write stage. Returns 0 unless stage profiling is compiled in
+ * and the current write loop is sampled.
+ */
+inline uint64_t writeStageStart(bool sampled) {
+  if constexpr (kWriteStageProfilingEnabled) {
+    if (sampled) {
+      return folly::hardware_timestamp();
+    }
+  }
+  return 0;
+}
+
+/**
+ * Finish timing a write stage started with writeStageStart.
+ */
+inline void writeStageEnd(
+    WriteStageCycles& stageCycles,
+    WriteStage stage,
+    uint64_t start) {
+  if constexpr (kWriteStageProfilingEnabled) {
+    if (start) {
+      stageCycles.add(stage, folly::hardware_timestamp() - start);
+    }
+  }
+}
+
+/**
+ * Same as above, for a connection's profile, which is nullptr when profiling
+ * is compiled out.
+ */
+inline uint64_t writeStageStart(const WriteStageProfile* profile) {
+  return profile ? writeStageStart(profile->sampled) : 0;
+}
+
+inline void writeStageEnd(
+    WriteStageProfile* profile,
+    WriteStage stage,
+    uint64_t start) {
+  if (profile) {
+    writeStageEnd(profile->pending, stage, start);
+  }
+}
+
+} // namespace quic
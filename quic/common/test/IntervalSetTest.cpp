@@ -52,6 +52,35 @@ TEST(IntervalSet, insertAtBack) {
   EXPECT_TRUE(set.empty());
 }
 
+TEST(IntervalSet, insertInOrderAtBack) {
+  IntervalSet<int> set;
+  set.insert(1, 2);
+  auto version1 = set.insertVersion();
+  set.insert(3);
+  set.insert(4);
+  auto version2 = set.insertVersion();
+  EXPECT_EQ(set.size(), 1);
+  EXPECT_EQ(set.back(), Interval<int>(1, 4));
+  EXPECT_GT(version2, version1);
+
+  // Duplicates of the last interval don't change the set.
+  set.insert(2, 4);
+  EXPECT_EQ(set.insertVersion(), version2);
+  EXPECT_EQ(set.back(), Interval<int>(1, 4));
+
+  // Overlapping the end extends it.
+  set.insert(3, 6);
+  EXPECT_EQ(set.size(), 1);
+  EXPECT_EQ(set.back(), Interval<int>(1, 6));
+  EXPECT_GT(set.insertVersion(), version2);
+
+  // A gap starts a new interval.
+  set.insert(8);
+  EXPECT_EQ(set.size(), 2);
+  EXPECT_EQ(set.front(), Interval<int>(1, 6));
+  EXPECT_EQ(set.back(), Interval<int>(8, 8));
+}
+
 TEST(IntervalSet, insertInTheMiddle) {
   IntervalSet<int> set;
   set.insert(1, 2);
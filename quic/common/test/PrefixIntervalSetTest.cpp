@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/common/PrefixIntervalSet.h>
+
+#include <gtest/gtest.h>
+
+using namespace quic;
+
+TEST(PrefixIntervalSet, empty) {
+  PrefixIntervalSet<uint64_t> set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(set.size(), 0);
+  auto originalVersion = set.insertVersion();
+  set.insert(0, 9);
+  EXPECT_FALSE(set.empty());
+  EXPECT_EQ(set.size(), 1);
+  EXPECT_EQ(set.front(), Interval<uint64_t>(0, 9));
+  EXPECT_GT(set.insertVersion(), originalVersion);
+}
+
+TEST(PrefixIntervalSet, insertInOrder) {
+  PrefixIntervalSet<uint64_t> set;
+  for (uint64_t i = 0; i < 100; i++) {
+    set.insert(i * 10, i * 10 + 9);
+  }
+  EXPECT_EQ(set.size(), 1);
+  EXPECT_EQ(set.front(), Interval<uint64_t>(0, 999));
+
+  // Data that is already in the set doesn't change the version.
+  auto version = set.insertVersion();
+  set.insert(100, 199);
+  EXPECT_EQ(set.insertVersion(), version);
+  EXPECT_EQ(set.front(), Interval<uint64_t>(0, 999));
+}
+
+TEST(PrefixIntervalSet, insertPastGap) {
+  PrefixIntervalSet<uint64_t> set;
+  set.insert(20, 29);
+  EXPECT_EQ(set.size(), 1);
+  EXPECT_EQ(set.front(), Interval<uint64_t>(20, 29));
+
+  set.insert(0, 9);
+  set.insert(40, 49);
+  EXPECT_EQ(set.size(), 3);
+  EXPECT_EQ(set.front(), Interval<uint64_t>(0, 9));
+
+  // Filling the first gap merges the next interval into the prefix.
+  auto version = set.insertVersion();
+  set.insert(10, 19);
+  EXPECT_GT(set.insertVersion(), version);
+  EXPECT_EQ(set.size(), 2);
+  EXPECT_EQ(set.front(), Interval<uint64_t>(0, 29));
+
+  // An interval covering the rest of the gaps merges everything.
+  set.insert(25, 45);
+  EXPECT_EQ(set.size(), 1);
+  EXPECT_EQ(set.front(), Interval<uint64_t>(0, 49));
+}
+
+TEST(PrefixIntervalSet, copy) {
+  PrefixIntervalSet<uint64_t> set;
+  set.insert(0, 9);
+  set.insert(20, 29);
+  auto copy = set;
+  set.insert(10, 19);
+  EXPECT_EQ(set.size(), 1);
+  EXPECT_EQ(copy.size(), 2);
+  EXPECT_EQ(copy.front(), Interval<uint64_t>(0, 9));
+}
+
+TEST(PrefixIntervalSet, tryInsertInvalid) {
+  PrefixIntervalSet<uint64_t> set;
+  auto result = set.tryInsert(10, 5);
+  ASSERT_TRUE(result.hasError());
+  EXPECT_EQ(result.error(), IntervalSetError::InvalidInterval);
+  result = set.tryInsert(0, std::numeric_limits<uint64_t>::max());
+  ASSERT_TRUE(result.hasError());
+  EXPECT_EQ(result.error(), IntervalSetError::IntervalBoundTooLarge);
+  EXPECT_TRUE(set.empty());
+}
+
+TEST(PrefixIntervalSet, footprint) {
+  // The prefix end, a pointer to the out of order intervals and the version.
+  EXPECT_EQ(sizeof(PrefixIntervalSet<uint64_t>), 3 * sizeof(uint64_t));
+}
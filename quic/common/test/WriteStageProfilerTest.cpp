@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/common/WriteStageProfiler.h>
+
+#include <gtest/gtest.h>
+
+namespace quic::test {
+
+TEST(WriteStageProfiler, AddAndMerge) {
+  WriteStageCycles stageCycles;
+  EXPECT_TRUE(stageCycles.empty());
+  stageCycles.add(WriteStage::Encrypt, 100);
+  stageCycles.add(WriteStage::Encrypt, 50);
+  stageCycles.add(WriteStage::SocketWrite, 10);
+  EXPECT_FALSE(stageCycles.empty());
+  EXPECT_EQ(stageCycles.cycles[WriteStage::Encrypt], 150);
+  EXPECT_EQ(stageCycles.samples[WriteStage::Encrypt], 2);
+  EXPECT_EQ(stageCycles.samples[WriteStage::Schedule], 0);
+
+  WriteStageCycles total;
+  total.add(WriteStage::SocketWrite, 5);
+  total.add(stageCycles);
+  EXPECT_EQ(total.cycles[WriteStage::SocketWrite], 15);
+  EXPECT_EQ(total.samples[WriteStage::SocketWrite], 2);
+  EXPECT_EQ(total.cycles[WriteStage::Encrypt], 150);
+
+  stageCycles.clear();
+  EXPECT_TRUE(stageCycles.empty());
+}
+
+TEST(WriteStageProfiler, UnsampledIsNotRecorded) {
+  WriteStageCycles stageCycles;
+  auto start = writeStageStart(false);
+  EXPECT_EQ(start, 0);
+  writeStageEnd(stageCycles, WriteStage::Schedule, start);
+  EXPECT_TRUE(stageCycles.empty());
+}
+
+TEST(WriteStageProfiler, SampledIsRecordedWhenEnabled) {
+  WriteStageCycles stageCycles;
+  auto start = writeStageStart(true);
+  writeStageEnd(stageCycles, WriteStage::HeaderProtection, start);
+  EXPECT_EQ(
+      stageCycles.samples[WriteStage::HeaderProtection],
+      kWriteStageProfilingEnabled ? 1 : 0);
+}
+
+} // namespace quic::test
@@ -19,6 +19,10 @@
 #include <sys/socket.h>
 #include <unistd.h>
 
+#if defined(FOLLY_HAVE_MSG_ERRQUEUE) && !defined(UDP_GRO)
+#define UDP_GRO 104
+#endif
+
 namespace quic {
 
 LibevQuicAsyncUDPSocket::LibevQuicAsyncUDPSocket(
@@ -320,13 +324,15 @@ quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::init(
   fd_ = fd;
   ownership_ = FDOwnership::OWNS;
   fdGuard.dismiss(); // Don't close the fd now that we've stored it
+  groCache_.reset();
+  timestampingCache_.reset();
 
   // Update the watchers
   removeEvent(EV_READ | EV_WRITE);
   ev_io_set(&readWatcher_, fd_, EV_READ);
   ev_io_set(&writeWatcher_, fd_, EV_WRITE);
 
-  return {};
+  return applyDeferredOptions();
 }
 
 quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::bind(
@@ -517,7 +523,22 @@ quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::setErrMessageCallback(
 }
 
 quic::Expected<int, QuicError> LibevQuicAsyncUDPSocket::getGRO() {
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+  if (fd_ == -1) {
+    return -1;
+  }
+  if (!groCache_.has_value()) {
+    int value = 0;
+    socklen_t len = sizeof(value);
+    if (::getsockopt(fd_, SOL_UDP, UDP_GRO, &value, &len) != 0) {
+      value = -1;
+    }
+    groCache_ = value;
+  }
+  return *groCache_;
+#else
   return -1;
+#endif
 }
 
 ssize_t LibevQuicAsyncUDPSocket::recvmsg(struct msghdr* msg, int flags) {
@@ -552,12 +573,63 @@ int LibevQuicAsyncUDPSocket::recvmmsg(
   return static_cast<int>(vlen);
 }
 
-quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::setGRO(
-    bool /* bVal */) {
-  // Not supported, return error
+quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::setGRO(bool bVal) {
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+  gro_ = bVal;
+  if (fd_ == -1) {
+    // Applied once the socket is created.
+    return {};
+  }
+  return applyGRO();
+#else
+  (void)bVal;
   return quic::make_unexpected(QuicError(
       QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
       "setGRO not supported"));
+#endif
+}
+
+quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::setRecvTos(
+    bool recvTos) {
+  recvTos_ = recvTos;
+  if (fd_ == -1) {
+    // Applied once the socket is created.
+    return {};
+  }
+  return applyRecvTos();
+}
+
+quic::Expected<bool, QuicError> LibevQuicAsyncUDPSocket::getRecvTos() {
+  return recvTos_;
+}
+
+quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::setTosOrTrafficClass(
+    uint8_t tos) {
+  tos_ = tos;
+  if (fd_ == -1) {
+    // Applied once the socket is created.
+    return {};
+  }
+  return applyTos();
+}
+
+quic::Expected<int, QuicError> LibevQuicAsyncUDPSocket::getTimestamping() {
+#if defined(FOLLY_HAVE_MSG_ERRQUEUE) && defined(SO_TIMESTAMPING)
+  if (fd_ == -1) {
+    return -1;
+  }
+  if (!timestampingCache_.has_value()) {
+    int value = 0;
+    socklen_t len = sizeof(value);
+    if (::getsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPING, &value, &len) != 0) {
+      value = -1;
+    }
+    timestampingCache_ = value;
+  }
+  return *timestampingCache_;
+#else
+  return -1;
+#endif
 }
 
 quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::applyOptions(
@@ -585,6 +657,9 @@ quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::applyOptions(
       }
     }
   }
+  // The options may have turned GRO or timestamping on or off.
+  groCache_.reset();
+  timestampingCache_.reset();
   return {};
 }
 
@@ -607,6 +682,8 @@ quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::setFD(
   ownership_ = ownership;
   bound_ = false; // Assume not bound until checked/bind called
   connected_ = false; // Assume not connected
+  groCache_.reset();
+  timestampingCache_.reset();
 
   // Update the watchers
   removeEvent(EV_READ | EV_WRITE);
@@ -620,8 +697,7 @@ quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::setFD(
     addEvent(EV_WRITE);
   }
   // TODO: Check if the FD is actually usable? Maybe getsockopt?
-  // For now, assume success if we reach here.
-  return {};
+  return applyDeferredOptions();
 }
 
 int LibevQuicAsyncUDPSocket::getFD() {
@@ -718,6 +794,108 @@ size_t LibevQuicAsyncUDPSocket::handleSocketErrors() {
 #endif
 }
 
+quic::Expected<void, QuicError>
+LibevQuicAsyncUDPSocket::applyDeferredOptions() {
+  if (recvTos_) {
+    auto result = applyRecvTos();
+    if (result.hasError()) {
+      return result;
+    }
+  }
+  if (tos_.has_value()) {
+    auto result = applyTos();
+    if (result.hasError()) {
+      return result;
+    }
+  }
+  if (gro_) {
+    auto result = applyGRO();
+    if (result.hasError()) {
+      return result;
+    }
+  }
+  return {};
+}
+
+quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::applyRecvTos() {
+  auto familyResult = socketFamily();
+  if (familyResult.hasError()) {
+    return quic::make_unexpected(familyResult.error());
+  }
+  int value = recvTos_ ? 1 : 0;
+  int level = IPPROTO_IP;
+  int optname = IP_RECVTOS;
+  if (*familyResult == AF_INET6) {
+    level = IPPROTO_IPV6;
+    optname = IPV6_RECVTCLASS;
+  }
+  if (::setsockopt(fd_, level, optname, &value, sizeof(value)) != 0) {
+    int errnoCopy = errno;
+    std::string errorMsg =
+        "failed to set receive TOS: " + quic::errnoStr(errnoCopy);
+    return quic::make_unexpected(QuicError(
+        QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+        std::move(errorMsg)));
+  }
+  return {};
+}
+
+quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::applyTos() {
+  auto familyResult = socketFamily();
+  if (familyResult.hasError()) {
+    return quic::make_unexpected(familyResult.error());
+  }
+  int value = *tos_;
+  int level = IPPROTO_IP;
+  int optname = IP_TOS;
+  if (*familyResult == AF_INET6) {
+    level = IPPROTO_IPV6;
+    optname = IPV6_TCLASS;
+  }
+  if (::setsockopt(fd_, level, optname, &value, sizeof(value)) != 0) {
+    int errnoCopy = errno;
+    std::string errorMsg =
+        "failed to set TOS or traffic class: " + quic::errnoStr(errnoCopy);
+    return quic::make_unexpected(QuicError(
+        QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+        std::move(errorMsg)));
+  }
+  return {};
+}
+
+quic::Expected<void, QuicError> LibevQuicAsyncUDPSocket::applyGRO() {
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+  int value = gro_ ? 1 : 0;
+  groCache_.reset();
+  if (::setsockopt(fd_, SOL_UDP, UDP_GRO, &value, sizeof(value)) != 0) {
+    int errnoCopy = errno;
+    std::string errorMsg =
+        "failed to set UDP_GRO: " + quic::errnoStr(errnoCopy);
+    return quic::make_unexpected(QuicError(
+        QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+        std::move(errorMsg)));
+  }
+#endif
+  return {};
+}
+
+quic::Expected<sa_family_t, QuicError> LibevQuicAsyncUDPSocket::socketFamily()
+    const {
+  // Unlike address(), this works before the socket is bound.
+  sockaddr_storage addrStorage;
+  socklen_t len = sizeof(addrStorage);
+  if (::getsockname(fd_, reinterpret_cast<sockaddr*>(&addrStorage), &len) !=
+      0) {
+    int errnoCopy = errno;
+    std::string errorMsg =
+        "error retrieving socket family: " + quic::errnoStr(errnoCopy);
+    return quic::make_unexpected(QuicError(
+        QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+        std::move(errorMsg)));
+  }
+  return addrStorage.ss_family;
+}
+
 void LibevQuicAsyncUDPSocket::addEvent(int event) {
   CHECK(evb_) << "EventBase not initialized";
   if (event & EV_READ) {
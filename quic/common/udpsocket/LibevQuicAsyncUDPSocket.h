@@ -106,20 +106,11 @@ class LibevQuicAsyncUDPSocket : public QuicAsyncUDPSocketImpl {
   // receive tos cmsgs
   // if true, the IPv6 Traffic Class/IPv4 Type of Service field should be
   // populated in OnDataAvailableParams.
-  quic::Expected<void, QuicError> setRecvTos(bool /*recvTos*/) override {
-    LOG(WARNING) << __func__ << " not implemented in LibevQuicAsyncUDPSocket";
-    return {}; // Or return error if strictness needed
-  }
+  quic::Expected<void, QuicError> setRecvTos(bool recvTos) override;
 
-  quic::Expected<bool, QuicError> getRecvTos() override {
-    return false; // Not implemented, return default/false
-  }
+  quic::Expected<bool, QuicError> getRecvTos() override;
 
-  quic::Expected<void, QuicError> setTosOrTrafficClass(
-      uint8_t /*tos*/) override {
-    LOG(WARNING) << __func__ << " not implemented in LibevQuicAsyncUDPSocket";
-    return {}; // Or return error if strictness needed
-  }
+  quic::Expected<void, QuicError> setTosOrTrafficClass(uint8_t tos) override;
 
   /**
    * Returns the socket address this socket is bound to and error otherwise.
@@ -150,12 +141,11 @@ class LibevQuicAsyncUDPSocket : public QuicAsyncUDPSocketImpl {
       std::function<Optional<folly::SocketCmsgMap>()>&& additionalCmsgsFunc)
       override;
 
-  /*
-   * Packet timestamping is currently not supported.
+  /**
+   * Returns the SO_TIMESTAMPING flags set on the socket, e.g. through
+   * applyOptions(), or -1 if timestamping isn't available.
    */
-  quic::Expected<int, QuicError> getTimestamping() override {
-    return -1; // Keep returning -1 for not supported
-  }
+  quic::Expected<int, QuicError> getTimestamping() override;
 
   /**
    * Set SO_REUSEADDR flag on the socket. Default is OFF.
@@ -232,6 +222,12 @@ class LibevQuicAsyncUDPSocket : public QuicAsyncUDPSocketImpl {
   void evHandleSocketRead();
   void evHandleSocketWritable();
   size_t handleSocketErrors();
+  // Applies the options that were set before the socket was created.
+  quic::Expected<void, QuicError> applyDeferredOptions();
+  quic::Expected<void, QuicError> applyRecvTos();
+  quic::Expected<void, QuicError> applyTos();
+  quic::Expected<void, QuicError> applyGRO();
+  quic::Expected<sa_family_t, QuicError> socketFamily() const;
 
   int fd_{-1};
   folly::SocketAddress localAddress_;
@@ -248,6 +244,14 @@ class LibevQuicAsyncUDPSocket : public QuicAsyncUDPSocketImpl {
   bool reusePort_{false};
   int rcvBuf_{0};
   int sndBuf_{0};
+  bool recvTos_{false};
+  Optional<uint8_t> tos_;
+  bool gro_{false};
+
+  // Read on every recvmmsgNetworkData() call, so they're only queried from
+  // the socket again after they may have changed.
+  Optional<int> groCache_;
+  Optional<int> timestampingCache_;
 
   ReadCallback* readCallback_{nullptr};
   WriteCallback* writeCallback_{nullptr};
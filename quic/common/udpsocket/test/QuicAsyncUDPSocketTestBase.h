@@ -176,6 +176,46 @@ TYPED_TEST_P(QuicAsyncUDPSocketTest, ConnectMarksSocketBoundIPv6) {
   EXPECT_EQ(addrFamilyResult.value(), AF_INET6);
 }
 
+TYPED_TEST_P(QuicAsyncUDPSocketTest, ReceiveTosSetBySender) {
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+  ASSERT_FALSE(
+      this->udpSocket_->bind(folly::SocketAddress("127.0.0.1", 0)).hasError());
+  ASSERT_FALSE(this->udpSocket_->setRecvTos(true).hasError());
+  auto recvTos = this->udpSocket_->getRecvTos();
+  ASSERT_FALSE(recvTos.hasError());
+  EXPECT_TRUE(*recvTos);
+
+  auto sender = TypeParam::makeQuicAsyncUDPSocket();
+  ASSERT_FALSE(sender->bind(folly::SocketAddress("127.0.0.1", 0)).hasError());
+  // ECT(0)
+  ASSERT_FALSE(sender->setTosOrTrafficClass(0x02).hasError());
+
+  quic::NetworkData networkData;
+  EXPECT_CALL(this->readCb_, onNotifyDataAvailable_(testing::_))
+      .WillOnce(testing::Invoke([&](quic::QuicAsyncUDPSocket& sock) {
+        quic::Optional<folly::SocketAddress> peerAddress;
+        size_t totalData = 0;
+        EXPECT_FALSE(sock.recvmmsgNetworkData(
+                             1500, 1, networkData, peerAddress, totalData)
+                         .hasError());
+        sock.getEventBase()->terminateLoopSoon();
+      }));
+  this->udpSocket_->resumeRead(&this->readCb_);
+
+  auto sendBuf = quic::BufHelpers::copyBuffer("hey");
+  iovec vec[quic::kNumIovecBufferChains];
+  size_t iovec_len =
+      sendBuf->fillIov(vec, sizeof(vec) / sizeof(vec[0])).numIovecs;
+  sender->write(*this->udpSocket_->address(), vec, iovec_len);
+  this->udpSocket_->getEventBase()->loopForever();
+
+  ASSERT_EQ(networkData.getPackets().size(), 1);
+  EXPECT_EQ(networkData.getPackets()[0].tosValue, 0x02);
+#else // !FOLLY_HAVE_MSG_ERRQUEUE
+  GTEST_SKIP();
+#endif
+}
+
 // Tests end here
 
 // All tests must be registered
@@ -185,6 +225,7 @@ REGISTER_TYPED_TEST_SUITE_P(
     TestUnsetErrCallback,
     CloseInErrorCallback,
     ConnectMarksSocketBoundIPv4,
-    ConnectMarksSocketBoundIPv6
+    ConnectMarksSocketBoundIPv6,
+    ReceiveTosSetBySender
     // Add more tests here
 );
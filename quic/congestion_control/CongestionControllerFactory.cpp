@@ -15,6 +15,7 @@
 #include <quic/congestion_control/Copa2.h>
 #include <quic/congestion_control/NewReno.h>
 #include <quic/congestion_control/QuicCubic.h>
+#include <quic/mvfst-features.h>
 
 #include <memory>
 
@@ -24,13 +25,16 @@ DefaultCongestionControllerFactory::makeCongestionController(
     QuicConnectionStateBase& conn,
     CongestionControlType type) {
   std::unique_ptr<CongestionController> congestionController;
+#if MVFST_ENABLE_ALL_CONGESTION_CONTROLLERS
   auto setupBBR = [&conn](BbrCongestionController* bbr) {
     bbr->setRttSampler(
         std::make_unique<BbrRttSampler>(
             std::chrono::seconds(kDefaultRttSamplerExpiration)));
     bbr->setBandwidthSampler(std::make_unique<BbrBandwidthSampler>(conn));
   };
+#endif
   switch (type) {
+#if MVFST_ENABLE_ALL_CONGESTION_CONTROLLERS
     case CongestionControlType::NewReno:
       congestionController = std::make_unique<NewReno>(conn);
       break;
@@ -58,6 +62,22 @@ DefaultCongestionControllerFactory::makeCongestionController(
       congestionController = std::move(bbr2);
       break;
     }
+#else
+    // Only Cubic is referenced, so the other controllers aren't linked in.
+    case CongestionControlType::NewReno:
+    case CongestionControlType::Copa:
+    case CongestionControlType::Copa2:
+    case CongestionControlType::BBRTesting:
+    case CongestionControlType::BBR:
+    case CongestionControlType::BBR2:
+      LOG(ERROR) << "Only Cubic is compiled in. Falling back to Cubic from "
+                 << congestionControlTypeToString(type);
+      type = CongestionControlType::Cubic;
+      [[fallthrough]];
+    case CongestionControlType::Cubic:
+      congestionController = std::make_unique<Cubic>(conn);
+      break;
+#endif
     case CongestionControlType::StaticCwnd: {
       throw QuicInternalException(
           "StaticCwnd Congestion Controller cannot be "
@@ -47,6 +47,32 @@ static quic::Expected<HeaderProtectionMask, QuicError> maskImpl(
   return outMask;
 }
 
+// ECB encrypts every block independently, so the masks of a whole batch come
+// out of one EVP_EncryptUpdate, which lets the AES-NI code pipeline several
+// blocks at a time rather than run one per call.
+static quic::Expected<void, QuicError> maskBatchImpl(
+    const folly::ssl::EvpCipherCtxUniquePtr& context,
+    ByteRange samples,
+    MutableByteRange masks) {
+  CHECK_EQ(samples.size() % sizeof(HeaderProtectionMask), 0);
+  CHECK_EQ(samples.size(), masks.size());
+  if (samples.empty()) {
+    return {};
+  }
+  int outLen = 0;
+  if (EVP_EncryptUpdate(
+          context.get(),
+          masks.data(),
+          &outLen,
+          samples.data(),
+          static_cast<int>(samples.size())) != 1 ||
+      static_cast<size_t>(outLen) != masks.size()) {
+    return quic::make_unexpected(
+        QuicError(TransportErrorCode::INTERNAL_ERROR, "Encryption error"));
+  }
+  return {};
+}
+
 quic::Expected<void, QuicError> Aes128PacketNumberCipher::setKey(
     ByteRange key) {
   pnKey_ = BufHelpers::copyBuffer(key);
@@ -77,6 +103,30 @@ quic::Expected<HeaderProtectionMask, QuicError> Aes256PacketNumberCipher::mask(
   return maskImpl(encryptCtx_, sample);
 }
 
+quic::Expected<void, QuicError> Aes128PacketNumberCipher::maskBatch(
+    ByteRange samples,
+    MutableByteRange masks) const {
+  return maskBatchImpl(encryptCtx_, samples, masks);
+}
+
+quic::Expected<void, QuicError> Aes256PacketNumberCipher::maskBatch(
+    ByteRange samples,
+    MutableByteRange masks) const {
+  return maskBatchImpl(encryptCtx_, samples, masks);
+}
+
+quic::Expected<void, QuicError> Aes128PacketNumberCipher::encryptHeaders(
+    const HeaderToEncrypt* headers,
+    size_t numHeaders) const {
+  return encryptHeadersWithMaskBatch(headers, numHeaders);
+}
+
+quic::Expected<void, QuicError> Aes256PacketNumberCipher::encryptHeaders(
+    const HeaderToEncrypt* headers,
+    size_t numHeaders) const {
+  return encryptHeadersWithMaskBatch(headers, numHeaders);
+}
+
 constexpr size_t kAES128KeyLength = 16;
 
 size_t Aes128PacketNumberCipher::keyLength() const {
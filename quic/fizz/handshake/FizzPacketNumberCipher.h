@@ -24,6 +24,14 @@ class Aes128PacketNumberCipher : public PacketNumberCipher {
   [[nodiscard]] quic::Expected<HeaderProtectionMask, QuicError> mask(
       ByteRange sample) const override;
 
+  [[nodiscard]] quic::Expected<void, QuicError> maskBatch(
+      ByteRange samples,
+      MutableByteRange masks) const override;
+
+  [[nodiscard]] quic::Expected<void, QuicError> encryptHeaders(
+      const HeaderToEncrypt* headers,
+      size_t numHeaders) const override;
+
   [[nodiscard]] size_t keyLength() const override;
 
  private:
@@ -43,6 +51,14 @@ class Aes256PacketNumberCipher : public PacketNumberCipher {
   [[nodiscard]] quic::Expected<HeaderProtectionMask, QuicError> mask(
       ByteRange sample) const override;
 
+  [[nodiscard]] quic::Expected<void, QuicError> maskBatch(
+      ByteRange samples,
+      MutableByteRange masks) const override;
+
+  [[nodiscard]] quic::Expected<void, QuicError> encryptHeaders(
+      const HeaderToEncrypt* headers,
+      size_t numHeaders) const override;
+
   [[nodiscard]] size_t keyLength() const override;
 
  private:
@@ -157,4 +157,41 @@ INSTANTIATE_TEST_SUITE_P(
             folly::StringPiece{"772aa701"},
             folly::StringPiece{"ce"}}));
 
+TEST(PacketNumberCipherTest, MaskBatchMatchesMask) {
+  FizzCryptoFactory cryptoFactory;
+  for (auto suite :
+       {fizz::CipherSuite::TLS_AES_128_GCM_SHA256,
+        fizz::CipherSuite::TLS_AES_256_GCM_SHA384}) {
+    auto cipherResult = cryptoFactory.makePacketNumberCipher(suite);
+    ASSERT_FALSE(cipherResult.hasError());
+    auto cipher = std::move(cipherResult.value());
+    std::vector<uint8_t> key(cipher->keyLength(), 0x0e);
+    ASSERT_FALSE(
+        cipher->setKey(quic::ByteRange(key.data(), key.size())).hasError());
+
+    constexpr size_t kNumSamples = 19;
+    std::vector<uint8_t> samples(kNumSamples * sizeof(Sample));
+    for (size_t i = 0; i < samples.size(); i++) {
+      samples[i] = static_cast<uint8_t>(i * 13);
+    }
+    std::vector<uint8_t> masks(samples.size());
+    ASSERT_FALSE(cipher
+                     ->maskBatch(
+                         quic::ByteRange(samples.data(), samples.size()),
+                         quic::MutableByteRange(masks.data(), masks.size()))
+                     .hasError());
+    for (size_t i = 0; i < kNumSamples; i++) {
+      auto mask = cipher->mask(
+          quic::ByteRange(samples.data() + i * sizeof(Sample), sizeof(Sample)));
+      ASSERT_FALSE(mask.hasError());
+      EXPECT_EQ(
+          0,
+          memcmp(
+              masks.data() + i * sizeof(Sample),
+              mask->data(),
+              sizeof(Sample)));
+    }
+  }
+}
+
 } // namespace quic::test
@@ -27,7 +27,7 @@ Optional<uint64_t> calculateNewWindowUpdate(
     const TimePoint& updateTime) {
   DCHECK_LE(curReadOffset, curAdvertisedOffset);
   auto nextAdvertisedOffset = curReadOffset + windowSize;
-  if (nextAdvertisedOffset == curAdvertisedOffset) {
+  if (nextAdvertisedOffset <= curAdvertisedOffset) {
     // No change in flow control
     return std::nullopt;
   }
@@ -82,6 +82,24 @@ template <typename T>
   return {};
 }
 
+// Whether the peer has so little credit left that a coalesced window update
+// shouldn't wait for a packet to carry it.
+inline bool isUrgentWindowUpdate(
+    uint64_t curReadOffset,
+    uint64_t curAdvertisedOffset,
+    uint64_t windowSize) {
+  DCHECK_LE(curReadOffset, curAdvertisedOffset);
+  return (curAdvertisedOffset - curReadOffset) * kUrgentWindowUpdateFraction <=
+      windowSize;
+}
+
+inline void maybeClearUrgentWindowUpdate(QuicConnectionStateBase& conn) {
+  if (!conn.pendingEvents.connWindowUpdate &&
+      !conn.streamManager->hasWindowUpdates()) {
+    conn.pendingEvents.urgentWindowUpdate = false;
+  }
+}
+
 inline uint64_t calculateMaximumData(const QuicStreamState& stream) {
   return std::max(
       stream.currentReadOffset + stream.flowControlState.windowSize,
@@ -136,16 +154,25 @@ bool maybeSendConnWindowUpdate(
     return false;
   }
   auto& flowControlState = conn.flowControlState;
+  auto windowUpdateSize = getConnWindowUpdateSize(conn);
   auto newAdvertisedOffset = calculateNewWindowUpdate(
       flowControlState.sumCurReadOffset,
       flowControlState.advertisedMaxOffset,
-      flowControlState.windowSize,
+      windowUpdateSize,
       conn.lossState.srtt,
       conn.transportSettings,
       flowControlState.timeOfLastFlowControlUpdate,
       updateTime);
   if (newAdvertisedOffset) {
     conn.pendingEvents.connWindowUpdate = true;
+    conn.pendingEvents.markPendingWrite(
+        PendingWriteReason::CONN_WINDOW_UPDATE);
+    if (isUrgentWindowUpdate(
+            flowControlState.sumCurReadOffset,
+            flowControlState.advertisedMaxOffset,
+            windowUpdateSize)) {
+      conn.pendingEvents.urgentWindowUpdate = true;
+    }
     QUIC_STATS(conn.statsCallback, onConnFlowControlUpdate);
     if (conn.qLogger) {
       conn.qLogger->addTransportStateUpdate(
@@ -182,6 +209,12 @@ bool maybeSendStreamWindowUpdate(
     VLOG(10) << "Queued flow control update for stream=" << stream.id
              << " offset=" << *newAdvertisedOffset;
     stream.conn.streamManager->queueWindowUpdate(stream.id);
+    if (isUrgentWindowUpdate(
+            stream.currentReadOffset,
+            flowControlState.advertisedMaxOffset,
+            flowControlState.windowSize)) {
+      stream.conn.pendingEvents.urgentWindowUpdate = true;
+    }
     QUIC_STATS(stream.conn.statsCallback, onStreamFlowControlUpdate);
     return true;
   }
@@ -447,6 +480,8 @@ void handleConnWindowUpdate(
 
 void handleConnBlocked(QuicConnectionStateBase& conn) {
   conn.pendingEvents.connWindowUpdate = true;
+  conn.pendingEvents.urgentWindowUpdate = true;
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::CONN_WINDOW_UPDATE);
   VLOG(4) << "Blocked triggered conn window update";
 }
 
@@ -456,6 +491,7 @@ void handleStreamBlocked(QuicStreamState& stream) {
         stream.flowControlState, Clock::now(), stream.conn.lossState.srtt);
   }
   stream.conn.streamManager->queueWindowUpdate(stream.id);
+  stream.conn.pendingEvents.urgentWindowUpdate = true;
   VLOG(4) << "Blocked triggered stream window update stream=" << stream.id;
 }
 
@@ -521,10 +557,37 @@ void onConnWindowUpdateSent(
     QuicConnectionStateBase& conn,
     uint64_t maximumDataSent,
     TimePoint sentTime) {
-  DCHECK_GE(maximumDataSent, conn.flowControlState.advertisedMaxOffset);
-  conn.flowControlState.advertisedMaxOffset = maximumDataSent;
-  conn.flowControlState.timeOfLastFlowControlUpdate = sentTime;
+  auto& flowControlState = conn.flowControlState;
+  DCHECK_GE(maximumDataSent, flowControlState.advertisedMaxOffset);
+  auto interval = flowControlState.timeOfLastFlowControlUpdate
+      ? std::chrono::duration_cast<std::chrono::nanoseconds>(
+            sentTime - *flowControlState.timeOfLastFlowControlUpdate)
+      : std::chrono::nanoseconds::zero();
+  if (conn.transportSettings.coalesceFlowControlUpdates &&
+      interval.count() > 0) {
+    auto drained = flowControlState.sumCurReadOffset -
+        flowControlState.sumCurReadOffsetAtLastUpdate;
+    // Bytes per second. Updates sent back to back can make this arbitrarily
+    // large, so clamp it to a value the smoothing below can't overflow
+    // before converting back to an integer.
+    constexpr uint64_t kMaxDrainRate = kMaxVarInt / kRttAlpha;
+    auto drainRate = static_cast<double>(drained) *
+        std::chrono::nanoseconds(1s).count() / interval.count();
+    auto drainRateSample = drainRate < static_cast<double>(kMaxDrainRate)
+        ? static_cast<uint64_t>(drainRate)
+        : kMaxDrainRate;
+    flowControlState.drainRate = flowControlState.drainRate == 0
+        ? drainRateSample
+        : (flowControlState.drainRate * (kRttAlpha - 1) + drainRateSample) /
+            kRttAlpha;
+  }
+  flowControlState.advertisedMaxOffset = maximumDataSent;
+  flowControlState.timeOfLastFlowControlUpdate = sentTime;
+  flowControlState.sumCurReadOffsetAtLastUpdate =
+      flowControlState.sumCurReadOffset;
   conn.pendingEvents.connWindowUpdate = false;
+  conn.pendingEvents.clearPendingWrite(PendingWriteReason::CONN_WINDOW_UPDATE);
+  maybeClearUrgentWindowUpdate(conn);
   VLOG(4) << "sent window for conn";
 }
 
@@ -535,11 +598,14 @@ void onStreamWindowUpdateSent(
   stream.flowControlState.advertisedMaxOffset = maximumDataSent;
   stream.flowControlState.timeOfLastFlowControlUpdate = sentTime;
   stream.conn.streamManager->removeWindowUpdate(stream.id);
+  maybeClearUrgentWindowUpdate(stream.conn);
   VLOG(4) << "sent window for stream=" << stream.id;
 }
 
 void onConnWindowUpdateLost(QuicConnectionStateBase& conn) {
   conn.pendingEvents.connWindowUpdate = true;
+  conn.pendingEvents.urgentWindowUpdate = true;
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::CONN_WINDOW_UPDATE);
   VLOG(4) << "Loss triggered conn window update";
 }
 
@@ -548,6 +614,7 @@ void onStreamWindowUpdateLost(QuicStreamState& stream) {
     return;
   }
   stream.conn.streamManager->queueWindowUpdate(stream.id);
+  stream.conn.pendingEvents.urgentWindowUpdate = true;
   VLOG(4) << "Loss triggered stream window update stream=" << stream.id;
 }
 
@@ -572,11 +639,29 @@ void updateFlowControlStateWithSettings(
       transportSettings.advertisedInitialConnectionFlowControlWindow;
 }
 
+uint64_t getConnWindowUpdateSize(const QuicConnectionStateBase& conn) {
+  const auto& flowControlState = conn.flowControlState;
+  if (!conn.transportSettings.coalesceFlowControlUpdates ||
+      flowControlState.drainRate == 0 || conn.lossState.srtt == 0us) {
+    return flowControlState.windowSize;
+  }
+  // Cover what the application drains in 2 RTTs, so that the peer doesn't
+  // need another update before this one has been acked.
+  auto drainWindow = static_cast<uint64_t>(
+      static_cast<double>(flowControlState.drainRate) * 2 *
+      conn.lossState.srtt.count() / std::chrono::microseconds(1s).count());
+  return std::max(
+      flowControlState.windowSize,
+      std::min(
+          drainWindow,
+          flowControlState.windowSize * kMaxDrainRateWindowMultiplier));
+}
+
 MaxDataFrame generateMaxDataFrame(const QuicConnectionStateBase& conn) {
   return MaxDataFrame(
       std::max(
           conn.flowControlState.sumCurReadOffset +
-              conn.flowControlState.windowSize,
+              getConnWindowUpdateSize(conn),
           conn.flowControlState.advertisedMaxOffset));
 }
 
@@ -153,6 +153,13 @@ void updateFlowControlStateWithSettings(
     QuicConnectionStateBase::ConnectionFlowControlState& flowControlState,
     const TransportSettings& transportSettings);
 
+/**
+ * Returns how far past the current read offset the next MAX_DATA should
+ * advertise. This is the connection window, grown to cover 2 * SRTT of the
+ * measured drain rate when coalesceFlowControlUpdates is enabled.
+ */
+uint64_t getConnWindowUpdateSize(const QuicConnectionStateBase& conn);
+
 /**
  * Generate a new MaxDataFrame with the latest flow control state and window
  * size of conn.
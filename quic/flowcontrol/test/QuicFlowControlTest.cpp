@@ -1128,6 +1128,115 @@ TEST_F(QuicFlowControlTest, OnStreamWindowUpdateSentWithoutPendingEvent) {
   EXPECT_FALSE(conn_.streamManager->pendingWindowUpdate(id));
 }
 
+TEST_F(QuicFlowControlTest, UrgentConnWindowUpdate) {
+  conn_.flowControlState.windowSize = 1000;
+  conn_.flowControlState.advertisedMaxOffset = 1000;
+  conn_.flowControlState.sumCurReadOffset = 600;
+  EXPECT_CALL(*quicStats_, onConnFlowControlUpdate()).Times(2);
+  maybeSendConnWindowUpdate(conn_, Clock::now());
+  EXPECT_TRUE(conn_.pendingEvents.connWindowUpdate);
+  EXPECT_FALSE(conn_.pendingEvents.urgentWindowUpdate);
+
+  // Less than a quarter of the window left for the peer.
+  conn_.pendingEvents.connWindowUpdate = false;
+  conn_.pendingEvents.clearPendingWrite(PendingWriteReason::CONN_WINDOW_UPDATE);
+  conn_.flowControlState.sumCurReadOffset = 800;
+  maybeSendConnWindowUpdate(conn_, Clock::now());
+  EXPECT_TRUE(conn_.pendingEvents.connWindowUpdate);
+  EXPECT_TRUE(conn_.pendingEvents.urgentWindowUpdate);
+
+  onConnWindowUpdateSent(
+      conn_, generateMaxDataFrame(conn_).maximumData, Clock::now());
+  EXPECT_FALSE(conn_.pendingEvents.urgentWindowUpdate);
+}
+
+TEST_F(QuicFlowControlTest, BlockedAndLostWindowUpdatesAreUrgent) {
+  handleConnBlocked(conn_);
+  EXPECT_TRUE(conn_.pendingEvents.urgentWindowUpdate);
+  conn_.pendingEvents.urgentWindowUpdate = false;
+  onConnWindowUpdateLost(conn_);
+  EXPECT_TRUE(conn_.pendingEvents.urgentWindowUpdate);
+  onConnWindowUpdateSent(conn_, 1000, Clock::now());
+  EXPECT_FALSE(conn_.pendingEvents.urgentWindowUpdate);
+
+  StreamId id = 4;
+  QuicStreamState stream(id, conn_);
+  stream.flowControlState.windowSize = 1000;
+  handleStreamBlocked(stream);
+  EXPECT_TRUE(conn_.pendingEvents.urgentWindowUpdate);
+  conn_.pendingEvents.urgentWindowUpdate = false;
+  onStreamWindowUpdateLost(stream);
+  EXPECT_TRUE(conn_.pendingEvents.urgentWindowUpdate);
+  onStreamWindowUpdateSent(stream, 1000, Clock::now());
+  EXPECT_FALSE(conn_.pendingEvents.urgentWindowUpdate);
+}
+
+TEST_F(QuicFlowControlTest, ConnWindowUpdateSizedFromDrainRate) {
+  conn_.flowControlState.windowSize = 1000;
+  conn_.flowControlState.advertisedMaxOffset = 20000;
+  conn_.lossState.srtt = 100ms;
+  auto lastUpdateTime = Clock::now();
+  conn_.flowControlState.timeOfLastFlowControlUpdate = lastUpdateTime;
+
+  // 10000 bytes drained over a second, only sampled when coalescing.
+  conn_.flowControlState.sumCurReadOffset = 10000;
+  onConnWindowUpdateSent(conn_, 20000, lastUpdateTime + 1s);
+  EXPECT_EQ(conn_.flowControlState.drainRate, 0);
+  EXPECT_EQ(conn_.flowControlState.sumCurReadOffsetAtLastUpdate, 10000);
+
+  conn_.transportSettings.coalesceFlowControlUpdates = true;
+  lastUpdateTime += 1s;
+  conn_.flowControlState.sumCurReadOffset = 20000;
+  onConnWindowUpdateSent(conn_, 20000, lastUpdateTime + 1s);
+  EXPECT_EQ(conn_.flowControlState.drainRate, 10000);
+  EXPECT_EQ(conn_.flowControlState.sumCurReadOffsetAtLastUpdate, 20000);
+  conn_.flowControlState.sumCurReadOffset = 10000;
+  conn_.flowControlState.sumCurReadOffsetAtLastUpdate = 10000;
+
+  // Only used when coalescing updates.
+  conn_.transportSettings.coalesceFlowControlUpdates = false;
+  EXPECT_EQ(getConnWindowUpdateSize(conn_), 1000);
+
+  // 2 * SRTT of drain.
+  conn_.transportSettings.coalesceFlowControlUpdates = true;
+  EXPECT_EQ(getConnWindowUpdateSize(conn_), 2000);
+  EXPECT_EQ(generateMaxDataFrame(conn_).maximumData, 20000);
+  conn_.flowControlState.sumCurReadOffset = 19000;
+  EXPECT_EQ(generateMaxDataFrame(conn_).maximumData, 21000);
+
+  // Bounded by a multiple of the configured window.
+  conn_.lossState.srtt = 1s;
+  EXPECT_EQ(
+      getConnWindowUpdateSize(conn_), 1000 * kMaxDrainRateWindowMultiplier);
+
+  // Never smaller than the configured window.
+  conn_.lossState.srtt = 1ms;
+  EXPECT_EQ(getConnWindowUpdateSize(conn_), 1000);
+}
+
+TEST_F(QuicFlowControlTest, ConnWindowUpdateDrainRateNoInterval) {
+  conn_.transportSettings.coalesceFlowControlUpdates = true;
+  conn_.flowControlState.advertisedMaxOffset = 20000;
+  auto lastUpdateTime = Clock::now();
+  conn_.flowControlState.timeOfLastFlowControlUpdate = lastUpdateTime;
+
+  // Two updates sent at the same time don't produce a sample.
+  conn_.flowControlState.sumCurReadOffset = 10000;
+  onConnWindowUpdateSent(conn_, 20000, lastUpdateTime);
+  EXPECT_EQ(conn_.flowControlState.drainRate, 0);
+
+  // Neither does an update that went backwards in time.
+  conn_.flowControlState.sumCurReadOffset = 20000;
+  onConnWindowUpdateSent(conn_, 20000, lastUpdateTime - 1ms);
+  EXPECT_EQ(conn_.flowControlState.drainRate, 0);
+
+  // A huge drain over a nanosecond is clamped instead of overflowing.
+  lastUpdateTime = *conn_.flowControlState.timeOfLastFlowControlUpdate;
+  conn_.flowControlState.sumCurReadOffset = kMaxVarInt / 2;
+  onConnWindowUpdateSent(conn_, kMaxVarInt, lastUpdateTime + 1ns);
+  EXPECT_EQ(conn_.flowControlState.drainRate, kMaxVarInt / kRttAlpha);
+}
+
 TEST_F(QuicFlowControlTest, StreamFlowControlWithBufMeta) {
   StreamId id = 0;
   QuicStreamState stream(id, conn_);
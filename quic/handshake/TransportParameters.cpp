@@ -6,6 +6,7 @@
  */
 
 #include <quic/handshake/TransportParameters.h>
+#include <quic/mvfst-features.h>
 #include <quic/state/StateData.h>
 
 #include <quic/common/BufUtil.h>
@@ -116,7 +117,7 @@ std::vector<TransportParameter> getSupportedExtTransportParams(
     }
   }
 
-  if (ts.advertisedMaxStreamGroups > 0) {
+  if (kStreamGroupsEnabled && ts.advertisedMaxStreamGroups > 0) {
     auto result = encodeIntegerParameter(
         TpId::stream_groups_enabled, ts.advertisedMaxStreamGroups);
     if (result.has_value()) {
@@ -157,7 +158,7 @@ std::vector<TransportParameter> getSupportedExtTransportParams(
     }
   }
 
-  if (ts.advertisedKnobFrameSupport) {
+  if (kKnobsEnabled && ts.advertisedKnobFrameSupport) {
     auto knobFrameResult =
         encodeIntegerParameter(TpId::knob_frames_supported, 1);
     if (knobFrameResult.has_value()) {
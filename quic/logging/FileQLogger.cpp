@@ -164,8 +164,16 @@ void FileQLogger::finishStream() {
   }
 }
 
+void FileQLogger::setTelemetryProducer(
+    std::shared_ptr<TelemetryProducer> producer) {
+  telemetryProducer_ = std::move(producer);
+}
+
 void FileQLogger::handleEvent(std::unique_ptr<QLogEvent> event) {
-  if (streaming_) {
+  if (telemetryProducer_) {
+    telemetryProducer_->tryPush(
+        TelemetryRecord::qlogEvent(dcid, std::move(event)));
+  } else if (streaming_) {
     numEvents_++;
     startTime_ = (startTime_ == std::chrono::microseconds::zero())
         ? event->refTime
@@ -198,6 +206,13 @@ void FileQLogger::addPacket(
   handleEvent(createPacketEvent(regularPacket, packetSize));
 }
 
+void FileQLogger::addPacket(
+    const RegularQuicPacket& regularPacket,
+    uint64_t packetSize,
+    TimePoint /* receiveTime */) {
+  addPacket(regularPacket, packetSize);
+}
+
 void FileQLogger::addPacket(
     const RegularQuicWritePacket& writePacket,
     uint64_t packetSize) {
@@ -16,6 +16,7 @@
 #include <quic/logging/BaseQLogger.h>
 #include <quic/logging/QLoggerConstants.h>
 #include <quic/logging/QLoggerTypes.h>
+#include <quic/logging/TelemetryExporter.h>
 
 namespace quic {
 
@@ -50,6 +51,10 @@ class FileQLogger : public BaseQLogger {
 
   void addPacket(const RegularQuicPacket& regularPacket, uint64_t packetSize)
       override;
+  void addPacket(
+      const RegularQuicPacket& regularPacket,
+      uint64_t packetSize,
+      TimePoint receiveTime) override;
   void addPacket(
       const VersionNegotiationPacket& versionPacket,
       uint64_t packetSize,
@@ -132,6 +137,13 @@ class FileQLogger : public BaseQLogger {
   void setDcid(Optional<ConnectionId> connID) override;
   void setScid(Optional<ConnectionId> connID) override;
 
+  /**
+   * Hands every event to the given producer, tagged with the dcid, instead of
+   * keeping or streaming it here. The events are serialized and written on
+   * the exporter's thread, and are dropped if the producer's ring is full.
+   */
+  void setTelemetryProducer(std::shared_ptr<TelemetryProducer> producer);
+
  private:
   void setupStream();
   void writeToStream(folly::StringPiece message);
@@ -141,6 +153,7 @@ class FileQLogger : public BaseQLogger {
   std::unique_ptr<folly::AsyncFileWriter> writer_;
   std::unique_ptr<folly::compression::StreamCodec> compressionCodec_;
   BufPtr compressionBuffer_;
+  std::shared_ptr<TelemetryProducer> telemetryProducer_;
 
   std::string path_;
   std::string basePadding_ = "  ";
@@ -28,6 +28,11 @@ class QLogger {
   virtual void addPacket(
       const RegularQuicPacket& regularPacket,
       uint64_t packetSize) = 0;
+  // A received packet, with the time the transport received it.
+  virtual void addPacket(
+      const RegularQuicPacket& regularPacket,
+      uint64_t packetSize,
+      TimePoint receiveTime) = 0;
   virtual void addPacket(
       const VersionNegotiationPacket& versionPacket,
       uint64_t packetSize,
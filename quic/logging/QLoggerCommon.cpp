@@ -20,6 +20,13 @@ void QLoggerCommon::addPacket(
   logTrace(createPacketEvent(regularPacket, packetSize));
 }
 
+void QLoggerCommon::addPacket(
+    const quic::RegularQuicPacket& regularPacket,
+    uint64_t packetSize,
+    quic::TimePoint /* receiveTime */) {
+  addPacket(regularPacket, packetSize);
+}
+
 void QLoggerCommon::addPacket(
     const quic::VersionNegotiationPacket& versionPacket,
     uint64_t packetSize,
@@ -21,6 +21,10 @@ class QLoggerCommon : public quic::BaseQLogger {
   void addPacket(
       const quic::RegularQuicPacket& regularPacket,
       uint64_t packetSize) override;
+  void addPacket(
+      const quic::RegularQuicPacket& regularPacket,
+      uint64_t packetSize,
+      quic::TimePoint receiveTime) override;
   void addPacket(
       const quic::VersionNegotiationPacket& versionPacket,
       uint64_t packetSize,
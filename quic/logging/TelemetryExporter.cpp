@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/logging/TelemetryExporter.h>
+
+#include <folly/json/json.h> // @manual=//folly:dynamic
+#include <glog/logging.h>
+
+namespace quic {
+
+FileTelemetrySink::FileTelemetrySink(const std::string& path)
+    : out_(path, std::ios::out | std::ios::app) {
+  if (!out_.is_open()) {
+    LOG(ERROR) << "Error opening telemetry file " << path;
+  }
+}
+
+void FileTelemetrySink::onRecord(TelemetryRecord record) {
+  folly::dynamic line = folly::dynamic::object;
+  switch (record.type) {
+    case TelemetryRecord::Type::QLogEvent:
+      if (!record.event) {
+        return;
+      }
+      line["type"] = "qlog";
+      if (record.connectionId.has_value()) {
+        line["dcid"] = record.connectionId->hex();
+      }
+      line["event"] = record.event->toDynamic();
+      break;
+    case TelemetryRecord::Type::StatsDelta:
+      if (!record.counter) {
+        return;
+      }
+      line["type"] = "stats";
+      line["counter"] = record.counter;
+      line["delta"] = record.delta;
+      break;
+  }
+  out_ << folly::toJson(line) << '\n';
+}
+
+void FileTelemetrySink::onRecordsDropped(uint64_t numDropped) {
+  folly::dynamic line = folly::dynamic::object("type", "dropped")(
+      "count", static_cast<int64_t>(numDropped));
+  out_ << folly::toJson(line) << '\n';
+}
+
+void FileTelemetrySink::flush() {
+  out_.flush();
+}
+
+TelemetryExporter::TelemetryExporter(std::unique_ptr<TelemetrySink> sink)
+    : TelemetryExporter(std::move(sink), Options()) {}
+
+TelemetryExporter::TelemetryExporter(
+    std::unique_ptr<TelemetrySink> sink,
+    Options options)
+    : sink_(std::move(sink)), options_(options) {
+  CHECK(sink_);
+  CHECK_GT(options_.ringCapacity, 0);
+  thread_ = std::thread([this] { run(); });
+}
+
+TelemetryExporter::~TelemetryExporter() {
+  stop();
+}
+
+std::shared_ptr<TelemetryProducer> TelemetryExporter::createProducer() {
+  auto producer = std::make_shared<TelemetryProducer>(options_.ringCapacity);
+  std::lock_guard<std::mutex> guard(mutex_);
+  producers_.push_back(producer);
+  return producer;
+}
+
+void TelemetryExporter::stop() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+uint64_t TelemetryExporter::droppedRecords() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  uint64_t dropped = releasedDropped_;
+  for (const auto& producer : producers_) {
+    dropped += producer->dropped();
+  }
+  return dropped;
+}
+
+void TelemetryExporter::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!cv_.wait_for(
+      lock, options_.drainInterval, [this] { return stopping_; })) {
+    lock.unlock();
+    drainOnce();
+    lock.lock();
+  }
+  lock.unlock();
+  drainOnce();
+}
+
+size_t TelemetryExporter::drainOnce() {
+  std::vector<std::shared_ptr<TelemetryProducer>> producers;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    producers = producers_;
+  }
+  size_t numRecords = 0;
+  uint64_t numDropped = 0;
+  for (auto& producer : producers) {
+    // Only read up to what was in the ring when we got here, so a busy
+    // producer can't keep this pass from reaching the others.
+    auto pending = producer->queue_.sizeGuess();
+    while (pending-- > 0) {
+      auto record = producer->queue_.frontPtr();
+      if (!record) {
+        break;
+      }
+      sink_->onRecord(std::move(*record));
+      producer->queue_.popFront();
+      numRecords++;
+    }
+    auto dropped = producer->dropped();
+    numDropped += dropped - producer->reportedDropped_;
+    producer->reportedDropped_ = dropped;
+  }
+  if (numDropped > 0) {
+    sink_->onRecordsDropped(numDropped);
+  }
+  if (numRecords > 0 || numDropped > 0) {
+    sink_->flush();
+  }
+  producers.clear();
+
+  // Release the producers nobody else holds anymore once they're drained.
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = producers_.begin();
+  while (it != producers_.end()) {
+    auto& producer = *it;
+    if (producer.use_count() == 1 && producer->queue_.isEmpty() &&
+        producer->dropped() == producer->reportedDropped_) {
+      releasedDropped_ += producer->dropped();
+      it = producers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return numRecords;
+}
+
+} // namespace quic
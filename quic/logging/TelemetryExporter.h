@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/ProducerConsumerQueue.h>
+#include <quic/codec/QuicConnectionId.h>
+#include <quic/logging/QLoggerTypes.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace quic {
+
+/**
+ * One unit of telemetry handed from a worker thread to the exporter thread.
+ *
+ * Records have a fixed size so they can be stored inline in the ring. A qlog
+ * event, including a connection's transport summary, is handed over as the
+ * event object itself and only serialized on the exporter thread. A stats
+ * delta names a counter with a string literal and carries the change in it.
+ */
+struct TelemetryRecord {
+  enum class Type : uint8_t {
+    QLogEvent,
+    StatsDelta,
+  };
+
+  static TelemetryRecord qlogEvent(
+      Optional<ConnectionId> connectionId,
+      std::unique_ptr<QLogEvent> event) {
+    TelemetryRecord record;
+    record.type = Type::QLogEvent;
+    record.connectionId = std::move(connectionId);
+    record.event = std::move(event);
+    return record;
+  }
+
+  static TelemetryRecord statsDelta(const char* counter, int64_t delta) {
+    TelemetryRecord record;
+    record.type = Type::StatsDelta;
+    record.counter = counter;
+    record.delta = delta;
+    return record;
+  }
+
+  Type type{Type::QLogEvent};
+  Optional<ConnectionId> connectionId;
+  std::unique_ptr<QLogEvent> event;
+  // Must point to a string that outlives the exporter, e.g. a literal.
+  const char* counter{nullptr};
+  int64_t delta{0};
+};
+
+/**
+ * Receives the records drained by a TelemetryExporter. All methods are called
+ * on the exporter thread, so a sink is free to block on I/O.
+ */
+class TelemetrySink {
+ public:
+  virtual ~TelemetrySink() = default;
+
+  virtual void onRecord(TelemetryRecord record) = 0;
+
+  // Records that were dropped because a producer's ring was full since the
+  // last drain.
+  virtual void onRecordsDropped(uint64_t /* numDropped */) {}
+
+  // Called after every drain pass that handed over records or drops.
+  virtual void flush() {}
+};
+
+/**
+ * Writes records to a file as JSON lines.
+ */
+class FileTelemetrySink : public TelemetrySink {
+ public:
+  explicit FileTelemetrySink(const std::string& path);
+
+  void onRecord(TelemetryRecord record) override;
+  void onRecordsDropped(uint64_t numDropped) override;
+  void flush() override;
+
+ private:
+  std::ofstream out_;
+};
+
+/**
+ * The producing end of one SPSC ring. Each worker thread gets its own
+ * producer, and only that thread may push to it. Pushing never blocks: when
+ * the ring is full the record is dropped and counted.
+ */
+class TelemetryProducer {
+ public:
+  // The queue keeps one slot empty to tell a full ring from an empty one.
+  explicit TelemetryProducer(uint32_t capacity) : queue_(capacity + 1) {}
+
+  bool tryPush(TelemetryRecord&& record) noexcept {
+    if (queue_.write(std::move(record))) {
+      return true;
+    }
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  [[nodiscard]] uint64_t dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  friend class TelemetryExporter;
+
+  folly::ProducerConsumerQueue<TelemetryRecord> queue_;
+  std::atomic<uint64_t> dropped_{0};
+  // Only accessed on the exporter thread.
+  uint64_t reportedDropped_{0};
+};
+
+/**
+ * Drains the rings of all its producers on a background thread and hands the
+ * records to a sink, so telemetry I/O never runs on a worker thread.
+ *
+ * Producers don't wake the exporter; it drains every drainInterval, so ring
+ * capacity should cover the records produced in one interval. A producer is
+ * released once it has been drained after the last reference to it outside
+ * the exporter went away.
+ */
+class TelemetryExporter {
+ public:
+  struct Options {
+    // Usable slots in each producer's ring.
+    uint32_t ringCapacity{4096};
+    std::chrono::milliseconds drainInterval{100};
+  };
+
+  explicit TelemetryExporter(std::unique_ptr<TelemetrySink> sink);
+  TelemetryExporter(std::unique_ptr<TelemetrySink> sink, Options options);
+
+  ~TelemetryExporter();
+
+  TelemetryExporter(const TelemetryExporter&) = delete;
+  TelemetryExporter& operator=(const TelemetryExporter&) = delete;
+
+  /**
+   * Creates a ring for one producing thread. Can be called from any thread.
+   */
+  std::shared_ptr<TelemetryProducer> createProducer();
+
+  /**
+   * Drains what is left in the rings and joins the exporter thread. Records
+   * pushed after this are never exported.
+   */
+  void stop();
+
+  /**
+   * Records dropped by all producers, including released ones.
+   */
+  [[nodiscard]] uint64_t droppedRecords() const;
+
+ private:
+  void run();
+  // Returns the number of records handed to the sink.
+  size_t drainOnce();
+
+  std::unique_ptr<TelemetrySink> sink_;
+  Options options_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<std::shared_ptr<TelemetryProducer>> producers_;
+  uint64_t releasedDropped_{0};
+  bool stopping_{false};
+
+  std::thread thread_;
+};
+
+} // namespace quic
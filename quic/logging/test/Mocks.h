@@ -19,6 +19,10 @@ class MockQLogger : public QLogger {
 
   ~MockQLogger() override = default;
   MOCK_METHOD(void, addPacket, (const RegularQuicPacket&, uint64_t));
+  MOCK_METHOD(
+      void,
+      addPacket,
+      (const RegularQuicPacket&, uint64_t, TimePoint));
   MOCK_METHOD(
       void,
       addPacket,
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/logging/TelemetryExporter.h>
+
+#include <folly/FileUtil.h>
+#include <folly/String.h>
+#include <folly/json/json.h> // @manual=//folly:dynamic
+#include <folly/portability/Filesystem.h>
+#include <gtest/gtest.h>
+#include <quic/common/test/TestUtils.h>
+#include <quic/logging/FileQLogger.h>
+
+using namespace testing;
+
+namespace quic::test {
+
+namespace {
+
+struct CollectedRecords {
+  std::mutex mutex;
+  std::vector<TelemetryRecord> records;
+  uint64_t dropped{0};
+};
+
+class CollectingSink : public TelemetrySink {
+ public:
+  explicit CollectingSink(std::shared_ptr<CollectedRecords> collected)
+      : collected_(std::move(collected)) {}
+
+  void onRecord(TelemetryRecord record) override {
+    std::lock_guard<std::mutex> guard(collected_->mutex);
+    collected_->records.push_back(std::move(record));
+  }
+
+  void onRecordsDropped(uint64_t numDropped) override {
+    std::lock_guard<std::mutex> guard(collected_->mutex);
+    collected_->dropped += numDropped;
+  }
+
+ private:
+  std::shared_ptr<CollectedRecords> collected_;
+};
+
+// Long enough that nothing is drained before stop() in these tests.
+TelemetryExporter::Options manualDrainOptions(uint32_t ringCapacity) {
+  TelemetryExporter::Options options;
+  options.ringCapacity = ringCapacity;
+  options.drainInterval = std::chrono::hours(1);
+  return options;
+}
+
+} // namespace
+
+TEST(TelemetryExporterTest, RecordsReachSinkInOrder) {
+  auto collected = std::make_shared<CollectedRecords>();
+  TelemetryExporter exporter(
+      std::make_unique<CollectingSink>(collected), manualDrainOptions(16));
+  auto producer = exporter.createProducer();
+  EXPECT_TRUE(producer->tryPush(TelemetryRecord::statsDelta("a", 1)));
+  EXPECT_TRUE(producer->tryPush(TelemetryRecord::statsDelta("b", -2)));
+  exporter.stop();
+
+  ASSERT_EQ(collected->records.size(), 2);
+  EXPECT_EQ(collected->records[0].type, TelemetryRecord::Type::StatsDelta);
+  EXPECT_STREQ(collected->records[0].counter, "a");
+  EXPECT_EQ(collected->records[0].delta, 1);
+  EXPECT_STREQ(collected->records[1].counter, "b");
+  EXPECT_EQ(collected->records[1].delta, -2);
+  EXPECT_EQ(collected->dropped, 0);
+}
+
+TEST(TelemetryExporterTest, FullRingDropsAndCounts) {
+  auto collected = std::make_shared<CollectedRecords>();
+  TelemetryExporter exporter(
+      std::make_unique<CollectingSink>(collected), manualDrainOptions(2));
+  auto producer = exporter.createProducer();
+  EXPECT_TRUE(producer->tryPush(TelemetryRecord::statsDelta("a", 1)));
+  EXPECT_TRUE(producer->tryPush(TelemetryRecord::statsDelta("a", 2)));
+  EXPECT_FALSE(producer->tryPush(TelemetryRecord::statsDelta("a", 3)));
+  EXPECT_FALSE(producer->tryPush(TelemetryRecord::statsDelta("a", 4)));
+  EXPECT_EQ(producer->dropped(), 2);
+  EXPECT_EQ(exporter.droppedRecords(), 2);
+  exporter.stop();
+
+  ASSERT_EQ(collected->records.size(), 2);
+  EXPECT_EQ(collected->records[1].delta, 2);
+  EXPECT_EQ(collected->dropped, 2);
+}
+
+TEST(TelemetryExporterTest, ReleasedProducerIsDrained) {
+  auto collected = std::make_shared<CollectedRecords>();
+  TelemetryExporter::Options options;
+  options.drainInterval = std::chrono::milliseconds(1);
+  TelemetryExporter exporter(
+      std::make_unique<CollectingSink>(collected), options);
+  auto producer = exporter.createProducer();
+  producer->tryPush(TelemetryRecord::statsDelta("a", 1));
+  producer.reset();
+  exporter.stop();
+
+  ASSERT_EQ(collected->records.size(), 1);
+  EXPECT_EQ(exporter.droppedRecords(), 0);
+}
+
+TEST(TelemetryExporterTest, FileQLoggerHandsOffEvents) {
+  auto collected = std::make_shared<CollectedRecords>();
+  TelemetryExporter exporter(
+      std::make_unique<CollectingSink>(collected), manualDrainOptions(16));
+  FileQLogger q(VantagePoint::Server);
+  q.setDcid(getTestConnectionId(1));
+  q.setTelemetryProducer(exporter.createProducer());
+  q.addPacketDrop(100, "reason");
+  q.addTransportStateUpdate("update");
+  EXPECT_TRUE(q.logs.empty());
+  exporter.stop();
+
+  ASSERT_EQ(collected->records.size(), 2);
+  const auto& record = collected->records[0];
+  EXPECT_EQ(record.type, TelemetryRecord::Type::QLogEvent);
+  EXPECT_EQ(record.connectionId, getTestConnectionId(1));
+  ASSERT_NE(record.event, nullptr);
+  EXPECT_EQ(record.event->eventType, QLogEventType::PacketDrop);
+  EXPECT_EQ(
+      collected->records[1].event->eventType,
+      QLogEventType::TransportStateUpdate);
+}
+
+TEST(TelemetryExporterTest, FileSinkWritesJsonLines) {
+  auto path = folly::fs::temp_directory_path() /
+      folly::fs::unique_path("telemetry-%%%%-%%%%.jsonl");
+  {
+    TelemetryExporter exporter(
+        std::make_unique<FileTelemetrySink>(path.string()),
+        manualDrainOptions(1));
+    auto producer = exporter.createProducer();
+    producer->tryPush(TelemetryRecord::statsDelta("counter", 3));
+    producer->tryPush(TelemetryRecord::statsDelta("counter", 4));
+  }
+
+  std::string contents;
+  ASSERT_TRUE(folly::readFile(path.string().c_str(), contents));
+  folly::fs::remove(path);
+  std::vector<std::string> lines;
+  folly::split('\n', contents, lines, true /* ignoreEmpty */);
+  ASSERT_EQ(lines.size(), 2);
+  auto stats = folly::parseJson(lines[0]);
+  EXPECT_EQ(stats["type"], "stats");
+  EXPECT_EQ(stats["counter"], "counter");
+  EXPECT_EQ(stats["delta"], 3);
+  auto dropped = folly::parseJson(lines[1]);
+  EXPECT_EQ(dropped["type"], "dropped");
+  EXPECT_EQ(dropped["count"], 1);
+}
+
+} // namespace quic::test
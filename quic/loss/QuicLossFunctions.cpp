@@ -6,6 +6,7 @@
  */
 
 #include <quic/loss/QuicLossFunctions.h>
+#include <quic/mvfst-features.h>
 #include <quic/state/QuicStreamFunctions.h>
 
 namespace quic {
@@ -190,6 +191,7 @@ quic::Expected<void, QuicError> markPacketLoss(
           }
           stream->retransmissionBuffer.erase(bufferItr);
         } else {
+#if MVFST_ENABLE_DSR
           auto retxBufMetaItr =
               stream->retransmissionBufMetas.find(frame.offset);
           if (retxBufMetaItr == stream->retransmissionBufMetas.end()) {
@@ -204,6 +206,7 @@ quic::Expected<void, QuicError> markPacketLoss(
             streamsWithAddedStreamLossForPacket.insert(frame.streamId);
           }
           stream->retransmissionBufMetas.erase(retxBufMetaItr);
+#endif
         }
         conn.streamManager->updateWritableStreams(*stream);
         break;
@@ -243,6 +246,7 @@ quic::Expected<void, QuicError> markPacketLoss(
           break;
         }
         conn.pendingEvents.resets.emplace(frame.streamId, frame);
+        conn.pendingEvents.markPendingWrite(PendingWriteReason::RESET);
         break;
       }
       case QuicWriteFrame::Type::StreamDataBlockedFrame: {
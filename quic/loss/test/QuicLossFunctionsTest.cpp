@@ -1057,6 +1057,7 @@ TEST_F(QuicLossFunctionsTest, TestMarkRstLoss) {
   RstStreamFrame rstFrame(
       stream->id, GenericApplicationErrorCode::UNKNOWN, currentOffset);
   conn->pendingEvents.resets.insert({stream->id, rstFrame});
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::RESET);
   ASSERT_FALSE(writeQuicDataToSocket(
                    socket,
                    *conn,
@@ -1713,6 +1714,7 @@ TEST_F(QuicLossFunctionsTest, TestMarkPacketLossProcessedPacket) {
       conn->streamManager->createNextBidirectionalStream().value()->id;
   conn->streamManager->queueWindowUpdate(stream2Id);
   conn->pendingEvents.connWindowUpdate = true;
+  conn->pendingEvents.markPendingWrite(PendingWriteReason::CONN_WINDOW_UPDATE);
   // writeQuicPacket will call writeQuicDataToSocket which will also take care
   // of sending the MaxStreamDataFrame for stream2
   auto stream1 = conn->streamManager->findStream(stream1Id);
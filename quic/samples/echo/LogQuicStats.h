@@ -168,6 +168,10 @@ class LogQuicStats : public quic::QuicTransportStatsCallback {
     VLOG(2) << prefix_ << __func__;
   }
 
+  void onControlFrameOnlyPacketSent() override {
+    VLOG(2) << prefix_ << __func__;
+  }
+
   void onCwndBlocked() override {
     VLOG(2) << prefix_ << __func__;
   }
@@ -299,6 +303,21 @@ class LogQuicStats : public quic::QuicTransportStatsCallback {
     VLOG(2) << prefix_ << __func__;
   }
 
+  void onWriteStageCycles(const WriteStageCycles& stageCycles) override {
+    VLOG(2) << prefix_ << __func__ << " schedule="
+            << stageCycles.cycles[WriteStage::Schedule]
+            << " encrypt=" << stageCycles.cycles[WriteStage::Encrypt]
+            << " headerProtection="
+            << stageCycles.cycles[WriteStage::HeaderProtection]
+            << " updateConnection="
+            << stageCycles.cycles[WriteStage::UpdateConnection]
+            << " socketWrite=" << stageCycles.cycles[WriteStage::SocketWrite];
+  }
+
+  void onPacketsBatchWritten(uint32_t numPackets) override {
+    VLOG(2) << prefix_ << __func__ << " numPackets=" << numPackets;
+  }
+
  private:
   std::string prefix_;
 };
@@ -224,6 +224,10 @@ void QuicServer::initializeWorkers(bool useDefaultTransport) {
     }
     worker->setWorkerId(i);
     workers_.push_back(std::move(worker));
+    if (workerHandoffQueueCapacity_ > 0) {
+      workerHandoffs_.push_back(
+          std::make_unique<WorkerHandoff>(workerHandoffQueueCapacity_));
+    }
     evbToWorkers_.emplace(
         (*workerEvbs)[i]->getEventBase(), workers_.back().get());
   }
@@ -255,6 +259,9 @@ std::unique_ptr<QuicServerWorker> QuicServer::newWorkerWithoutSocket() {
     CHECK(statsCallback);
     worker->setTransportStatsCallback(std::move(statsCallback));
   }
+  if (telemetryExporter_) {
+    worker->setTelemetryProducer(telemetryExporter_->createProducer());
+  }
   worker->setConnectionIdAlgo(connIdAlgoFactory_->make());
   worker->setCongestionControllerFactory(ccFactory_);
   if (rateLimit_) {
@@ -266,6 +273,11 @@ std::unique_ptr<QuicServerWorker> QuicServer::newWorkerWithoutSocket() {
   worker->setTransportSettingsOverrideFn(transportSettingsOverrideFn_);
   worker->setShouldRegisterKnobParamHandlerFn(
       shouldRegisterKnobParamHandlerFn_);
+  if (knobTunerFactory_) {
+    auto tuner = knobTunerFactory_->make();
+    CHECK(tuner);
+    worker->setTransportKnobTuner(std::move(tuner));
+  }
   return worker;
 }
 
@@ -286,15 +298,24 @@ void QuicServer::bindWorkersToSocket(const folly::SocketAddress& address) {
           if (self->shutdown_) {
             return;
           }
-          auto workerSocket = self->listenerSocketFactory_->make(workerEvb, -1);
           auto it = self->evbToWorkers_.find(workerEvb);
           CHECK(it != self->evbToWorkers_.end());
           auto worker = it->second;
+          // Pin first, so that the socket and everything the worker sets up
+          // next is allocated on its node.
+          const auto& placement = self->workerPlacementPolicy_;
+          if (!placement.cpus.empty()) {
+            worker->setPlacement(
+                placement.cpus[idx % placement.cpus.size()], placement);
+          }
+          auto workerSocket = self->listenerSocketFactory_->make(workerEvb, -1);
           int takeoverOverFd = -1;
           if (self->listeningFDs_.size() > idx) {
             takeoverOverFd = self->listeningFDs_[idx];
           }
           worker->setSocketOptions(&self->socketOptions_);
+          worker->setConnectionObjectPoolMaxBytes(
+              self->connectionObjectPoolMaxBytes_);
           // dup the takenover socket on only one worker and bind the rest
           if (takeoverOverFd >= 0) {
             workerSocket->setFD(
@@ -321,6 +342,19 @@ void QuicServer::bindWorkersToSocket(const folly::SocketAddress& address) {
             }
           }
           if (idx == (numWorkers - 1)) {
+            // The workers joined the reuseport group in order, so worker i
+            // is the group's i-th socket.
+            if (placement.steerByReceiveCpu && !placement.cpus.empty() &&
+                takeoverOverFd < 0) {
+              std::vector<int> cpuOfWorker;
+              for (size_t i = 0; i < numWorkers; ++i) {
+                cpuOfWorker.push_back(
+                    placement.cpus[i % placement.cpus.size()]);
+              }
+              if (!worker->steerByReceiveCpu(cpuOfWorker)) {
+                LOG(WARNING) << "Failed to steer packets by receive cpu";
+              }
+            }
             VLOG(4) << "Initialized all workers in the eventbase";
             self->initialized_ = true;
             folly::call_once(
@@ -467,6 +501,10 @@ void QuicServer::routeDataToWorker(
       << " Routing to worker in different EVB, to workerId=" << workerToRunOn;
   folly::EventBase* workerEvb = worker->getEventBase();
   bool isInEvb = workerEvb->isInEventBaseThread();
+  if (!isInEvb && workerPtr_) {
+    workerPtr_->onPacketsHandedOff(
+        networkData.getPackets().size(), worker->getNumaNode());
+  }
   if (isInEvb) {
     worker->dispatchPacketData(
         client,
@@ -476,6 +514,31 @@ void QuicServer::routeDataToWorker(
         isForwardedData);
     return;
   }
+  if (!workerHandoffs_.empty()) {
+    auto& handoff = *workerHandoffs_[workerToRunOn];
+    HandoffPacket packet;
+    packet.client = client;
+    packet.headerForm = routingData.headerForm;
+    packet.isInitial = routingData.isInitial;
+    packet.is0Rtt = routingData.is0Rtt;
+    packet.destinationConnId = routingData.destinationConnId;
+    packet.sourceConnId = std::move(routingData.sourceConnId);
+    packet.networkData = std::move(networkData);
+    packet.quicVersion = quicVersion;
+    packet.isForwardedData = isForwardedData;
+    if (handoff.queue.write(std::move(packet))) {
+      if (!handoff.drainScheduled.exchange(true)) {
+        workerEvb->runInEventBaseThread(
+            [server = this->shared_from_this(), workerToRunOn] {
+              server->drainWorkerHandoff(workerToRunOn);
+            });
+      }
+      return;
+    }
+    // The queue is full, hand this one over on its own.
+    routingData.sourceConnId = std::move(packet.sourceConnId);
+    networkData = std::move(packet.networkData);
+  }
   worker->getEventBase()->runInEventBaseThread([server =
                                                     this->shared_from_this(),
                                                 cl = client,
@@ -493,6 +556,31 @@ void QuicServer::routeDataToWorker(
   });
 }
 
+void QuicServer::drainWorkerHandoff(size_t workerIdx) {
+  auto& handoff = *workerHandoffs_[workerIdx];
+  // Packets queued from here on schedule another drain, so only what's queued
+  // now is dispatched and a busy producer can't keep the worker here.
+  handoff.drainScheduled = false;
+  auto pending = handoff.queue.sizeGuess();
+  HandoffPacket packet;
+  while (pending-- > 0 && handoff.queue.read(packet)) {
+    if (shutdown_) {
+      continue;
+    }
+    workers_[workerIdx]->dispatchPacketData(
+        packet.client,
+        RoutingData(
+            packet.headerForm,
+            packet.isInitial,
+            packet.is0Rtt,
+            packet.destinationConnId,
+            std::move(packet.sourceConnId)),
+        std::move(packet.networkData),
+        packet.quicVersion,
+        packet.isForwardedData);
+  }
+}
+
 void QuicServer::handleWorkerError(LocalErrorCode error) {
   shutdown(error);
 }
@@ -610,6 +698,14 @@ void QuicServer::setShouldRegisterKnobParamHandlerFn(
   shouldRegisterKnobParamHandlerFn_ = std::move(fn);
 }
 
+void QuicServer::setTransportKnobTunerFactory(
+    std::unique_ptr<TransportKnobTunerFactory> tunerFactory) {
+  checkRunningInThread(mainThreadId_);
+  CHECK(!initialized_) << kQuicServerNotInitialized << __func__;
+  CHECK(tunerFactory);
+  knobTunerFactory_ = std::move(tunerFactory);
+}
+
 void QuicServer::setHealthCheckToken(const std::string& healthCheckToken) {
   checkRunningInThread(mainThreadId_);
   // Make sure the token satisfies the required properties, i.e. it is not a
@@ -623,6 +719,26 @@ void QuicServer::setHealthCheckToken(const std::string& healthCheckToken) {
   });
 }
 
+void QuicServer::setConnectionObjectPoolMaxBytes(uint64_t maxRetainedBytes) {
+  checkRunningInThread(mainThreadId_);
+  connectionObjectPoolMaxBytes_ = maxRetainedBytes;
+  runOnAllWorkers([maxRetainedBytes](auto worker) mutable {
+    worker->setConnectionObjectPoolMaxBytes(maxRetainedBytes);
+  });
+}
+
+void QuicServer::setWorkerHandoffQueueCapacity(size_t capacity) {
+  checkRunningInThread(mainThreadId_);
+  CHECK(workers_.empty()) << "Workers are already initialized";
+  workerHandoffQueueCapacity_ = capacity;
+}
+
+void QuicServer::setWorkerPlacementPolicy(WorkerPlacementPolicy policy) {
+  checkRunningInThread(mainThreadId_);
+  CHECK(!initialized_) << "Workers are already bound";
+  workerPlacementPolicy_ = std::move(policy);
+}
+
 void QuicServer::setFizzContext(
     std::shared_ptr<const fizz::server::FizzServerContext> ctx) {
   checkRunningInThread(mainThreadId_);
@@ -713,6 +829,31 @@ void QuicServer::setTransportStatsCallbackFactory(
   transportStatsFactory_ = std::move(statsFactory);
 }
 
+void QuicServer::setTelemetryExporter(
+    std::shared_ptr<TelemetryExporter> exporter) {
+  checkRunningInThread(mainThreadId_);
+  CHECK(!initialized_);
+  CHECK(exporter);
+  telemetryExporter_ = std::move(exporter);
+}
+
+std::shared_ptr<TelemetryProducer> QuicServer::getTelemetryProducer(
+    folly::EventBase* evb) {
+  CHECK(evb);
+  std::shared_ptr<TelemetryProducer> producer;
+  evb->runImmediatelyOrRunInEventBaseThreadAndWait([&] {
+    std::lock_guard<std::mutex> guard(startMutex_);
+    if (shutdown_) {
+      return;
+    }
+    auto it = evbToWorkers_.find(evb);
+    if (it != evbToWorkers_.end()) {
+      producer = it->second->getTelemetryProducer();
+    }
+  });
+  return producer;
+}
+
 void QuicServer::setConnectionIdAlgoFactory(
     std::unique_ptr<ConnectionIdAlgoFactory> connIdAlgoFactory) {
   checkRunningInThread(mainThreadId_);
@@ -775,6 +916,25 @@ void QuicServer::getAllConnectionsStats(
       [&stats](auto worker) mutable { worker->getAllConnectionsStats(stats); });
 }
 
+std::vector<WorkerPlacementStats> QuicServer::getWorkerPlacementStats() {
+  std::vector<WorkerPlacementStats> stats;
+  runOnAllWorkersSync([&stats](auto worker) mutable {
+    stats.push_back(worker->getPlacementStats());
+  });
+  return stats;
+}
+
+std::vector<TransportKnobTuner::State>
+QuicServer::exportTransportKnobTunerStates() {
+  std::vector<TransportKnobTuner::State> states;
+  runOnAllWorkersSync([&states](auto worker) mutable {
+    if (auto tuner = worker->getTransportKnobTuner()) {
+      states.push_back(tuner->exportState());
+    }
+  });
+  return states;
+}
+
 TakeoverProtocolVersion QuicServer::getTakeoverProtocolVersion()
     const noexcept {
   return workers_[0]->getTakeoverProtocolVersion();
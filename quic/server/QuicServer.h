@@ -7,9 +7,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
+#include <folly/MPMCQueue.h>
 #include <folly/ThreadLocal.h>
 #include <folly/container/F14Map.h>
 #include <folly/io/SocketOptionMap.h>
@@ -18,6 +20,7 @@
 #include <quic/QuicConstants.h>
 #include <quic/codec/ConnectionIdAlgo.h>
 #include <quic/congestion_control/ServerCongestionControllerFactory.h>
+#include <quic/logging/TelemetryExporter.h>
 #include <quic/server/QuicServerTransportFactory.h>
 #include <quic/server/QuicServerWorker.h>
 #include <quic/server/QuicUDPSocketFactory.h>
@@ -78,6 +81,14 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
    */
   void setShouldRegisterKnobParamHandlerFn(ShouldRegisterKnobParamHandlerFn fn);
 
+  /*
+   * Factory to create the knob tuner of each worker, which picks the knobs of
+   * the worker's new connections. QuicServer calls 'make' during the
+   * initialization _for each worker_.
+   */
+  void setTransportKnobTunerFactory(
+      std::unique_ptr<TransportKnobTunerFactory> tunerFactory);
+
   /*
    * Transport factory to create server-transport.
    * QuicServer calls 'make()' on the supplied transport factory for *each* new
@@ -128,6 +139,32 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
    */
   void setHealthCheckToken(const std::string& healthCheckToken);
 
+  /**
+   * Opt in to recycling the memory of transports and connection states on
+   * every worker. Each worker keeps up to maxRetainedBytes of freed blocks
+   * for reuse by later connections. 0 (the default) disables recycling.
+   */
+  void setConnectionObjectPoolMaxBytes(uint64_t maxRetainedBytes);
+
+  /**
+   * Capacity of the queue every worker takes packets routed to it from other
+   * threads on. Queued packets are dispatched in batches, with one wakeup of
+   * the worker's event base per batch instead of one callback per packet.
+   * Packets that don't fit while a queue is full get a callback each. 0
+   * gives every packet a callback. Must be called before the workers are
+   * initialized.
+   */
+  void setWorkerHandoffQueueCapacity(size_t capacity);
+
+  /**
+   * Pin the workers' event base threads to CPUs and keep their memory, and
+   * optionally their packets, on the CPUs' NUMA nodes, see
+   * WorkerPlacementPolicy. Applies to the event bases passed to initialize()
+   * as well as the ones start() creates. Must be called before the workers
+   * are bound.
+   */
+  void setWorkerPlacementPolicy(WorkerPlacementPolicy policy);
+
   /**
    * Set server TLS context.
    */
@@ -312,6 +349,23 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
   void setTransportStatsCallbackFactory(
       std::unique_ptr<QuicTransportStatsCallbackFactory> statsFactory);
 
+  /**
+   * Exporter that telemetry is handed to off the worker threads. QuicServer
+   * creates one producer per worker during the initialization, and
+   * transports whose QLogger is a FileQLogger hand their events to their
+   * worker's producer.
+   * NOTE: it must be set before calling 'start()' or 'initialize(..)'
+   */
+  void setTelemetryExporter(std::shared_ptr<TelemetryExporter> exporter);
+
+  /**
+   * Returns the telemetry producer of the worker running on the given
+   * eventbase, e.g. for stats callbacks to push deltas to. Null if there is
+   * no exporter or no such worker.
+   */
+  std::shared_ptr<TelemetryProducer> getTelemetryProducer(
+      folly::EventBase* evb);
+
   /**
    * Factory to create per worker ConnectionIdAlgo instance
    * NOTE: it must be set before calling 'start()' or 'initialize(..)'
@@ -359,6 +413,17 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
 
   void getAllConnectionsStats(std::vector<QuicConnectionStats>& stats);
 
+  /**
+   * Placement of every worker, in worker order.
+   */
+  std::vector<WorkerPlacementStats> getWorkerPlacementStats();
+
+  /**
+   * What the knob tuner of every worker learned, in worker order. Empty if
+   * there is no tuner factory.
+   */
+  std::vector<TransportKnobTuner::State> exportTransportKnobTunerStates();
+
  private:
   explicit QuicServer(TransportSettings transportSettings);
 
@@ -379,6 +444,30 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
 
   void handleWorkerError(LocalErrorCode error) override;
 
+  // A packet routed to a worker from another thread.
+  struct HandoffPacket {
+    folly::SocketAddress client;
+    HeaderForm headerForm{HeaderForm::Short};
+    bool isInitial{false};
+    bool is0Rtt{false};
+    ConnectionId destinationConnId{ConnectionId::createZeroLength()};
+    Optional<ConnectionId> sourceConnId;
+    NetworkData networkData;
+    Optional<QuicVersion> quicVersion;
+    bool isForwardedData{false};
+  };
+
+  struct WorkerHandoff {
+    explicit WorkerHandoff(size_t capacity) : queue(capacity) {}
+
+    folly::MPMCQueue<HandoffPacket> queue;
+    // Set while a drain is scheduled on the worker's event base.
+    std::atomic<bool> drainScheduled{false};
+  };
+
+  // Dispatches the packets queued for the worker, in the worker's event base.
+  void drainWorkerHandoff(size_t workerIdx);
+
   using MaybeOwnedEvbPtr =
       std::unique_ptr<folly::IOExecutor, void (*)(folly::IOExecutor*)>;
 
@@ -449,6 +538,11 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
   std::shared_ptr<CongestionControllerFactory> ccFactory_;
 
   Optional<std::string> healthCheckToken_;
+  uint64_t connectionObjectPoolMaxBytes_{0};
+  size_t workerHandoffQueueCapacity_{kDefaultWorkerHandoffQueueCapacity};
+  WorkerPlacementPolicy workerPlacementPolicy_;
+  // One per worker, in the order of workers_. Empty when the capacity is 0.
+  std::vector<std::unique_ptr<WorkerHandoff>> workerHandoffs_;
   // vector of all the listening fds on each quic server worker
   std::vector<int> listeningFDs_;
   ProcessId processId_{ProcessId::ZERO};
@@ -460,6 +554,8 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
       [](uint16_t) { return false; }};
   // factory to create per worker QuicTransportStatsCallback
   std::unique_ptr<QuicTransportStatsCallbackFactory> transportStatsFactory_;
+  // exporter handing out a telemetry producer per worker
+  std::shared_ptr<TelemetryExporter> telemetryExporter_;
   // factory to create per worker ConnectionIdAlgo
   std::unique_ptr<ConnectionIdAlgoFactory> connIdAlgoFactory_;
   // Impl of ConnectionIdAlgo to make routing decisions from ConnectionId
@@ -469,6 +565,8 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
   // Used to validate whether a transport knob parameter is allowed to be
   // registered
   ShouldRegisterKnobParamHandlerFn shouldRegisterKnobParamHandlerFn_;
+  // factory to create per worker TransportKnobTuner
+  std::unique_ptr<TransportKnobTunerFactory> knobTunerFactory_;
   // address that the server is bound to
   folly::SocketAddress boundAddress_;
   folly::SocketOptionMap socketOptions_;
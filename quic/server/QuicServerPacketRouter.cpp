@@ -130,25 +130,26 @@ void TakeoverPacketHandler::forwardPacketToAnotherServer(
     const folly::SocketAddress& peerAddress,
     NetworkData&& networkData) {
   const TimePoint receiveTimePoint = networkData.getReceiveTimePoint();
-  BufPtr buf = std::move(networkData).moveAllData();
-
-  // create buffer for the peerAddress address and receiveTimePoint
-  // Serialize: version (4B), socket(2 + 16)B and time of ack (8B)
-  auto bufSize = sizeof(TakeoverProtocolVersion) + sizeof(uint16_t) +
-      peerAddress.getActualSize() + sizeof(uint64_t);
-  BufPtr writeBuffer = BufHelpers::create(bufSize);
-  BufWriter bufWriter(writeBuffer->writableData(), bufSize);
-  bufWriter.writeBE<uint32_t>(folly::to_underlying(takeoverProtocol_));
-  sockaddr_storage addrStorage;
-  uint16_t socklen = peerAddress.getAddress(&addrStorage);
-  bufWriter.writeBE<uint16_t>(socklen);
-  bufWriter.push((uint8_t*)&addrStorage, socklen);
-  uint64_t tick = receiveTimePoint.time_since_epoch().count();
-  bufWriter.writeBE<uint64_t>(tick);
-  writeBuffer->append(bufSize);
-
-  writeBuffer->appendToChain(std::move(buf));
-  forwardPacket(std::move(writeBuffer));
+  // Every packet is forwarded in its own datagram, as it was received.
+  for (auto& packet : std::move(networkData).movePackets()) {
+    // create buffer for the peerAddress address and receiveTimePoint
+    // Serialize: version (4B), socket(2 + 16)B and time of ack (8B)
+    auto bufSize = sizeof(TakeoverProtocolVersion) + sizeof(uint16_t) +
+        peerAddress.getActualSize() + sizeof(uint64_t);
+    BufPtr writeBuffer = BufHelpers::create(bufSize);
+    BufWriter bufWriter(writeBuffer->writableData(), bufSize);
+    bufWriter.writeBE<uint32_t>(folly::to_underlying(takeoverProtocol_));
+    sockaddr_storage addrStorage;
+    uint16_t socklen = peerAddress.getAddress(&addrStorage);
+    bufWriter.writeBE<uint16_t>(socklen);
+    bufWriter.push((uint8_t*)&addrStorage, socklen);
+    uint64_t tick = receiveTimePoint.time_since_epoch().count();
+    bufWriter.writeBE<uint64_t>(tick);
+    writeBuffer->append(bufSize);
+
+    writeBuffer->appendToChain(packet.buf.move());
+    forwardPacket(std::move(writeBuffer));
+  }
 }
 
 TakeoverPacketHandler::TakeoverPacketHandler(QuicServerWorker* worker)
@@ -13,6 +13,7 @@
 #include <quic/server/QuicServerTransport.h>
 #include <quic/server/handshake/AppToken.h>
 #include <quic/server/handshake/DefaultAppTokenValidator.h>
+#include <quic/server/state/ConnectionObjectPool.h>
 #include <quic/state/QuicStreamUtilities.h>
 #include <quic/state/TransportSettingsFunctions.h>
 
@@ -59,8 +60,7 @@ QuicServerTransport::QuicServerTransport(
                    */
           ,
           useConnectionEndWithErrorCallback),
-      ctx_(std::move(ctx)),
-      wrappedObserverContainer_(this) {
+      ctx_(std::move(ctx)) {
   auto tempConn = std::make_unique<QuicServerConnectionState>(
       FizzServerQuicHandshakeContext::Builder()
           .setFizzServerContext(ctx_)
@@ -71,7 +71,9 @@ QuicServerTransport::QuicServerTransport(
   tempConn->serverAddr = addrResult.value();
   serverConn_ = tempConn.get();
   conn_.reset(tempConn.release());
+#if MVFST_ENABLE_OBSERVERS
   conn_->observerContainer = wrappedObserverContainer_.getWeakPtr();
+#endif
   setConnectionSetupCallback(connSetupCb);
   setConnectionCallbackFromCtor(connStreamsCb);
   conn_->pathManager->setPathValidationCallback(this);
@@ -100,7 +102,8 @@ QuicServerTransport::Ptr QuicServerTransport::make(
     bool useConnectionEndWithErrorCallback) {
   auto qEvb = std::make_shared<FollyQuicEventBase>(evb);
   auto qSock = std::make_unique<FollyQuicAsyncUDPSocket>(qEvb, std::move(sock));
-  return std::make_shared<QuicServerTransport>(
+  return std::allocate_shared<QuicServerTransport>(
+      ConnectionObjectPoolAllocator<QuicServerTransport>(),
       std::move(qEvb),
       std::move(qSock),
       connSetupCb,
@@ -156,6 +159,21 @@ void QuicServerTransport::setServerConnectionIdRejector(
   }
 }
 
+void QuicServerTransport::setTransportParametersCache(
+    std::shared_ptr<ServerTransportParametersCache> cache) noexcept {
+  if (serverConn_) {
+    serverConn_->transportParametersCache = std::move(cache);
+  }
+}
+
+void QuicServerTransport::setPendingPacketBudget(
+    std::shared_ptr<PendingPacketBudget> budget) noexcept {
+  if (serverConn_) {
+    serverConn_->pendingPacketLease =
+        PendingPacketBudget::Lease(std::move(budget));
+  }
+}
+
 quic::Expected<void, QuicError> QuicServerTransport::onReadData(
     const folly::SocketAddress& localAddress,
     ReceivedUdpPacket&& udpPacket,
@@ -425,6 +443,7 @@ void QuicServerTransport::closeTransport() {
   // Clear out pending data.
   serverConn_->pendingZeroRttData.reset();
   serverConn_->pendingOneRttData.reset();
+  serverConn_->pendingPacketLease.releaseAll();
   onServerClose(*serverConn_);
 }
 
@@ -518,6 +537,11 @@ void QuicServerTransport::onCryptoEventAvailable() noexcept {
   }
 }
 
+void QuicServerTransport::applyTransportKnobParams(
+    const TransportKnobParams& params) {
+  handleTransportKnobParams(params);
+}
+
 void QuicServerTransport::handleTransportKnobParams(
     const TransportKnobParams& params) {
   for (const auto& param : params) {
@@ -545,14 +569,22 @@ void QuicServerTransport::processPendingData(bool async) {
   // This is shared pointer because the lamda below (auto func) does a copy
   // for std::function for a reason not understood.
   std::shared_ptr<std::vector<ServerEvents::ReadData>> pendingData;
+  size_t numReleased = 0;
   if (conn_->readCodec && conn_->readCodec->getOneRttReadCipher()) {
     pendingData = std::move(serverConn_->pendingOneRttData);
     // It's possible that 0-rtt packets are received after CFIN, we are not
     // dealing with that much level of reordering.
-    serverConn_->pendingZeroRttData.reset();
+    if (serverConn_->pendingZeroRttData) {
+      numReleased += serverConn_->pendingZeroRttData->size();
+      serverConn_->pendingZeroRttData.reset();
+    }
   } else if (conn_->readCodec && conn_->readCodec->getZeroRttReadCipher()) {
     pendingData = std::move(serverConn_->pendingZeroRttData);
   }
+  if (pendingData) {
+    numReleased += pendingData->size();
+  }
+  serverConn_->pendingPacketLease.release(numReleased);
   if (pendingData) {
     // Move the pending data out so that we don't ever add new data to the
     // pending data.
@@ -560,11 +592,25 @@ void QuicServerTransport::processPendingData(bool async) {
         << "Processing pending data size=" << pendingData->size() << " "
         << *this;
     auto func = [pendingData = std::move(pendingData), this](auto) {
-      for (auto& pendingPacket : *pendingData) {
-        onNetworkData(
-            pendingPacket.localAddress,
-            NetworkData(std::move(pendingPacket.udpPacket)),
-            pendingPacket.peerAddress);
+      // Packets that arrived on the same path are handed over together, the
+      // way they would have been had they come in one read, so the work done
+      // after every read runs once per batch rather than once per packet.
+      // Each packet keeps the receive time it was buffered with.
+      size_t i = 0;
+      while (i < pendingData->size()) {
+        auto localAddress = (*pendingData)[i].localAddress;
+        auto peerAddress = (*pendingData)[i].peerAddress;
+        NetworkData networkData;
+        networkData.reserve(pendingData->size() - i);
+        for (; i < pendingData->size(); i++) {
+          auto& pendingPacket = (*pendingData)[i];
+          if (pendingPacket.localAddress != localAddress ||
+              pendingPacket.peerAddress != peerAddress) {
+            break;
+          }
+          networkData.addPacketWithTimings(std::move(pendingPacket.udpPacket));
+        }
+        onNetworkData(localAddress, std::move(networkData), peerAddress);
         if (closeState_ == CloseState::CLOSED) {
           // The pending data could potentially contain a connection close, or
           // the app could have triggered a connection close with an error. It
@@ -1448,6 +1494,11 @@ QuicSocket::WriteResult QuicServerTransport::writeBufMeta(
 QuicSocket::WriteResult QuicServerTransport::setDSRPacketizationRequestSender(
     StreamId id,
     std::unique_ptr<DSRPacketizationRequestSender> sender) {
+#if !MVFST_ENABLE_DSR
+  (void)id;
+  (void)sender;
+  return quic::make_unexpected(LocalErrorCode::INVALID_OPERATION);
+#else
   if (closeState_ != CloseState::OPEN) {
     return quic::make_unexpected(LocalErrorCode::CONNECTION_CLOSED);
   }
@@ -1516,6 +1567,7 @@ QuicSocket::WriteResult QuicServerTransport::setDSRPacketizationRequestSender(
     return quic::make_unexpected(LocalErrorCode::INTERNAL_ERROR);
   }
   return {};
+#endif
 }
 
 CipherInfo QuicServerTransport::getOneRttCipherInfo() const {
@@ -17,6 +17,7 @@
 #include <quic/common/udpsocket/FollyQuicAsyncUDPSocket.h>
 #include <quic/congestion_control/CongestionControllerFactory.h>
 #include <quic/handshake/HandshakeLayer.h>
+#include <quic/mvfst-features.h>
 #include <quic/server/handshake/ServerTransportParametersExtension.h>
 #include <quic/server/state/ServerConnectionIdRejector.h>
 #include <quic/server/state/ServerStateMachine.h>
@@ -132,6 +133,20 @@ class QuicServerTransport
   void setServerConnectionIdRejector(
       ServerConnectionIdRejector* connIdRejector) noexcept;
 
+  /**
+   * Set the cache to take the configuration dependent transport parameters
+   * from, so they aren't encoded again for every connection.
+   */
+  void setTransportParametersCache(
+      std::shared_ptr<ServerTransportParametersCache> cache) noexcept;
+
+  /**
+   * Set the budget that the packets buffered before the keys are available
+   * are held against, in addition to maxPacketsToBuffer.
+   */
+  void setPendingPacketBudget(
+      std::shared_ptr<PendingPacketBudget> budget) noexcept;
+
   virtual void setClientConnectionId(const ConnectionId& clientConnectionId);
 
   void setClientChosenDestConnectionId(const ConnectionId& serverCid);
@@ -145,6 +160,12 @@ class QuicServerTransport
   virtual void setShouldRegisterKnobParamHandlerFn(
       ShouldRegisterKnobParamHandlerFn fn);
 
+  /*
+   * Apply knobs chosen locally, as if the peer had sent them. Must be called
+   * after accept().
+   */
+  void applyTransportKnobParams(const TransportKnobParams& params);
+
   void verifiedClientAddress();
 
   // From QuicTransportBase
@@ -221,7 +242,11 @@ class QuicServerTransport
  protected:
   // From QuicSocket
   SocketObserverContainer* getSocketObserverContainer() const override {
+#if MVFST_ENABLE_OBSERVERS
     return wrappedObserverContainer_.getPtr();
+#else
+    return nullptr;
+#endif
   }
 
   // From ServerHandshake::HandshakeCallback
@@ -302,6 +327,8 @@ class QuicServerTransport
   // first, before any other members are destroyed. This ensures that observers
   // can inspect any socket / transport state available through public methods
   // when destruction of the transport begins.
-  const WrappedSocketObserverContainer wrappedObserverContainer_;
+#if MVFST_ENABLE_OBSERVERS
+  const WrappedSocketObserverContainer wrappedObserverContainer_{this};
+#endif
 };
 } // namespace quic
@@ -25,6 +25,7 @@
 #include <quic/congestion_control/Bbr.h>
 #include <quic/congestion_control/Copa.h>
 #include <quic/fizz/handshake/FizzRetryIntegrityTagGenerator.h>
+#include <quic/logging/FileQLogger.h>
 #include <quic/server/AcceptObserver.h>
 #include <quic/server/QuicServerWorker.h>
 #include <quic/server/handshake/StatelessResetGenerator.h>
@@ -44,6 +45,28 @@ bool isValidConnIdLength(const quic::ConnectionId& connId) {
   return quic::kMinInitialDestinationConnIdLength <= connId.size() &&
       connId.size() <= quic::kMaxConnectionIdSize;
 }
+
+// Whether both packets have a short header with the same connection id, in
+// which case they belong to the same connection.
+bool haveSameShortHeaderConnId(
+    const quic::ReceivedUdpPacket& packet,
+    const quic::ReceivedUdpPacket& otherPacket) {
+  constexpr size_t kHeaderLength = 1 + quic::kDefaultConnectionIdSize;
+  const auto* buf = packet.buf.front();
+  const auto* otherBuf = otherPacket.buf.front();
+  if (!buf || !otherBuf || buf->length() < kHeaderLength ||
+      otherBuf->length() < kHeaderLength) {
+    return false;
+  }
+  if (quic::getHeaderForm(buf->data()[0]) != quic::HeaderForm::Short ||
+      quic::getHeaderForm(otherBuf->data()[0]) != quic::HeaderForm::Short) {
+    return false;
+  }
+  return memcmp(
+             buf->data() + 1,
+             otherBuf->data() + 1,
+             quic::kDefaultConnectionIdSize) == 0;
+}
 } // namespace
 
 namespace quic {
@@ -74,6 +97,10 @@ QuicServerWorker::QuicServerWorker(
         kDefaultMaxUDPPayload * transportSettings_.maxBatchSize);
     VLOG(10) << "GSO write buf accessor created for ContinuousMemory data path";
   }
+  if (transportSettings_.maxPacketsToBufferPerWorker > 0) {
+    pendingPacketBudget_ = std::make_shared<PendingPacketBudget>(
+        transportSettings_.maxPacketsToBufferPerWorker);
+  }
 }
 
 folly::EventBase* QuicServerWorker::getEventBase() const {
@@ -173,6 +200,15 @@ void QuicServerWorker::setShouldRegisterKnobParamHandlerFn(
   shouldRegisterKnobParamHandlerFn_ = std::move(fn);
 }
 
+void QuicServerWorker::setTransportKnobTuner(
+    std::unique_ptr<TransportKnobTuner> tuner) {
+  knobTuner_ = std::move(tuner);
+}
+
+TransportKnobTuner* QuicServerWorker::getTransportKnobTuner() const {
+  return knobTuner_.get();
+}
+
 void QuicServerWorker::setTransportStatsCallback(
     std::unique_ptr<QuicTransportStatsCallback> statsCallback) noexcept {
   CHECK(statsCallback);
@@ -184,6 +220,16 @@ QuicTransportStatsCallback* QuicServerWorker::getTransportStatsCallback()
   return statsCallback_.get();
 }
 
+void QuicServerWorker::setTelemetryProducer(
+    std::shared_ptr<TelemetryProducer> telemetryProducer) noexcept {
+  telemetryProducer_ = std::move(telemetryProducer);
+}
+
+const std::shared_ptr<TelemetryProducer>&
+QuicServerWorker::getTelemetryProducer() const noexcept {
+  return telemetryProducer_;
+}
+
 void QuicServerWorker::setConnectionIdAlgo(
     std::unique_ptr<ConnectionIdAlgo> connIdAlgo) noexcept {
   CHECK(connIdAlgo);
@@ -409,6 +455,8 @@ void QuicServerWorker::onDataAvailable(
 
     size_t remaining = len;
     size_t offset = 0;
+    std::vector<ReceivedUdpPacket> segments;
+    segments.reserve((len + params.gro - 1) / params.gro);
     while (remaining) {
       if (static_cast<int>(remaining) <= params.gro) {
         // do not clone the last packet
@@ -419,7 +467,7 @@ void QuicServerWorker::onDataAvailable(
         udpPacket.timings.receiveTimePoint = packetReceiveTime;
         udpPacket.tosValue = params.tos;
         udpPacket.timings.maybeSoftwareTs = maybeSockTsExt;
-        handleNetworkData(client, udpPacket);
+        segments.push_back(std::move(udpPacket));
         break;
       }
       auto tmp = data->cloneOne();
@@ -435,8 +483,31 @@ void QuicServerWorker::onDataAvailable(
       udpPacket.timings.receiveTimePoint = packetReceiveTime;
       udpPacket.tosValue = params.tos;
       udpPacket.timings.maybeSoftwareTs = maybeSockTsExt;
-      handleNetworkData(client, udpPacket);
+      segments.push_back(std::move(udpPacket));
+    }
+    handleGroSegments(client, std::move(segments));
+  }
+}
+
+void QuicServerWorker::handleGroSegments(
+    const folly::SocketAddress& client,
+    std::vector<ReceivedUdpPacket>&& segments) noexcept {
+  // The segments of a GRO read all come from the same peer, and usually
+  // belong to the same connection. A run of short header segments with the
+  // same connection id is routed once and reaches the transport in one read.
+  size_t i = 0;
+  while (i < segments.size()) {
+    auto& udpPacket = segments[i++];
+    std::vector<ReceivedUdpPacket> sameConnIdPackets;
+    while (i < segments.size() &&
+           haveSameShortHeaderConnId(udpPacket, segments[i])) {
+      sameConnIdPackets.push_back(std::move(segments[i++]));
     }
+    handleNetworkData(
+        client,
+        udpPacket,
+        std::move(sameConnIdPackets),
+        false /* isForwardedData */);
   }
 }
 
@@ -444,13 +515,31 @@ void QuicServerWorker::handleNetworkData(
     const folly::SocketAddress& client,
     ReceivedUdpPacket& udpPacket,
     bool isForwardedData) noexcept {
+  handleNetworkData(client, udpPacket, {}, isForwardedData);
+}
+
+void QuicServerWorker::handleNetworkData(
+    const folly::SocketAddress& client,
+    ReceivedUdpPacket& udpPacket,
+    std::vector<ReceivedUdpPacket>&& sameConnIdPackets,
+    bool isForwardedData) noexcept {
   // if packet drop reason is set, invoke stats cb accordingly
   auto packetDropReason = PacketDropReason::NONE;
   auto maybeReportPacketDrop = folly::makeGuard([&]() {
     if (packetDropReason != PacketDropReason::NONE) {
-      QUIC_STATS(statsCallback_, onPacketDropped, packetDropReason);
+      for (size_t i = 0; i <= sameConnIdPackets.size(); i++) {
+        QUIC_STATS(statsCallback_, onPacketDropped, packetDropReason);
+      }
     }
   });
+  auto makeNetworkData = [&]() {
+    NetworkData networkData(std::move(udpPacket));
+    networkData.reserve(1 + sameConnIdPackets.size());
+    for (auto& packet : sameConnIdPackets) {
+      networkData.addPacket(std::move(packet));
+    }
+    return networkData;
+  };
 
   try {
     // check error conditions for packet drop & early return
@@ -492,7 +581,7 @@ void QuicServerWorker::handleNetworkData(
         return forwardNetworkData(
             client,
             std::move(routingData),
-            NetworkData(std::move(udpPacket)),
+            makeNetworkData(),
             std::nullopt, /* quicVersion */
             isForwardedData);
       }
@@ -523,6 +612,10 @@ void QuicServerWorker::handleNetworkData(
         packetDropReason = PacketDropReason::INVALID_PACKET_CID;
         return;
       }
+      // The transport takes the invariant fields from here rather than
+      // parsing them again.
+      udpPacket.routingDescriptor =
+          makePacketRoutingDescriptor(*maybeParsedLongHeader);
       RoutingData routingData(
           headerForm,
           isInitial,
@@ -532,7 +625,7 @@ void QuicServerWorker::handleNetworkData(
       return forwardNetworkData(
           client,
           std::move(routingData),
-          NetworkData(std::move(udpPacket)),
+          makeNetworkData(),
           invariant.version,
           isForwardedData);
     }
@@ -712,6 +805,12 @@ QuicServerTransport::Ptr QuicServerWorker::makeTransport(
     }
     trans->setCongestionControllerFactory(ccFactory_);
     trans->setTransportStatsCallback(statsCallback_.get()); // ok if nullptr
+    if (telemetryProducer_) {
+      if (auto fileQLogger =
+              std::dynamic_pointer_cast<FileQLogger>(trans->getQLogger())) {
+        fileQLogger->setTelemetryProducer(telemetryProducer_);
+      }
+    }
 
     auto transportSettingsCopy = transportSettings_;
     if (quicVersion == QuicVersion::MVFST_EXPERIMENTAL ||
@@ -739,6 +838,10 @@ QuicServerTransport::Ptr QuicServerWorker::makeTransport(
     trans->setTransportSettings(transportSettingsCopy);
     trans->setConnectionIdAlgo(connIdAlgo_.get());
     trans->setServerConnectionIdRejector(this);
+    trans->setTransportParametersCache(transportParametersCache_);
+    if (pendingPacketBudget_) {
+      trans->setPendingPacketBudget(pendingPacketBudget_);
+    }
     trans->setShouldRegisterKnobParamHandlerFn(
         shouldRegisterKnobParamHandlerFn_);
     if (srcConnId) {
@@ -749,6 +852,14 @@ QuicServerTransport::Ptr QuicServerWorker::makeTransport(
     trans->setServerConnectionIdParams(ServerConnectionIdParams(
         cidVersion_, hostId_, static_cast<uint8_t>(processId_), workerId_));
     trans->accept(quicVersion);
+    if (knobTuner_) {
+      auto assignment = knobTuner_->assign(client);
+      trans->applyTransportKnobParams(
+          knobTuner_->getArm(assignment.arm).knobs);
+      // A transport may reuse the address of one that was destroyed without
+      // being unbound.
+      knobTunerAssignments_.insert_or_assign(trans.get(), assignment);
+    }
     auto result = sourceAddressMap_.emplace(
         std::make_pair(std::make_pair(client, dstConnId), trans));
     CHECK(result.second);
@@ -819,7 +930,7 @@ void QuicServerWorker::dispatchPacketData(
   bool shouldFwdPacket = false;
   const auto& maybeSrcConnId = routingData.sourceConnId;
   const auto& dstConnId = routingData.destinationConnId;
-  auto cit = connectionIdMap_.find(dstConnId);
+  auto* boundTransport = findTransport(dstConnId);
 
   // if conditions satisfy, drop packet or fwd to another server
   auto handlePacketFwdOrDrop = folly::makeGuard([&]() {
@@ -888,10 +999,10 @@ void QuicServerWorker::dispatchPacketData(
     }
   };
 
-  if (cit != connectionIdMap_.end()) {
+  if (boundTransport) {
     VLOG(10) << "Found existing connection for CID=" << dstConnId.hex() << " "
-             << *cit->second.get();
-    fwdNetworkDataToTransport(cit->second.get());
+             << *boundTransport;
+    fwdNetworkDataToTransport(boundTransport);
     return;
   }
 
@@ -1020,32 +1131,38 @@ void QuicServerWorker::sendResetPacket(
     // Only send resets in response to short header packets.
     return;
   }
-  auto packetSize = networkData.getTotalData();
-  if (packetSize <= kMinStatelessPacketSize) {
-    // We must decrease the packet size to prevent reset loops. If it's already
-    // too small, we can't send one.
-    return;
+  Optional<StatelessResetToken> token;
+  // Each packet of a run gets its own reset, smaller than that packet.
+  for (const auto& packet : networkData.getPackets()) {
+    auto packetSize = packet.buf.chainLength();
+    if (packetSize <= kMinStatelessPacketSize) {
+      // We must decrease the packet size to prevent reset loops. If it's
+      // already too small, we can't send one.
+      continue;
+    }
+    auto resetSize = std::min<uint16_t>(packetSize, kDefaultMaxUDPPayload);
+    // Per the spec, less than 43 we should respond with packet size - 1.
+    if (packetSize < 43) {
+      resetSize = packetSize - 1;
+    } else {
+      resetSize = std::max<uint16_t>(
+          folly::Random::secureRand32() % resetSize, kMinStatelessPacketSize);
+    }
+    if (!token) {
+      CHECK(transportSettings_.statelessResetTokenSecret.has_value());
+      StatelessResetGenerator generator(
+          *transportSettings_.statelessResetTokenSecret,
+          getAddress().getFullyQualified());
+      token = generator.generateToken(connId);
+    }
+    StatelessResetPacketBuilder builder(resetSize, *token);
+    auto resetData = std::move(builder).buildPacket();
+    auto resetDataLen = resetData->computeChainDataLength();
+    socket_->write(client, std::move(resetData));
+    QUIC_STATS(statsCallback_, onWrite, resetDataLen);
+    QUIC_STATS(statsCallback_, onPacketSent);
+    QUIC_STATS(statsCallback_, onStatelessReset);
   }
-  auto resetSize = std::min<uint16_t>(packetSize, kDefaultMaxUDPPayload);
-  // Per the spec, less than 43 we should respond with packet size - 1.
-  if (packetSize < 43) {
-    resetSize = packetSize - 1;
-  } else {
-    resetSize = std::max<uint16_t>(
-        folly::Random::secureRand32() % resetSize, kMinStatelessPacketSize);
-  }
-  CHECK(transportSettings_.statelessResetTokenSecret.has_value());
-  StatelessResetGenerator generator(
-      *transportSettings_.statelessResetTokenSecret,
-      getAddress().getFullyQualified());
-  StatelessResetToken token = generator.generateToken(connId);
-  StatelessResetPacketBuilder builder(resetSize, token);
-  auto resetData = std::move(builder).buildPacket();
-  auto resetDataLen = resetData->computeChainDataLength();
-  socket_->write(client, std::move(resetData));
-  QUIC_STATS(statsCallback_, onWrite, resetDataLen);
-  QUIC_STATS(statsCallback_, onPacketSent);
-  QUIC_STATS(statsCallback_, onStatelessReset);
 }
 
 Optional<std::string> QuicServerWorker::maybeGetEncryptedToken(
@@ -1314,6 +1431,71 @@ void QuicServerWorker::setHealthCheckToken(
   healthCheckToken_ = BufHelpers::copyBuffer(healthCheckToken);
 }
 
+void QuicServerWorker::setConnectionObjectPoolMaxBytes(
+    uint64_t maxRetainedBytes) {
+  DCHECK(!evb_ || evb_->isInEventBaseThread());
+  connectionObjectPool_.setMaxRetainedBytes(maxRetainedBytes);
+  if (maxRetainedBytes > 0 && !shutdown_) {
+    connectionObjectPool_.makeCurrent();
+  } else {
+    connectionObjectPool_.clearCurrent();
+  }
+}
+
+ConnectionObjectPool::Stats QuicServerWorker::getConnectionObjectPoolStats()
+    const {
+  DCHECK(!evb_ || evb_->isInEventBaseThread());
+  return connectionObjectPool_.getStats();
+}
+
+void QuicServerWorker::setPlacement(
+    int cpu,
+    const WorkerPlacementPolicy& policy) {
+  DCHECK(!evb_ || evb_->isInEventBaseThread());
+  if (!pinCurrentThreadToCpu(cpu)) {
+    LOG(ERROR) << "Failed to pin workerId=" << (int)workerId_
+               << " to cpu=" << cpu;
+    return;
+  }
+  if (policy.localMemory && !preferLocalMemoryForCurrentThread()) {
+    LOG(WARNING) << "Failed to set local memory policy for workerId="
+                 << (int)workerId_;
+  }
+  placementStats_.cpu = cpu;
+  placementStats_.numaNode = getNumaNodeOfCpu(cpu).value_or(-1);
+}
+
+WorkerPlacementStats QuicServerWorker::getPlacementStats() const {
+  DCHECK(!evb_ || evb_->isInEventBaseThread());
+  return placementStats_;
+}
+
+int QuicServerWorker::getNumaNode() const noexcept {
+  return placementStats_.numaNode;
+}
+
+void QuicServerWorker::onPacketsHandedOff(
+    size_t numPackets,
+    int numaNode) noexcept {
+  DCHECK(!evb_ || evb_->isInEventBaseThread());
+  placementStats_.packetsHandedOff += numPackets;
+  if (placementStats_.numaNode >= 0 && numaNode >= 0 &&
+      placementStats_.numaNode != numaNode) {
+    placementStats_.packetsHandedOffAcrossNodes += numPackets;
+  }
+}
+
+bool QuicServerWorker::steerByReceiveCpu(const std::vector<int>& cpuOfWorker) {
+  DCHECK(!evb_ || evb_->isInEventBaseThread());
+  CHECK(socket_);
+  if (!attachReuseportCpuSteering(
+          socket_->getNetworkSocket().toFd(), cpuOfWorker)) {
+    return false;
+  }
+  placementStats_.steeredByReceiveCpu = true;
+  return true;
+}
+
 std::unique_ptr<FollyAsyncUDPSocketAlias> QuicServerWorker::makeSocket(
     folly::EventBase* evb) const {
   CHECK(socket_);
@@ -1360,8 +1542,10 @@ void QuicServerWorker::onConnectionIdAvailable(
     LOG(ERROR) << "connectionIdMap_ already has CID=" << id
                << " Is same transport: "
                << (existingTransportPtr == transportPtr);
-  } else if (boundServerTransports_.emplace(transportPtr, weakTransport)
-                 .second) {
+    return;
+  }
+  connectionIdIndex_.insert(id, transportPtr);
+  if (boundServerTransports_.emplace(transportPtr, weakTransport).second) {
     if (!isScheduled()) {
       // If we aren't currently running, start the timer.
       evb_->timer().scheduleTimeout(this, timeLoggingSamplingInterval_);
@@ -1378,6 +1562,7 @@ void QuicServerWorker::onConnectionIdRetired(
   } else {
     VLOG(4) << "Retiring CID=" << id << " " << transport;
     connectionIdMap_.erase(it);
+    connectionIdIndex_.erase(id);
   }
 }
 
@@ -1413,6 +1598,18 @@ void QuicServerWorker::onConnectionUnbound(
     }
   }
 
+  auto assignmentIt = knobTunerAssignments_.find(transport);
+  if (assignmentIt != knobTunerAssignments_.end()) {
+    auto info = transport->getTransportInfo();
+    // Connections that never sent anything say nothing about their knobs.
+    if (knobTuner_ && info.bytesSent > 0) {
+      knobTuner_->onOutcome(
+          assignmentIt->second,
+          KnobTunerOutcome::fromTransportInfo(info, Clock::now()));
+    }
+    knobTunerAssignments_.erase(assignmentIt);
+  }
+
   // Ensures we only process `onConnectionUnbound()` once.
   transport->setRoutingCallback(nullptr);
   boundServerTransports_.erase(transport);
@@ -1442,6 +1639,7 @@ void QuicServerWorker::onConnectionUnbound(
       }
     }
     connectionIdMap_.erase(connId.connId);
+    connectionIdIndex_.erase(connId.connId);
     if (incorrectTransportPtr != nullptr) {
       if (boundServerTransports_.find(incorrectTransportPtr) !=
           boundServerTransports_.end()) {
@@ -1471,6 +1669,10 @@ void QuicServerWorker::shutdownAllConnections(LocalErrorCode error) {
     return;
   }
   shutdown_ = true;
+  // Connections closed from here on free their memory to the allocator, so
+  // nothing is left pointing at the pool once the worker is gone.
+  connectionObjectPool_.setMaxRetainedBytes(0);
+  connectionObjectPool_.clearCurrent();
   if (socket_) {
     socket_->pauseRead();
   }
@@ -1503,6 +1705,7 @@ void QuicServerWorker::shutdownAllConnections(LocalErrorCode error) {
   boundServerTransports_.clear();
   sourceAddressMap_.clear();
   connectionIdMap_.clear();
+  connectionIdIndex_.clear();
   takeoverPktHandler_.stop();
   if (statsCallback_) {
     statsCallback_.reset();
@@ -1519,7 +1722,16 @@ QuicServerWorker::~QuicServerWorker() {
 
 bool QuicServerWorker::rejectConnectionId(
     const ConnectionId& candidate) const noexcept {
-  return connectionIdMap_.find(candidate) != connectionIdMap_.end();
+  return findTransport(candidate) != nullptr;
+}
+
+QuicServerTransport* QuicServerWorker::findTransport(
+    const ConnectionId& connId) const {
+  if (FlatConnectionIdTable<QuicServerTransport>::canIndex(connId)) {
+    return connectionIdIndex_.find(connId);
+  }
+  auto it = connectionIdMap_.find(connId);
+  return it != connectionIdMap_.end() ? it->second.get() : nullptr;
 }
 
 std::string QuicServerWorker::logRoutingInfo(const ConnectionId& connId) const {
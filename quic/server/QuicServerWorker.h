@@ -21,10 +21,16 @@
 #include <quic/common/BufAccessor.h>
 #include <quic/common/events/HighResQuicTimer.h>
 #include <quic/congestion_control/CongestionControllerFactory.h>
+#include <quic/logging/TelemetryExporter.h>
 #include <quic/server/QuicServerPacketRouter.h>
 #include <quic/server/QuicServerTransportFactory.h>
 #include <quic/server/QuicUDPSocketFactory.h>
 #include <quic/server/RateLimiter.h>
+#include <quic/server/TransportKnobTuner.h>
+#include <quic/server/WorkerPlacement.h>
+#include <quic/server/state/ConnectionObjectPool.h>
+#include <quic/server/state/FlatConnectionIdTable.h>
+#include <quic/server/state/PendingPacketBudget.h>
 #include <quic/server/state/ServerConnectionIdRejector.h>
 #include <quic/state/QuicConnectionStats.h>
 #include <quic/state/QuicTransportStatsCallback.h>
@@ -197,6 +203,14 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
    */
   void setShouldRegisterKnobParamHandlerFn(ShouldRegisterKnobParamHandlerFn fn);
 
+  /*
+   * Let the tuner pick the knobs of every new connection, and report each
+   * connection's outcome to it once it is unbound.
+   */
+  void setTransportKnobTuner(std::unique_ptr<TransportKnobTuner> tuner);
+
+  [[nodiscard]] TransportKnobTuner* getTransportKnobTuner() const;
+
   /**
    * Sets the listening socket
    */
@@ -344,6 +358,56 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
    */
   void setHealthCheckToken(const std::string& healthCheckToken);
 
+  /**
+   * Enable recycling of the memory of transports and connection states
+   * through this worker's pool, keeping at most maxRetainedBytes of freed
+   * blocks around for reuse. 0 disables recycling. Must be called from the
+   * worker's event base thread, on which the pool is installed.
+   */
+  void setConnectionObjectPoolMaxBytes(uint64_t maxRetainedBytes);
+
+  /**
+   * Reuse hits and retained memory of this worker's connection object pool.
+   * Must be called from the worker's event base thread.
+   */
+  [[nodiscard]] ConnectionObjectPool::Stats getConnectionObjectPoolStats()
+      const;
+
+  /**
+   * Pins the worker's event base thread to cpu and applies the rest of the
+   * placement policy. Must be called from the worker's event base thread,
+   * before its socket is set up, so that what the worker allocates from
+   * then on is on the cpu's node.
+   */
+  void setPlacement(int cpu, const WorkerPlacementPolicy& policy);
+
+  /**
+   * Where the worker runs. Must be called from the worker's event base
+   * thread.
+   */
+  [[nodiscard]] WorkerPlacementStats getPlacementStats() const;
+
+  /**
+   * NUMA node the worker is pinned to, -1 when it isn't. It's set before the
+   * worker starts reading, so it can be read from any thread after that.
+   */
+  [[nodiscard]] int getNumaNode() const noexcept;
+
+  /**
+   * Counts packets this worker received that are handed to another worker,
+   * pinned to numaNode, to be processed there. Must be called from the
+   * worker's event base thread.
+   */
+  void onPacketsHandedOff(size_t numPackets, int numaNode) noexcept;
+
+  /**
+   * Steers packets received on cpuOfWorker[i] to the i-th worker of this
+   * worker's SO_REUSEPORT group, see attachReuseportCpuSteering(). Must be
+   * called from the worker's event base thread, once every worker's socket
+   * is bound. Returns false when that isn't possible.
+   */
+  bool steerByReceiveCpu(const std::vector<int>& cpuOfWorker);
+
   /**
    * Set callback for various transport stats (such as packet received, dropped
    * etc). Since the callback is invoked very frequently and per thread, it is
@@ -358,6 +422,16 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
    */
   QuicTransportStatsCallback* getTransportStatsCallback() const noexcept;
 
+  /**
+   * Set this worker's ring to the telemetry exporter. Transports created by
+   * the worker hand their FileQLogger events to it.
+   */
+  void setTelemetryProducer(
+      std::shared_ptr<TelemetryProducer> telemetryProducer) noexcept;
+
+  [[nodiscard]] const std::shared_ptr<TelemetryProducer>&
+  getTelemetryProducer() const noexcept;
+
   /**
    * Set ConnectionIdAlgo implementation to encode and decode ConnectionId with
    * various info, such as routing related info.
@@ -601,6 +675,19 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
     return (socket_ && (socket_->getTimestamping() > 0));
   }
 
+  // Handle a udp packet together with the packets that follow it in the same
+  // read and have the same short header connection id.
+  void handleNetworkData(
+      const folly::SocketAddress& client,
+      ReceivedUdpPacket& packet,
+      std::vector<ReceivedUdpPacket>&& sameConnIdPackets,
+      bool isForwardedData) noexcept;
+
+  // Handle the segments of a GRO read.
+  void handleGroSegments(
+      const folly::SocketAddress& client,
+      std::vector<ReceivedUdpPacket>&& segments) noexcept;
+
   /**
    * Forward data to the right worker or to the takeover socket
    */
@@ -638,6 +725,9 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
 
   // A server transport's membership is exclusive to only one of these maps.
   ConnIdToTransportMap connectionIdMap_;
+  // Index of the 8 byte CIDs in connectionIdMap_, for the per packet lookup.
+  // Kept in sync with connectionIdMap_, which owns the transports.
+  FlatConnectionIdTable<QuicServerTransport> connectionIdIndex_;
   SrcToTransportMap sourceAddressMap_;
 
   folly::EvictingCacheMap<
@@ -662,6 +752,9 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
   // supports GRO. otherwise 1
   uint32_t numGROBuffers_{kDefaultNumGROBuffers};
   Optional<BufPtr> healthCheckToken_;
+  // Recycles connection object memory. Installed on the event base thread
+  // while enabled and uninstalled in shutdownAllConnections().
+  ConnectionObjectPool connectionObjectPool_;
   std::function<bool()> rejectNewConnections_{[]() { return false; }};
   std::function<bool()> isPrimingEnabled_{[]() { return false; }};
   std::function<bool(uint16_t)> isBlockListedSrcPort_{
@@ -673,6 +766,14 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
   ConnectionIdVersion cidVersion_{ConnectionIdVersion::V1};
   // QuicServerWorker maintains ownership of the info stats callback
   std::unique_ptr<QuicTransportStatsCallback> statsCallback_;
+  // Only pushed to from this worker's thread.
+  std::shared_ptr<TelemetryProducer> telemetryProducer_;
+  // Encoded transport parameters shared by the connections of this worker.
+  std::shared_ptr<ServerTransportParametersCache> transportParametersCache_{
+      std::make_shared<ServerTransportParametersCache>()};
+  // Bounds the packets the connections of this worker buffer before their
+  // keys are available, if set.
+  std::shared_ptr<PendingPacketBudget> pendingPacketBudget_;
   std::chrono::seconds timeLoggingSamplingInterval_{1};
 
   // Handle takeover between processes
@@ -691,6 +792,11 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
   // registered
   ShouldRegisterKnobParamHandlerFn shouldRegisterKnobParamHandlerFn_;
 
+  std::unique_ptr<TransportKnobTuner> knobTuner_;
+  // The tuner's arm for each connection, until the connection is unbound.
+  folly::F14FastMap<QuicServerTransport*, TransportKnobTuner::Assignment>
+      knobTunerAssignments_;
+
   // Output buffer to be used for continuous memory GSO write
   std::unique_ptr<BufAccessor> bufAccessor_;
 
@@ -738,6 +844,11 @@ class QuicServerWorker : public FollyAsyncUDPSocketAlias::ReadCallback,
   AcceptObserverList observerList_;
 
   TimePoint largestPacketReceiveTime_{TimePoint::min()};
+
+  // The transport connId is bound to, if any.
+  QuicServerTransport* findTransport(const ConnectionId& connId) const;
+
+  WorkerPlacementStats placementStats_;
 };
 
 } // namespace quic
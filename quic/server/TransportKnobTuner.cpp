@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/server/TransportKnobTuner.h>
+
+#include <folly/Random.h>
+#include <glog/logging.h>
+#include <quic/common/Optional.h>
+
+#include <cmath>
+
+namespace quic {
+
+namespace {
+
+// Index of the arm without outcomes that was assigned the least, if any.
+Optional<size_t> findUntriedArm(
+    const std::vector<TransportKnobTuner::ArmStats>& arms) {
+  Optional<size_t> untried;
+  for (size_t i = 0; i < arms.size(); i++) {
+    if (arms[i].outcomes == 0 &&
+        (!untried || arms[i].assigned < arms[*untried].assigned)) {
+      untried = i;
+    }
+  }
+  return untried;
+}
+
+size_t findBestArm(const std::vector<TransportKnobTuner::ArmStats>& arms) {
+  size_t best = 0;
+  for (size_t i = 1; i < arms.size(); i++) {
+    if (arms[i].meanReward() > arms[best].meanReward()) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+} // namespace
+
+KnobTunerOutcome KnobTunerOutcome::fromTransportInfo(
+    const TransportInfo& info,
+    TimePoint now) {
+  KnobTunerOutcome outcome;
+  // Time spent application limited says nothing about the knobs, e.g. a
+  // connection that idles until it times out.
+  auto activeTime = std::max(
+      std::chrono::duration<double>(now - info.connectionTime) -
+          std::chrono::duration<double>(info.totalAppLimitedTime),
+      std::chrono::duration<double>(info.srtt));
+  if (activeTime.count() > 0) {
+    outcome.goodputBytesPerSec =
+        info.totalNewStreamBytesSent / activeTime.count();
+  }
+  if (info.maybeMinRtt && info.maybeMinRtt->count() > 0) {
+    outcome.rttInflation = std::max(
+        1.0,
+        static_cast<double>(info.srtt.count()) / info.maybeMinRtt->count());
+  }
+  if (info.bytesSent > 0) {
+    outcome.retransmissionRate =
+        static_cast<double>(info.totalBytesRetransmitted) / info.bytesSent;
+  }
+  return outcome;
+}
+
+TransportKnobTuner::TransportKnobTuner(
+    std::vector<Arm> arms,
+    std::unique_ptr<Policy> policy)
+    : arms_(std::move(arms)),
+      policy_(std::move(policy)),
+      contextFn_([](const folly::SocketAddress& client) -> std::string {
+        return client.getFamily() == AF_INET6 ? "v6" : "v4";
+      }),
+      rewardFn_(&TransportKnobTuner::defaultReward) {
+  CHECK(!arms_.empty());
+  CHECK(policy_);
+}
+
+void TransportKnobTuner::setContextFn(ContextFn contextFn) {
+  contextFn_ = std::move(contextFn);
+}
+
+void TransportKnobTuner::setRewardFn(RewardFn rewardFn) {
+  rewardFn_ = std::move(rewardFn);
+}
+
+double TransportKnobTuner::defaultReward(const KnobTunerOutcome& outcome) {
+  return outcome.goodputBytesPerSec / std::max(1.0, outcome.rttInflation) *
+      (1.0 - std::min(1.0, outcome.retransmissionRate));
+}
+
+TransportKnobTuner::Assignment TransportKnobTuner::assign(
+    const folly::SocketAddress& client) {
+  Assignment assignment;
+  auto context = contextFn_(client);
+  auto it = contextIndices_.find(context);
+  if (it == contextIndices_.end()) {
+    it = contextIndices_.emplace(context, contextNames_.size()).first;
+    contextNames_.push_back(std::move(context));
+    contextArms_.emplace_back(arms_.size());
+  }
+  assignment.context = it->second;
+  auto& arms = contextArms_[assignment.context];
+  assignment.arm = policy_->chooseArm(arms);
+  CHECK_LT(assignment.arm, arms.size());
+  arms[assignment.arm].assigned++;
+  return assignment;
+}
+
+const TransportKnobTuner::Arm& TransportKnobTuner::getArm(size_t arm) const {
+  return arms_.at(arm);
+}
+
+const std::string& TransportKnobTuner::getContextName(size_t context) const {
+  return contextNames_.at(context);
+}
+
+void TransportKnobTuner::onOutcome(
+    const Assignment& assignment,
+    const KnobTunerOutcome& outcome) {
+  auto reward = rewardFn_(outcome);
+  if (!std::isfinite(reward)) {
+    return;
+  }
+  if (assignment.context >= contextArms_.size() ||
+      assignment.arm >= arms_.size()) {
+    return;
+  }
+  auto& stats = contextArms_[assignment.context][assignment.arm];
+  stats.outcomes++;
+  stats.rewardSum += reward;
+}
+
+TransportKnobTuner::State TransportKnobTuner::exportState() const {
+  State state;
+  for (size_t i = 0; i < contextNames_.size(); i++) {
+    state.emplace(contextNames_[i], contextArms_[i]);
+  }
+  return state;
+}
+
+void TransportKnobTuner::importState(State state) {
+  for (auto& arms : contextArms_) {
+    arms.assign(arms_.size(), ArmStats());
+  }
+  for (auto& [context, arms] : state) {
+    if (arms.size() != arms_.size()) {
+      continue;
+    }
+    auto it = contextIndices_.find(context);
+    if (it == contextIndices_.end()) {
+      it = contextIndices_.emplace(context, contextNames_.size()).first;
+      contextNames_.push_back(context);
+      contextArms_.emplace_back();
+    }
+    contextArms_[it->second] = std::move(arms);
+  }
+}
+
+size_t EpsilonGreedyKnobTunerPolicy::chooseArm(
+    const std::vector<TransportKnobTuner::ArmStats>& arms) {
+  if (auto untried = findUntriedArm(arms)) {
+    return *untried;
+  }
+  if (folly::Random::randDouble01() < epsilon_) {
+    return folly::Random::rand32(static_cast<uint32_t>(arms.size()));
+  }
+  return findBestArm(arms);
+}
+
+size_t Ucb1KnobTunerPolicy::chooseArm(
+    const std::vector<TransportKnobTuner::ArmStats>& arms) {
+  if (auto untried = findUntriedArm(arms)) {
+    return *untried;
+  }
+  uint64_t totalOutcomes = 0;
+  double scale = 0;
+  for (const auto& arm : arms) {
+    totalOutcomes += arm.outcomes;
+    scale = std::max(scale, std::abs(arm.meanReward()));
+  }
+  auto logTotal = std::log(static_cast<double>(totalOutcomes));
+  size_t best = 0;
+  double bestBound = 0;
+  for (size_t i = 0; i < arms.size(); i++) {
+    double bound = arms[i].meanReward() +
+        explorationFactor_ * scale *
+            std::sqrt(2 * logTotal / static_cast<double>(arms[i].outcomes));
+    if (i == 0 || bound > bestBound) {
+      best = i;
+      bestBound = bound;
+    }
+  }
+  return best;
+}
+
+} // namespace quic
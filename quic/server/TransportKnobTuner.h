@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/SocketAddress.h>
+#include <folly/container/F14Map.h>
+#include <quic/api/TransportInfo.h>
+#include <quic/common/TransportKnobs.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace quic {
+
+/**
+ * What a connection achieved with the knobs it was given, measured when it
+ * closes.
+ */
+struct KnobTunerOutcome {
+  // New stream bytes sent per second the connection had data to send. Time
+  // spent application limited doesn't count, and the time is at least one
+  // smoothed RTT.
+  double goodputBytesPerSec{0};
+  // Smoothed RTT over min RTT, 1 when the RTT didn't grow.
+  double rttInflation{1};
+  // Retransmitted bytes over all bytes sent.
+  double retransmissionRate{0};
+
+  // now is the close time on the transport's Clock, so that connections
+  // driven by a virtual time are measured in that time.
+  static KnobTunerOutcome fromTransportInfo(
+      const TransportInfo& info,
+      TimePoint now);
+};
+
+/**
+ * Online tuner for transport knobs. Each arm is a set of knob values that
+ * can be applied to a new connection. The tuner assigns an arm to every new
+ * connection, learns from the connection's outcome when it closes, and lets a
+ * bandit policy shift new connections towards the arms with the best reward.
+ *
+ * Arms are learned separately for every client network context, which by
+ * default is just the address family, and can be set to anything derived
+ * from the client address with setContextFn().
+ *
+ * A tuner isn't thread safe. QuicServer gives each worker its own tuner from
+ * a TransportKnobTunerFactory, so every worker learns from its own
+ * connections without synchronizing with the others.
+ */
+class TransportKnobTuner {
+ public:
+  struct Arm {
+    std::string name;
+    TransportKnobParams knobs;
+  };
+
+  struct ArmStats {
+    // Connections the arm was assigned to.
+    uint64_t assigned{0};
+    // Connections that reported an outcome.
+    uint64_t outcomes{0};
+    double rewardSum{0};
+
+    [[nodiscard]] double meanReward() const {
+      return outcomes > 0 ? rewardSum / outcomes : 0;
+    }
+  };
+
+  /**
+   * Decides which arm a new connection in a context gets, given what was
+   * learned in that context so far.
+   */
+  class Policy {
+   public:
+    virtual ~Policy() = default;
+
+    virtual size_t chooseArm(const std::vector<ArmStats>& arms) = 0;
+  };
+
+  struct Assignment {
+    // Index of the context, see getContextName().
+    size_t context{0};
+    size_t arm{0};
+  };
+
+  /**
+   * The learned state, which can be exported and loaded into another tuner
+   * with the same arms, e.g. to carry it over a restart.
+   */
+  using State = folly::F14FastMap<std::string, std::vector<ArmStats>>;
+
+  using ContextFn = std::function<std::string(const folly::SocketAddress&)>;
+  using RewardFn = std::function<double(const KnobTunerOutcome&)>;
+
+  TransportKnobTuner(std::vector<Arm> arms, std::unique_ptr<Policy> policy);
+
+  void setContextFn(ContextFn contextFn);
+
+  /**
+   * The default reward is goodput, discounted by RTT inflation and by the
+   * share of bytes that had to be retransmitted.
+   */
+  void setRewardFn(RewardFn rewardFn);
+
+  Assignment assign(const folly::SocketAddress& client);
+
+  [[nodiscard]] const Arm& getArm(size_t arm) const;
+
+  [[nodiscard]] const std::string& getContextName(size_t context) const;
+
+  void onOutcome(const Assignment& assignment, const KnobTunerOutcome& outcome);
+
+  [[nodiscard]] State exportState() const;
+
+  /**
+   * Replaces the learned state. Contexts that don't have one entry per arm
+   * are ignored. Assignments made before stay valid.
+   */
+  void importState(State state);
+
+  static double defaultReward(const KnobTunerOutcome& outcome);
+
+ private:
+  const std::vector<Arm> arms_;
+  std::unique_ptr<Policy> policy_;
+  ContextFn contextFn_;
+  RewardFn rewardFn_;
+
+  // Contexts are never removed, so that an assignment's index stays valid.
+  folly::F14FastMap<std::string, size_t> contextIndices_;
+  std::vector<std::string> contextNames_;
+  std::vector<std::vector<ArmStats>> contextArms_;
+};
+
+/**
+ * Creates the tuner of each worker.
+ */
+class TransportKnobTunerFactory {
+ public:
+  virtual ~TransportKnobTunerFactory() = default;
+
+  virtual std::unique_ptr<TransportKnobTuner> make() = 0;
+};
+
+/**
+ * Assigns a random arm with probability epsilon and the arm with the best
+ * mean reward otherwise. Arms without outcomes are tried first.
+ */
+class EpsilonGreedyKnobTunerPolicy : public TransportKnobTuner::Policy {
+ public:
+  explicit EpsilonGreedyKnobTunerPolicy(double epsilon) : epsilon_(epsilon) {}
+
+  size_t chooseArm(
+      const std::vector<TransportKnobTuner::ArmStats>& arms) override;
+
+ private:
+  const double epsilon_;
+};
+
+/**
+ * UCB1. Rewards aren't bounded, so the exploration bonus is scaled by the
+ * best mean reward so far. Arms without outcomes are tried first, least
+ * assigned first, so arms whose connections are still open aren't all piled
+ * onto.
+ */
+class Ucb1KnobTunerPolicy : public TransportKnobTuner::Policy {
+ public:
+  explicit Ucb1KnobTunerPolicy(double explorationFactor = 1.0)
+      : explorationFactor_(explorationFactor) {}
+
+  size_t chooseArm(
+      const std::vector<TransportKnobTuner::ArmStats>& arms) override;
+
+ private:
+  const double explorationFactor_;
+};
+
+} // namespace quic
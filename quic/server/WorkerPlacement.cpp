@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/server/WorkerPlacement.h>
+
+#include <folly/Conv.h>
+#include <folly/portability/Filesystem.h>
+#include <folly/portability/Sockets.h>
+
+#if defined(__linux__) && !defined(ANDROID)
+#include <linux/filter.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace quic {
+
+bool pinCurrentThreadToCpu(int cpu) {
+#if defined(__linux__) && !defined(ANDROID)
+  if (cpu < 0 || cpu >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(cpu, &cpus);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+  (void)cpu;
+  return false;
+#endif
+}
+
+bool preferLocalMemoryForCurrentThread() {
+#if defined(__linux__) && !defined(ANDROID) && defined(SYS_set_mempolicy)
+  // MPOL_LOCAL from linux/mempolicy.h, so this doesn't need libnuma.
+  constexpr int kMpolLocal = 4;
+  return syscall(SYS_set_mempolicy, kMpolLocal, nullptr, 0) == 0;
+#else
+  return false;
+#endif
+}
+
+Optional<int> getNumaNodeOfCpu(int cpu, const std::string& sysfsCpuDir) {
+  // The cpu's directory links the node it's on as nodeN.
+  auto cpuDir =
+      folly::fs::path(sysfsCpuDir) / folly::to<std::string>("cpu", cpu);
+  std::error_code ec;
+  folly::fs::directory_iterator it(cpuDir, ec);
+  if (ec) {
+    return std::nullopt;
+  }
+  for (; it != folly::fs::directory_iterator(); it.increment(ec)) {
+    if (ec) {
+      return std::nullopt;
+    }
+    auto name = it->path().filename().string();
+    if (name.rfind("node", 0) != 0) {
+      continue;
+    }
+    auto node = folly::tryTo<int>(name.substr(4));
+    if (node.hasValue()) {
+      return node.value();
+    }
+  }
+  return std::nullopt;
+}
+
+bool attachReuseportCpuSteering(int fd, const std::vector<int>& cpuOfSocket) {
+#if defined(__linux__) && !defined(ANDROID) && \
+    defined(SO_ATTACH_REUSEPORT_CBPF)
+  // A = receive cpu; for every socket: if (A == cpu) return index. Returning
+  // an index past the group's last socket falls back to the hash.
+  std::vector<sock_filter> code;
+  code.push_back(BPF_STMT(
+      BPF_LD | BPF_W | BPF_ABS,
+      static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)));
+  for (size_t i = 0; i < cpuOfSocket.size(); i++) {
+    if (cpuOfSocket[i] < 0) {
+      continue;
+    }
+    code.push_back(BPF_JUMP(
+        BPF_JMP | BPF_JEQ | BPF_K,
+        static_cast<uint32_t>(cpuOfSocket[i]),
+        0 /* jt */,
+        1 /* jf */));
+    code.push_back(BPF_STMT(BPF_RET | BPF_K, static_cast<uint32_t>(i)));
+  }
+  code.push_back(BPF_STMT(BPF_RET | BPF_K, 0xffffffff));
+  if (code.size() > BPF_MAXINSNS) {
+    return false;
+  }
+  sock_fprog prog{};
+  prog.len = static_cast<unsigned short>(code.size());
+  prog.filter = code.data();
+  return ::setsockopt(
+             fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) ==
+      0;
+#else
+  (void)fd;
+  (void)cpuOfSocket;
+  return false;
+#endif
+}
+
+} // namespace quic
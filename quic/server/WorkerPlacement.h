@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/common/Optional.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace quic {
+
+/**
+ * Where the server runs its workers. By default the workers' event base
+ * threads go wherever the scheduler puts them.
+ */
+struct WorkerPlacementPolicy {
+  // CPU of every worker, worker i runs on cpus[i % cpus.size()]. Empty
+  // leaves the workers unpinned and the rest of the policy unused.
+  std::vector<int> cpus;
+
+  // Have pinned workers allocate the memory they first touch, e.g. their
+  // read buffers and connection object pools, on their own NUMA node, even
+  // when the process' memory policy says otherwise.
+  bool localMemory{true};
+
+  // UDP SO_REUSEPORT picks a worker's socket by hashing the packet's
+  // addresses, wherever the packet was received. When set, the server
+  // attaches a reuseport BPF program that hands packets received on a
+  // worker's CPU to that worker instead, so with NIC queue IRQs spread over
+  // the workers' CPUs a packet stays on the core, and the node, it arrived
+  // on. Packets received on other CPUs are still hashed. Only applies to
+  // sockets the server binds itself, not to taken over ones.
+  bool steerByReceiveCpu{false};
+};
+
+/**
+ * Where a worker runs.
+ */
+struct WorkerPlacementStats {
+  // CPU and NUMA node the worker is pinned to, -1 when it isn't.
+  int cpu{-1};
+  int numaNode{-1};
+  // Whether packets are steered to the worker by their receive CPU.
+  bool steeredByReceiveCpu{false};
+  // Packets the worker received for connections of another worker, which
+  // were handed to that worker's thread and processed away from the CPU
+  // they were read on, e.g. when the reuseport hash didn't pick the
+  // connection's worker. Those handed to a worker on another NUMA node are
+  // also counted in packetsHandedOffAcrossNodes.
+  uint64_t packetsHandedOff{0};
+  uint64_t packetsHandedOffAcrossNodes{0};
+};
+
+/**
+ * Pins the calling thread to cpu. Returns false when that isn't possible.
+ */
+bool pinCurrentThreadToCpu(int cpu);
+
+/**
+ * Makes the calling thread allocate on the NUMA node it runs on. Returns
+ * false when that isn't possible.
+ */
+bool preferLocalMemoryForCurrentThread();
+
+/**
+ * NUMA node of the cpu, read from sysfs. Empty when it's unknown, e.g. on
+ * machines without NUMA.
+ */
+Optional<int> getNumaNodeOfCpu(
+    int cpu,
+    const std::string& sysfsCpuDir = "/sys/devices/system/cpu");
+
+/**
+ * Attaches a reuseport BPF program to the SO_REUSEPORT group of the socket,
+ * which hands a packet received on cpuOfSocket[i] to the i-th socket that
+ * joined the group. Packets received on other CPUs fall back to the hash.
+ * Returns false when that isn't possible.
+ */
+bool attachReuseportCpuSteering(int fd, const std::vector<int>& cpuOfSocket);
+
+} // namespace quic
@@ -8,6 +8,8 @@
 #pragma once
 
 #include <fizz/server/ServerExtensions.h>
+#include <fmt/format.h>
+#include <folly/io/IOBuf.h>
 #include <quic/fizz/handshake/FizzTransportParameters.h>
 #include <quic/server/handshake/StatelessResetGenerator.h>
 #include <quic/state/StateData.h>
@@ -52,6 +54,181 @@ std::vector<quic::TransportParameter> getClientDependentExtTransportParams(
 
 namespace quic {
 
+/**
+ * The transport parameters a server sends that only depend on its
+ * configuration, i.e. everything but the connection ids, the stateless reset
+ * token and the parameters negotiated with the client.
+ */
+struct ServerTransportParametersConfig {
+  uint64_t initialMaxData;
+  uint64_t initialMaxStreamDataBidiLocal;
+  uint64_t initialMaxStreamDataBidiRemote;
+  uint64_t initialMaxStreamDataUni;
+  uint64_t initialMaxStreamsBidi;
+  uint64_t initialMaxStreamsUni;
+  bool disableMigration;
+  std::chrono::milliseconds idleTimeout;
+  uint64_t ackDelayExponent;
+  uint64_t maxRecvPacketSize;
+  uint64_t activeConnectionIdLimit;
+  std::vector<TransportParameter> customTransportParameters;
+
+  bool operator==(const ServerTransportParametersConfig& rhs) const {
+    if (initialMaxData != rhs.initialMaxData ||
+        initialMaxStreamDataBidiLocal != rhs.initialMaxStreamDataBidiLocal ||
+        initialMaxStreamDataBidiRemote != rhs.initialMaxStreamDataBidiRemote ||
+        initialMaxStreamDataUni != rhs.initialMaxStreamDataUni ||
+        initialMaxStreamsBidi != rhs.initialMaxStreamsBidi ||
+        initialMaxStreamsUni != rhs.initialMaxStreamsUni ||
+        disableMigration != rhs.disableMigration ||
+        idleTimeout != rhs.idleTimeout ||
+        ackDelayExponent != rhs.ackDelayExponent ||
+        maxRecvPacketSize != rhs.maxRecvPacketSize ||
+        activeConnectionIdLimit != rhs.activeConnectionIdLimit ||
+        customTransportParameters.size() !=
+            rhs.customTransportParameters.size()) {
+      return false;
+    }
+    folly::IOBufEqualTo eq;
+    for (size_t i = 0; i < customTransportParameters.size(); i++) {
+      const auto& param = customTransportParameters[i];
+      const auto& rhsParam = rhs.customTransportParameters[i];
+      if (param.parameter != rhsParam.parameter ||
+          !eq(param.value, rhsParam.value)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Encodes the parameters, in the wire format of the transport parameters
+   * extension. Throws a FizzException if one can't be encoded.
+   */
+  [[nodiscard]] BufPtr encode() const {
+    std::vector<TransportParameter> params;
+    params.reserve(10 + customTransportParameters.size());
+    auto pushIntegerParameter =
+        [&](TransportParameterId id, uint64_t value, const char* name) {
+          auto result = encodeIntegerParameter(id, value);
+          if (result.hasError()) {
+            throw fizz::FizzException(
+                fmt::format("Failed to encode {}", name),
+                fizz::AlertDescription::internal_error);
+          }
+          params.push_back(std::move(result.value()));
+        };
+    pushIntegerParameter(
+        TransportParameterId::initial_max_stream_data_bidi_local,
+        initialMaxStreamDataBidiLocal,
+        "initial_max_stream_data_bidi_local");
+    pushIntegerParameter(
+        TransportParameterId::initial_max_stream_data_bidi_remote,
+        initialMaxStreamDataBidiRemote,
+        "initial_max_stream_data_bidi_remote");
+    pushIntegerParameter(
+        TransportParameterId::initial_max_stream_data_uni,
+        initialMaxStreamDataUni,
+        "initial_max_stream_data_uni");
+    pushIntegerParameter(
+        TransportParameterId::initial_max_data,
+        initialMaxData,
+        "initial_max_data");
+    pushIntegerParameter(
+        TransportParameterId::initial_max_streams_bidi,
+        initialMaxStreamsBidi,
+        "initial_max_streams_bidi");
+    pushIntegerParameter(
+        TransportParameterId::initial_max_streams_uni,
+        initialMaxStreamsUni,
+        "initial_max_streams_uni");
+    pushIntegerParameter(
+        TransportParameterId::idle_timeout,
+        idleTimeout.count(),
+        "idle_timeout");
+    pushIntegerParameter(
+        TransportParameterId::ack_delay_exponent,
+        ackDelayExponent,
+        "ack_delay_exponent");
+    pushIntegerParameter(
+        TransportParameterId::max_packet_size,
+        maxRecvPacketSize,
+        "max_packet_size");
+    pushIntegerParameter(
+        TransportParameterId::active_connection_id_limit,
+        activeConnectionIdLimit,
+        "active_connection_id_limit");
+    if (disableMigration) {
+      params.push_back(
+          encodeEmptyParameter(TransportParameterId::disable_migration));
+    }
+    for (const auto& customParameter : customTransportParameters) {
+      params.push_back(customParameter);
+    }
+    return encodeVarintParams(params);
+  }
+};
+
+/**
+ * Keeps the encoded configuration dependent transport parameters of the last
+ * few server configurations seen, so that a connection only has to encode
+ * its own connection ids and stateless reset token.
+ *
+ * Entries are looked up by comparing the whole configuration, so connections
+ * whose transport settings are overridden still get their own parameters.
+ * Not thread safe, each server worker owns one.
+ */
+class ServerTransportParametersCache {
+ public:
+  static constexpr size_t kMaxEntries = 4;
+
+  /**
+   * Returns the encoded parameters for the config, encoding and caching them
+   * if needed. The returned buffer shares the cached one.
+   */
+  BufPtr getEncodedParameters(const ServerTransportParametersConfig& config) {
+    for (const auto& entry : entries_) {
+      if (entry.config == config) {
+        hits_++;
+        return entry.encoded->clone();
+      }
+    }
+    misses_++;
+    Entry entry{config, config.encode()};
+    auto encoded = entry.encoded->clone();
+    if (entries_.size() < kMaxEntries) {
+      entries_.push_back(std::move(entry));
+    } else {
+      entries_[nextEvicted_] = std::move(entry);
+      nextEvicted_ = (nextEvicted_ + 1) % kMaxEntries;
+    }
+    return encoded;
+  }
+
+  [[nodiscard]] size_t size() const {
+    return entries_.size();
+  }
+
+  [[nodiscard]] uint64_t hits() const {
+    return hits_;
+  }
+
+  [[nodiscard]] uint64_t misses() const {
+    return misses_;
+  }
+
+ private:
+  struct Entry {
+    ServerTransportParametersConfig config;
+    BufPtr encoded;
+  };
+
+  std::vector<Entry> entries_;
+  size_t nextEvicted_{0};
+  uint64_t hits_{0};
+  uint64_t misses_{0};
+};
+
 class ServerTransportParametersExtension : public fizz::ServerExtensions {
  public:
   ServerTransportParametersExtension(
@@ -72,24 +249,27 @@ class ServerTransportParametersExtension : public fizz::ServerExtensions {
       ConnectionId originalDestinationCid,
       const QuicConnectionStateBase& conn,
       std::vector<TransportParameter> customTransportParameters =
-          std::vector<TransportParameter>())
+          std::vector<TransportParameter>(),
+      ServerTransportParametersCache* cache = nullptr)
       : encodingVersion_(encodingVersion),
-        initialMaxData_(initialMaxData),
-        initialMaxStreamDataBidiLocal_(initialMaxStreamDataBidiLocal),
-        initialMaxStreamDataBidiRemote_(initialMaxStreamDataBidiRemote),
-        initialMaxStreamDataUni_(initialMaxStreamDataUni),
-        initialMaxStreamsBidi_(initialMaxStreamsBidi),
-        initialMaxStreamsUni_(initialMaxStreamsUni),
-        disableMigration_(disableMigration),
-        idleTimeout_(idleTimeout),
-        ackDelayExponent_(ackDelayExponent),
-        maxRecvPacketSize_(maxRecvPacketSize),
-        activeConnectionIdLimit_(activeConnectionIdLimit),
+        config_{
+            initialMaxData,
+            initialMaxStreamDataBidiLocal,
+            initialMaxStreamDataBidiRemote,
+            initialMaxStreamDataUni,
+            initialMaxStreamsBidi,
+            initialMaxStreamsUni,
+            disableMigration,
+            idleTimeout,
+            ackDelayExponent,
+            maxRecvPacketSize,
+            activeConnectionIdLimit,
+            std::move(customTransportParameters)},
         token_(token),
         initialSourceCid_(initialSourceCid),
         originalDestinationCid_(originalDestinationCid),
-        customTransportParameters_(std::move(customTransportParameters)),
-        conn_(conn) {}
+        conn_(conn),
+        cache_(cache) {}
 
   ~ServerTransportParametersExtension() override = default;
 
@@ -108,144 +288,48 @@ class ServerTransportParametersExtension : public fizz::ServerExtensions {
 
     std::vector<fizz::Extension> exts;
 
-    ServerTransportParameters params;
-    params.parameters.reserve(10);
+    // The parameters that are specific to this connection. The rest only
+    // depend on the configuration and may come pre-encoded from the cache.
+    std::vector<TransportParameter> connParams;
+    connParams.reserve(3);
     if (encodingVersion_ == QuicVersion::QUIC_V1 ||
         encodingVersion_ == QuicVersion::QUIC_V1_ALIAS ||
         encodingVersion_ == QuicVersion::QUIC_V1_ALIAS2 ||
         encodingVersion_ == QuicVersion::MVFST_PRIMING) {
-      params.parameters.push_back(encodeConnIdParameter(
+      connParams.push_back(encodeConnIdParameter(
           TransportParameterId::original_destination_connection_id,
           originalDestinationCid_));
     }
 
-    auto bidiLocalResult = encodeIntegerParameter(
-        TransportParameterId::initial_max_stream_data_bidi_local,
-        initialMaxStreamDataBidiLocal_);
-    if (bidiLocalResult.hasError()) {
-      throw fizz::FizzException(
-          "Failed to encode initial_max_stream_data_bidi_local",
-          fizz::AlertDescription::internal_error);
-    }
-    params.parameters.push_back(std::move(bidiLocalResult.value()));
-
-    auto bidiRemoteResult = encodeIntegerParameter(
-        TransportParameterId::initial_max_stream_data_bidi_remote,
-        initialMaxStreamDataBidiRemote_);
-    if (bidiRemoteResult.hasError()) {
-      throw fizz::FizzException(
-          "Failed to encode initial_max_stream_data_bidi_remote",
-          fizz::AlertDescription::internal_error);
-    }
-    params.parameters.push_back(std::move(bidiRemoteResult.value()));
-
-    auto uniResult = encodeIntegerParameter(
-        TransportParameterId::initial_max_stream_data_uni,
-        initialMaxStreamDataUni_);
-    if (uniResult.hasError()) {
-      throw fizz::FizzException(
-          "Failed to encode initial_max_stream_data_uni",
-          fizz::AlertDescription::internal_error);
-    }
-    params.parameters.push_back(std::move(uniResult.value()));
-
-    auto maxDataResult = encodeIntegerParameter(
-        TransportParameterId::initial_max_data, initialMaxData_);
-    if (maxDataResult.hasError()) {
-      throw fizz::FizzException(
-          "Failed to encode initial_max_data",
-          fizz::AlertDescription::internal_error);
-    }
-    params.parameters.push_back(std::move(maxDataResult.value()));
-
-    auto streamsBidiResult = encodeIntegerParameter(
-        TransportParameterId::initial_max_streams_bidi, initialMaxStreamsBidi_);
-    if (streamsBidiResult.hasError()) {
-      throw fizz::FizzException(
-          "Failed to encode initial_max_streams_bidi",
-          fizz::AlertDescription::internal_error);
-    }
-    params.parameters.push_back(std::move(streamsBidiResult.value()));
-
-    auto streamsUniResult = encodeIntegerParameter(
-        TransportParameterId::initial_max_streams_uni, initialMaxStreamsUni_);
-    if (streamsUniResult.hasError()) {
-      throw fizz::FizzException(
-          "Failed to encode initial_max_streams_uni",
-          fizz::AlertDescription::internal_error);
-    }
-    params.parameters.push_back(std::move(streamsUniResult.value()));
-
-    auto idleTimeoutResult = encodeIntegerParameter(
-        TransportParameterId::idle_timeout, idleTimeout_.count());
-    if (idleTimeoutResult.hasError()) {
-      throw fizz::FizzException(
-          "Failed to encode idle_timeout",
-          fizz::AlertDescription::internal_error);
-    }
-    params.parameters.push_back(std::move(idleTimeoutResult.value()));
-
-    auto ackDelayResult = encodeIntegerParameter(
-        TransportParameterId::ack_delay_exponent, ackDelayExponent_);
-    if (ackDelayResult.hasError()) {
-      throw fizz::FizzException(
-          "Failed to encode ack_delay_exponent",
-          fizz::AlertDescription::internal_error);
-    }
-    params.parameters.push_back(std::move(ackDelayResult.value()));
-
-    auto maxPacketSizeResult = encodeIntegerParameter(
-        TransportParameterId::max_packet_size, maxRecvPacketSize_);
-    if (maxPacketSizeResult.hasError()) {
-      throw fizz::FizzException(
-          "Failed to encode max_packet_size",
-          fizz::AlertDescription::internal_error);
-    }
-    params.parameters.push_back(std::move(maxPacketSizeResult.value()));
-
-    auto activeConnLimitResult = encodeIntegerParameter(
-        TransportParameterId::active_connection_id_limit,
-        activeConnectionIdLimit_);
-    if (activeConnLimitResult.hasError()) {
-      throw fizz::FizzException(
-          "Failed to encode active_connection_id_limit",
-          fizz::AlertDescription::internal_error);
-    }
-    params.parameters.push_back(std::move(activeConnLimitResult.value()));
-
     // stateless reset token
-    params.parameters.push_back(TransportParameter(
+    connParams.push_back(TransportParameter(
         TransportParameterId::stateless_reset_token,
         BufHelpers::copyBuffer(token_)));
 
-    if (disableMigration_) {
-      params.parameters.push_back(
-          encodeEmptyParameter(TransportParameterId::disable_migration));
-    }
-
     if (encodingVersion_ == QuicVersion::QUIC_V1 ||
         encodingVersion_ == QuicVersion::QUIC_V1_ALIAS ||
         encodingVersion_ == QuicVersion::QUIC_V1_ALIAS2 ||
         encodingVersion_ == QuicVersion::MVFST_PRIMING) {
-      params.parameters.push_back(encodeConnIdParameter(
+      connParams.push_back(encodeConnIdParameter(
           TransportParameterId::initial_source_connection_id,
           initialSourceCid_));
     }
 
-    for (const auto& customParameter : customTransportParameters_) {
-      params.parameters.push_back(customParameter);
-    }
-
     // Add direct encap parameters if connection state is available
     if (clientTransportParameters_.has_value()) {
       auto additionalParams = getClientDependentExtTransportParams(
           conn_, clientTransportParameters_->parameters);
       for (const auto& param : additionalParams) {
-        params.parameters.push_back(param);
+        connParams.push_back(param);
       }
     }
 
-    exts.push_back(encodeExtension(params, encodingVersion_));
+    fizz::Extension ext;
+    ext.extension_type = getQuicTransportParametersExtention(encodingVersion_);
+    ext.extension_data =
+        cache_ ? cache_->getEncodedParameters(config_) : config_.encode();
+    ext.extension_data->appendToChain(encodeVarintParams(connParams));
+    exts.push_back(std::move(ext));
     return exts;
   }
 
@@ -255,22 +339,12 @@ class ServerTransportParametersExtension : public fizz::ServerExtensions {
 
  private:
   QuicVersion encodingVersion_;
-  uint64_t initialMaxData_;
-  uint64_t initialMaxStreamDataBidiLocal_;
-  uint64_t initialMaxStreamDataBidiRemote_;
-  uint64_t initialMaxStreamDataUni_;
-  uint64_t initialMaxStreamsBidi_;
-  uint64_t initialMaxStreamsUni_;
-  bool disableMigration_;
-  std::chrono::milliseconds idleTimeout_;
-  uint64_t ackDelayExponent_;
-  uint64_t maxRecvPacketSize_;
-  uint64_t activeConnectionIdLimit_;
+  ServerTransportParametersConfig config_;
   Optional<ClientTransportParameters> clientTransportParameters_;
   StatelessResetToken token_;
   ConnectionId initialSourceCid_;
   ConnectionId originalDestinationCid_;
-  std::vector<TransportParameter> customTransportParameters_;
   const QuicConnectionStateBase& conn_;
+  ServerTransportParametersCache* cache_;
 };
 } // namespace quic
@@ -241,4 +241,76 @@ TEST(ServerTransportParametersTest, TestMvfstFields) {
   EXPECT_FALSE(hasOriginalDestCid);
 }
 
+static std::unique_ptr<ServerTransportParametersExtension>
+makeCachedExtension(
+    const QuicServerConnectionState& conn,
+    const StatelessResetToken& token,
+    uint64_t initialMaxData,
+    ServerTransportParametersCache* cache) {
+  return std::make_unique<ServerTransportParametersExtension>(
+      QuicVersion::QUIC_V1,
+      initialMaxData,
+      kDefaultStreamFlowControlWindow,
+      kDefaultStreamFlowControlWindow,
+      kDefaultStreamFlowControlWindow,
+      std::numeric_limits<uint32_t>::max(),
+      std::numeric_limits<uint32_t>::max(),
+      /*disableMigration=*/true,
+      kDefaultIdleTimeout,
+      kDefaultAckDelayExponent,
+      kDefaultUDPSendPacketLen,
+      kDefaultActiveConnectionIdLimit,
+      token,
+      ConnectionId::createAndMaybeCrash(
+          std::vector<uint8_t>{0xff, 0xfe, 0xfd, 0xfc}),
+      ConnectionId::createAndMaybeCrash(
+          std::vector<uint8_t>{0xfb, 0xfa, 0xf9, 0xf8}),
+      conn,
+      std::vector<TransportParameter>{
+          encodeEmptyParameter(static_cast<TransportParameterId>(0x4000))},
+      cache);
+}
+
+TEST(ServerTransportParametersTest, TestCachedParametersMatchEncoded) {
+  QuicServerConnectionState conn(
+      FizzServerQuicHandshakeContext::Builder().build());
+  ServerTransportParametersCache cache;
+  auto token = generateStatelessResetToken();
+  auto getParams = [&](ServerTransportParametersCache* extCache,
+                       uint64_t initialMaxData) {
+    auto ext = makeCachedExtension(conn, token, initialMaxData, extCache);
+    auto extensions =
+        ext->getExtensions(getClientHello(QuicVersion::QUIC_V1));
+    EXPECT_EQ(extensions.size(), 1);
+    auto serverParams = getServerExtension(extensions, QuicVersion::QUIC_V1);
+    CHECK(serverParams.has_value());
+    return std::move(serverParams.value().parameters);
+  };
+  auto expectSameParams = [](const std::vector<TransportParameter>& a,
+                             const std::vector<TransportParameter>& b) {
+    ASSERT_EQ(a.size(), b.size());
+    folly::IOBufEqualTo eq;
+    for (size_t i = 0; i < a.size(); i++) {
+      EXPECT_EQ(a[i].parameter, b[i].parameter);
+      EXPECT_TRUE(eq(a[i].value, b[i].value));
+    }
+  };
+
+  auto uncached = getParams(nullptr, kDefaultConnectionFlowControlWindow);
+  auto first = getParams(&cache, kDefaultConnectionFlowControlWindow);
+  auto second = getParams(&cache, kDefaultConnectionFlowControlWindow);
+  expectSameParams(uncached, first);
+  expectSameParams(uncached, second);
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_EQ(cache.misses(), 1);
+  EXPECT_EQ(cache.hits(), 1);
+
+  // A connection with different settings gets its own entry.
+  auto overridden = getParams(&cache, kDefaultConnectionFlowControlWindow * 2);
+  expectSameParams(
+      getParams(nullptr, kDefaultConnectionFlowControlWindow * 2), overridden);
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.misses(), 2);
+}
+
 } // namespace quic::test
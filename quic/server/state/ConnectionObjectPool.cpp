@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/server/state/ConnectionObjectPool.h>
+
+#include <new>
+
+namespace quic {
+
+namespace {
+
+// The pool of the worker running on this thread. Only a pointer is thread
+// local, the pool itself is owned by the worker.
+thread_local ConnectionObjectPool* currentPool{nullptr};
+
+} // namespace
+
+void* ConnectionObjectPool::allocateCurrent(size_t size) {
+  if (currentPool) {
+    return currentPool->allocate(size);
+  }
+  return ::operator new(size);
+}
+
+void ConnectionObjectPool::deallocateCurrent(void* p, size_t size) noexcept {
+  if (currentPool) {
+    currentPool->deallocate(p, size);
+    return;
+  }
+  ::operator delete(p, size);
+}
+
+ConnectionObjectPool::~ConnectionObjectPool() {
+  clearCurrent();
+  maxRetainedBytes_ = 0;
+  releaseUntil(0);
+}
+
+void ConnectionObjectPool::makeCurrent() noexcept {
+  currentPool = this;
+}
+
+void ConnectionObjectPool::clearCurrent() noexcept {
+  if (currentPool == this) {
+    currentPool = nullptr;
+  }
+}
+
+void ConnectionObjectPool::setMaxRetainedBytes(uint64_t maxRetainedBytes) {
+  maxRetainedBytes_ = maxRetainedBytes;
+  releaseUntil(maxRetainedBytes_);
+}
+
+void* ConnectionObjectPool::allocate(size_t size) {
+  if (!enabled()) {
+    return ::operator new(size);
+  }
+  auto it = freeBlocks_.find(size);
+  if (it == freeBlocks_.end() || it->second.empty()) {
+    stats_.reuseMisses++;
+    return ::operator new(size);
+  }
+  void* p = it->second.back();
+  it->second.pop_back();
+  stats_.reuseHits++;
+  stats_.retainedBlocks--;
+  stats_.retainedBytes -= size;
+  return p;
+}
+
+void ConnectionObjectPool::deallocate(void* p, size_t size) noexcept {
+  if (!p) {
+    return;
+  }
+  if (!enabled() || stats_.retainedBytes + size > maxRetainedBytes_) {
+    ::operator delete(p, size);
+    return;
+  }
+  // Growing the free list can throw, in which case the block is released.
+  try {
+    freeBlocks_[size].push_back(p);
+  } catch (const std::bad_alloc&) {
+    ::operator delete(p, size);
+    return;
+  }
+  stats_.retainedBlocks++;
+  stats_.retainedBytes += size;
+}
+
+void ConnectionObjectPool::releaseUntil(uint64_t retainedBytes) noexcept {
+  for (auto& [size, blocks] : freeBlocks_) {
+    while (stats_.retainedBytes > retainedBytes && !blocks.empty()) {
+      ::operator delete(blocks.back(), size);
+      blocks.pop_back();
+      stats_.retainedBlocks--;
+      stats_.retainedBytes -= size;
+    }
+  }
+  if (stats_.retainedBytes == 0) {
+    freeBlocks_.clear();
+  }
+}
+
+} // namespace quic
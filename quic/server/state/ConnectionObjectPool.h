@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/mvfst-config.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace quic {
+
+/**
+ * Recycling pool for the memory of the two fixed size blocks the server
+ * allocates for every connection: QuicServerTransport and
+ * QuicServerConnectionState.
+ *
+ * Each QuicServerWorker owns one pool and installs it as the current pool of
+ * its event base thread with makeCurrent(). Connection objects are allocated
+ * through allocateCurrent()/deallocateCurrent(), which use the current pool
+ * of the calling thread, or the global allocator when there is none. When
+ * the pool is enabled, freed blocks are kept on a free list keyed by size and
+ * handed back out to the next allocation of the same size, instead of being
+ * returned to the allocator. This keeps their pages warm under high
+ * connection churn. Blocks are plain operator new memory, so an object that
+ * outlives the worker's pool is released to the allocator.
+ *
+ * The pool recycles memory, not constructed objects. A recycled connection
+ * state is constructed from scratch, so its containers don't keep their
+ * capacity from the previous connection, and the stream manager, congestion
+ * controller, pacer and codecs are allocated as usual. What it saves is the
+ * allocator round trip for the two blocks, which ConnectionObjectPoolBenchmark
+ * measures under churn. That is a small part of the cost of a connection.
+ *
+ * The pool is disabled until the worker opts in with setMaxRetainedBytes().
+ */
+class ConnectionObjectPool {
+ public:
+  struct Stats {
+    // Allocations served from a recycled block.
+    uint64_t reuseHits{0};
+    // Allocations that had to go to the allocator while enabled.
+    uint64_t reuseMisses{0};
+    // Blocks, and their total size, currently held on the free lists.
+    uint64_t retainedBlocks{0};
+    uint64_t retainedBytes{0};
+  };
+
+  /**
+   * Allocates from the calling thread's current pool, or from the global
+   * allocator if the thread has none.
+   */
+  static void* allocateCurrent(size_t size);
+
+  static void deallocateCurrent(void* p, size_t size) noexcept;
+
+  ConnectionObjectPool() = default;
+
+  ~ConnectionObjectPool();
+
+  ConnectionObjectPool(const ConnectionObjectPool&) = delete;
+  ConnectionObjectPool& operator=(const ConnectionObjectPool&) = delete;
+
+  /**
+   * Sets the upper bound on the memory kept on the free lists. 0 disables
+   * the pool and releases everything it holds.
+   */
+  void setMaxRetainedBytes(uint64_t maxRetainedBytes);
+
+  [[nodiscard]] bool enabled() const {
+    return maxRetainedBytes_ > 0;
+  }
+
+  /**
+   * Make this the current pool of the calling thread. Must be undone with
+   * clearCurrent() on the same thread before the pool is destroyed.
+   */
+  void makeCurrent() noexcept;
+
+  /**
+   * Uninstall this pool if it is the current pool of the calling thread.
+   */
+  void clearCurrent() noexcept;
+
+  void* allocate(size_t size);
+
+  void deallocate(void* p, size_t size) noexcept;
+
+  [[nodiscard]] const Stats& getStats() const {
+    return stats_;
+  }
+
+ private:
+  void releaseUntil(uint64_t retainedBytes) noexcept;
+
+  uint64_t maxRetainedBytes_{0};
+  UnorderedMap<size_t, std::vector<void*>> freeBlocks_;
+  Stats stats_;
+};
+
+/**
+ * Allocator that draws from the calling thread's current ConnectionObjectPool,
+ * for use with std::allocate_shared.
+ */
+template <class T>
+struct ConnectionObjectPoolAllocator {
+  using value_type = T;
+
+  ConnectionObjectPoolAllocator() noexcept = default;
+
+  template <class U>
+  /* implicit */ ConnectionObjectPoolAllocator(
+      const ConnectionObjectPoolAllocator<U>&) noexcept {}
+
+  T* allocate(size_t n) {
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    return static_cast<T*>(
+        ConnectionObjectPool::allocateCurrent(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, size_t n) noexcept {
+    ConnectionObjectPool::deallocateCurrent(p, n * sizeof(T));
+  }
+
+  template <class U>
+  bool operator==(const ConnectionObjectPoolAllocator<U>&) const noexcept {
+    return true;
+  }
+
+  template <class U>
+  bool operator!=(const ConnectionObjectPoolAllocator<U>&) const noexcept {
+    return false;
+  }
+};
+
+} // namespace quic
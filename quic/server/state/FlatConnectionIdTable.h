@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/Random.h>
+#include <folly/lang/Bits.h>
+#include <quic/codec/QuicConnectionId.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace quic {
+
+/**
+ * Open addressing table from the 8 byte connection ids a server issues to
+ * raw pointers of type T. It only indexes; whoever inserts keeps the values
+ * alive.
+ *
+ * Keys are stored inline as 64 bit integers and values in a parallel array,
+ * so a lookup touches one control group, one key and one value. Slots are
+ * probed a group of 16 at a time: every slot has a control byte holding 7
+ * bits of the key's hash, and a whole group is matched against the hash
+ * with one SIMD compare.
+ *
+ * The hash is a multiply-fold keyed with a random per table secret. That is
+ * much cheaper than SipHash on the full ConnectionId and it's enough here:
+ * the keys in the table are picked by the server, so a peer can't crowd
+ * them into a few groups, it can only look up ids that aren't there, and a
+ * secret hash keeps it from aiming those at the longest probe sequences.
+ */
+template <class T>
+class FlatConnectionIdTable {
+ public:
+  static constexpr size_t kKeyLength = sizeof(uint64_t);
+
+  FlatConnectionIdTable()
+      : seed0_(folly::Random::secureRandom<uint64_t>()),
+        seed1_(folly::Random::secureRandom<uint64_t>() | 1) {}
+
+  static bool canIndex(const ConnectionId& connId) {
+    return connId.size() == kKeyLength;
+  }
+
+  static uint64_t toKey(const ConnectionId& connId) {
+    uint64_t key;
+    std::memcpy(&key, connId.data(), kKeyLength);
+    return key;
+  }
+
+  [[nodiscard]] T* find(uint64_t key) const {
+    auto slot = findSlot(key, hash(key));
+    return slot == kNotFound ? nullptr : values_[slot];
+  }
+
+  [[nodiscard]] T* find(const ConnectionId& connId) const {
+    return canIndex(connId) ? find(toKey(connId)) : nullptr;
+  }
+
+  /**
+   * Returns false, and leaves the table as is, if the key is already there.
+   */
+  bool insert(uint64_t key, T* value) {
+    auto h = hash(key);
+    if (findSlot(key, h) != kNotFound) {
+      return false;
+    }
+    if (growthLeft_ == 0) {
+      rehash(size_ + 1);
+    }
+    auto slot = findFreeSlot(h);
+    if (ctrl_[slot] == kEmpty) {
+      growthLeft_--;
+    }
+    ctrl_[slot] = tagOf(h);
+    keys_[slot] = key;
+    values_[slot] = value;
+    size_++;
+    return true;
+  }
+
+  bool insert(const ConnectionId& connId, T* value) {
+    return canIndex(connId) && insert(toKey(connId), value);
+  }
+
+  bool erase(uint64_t key) {
+    auto slot = findSlot(key, hash(key));
+    if (slot == kNotFound) {
+      return false;
+    }
+    // A probe only moves past a group that had no empty slot, and a group
+    // only gets an empty slot back if it still has one. So if this group has
+    // one, no probe goes past it and the slot can be empty again. Otherwise
+    // it has to stay a tombstone.
+    const auto* group = &ctrl_[slot - slot % kGroupSize];
+    if (matchByte(group, kEmpty) != 0) {
+      ctrl_[slot] = kEmpty;
+      growthLeft_++;
+    } else {
+      ctrl_[slot] = kDeleted;
+    }
+    values_[slot] = nullptr;
+    size_--;
+    return true;
+  }
+
+  bool erase(const ConnectionId& connId) {
+    return canIndex(connId) && erase(toKey(connId));
+  }
+
+  void clear() {
+    ctrl_.clear();
+    keys_.clear();
+    values_.clear();
+    size_ = 0;
+    growthLeft_ = 0;
+  }
+
+  void reserve(size_t count) {
+    if (count > size_ + growthLeft_) {
+      rehash(count);
+    }
+  }
+
+  [[nodiscard]] size_t size() const {
+    return size_;
+  }
+
+  [[nodiscard]] bool empty() const {
+    return size_ == 0;
+  }
+
+ private:
+  static constexpr size_t kGroupSize = 16;
+  static constexpr size_t kNotFound = ~size_t(0);
+  // Free slots have the high bit set, full ones hold 7 bits of the hash.
+  static constexpr uint8_t kEmpty = 0x80;
+  static constexpr uint8_t kDeleted = 0xFE;
+
+  static uint8_t tagOf(uint64_t h) {
+    return static_cast<uint8_t>(h & 0x7F);
+  }
+
+  // Bit i is set if byte i of the group is value.
+  static uint32_t matchByte(const uint8_t* group, uint8_t value) {
+#if defined(__SSE2__)
+    auto ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    auto match = _mm_cmpeq_epi8(ctrl, _mm_set1_epi8(static_cast<char>(value)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(match));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupSize; i++) {
+      mask |= static_cast<uint32_t>(group[i] == value) << i;
+    }
+    return mask;
+#endif
+  }
+
+  // Bit i is set if slot i of the group is empty or deleted.
+  static uint32_t matchFree(const uint8_t* group) {
+#if defined(__SSE2__)
+    auto ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupSize; i++) {
+      mask |= static_cast<uint32_t>(group[i] >> 7) << i;
+    }
+    return mask;
+#endif
+  }
+
+  uint64_t hash(uint64_t key) const {
+    // High and low halves of the 128 bit product, folded.
+    uint64_t x = key ^ seed0_;
+#if defined(__SIZEOF_INT128__)
+    auto product = static_cast<unsigned __int128>(x) * seed1_;
+    return static_cast<uint64_t>(product) ^
+        static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t xLo = x & 0xFFFFFFFF, xHi = x >> 32;
+    uint64_t sLo = seed1_ & 0xFFFFFFFF, sHi = seed1_ >> 32;
+    uint64_t lolo = xLo * sLo, lohi = xLo * sHi;
+    uint64_t hilo = xHi * sLo, hihi = xHi * sHi;
+    uint64_t mid = (lolo >> 32) + (lohi & 0xFFFFFFFF) + (hilo & 0xFFFFFFFF);
+    uint64_t lo = (lolo & 0xFFFFFFFF) | (mid << 32);
+    uint64_t hi = hihi + (lohi >> 32) + (hilo >> 32) + (mid >> 32);
+    return lo ^ hi;
+#endif
+  }
+
+  size_t numGroups() const {
+    return ctrl_.size() / kGroupSize;
+  }
+
+  // Groups are visited at triangular offsets from the hash's home group,
+  // which covers all of them when their number is a power of two.
+  size_t findSlot(uint64_t key, uint64_t h) const {
+    if (ctrl_.empty()) {
+      return kNotFound;
+    }
+    auto groupMask = numGroups() - 1;
+    auto group = (h >> 7) & groupMask;
+    auto tag = tagOf(h);
+    for (size_t step = 1; step <= numGroups(); step++) {
+      const auto* ctrl = &ctrl_[group * kGroupSize];
+      for (auto match = matchByte(ctrl, tag); match != 0;
+           match &= match - 1) {
+        auto slot = group * kGroupSize + folly::findFirstSet(match) - 1;
+        if (keys_[slot] == key) {
+          return slot;
+        }
+      }
+      if (matchByte(ctrl, kEmpty) != 0) {
+        return kNotFound;
+      }
+      group = (group + step) & groupMask;
+    }
+    return kNotFound;
+  }
+
+  size_t findFreeSlot(uint64_t h) const {
+    auto groupMask = numGroups() - 1;
+    auto group = (h >> 7) & groupMask;
+    for (size_t step = 1;; step++) {
+      auto match = matchFree(&ctrl_[group * kGroupSize]);
+      if (match != 0) {
+        return group * kGroupSize + folly::findFirstSet(match) - 1;
+      }
+      group = (group + step) & groupMask;
+    }
+  }
+
+  // Rebuilds the table for at least count entries, dropping tombstones.
+  void rehash(size_t count) {
+    // Keep the load at most 7/8, and start out at most half full.
+    size_t capacity = kGroupSize;
+    while (capacity / 2 < count) {
+      capacity *= 2;
+    }
+    std::vector<uint8_t> oldCtrl(capacity, kEmpty);
+    std::vector<uint64_t> oldKeys(capacity);
+    std::vector<T*> oldValues(capacity, nullptr);
+    oldCtrl.swap(ctrl_);
+    oldKeys.swap(keys_);
+    oldValues.swap(values_);
+    growthLeft_ = capacity - capacity / 8;
+    for (size_t i = 0; i < oldCtrl.size(); i++) {
+      if (oldCtrl[i] & kEmpty) {
+        continue;
+      }
+      auto h = hash(oldKeys[i]);
+      auto slot = findFreeSlot(h);
+      ctrl_[slot] = tagOf(h);
+      keys_[slot] = oldKeys[i];
+      values_[slot] = oldValues[i];
+      growthLeft_--;
+    }
+  }
+
+  const uint64_t seed0_;
+  const uint64_t seed1_;
+  std::vector<uint8_t> ctrl_;
+  std::vector<uint64_t> keys_;
+  std::vector<T*> values_;
+  size_t size_{0};
+  // Empty slots that can still be filled before the load gets too high.
+  size_t growthLeft_{0};
+};
+
+} // namespace quic
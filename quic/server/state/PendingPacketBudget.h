@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+namespace quic {
+
+/**
+ * Bounds the number of packets the connections of one worker may hold while
+ * they wait for 0-RTT or 1-RTT keys. Every connection is still bounded by
+ * maxPacketsToBuffer on its own; this keeps a flood of handshakes from
+ * pinning maxPacketsToBuffer receive buffers each.
+ *
+ * A budget belongs to one worker and is only used on its event base.
+ */
+class PendingPacketBudget {
+ public:
+  /**
+   * The packets one connection holds against the budget. Whatever is still
+   * held is given back when the lease goes away with the connection.
+   */
+  class Lease {
+   public:
+    Lease() = default;
+
+    explicit Lease(std::shared_ptr<PendingPacketBudget> budget)
+        : budget_(std::move(budget)) {}
+
+    ~Lease() {
+      releaseAll();
+    }
+
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+
+    Lease(Lease&& other) noexcept
+        : budget_(std::move(other.budget_)), held_(other.held_) {
+      other.held_ = 0;
+    }
+
+    Lease& operator=(Lease&& other) noexcept {
+      if (this != &other) {
+        releaseAll();
+        budget_ = std::move(other.budget_);
+        held_ = other.held_;
+        other.held_ = 0;
+      }
+      return *this;
+    }
+
+    /**
+     * Takes one packet from the budget. Always succeeds without a budget.
+     */
+    bool tryAcquire() {
+      if (budget_ && budget_->inUse_ >= budget_->maxPackets_) {
+        return false;
+      }
+      if (budget_) {
+        budget_->inUse_++;
+      }
+      held_++;
+      return true;
+    }
+
+    void release(size_t numPackets) {
+      DCHECK_LE(numPackets, held_);
+      numPackets = std::min(numPackets, held_);
+      if (budget_) {
+        DCHECK_GE(budget_->inUse_, numPackets);
+        budget_->inUse_ -= numPackets;
+      }
+      held_ -= numPackets;
+    }
+
+    void releaseAll() {
+      release(held_);
+    }
+
+    [[nodiscard]] size_t held() const {
+      return held_;
+    }
+
+   private:
+    std::shared_ptr<PendingPacketBudget> budget_;
+    size_t held_{0};
+  };
+
+  explicit PendingPacketBudget(size_t maxPackets) : maxPackets_(maxPackets) {}
+
+  [[nodiscard]] size_t maxPackets() const {
+    return maxPackets_;
+  }
+
+  [[nodiscard]] size_t inUse() const {
+    return inUse_;
+  }
+
+ private:
+  const size_t maxPackets_;
+  size_t inUse_{0};
+};
+
+} // namespace quic
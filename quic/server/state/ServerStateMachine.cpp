@@ -16,6 +16,7 @@
 #include <quic/flowcontrol/QuicFlowController.h>
 #include <quic/handshake/TransportParameters.h>
 #include <quic/logging/QLoggerConstants.h>
+#include <quic/mvfst-features.h>
 #include <quic/state/DatagramHandlers.h>
 #include <quic/state/QuicPacingFunctions.h>
 #include <quic/state/QuicStreamFunctions.h>
@@ -868,6 +869,15 @@ static void handleCipherUnavailable(
       ? conn.pendingZeroRttData
       : conn.pendingOneRttData;
   if (pendingData) {
+    if (!conn.pendingPacketLease.tryAcquire()) {
+      VLOG(10) << "drop because worker max buffered " << conn;
+      if (conn.qLogger) {
+        conn.qLogger->addPacketDrop(packetSize, kMaxBuffered);
+      }
+      QUIC_STATS(
+          conn.statsCallback, onPacketDropped, PacketDropReason::MAX_BUFFERED);
+      return;
+    }
     if (conn.qLogger) {
       conn.qLogger->addPacketBuffered(originalData->protectionType, packetSize);
     }
@@ -909,6 +919,12 @@ quic::Expected<void, QuicError> onServerReadDataFromOpen(
     return {};
   }
   bool firstPacketFromPeer = false;
+  // What the worker parsed while routing the datagram, if anything. It only
+  // describes the first packet in the datagram.
+  const PacketRoutingDescriptor* routingDescriptor =
+      readData.udpPacket.routingDescriptor.longHeader
+      ? &readData.udpPacket.routingDescriptor
+      : nullptr;
   if (!conn.readCodec) {
     firstPacketFromPeer = true;
     ContiguousReadCursor cursor(
@@ -917,7 +933,9 @@ quic::Expected<void, QuicError> onServerReadDataFromOpen(
     uint8_t initialByte = 0;
     // Non-empty => at least one byte
     CHECK(cursor.tryReadBE(initialByte));
-    auto parsedLongHeader = parseLongHeaderInvariant(initialByte, cursor);
+    auto parsedLongHeader = routingDescriptor
+        ? parseLongHeaderInvariant(initialByte, cursor, *routingDescriptor)
+        : parseLongHeaderInvariant(initialByte, cursor);
     if (!parsedLongHeader) {
       VLOG(4) << "Could not parse initial packet header";
       if (conn.qLogger) {
@@ -999,7 +1017,8 @@ quic::Expected<void, QuicError> onServerReadDataFromOpen(
             conn.serverConnectionId.value(),
             initialDestinationConnectionId,
             conn,
-            customTransportParams));
+            customTransportParams,
+            conn.transportParametersCache.get()));
     conn.transportParametersEncoded = true;
     const CryptoFactory& cryptoFactory =
         conn.serverHandshakeLayer->getCryptoFactory();
@@ -1066,7 +1085,11 @@ quic::Expected<void, QuicError> onServerReadDataFromOpen(
        !udpData.empty() && processedPackets < kMaxNumCoalescedPackets;
        processedPackets++) {
     size_t dataSize = udpData.chainLength();
-    auto parsedPacket = conn.readCodec->parsePacket(udpData, conn.ackStates);
+    auto parsedPacket = conn.readCodec->parsePacket(
+        udpData,
+        conn.ackStates,
+        kDefaultConnectionIdSize,
+        processedPackets == 0 ? routingDescriptor : nullptr);
     size_t packetSize = dataSize - udpData.chainLength();
 
     switch (parsedPacket.type()) {
@@ -1198,8 +1221,11 @@ quic::Expected<void, QuicError> onServerReadDataFromOpen(
     }
 
     CHECK(conn.clientConnectionId);
-    if (conn.qLogger) {
-      conn.qLogger->addPacket(regularPacket, packetSize);
+    if (kQLogEnabled && conn.qLogger) {
+      conn.qLogger->addPacket(
+          regularPacket,
+          packetSize,
+          readData.udpPacket.timings.receiveTimePoint);
     }
 
     if (!conn.version) {
@@ -1346,6 +1372,7 @@ quic::Expected<void, QuicError> onServerReadDataFromOpen(
       }
       conn.pendingEvents.pathChallenges.emplace(
           readPath.id, PathChallengeFrame(pathChallengeDataResult.value()));
+      conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
     }
     if (conn.currentPathId != readPath.id &&
         !readPath.destinationConnectionId) {
@@ -1853,7 +1880,8 @@ quic::Expected<void, QuicError> onServerReadDataFromClosed(
   auto packetNum = regularPacket.header.getPacketSequenceNum();
   auto pnSpace = regularPacket.header.getPacketNumberSpace();
   if (conn.qLogger) {
-    conn.qLogger->addPacket(regularPacket, packetSize);
+    conn.qLogger->addPacket(
+        regularPacket, packetSize, readData.udpPacket.timings.receiveTimePoint);
   }
 
   // TODO: Should we honor a key update from the peer on a closed connection?
@@ -20,6 +20,8 @@
 #include <quic/loss/QuicLossFunctions.h>
 #include <quic/server/handshake/ServerHandshake.h>
 #include <quic/server/handshake/ServerHandshakeFactory.h>
+#include <quic/server/state/ConnectionObjectPool.h>
+#include <quic/server/state/PendingPacketBudget.h>
 #include <quic/server/state/ServerConnectionIdRejector.h>
 #include <quic/state/AckHandlers.h>
 #include <quic/state/QuicStateFunctions.h>
@@ -83,6 +85,16 @@ struct QuicServerConnectionState : public QuicConnectionStateBase {
     streamManager->clearOpenStreams();
   }
 
+  // The memory of connection states is recycled through the worker's
+  // ConnectionObjectPool when it is enabled.
+  static void* operator new(size_t size) {
+    return ConnectionObjectPool::allocateCurrent(size);
+  }
+
+  static void operator delete(void* p, size_t size) noexcept {
+    ConnectionObjectPool::deallocateCurrent(p, size);
+  }
+
   ServerState state;
 
   // Data which we cannot read yet, because the handshake has not completed.
@@ -90,6 +102,9 @@ struct QuicServerConnectionState : public QuicConnectionStateBase {
   std::unique_ptr<std::vector<ServerEvents::ReadData>> pendingZeroRttData;
   // One rtt protected packets
   std::unique_ptr<std::vector<ServerEvents::ReadData>> pendingOneRttData;
+  // The pending packets above, held against the worker's budget if it has
+  // one.
+  PendingPacketBudget::Lease pendingPacketLease;
 
   // Parameters to generate server chosen connection id
   Optional<ServerConnectionIdParams> serverConnIdParams;
@@ -101,6 +116,9 @@ struct QuicServerConnectionState : public QuicConnectionStateBase {
   // ServerConnectionIdRejector can reject a ConnectionId from ConnectionIdAlgo
   ServerConnectionIdRejector* connIdRejector{nullptr};
 
+  // The worker's cache of encoded transport parameters, if it has one.
+  std::shared_ptr<ServerTransportParametersCache> transportParametersCache;
+
   // Source address token that can be saved to client via PSK.
   // Address with higher index is more recently used.
   std::vector<folly::IPAddress> tokenSourceAddresses;
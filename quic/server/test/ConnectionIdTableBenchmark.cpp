@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <folly/container/F14Map.h>
+#include <folly/portability/GFlags.h>
+#include <quic/server/state/FlatConnectionIdTable.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace quic;
+
+/**
+ * Compares the worker's short header lookup, 8 byte server CID to
+ * transport, between the F14 map keyed by ConnectionId and
+ * FlatConnectionIdTable. Tables are built once per entry count; lookups go
+ * through a shuffled list of ids so they don't walk the tables in order.
+ */
+
+namespace {
+
+struct Transport {
+  uint64_t id;
+};
+
+struct Tables {
+  explicit Tables(size_t numEntries) : transports(numEntries) {
+    for (size_t i = 0; i < numEntries; i++) {
+      uint64_t key = folly::Random::rand64();
+      std::vector<uint8_t> bytes(sizeof(key));
+      std::memcpy(bytes.data(), &key, sizeof(key));
+      auto connId = ConnectionId::createAndMaybeCrash(bytes);
+      transports[i].id = i;
+      if (!f14.emplace(connId, &transports[i]).second) {
+        continue;
+      }
+      flat.insert(connId, &transports[i]);
+      present.push_back(connId);
+    }
+    for (size_t i = 0; i < present.size(); i++) {
+      uint64_t key = folly::Random::rand64();
+      std::vector<uint8_t> bytes(sizeof(key));
+      std::memcpy(bytes.data(), &key, sizeof(key));
+      absent.push_back(ConnectionId::createAndMaybeCrash(bytes));
+    }
+    std::shuffle(present.begin(), present.end(), folly::ThreadLocalPRNG());
+  }
+
+  std::vector<Transport> transports;
+  folly::F14FastMap<ConnectionId, Transport*, ConnectionIdHash> f14;
+  FlatConnectionIdTable<Transport> flat;
+  std::vector<ConnectionId> present;
+  std::vector<ConnectionId> absent;
+};
+
+Tables& getTables(size_t numEntries) {
+  static folly::F14FastMap<size_t, std::unique_ptr<Tables>> tables;
+  auto& entry = tables[numEntries];
+  if (!entry) {
+    entry = std::make_unique<Tables>(numEntries);
+  }
+  return *entry;
+}
+
+template <class Lookup>
+void runLookups(
+    size_t iters,
+    size_t numEntries,
+    bool hits,
+    const Lookup& lookup) {
+  const Tables* tables = nullptr;
+  BENCHMARK_SUSPEND {
+    tables = &getTables(numEntries);
+  }
+  const auto& ids = hits ? tables->present : tables->absent;
+  uint64_t sum = 0;
+  for (size_t i = 0; i < iters; i++) {
+    auto* transport = lookup(*tables, ids[i % ids.size()]);
+    sum += transport ? transport->id : 1;
+  }
+  folly::doNotOptimizeAway(sum);
+}
+
+Transport* f14Lookup(const Tables& tables, const ConnectionId& connId) {
+  auto it = tables.f14.find(connId);
+  return it == tables.f14.end() ? nullptr : it->second;
+}
+
+Transport* flatLookup(const Tables& tables, const ConnectionId& connId) {
+  return tables.flat.find(connId);
+}
+
+} // namespace
+
+void f14Map(size_t iters, size_t numEntries, bool hits) {
+  runLookups(iters, numEntries, hits, f14Lookup);
+}
+
+void flatTable(size_t iters, size_t numEntries, bool hits) {
+  runLookups(iters, numEntries, hits, flatLookup);
+}
+
+BENCHMARK_NAMED_PARAM(f14Map, hit_1k, 1000, true)
+BENCHMARK_RELATIVE_NAMED_PARAM(flatTable, hit_1k, 1000, true)
+BENCHMARK_NAMED_PARAM(f14Map, miss_1k, 1000, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(flatTable, miss_1k, 1000, false)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM(f14Map, hit_100k, 100000, true)
+BENCHMARK_RELATIVE_NAMED_PARAM(flatTable, hit_100k, 100000, true)
+BENCHMARK_NAMED_PARAM(f14Map, miss_100k, 100000, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(flatTable, miss_100k, 100000, false)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM(f14Map, hit_1m, 1000000, true)
+BENCHMARK_RELATIVE_NAMED_PARAM(flatTable, hit_1m, 1000000, true)
+BENCHMARK_NAMED_PARAM(f14Map, miss_1m, 1000000, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(flatTable, miss_1m, 1000000, false)
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
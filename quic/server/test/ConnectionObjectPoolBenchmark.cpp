@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <folly/portability/GFlags.h>
+#include <quic/server/QuicServerTransport.h>
+#include <quic/server/state/ConnectionObjectPool.h>
+#include <quic/server/state/ServerStateMachine.h>
+
+#include <iterator>
+#include <vector>
+
+using namespace quic;
+
+/**
+ * Compares the worker's connection object pool with the global allocator
+ * under connection churn. A fixed number of connections is kept live; each
+ * iteration closes a random one and accepts a new one. Every connection
+ * holds a transport and a connection state block, the two the pool serves,
+ * and a few blocks of other sizes standing in for the rest of its
+ * allocations, which always go to the allocator.
+ */
+
+namespace {
+
+constexpr size_t kTransportSize = sizeof(QuicServerTransport);
+constexpr size_t kConnStateSize = sizeof(QuicServerConnectionState);
+constexpr size_t kOtherBlockSizes[] = {48, 200, 1024, 4096};
+
+struct Connection {
+  void* transport{nullptr};
+  void* connState{nullptr};
+  void* others[std::size(kOtherBlockSizes)]{};
+};
+
+template <class Allocate>
+Connection acceptConnection(const Allocate& allocate) {
+  Connection conn;
+  conn.transport = allocate(kTransportSize);
+  for (size_t i = 0; i < std::size(kOtherBlockSizes); i++) {
+    conn.others[i] = ::operator new(kOtherBlockSizes[i]);
+    if (i == 0) {
+      conn.connState = allocate(kConnStateSize);
+    }
+  }
+  return conn;
+}
+
+template <class Deallocate>
+void closeConnection(Connection& conn, const Deallocate& deallocate) {
+  for (size_t i = 0; i < std::size(kOtherBlockSizes); i++) {
+    ::operator delete(conn.others[i], kOtherBlockSizes[i]);
+  }
+  deallocate(conn.connState, kConnStateSize);
+  deallocate(conn.transport, kTransportSize);
+}
+
+template <class Allocate, class Deallocate>
+void runChurn(
+    size_t iters,
+    size_t numLive,
+    const Allocate& allocate,
+    const Deallocate& deallocate) {
+  std::vector<Connection> live;
+  std::vector<uint32_t> victims;
+  BENCHMARK_SUSPEND {
+    live.reserve(numLive);
+    for (size_t i = 0; i < numLive; i++) {
+      live.push_back(acceptConnection(allocate));
+    }
+    victims.reserve(iters);
+    for (size_t i = 0; i < iters; i++) {
+      victims.push_back(folly::Random::rand32(numLive));
+    }
+  }
+  for (size_t i = 0; i < iters; i++) {
+    auto& conn = live[victims[i]];
+    closeConnection(conn, deallocate);
+    conn = acceptConnection(allocate);
+  }
+  BENCHMARK_SUSPEND {
+    for (auto& conn : live) {
+      closeConnection(conn, deallocate);
+    }
+  }
+}
+
+} // namespace
+
+void allocator(size_t iters, size_t numLive) {
+  runChurn(
+      iters,
+      numLive,
+      [](size_t size) { return ::operator new(size); },
+      [](void* p, size_t size) { ::operator delete(p, size); });
+}
+
+void pool(size_t iters, size_t numLive) {
+  ConnectionObjectPool connPool;
+  connPool.setMaxRetainedBytes(kTransportSize + kConnStateSize);
+  runChurn(
+      iters,
+      numLive,
+      [&](size_t size) { return connPool.allocate(size); },
+      [&](void* p, size_t size) { connPool.deallocate(p, size); });
+}
+
+BENCHMARK_NAMED_PARAM(allocator, live_1k, 1000)
+BENCHMARK_RELATIVE_NAMED_PARAM(pool, live_1k, 1000)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM(allocator, live_100k, 100000)
+BENCHMARK_RELATIVE_NAMED_PARAM(pool, live_100k, 100000)
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
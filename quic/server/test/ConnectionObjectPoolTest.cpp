@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <quic/server/state/ConnectionObjectPool.h>
+
+#include <memory>
+
+using namespace quic;
+
+namespace {
+
+struct PooledObject {
+  uint64_t payload[8]{};
+};
+
+class ConnectionObjectPoolTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    pool.clearCurrent();
+  }
+
+  ConnectionObjectPool pool;
+};
+
+} // namespace
+
+TEST_F(ConnectionObjectPoolTest, DisabledByDefault) {
+  EXPECT_FALSE(pool.enabled());
+  void* p = pool.allocate(sizeof(PooledObject));
+  pool.deallocate(p, sizeof(PooledObject));
+  EXPECT_EQ(pool.getStats().retainedBlocks, 0);
+  p = pool.allocate(sizeof(PooledObject));
+  pool.deallocate(p, sizeof(PooledObject));
+  EXPECT_EQ(pool.getStats().reuseHits, 0);
+}
+
+TEST_F(ConnectionObjectPoolTest, ReusesFreedBlocks) {
+  pool.setMaxRetainedBytes(1024);
+  void* p1 = pool.allocate(sizeof(PooledObject));
+  pool.deallocate(p1, sizeof(PooledObject));
+  EXPECT_EQ(pool.getStats().retainedBlocks, 1);
+  EXPECT_EQ(pool.getStats().retainedBytes, sizeof(PooledObject));
+
+  void* p2 = pool.allocate(sizeof(PooledObject));
+  EXPECT_EQ(p1, p2);
+  EXPECT_EQ(pool.getStats().reuseHits, 1);
+  EXPECT_EQ(pool.getStats().retainedBlocks, 0);
+  pool.deallocate(p2, sizeof(PooledObject));
+}
+
+TEST_F(ConnectionObjectPoolTest, RespectsRetainedBytesLimit) {
+  pool.setMaxRetainedBytes(sizeof(PooledObject));
+  void* p1 = pool.allocate(sizeof(PooledObject));
+  void* p2 = pool.allocate(sizeof(PooledObject));
+  pool.deallocate(p1, sizeof(PooledObject));
+  pool.deallocate(p2, sizeof(PooledObject));
+  EXPECT_EQ(pool.getStats().retainedBlocks, 1);
+
+  pool.setMaxRetainedBytes(0);
+  EXPECT_EQ(pool.getStats().retainedBlocks, 0);
+  EXPECT_EQ(pool.getStats().retainedBytes, 0);
+}
+
+TEST_F(ConnectionObjectPoolTest, AllocateSharedUsesCurrentPool) {
+  pool.setMaxRetainedBytes(1024);
+  pool.makeCurrent();
+  {
+    auto obj = std::allocate_shared<PooledObject>(
+        ConnectionObjectPoolAllocator<PooledObject>());
+  }
+  EXPECT_EQ(pool.getStats().retainedBlocks, 1);
+  auto obj = std::allocate_shared<PooledObject>(
+      ConnectionObjectPoolAllocator<PooledObject>());
+  EXPECT_EQ(pool.getStats().reuseHits, 1);
+}
+
+TEST_F(ConnectionObjectPoolTest, NoCurrentPoolUsesAllocator) {
+  pool.setMaxRetainedBytes(1024);
+  pool.makeCurrent();
+  void* p = ConnectionObjectPool::allocateCurrent(sizeof(PooledObject));
+  pool.clearCurrent();
+  // Freed after the pool was uninstalled, so it goes back to the allocator.
+  ConnectionObjectPool::deallocateCurrent(p, sizeof(PooledObject));
+  EXPECT_EQ(pool.getStats().retainedBlocks, 0);
+}
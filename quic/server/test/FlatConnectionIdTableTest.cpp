@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/server/state/FlatConnectionIdTable.h>
+
+#include <folly/Random.h>
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace quic::test {
+
+namespace {
+
+ConnectionId makeConnId(uint64_t key) {
+  std::vector<uint8_t> bytes(sizeof(key));
+  std::memcpy(bytes.data(), &key, sizeof(key));
+  return ConnectionId::createAndMaybeCrash(bytes);
+}
+
+} // namespace
+
+TEST(FlatConnectionIdTableTest, InsertFindErase) {
+  FlatConnectionIdTable<int> table;
+  int a = 1;
+  int b = 2;
+  EXPECT_EQ(table.find(makeConnId(10)), nullptr);
+  EXPECT_TRUE(table.insert(makeConnId(10), &a));
+  EXPECT_TRUE(table.insert(makeConnId(11), &b));
+  EXPECT_FALSE(table.insert(makeConnId(10), &b));
+  EXPECT_EQ(table.size(), 2);
+  EXPECT_EQ(table.find(makeConnId(10)), &a);
+  EXPECT_EQ(table.find(makeConnId(11)), &b);
+  EXPECT_EQ(table.find(makeConnId(12)), nullptr);
+
+  EXPECT_TRUE(table.erase(makeConnId(10)));
+  EXPECT_FALSE(table.erase(makeConnId(10)));
+  EXPECT_EQ(table.find(makeConnId(10)), nullptr);
+  EXPECT_EQ(table.find(makeConnId(11)), &b);
+  EXPECT_EQ(table.size(), 1);
+
+  table.clear();
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(table.find(makeConnId(11)), nullptr);
+  EXPECT_TRUE(table.insert(makeConnId(11), &a));
+  EXPECT_EQ(table.find(makeConnId(11)), &a);
+}
+
+TEST(FlatConnectionIdTableTest, OnlyIndexesServerLength) {
+  FlatConnectionIdTable<int> table;
+  int a = 1;
+  auto shortId = ConnectionId::createAndMaybeCrash({1, 2, 3, 4});
+  auto longId = ConnectionId::createAndMaybeCrash(
+      {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16});
+  EXPECT_FALSE(table.insert(shortId, &a));
+  EXPECT_FALSE(table.insert(longId, &a));
+  EXPECT_EQ(table.find(shortId), nullptr);
+  EXPECT_TRUE(table.empty());
+}
+
+TEST(FlatConnectionIdTableTest, MatchesReferenceUnderChurn) {
+  FlatConnectionIdTable<uint64_t> table;
+  std::unordered_map<uint64_t, uint64_t*> reference;
+  std::vector<uint64_t> values(4096);
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = i;
+  }
+  std::vector<uint64_t> keys;
+  for (size_t round = 0; round < 20000; round++) {
+    if (keys.empty() || !folly::Random::oneIn(3)) {
+      auto key = folly::Random::rand64();
+      auto* value = &values[round % values.size()];
+      EXPECT_EQ(table.insert(key, value), reference.emplace(key, value).second);
+      keys.push_back(key);
+    } else {
+      auto idx = folly::Random::rand32(keys.size());
+      auto key = keys[idx];
+      keys[idx] = keys.back();
+      keys.pop_back();
+      EXPECT_EQ(table.erase(key), reference.erase(key) == 1);
+    }
+  }
+  EXPECT_EQ(table.size(), reference.size());
+  for (const auto& [key, value] : reference) {
+    EXPECT_EQ(table.find(key), value);
+  }
+  for (size_t i = 0; i < 1000; i++) {
+    auto key = folly::Random::rand64();
+    if (reference.count(key) == 0) {
+      EXPECT_EQ(table.find(key), nullptr);
+    }
+  }
+}
+
+} // namespace quic::test
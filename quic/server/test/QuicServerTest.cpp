@@ -30,6 +30,10 @@
 #include <quic/server/test/Mocks.h>
 #include <quic/state/test/MockQuicStats.h>
 
+#if defined(__linux__) && !defined(ANDROID)
+#include <sched.h>
+#endif
+
 using namespace testing;
 using namespace folly;
 
@@ -429,6 +433,48 @@ TEST_F(QuicServerWorkerTest, SmallPacketTestNoReset) {
   eventbase_.loopIgnoreKeepAlive();
 }
 
+TEST_F(QuicServerWorkerTest, ResetSizedPerPacketOfRun) {
+  EXPECT_CALL(*socketPtr_, address()).WillRepeatedly(ReturnRef(fakeAddress_));
+  // A run of packets with the same connection id, as routed from one GRO
+  // read. The last one is too small to answer.
+  std::vector<size_t> packetSizes{1000, 40, 20};
+  NetworkData networkData;
+  for (auto size : packetSizes) {
+    ReceivedUdpPacket packet(folly::IOBuf::copyBuffer(std::string(size, 'a')));
+    packet.timings.receiveTimePoint = Clock::now();
+    networkData.addPacket(std::move(packet));
+  }
+  ShortHeader shortHeaderConnId(
+      ProtectionType::KeyPhaseZero, getTestConnectionId(hostId_ + 1), 2);
+
+  EXPECT_CALL(*quicStats_, onPacketDropped(_)).Times(AnyNumber());
+  EXPECT_CALL(*quicStats_, onWrite(_)).Times(2);
+  EXPECT_CALL(*quicStats_, onPacketSent()).Times(2);
+  EXPECT_CALL(*quicStats_, onStatelessReset()).Times(2);
+  std::vector<size_t> resetSizes;
+  EXPECT_CALL(*socketPtr_, write(_, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](const folly::SocketAddress&,
+                                 const std::unique_ptr<folly::IOBuf>& buf) {
+        resetSizes.push_back(buf->computeChainDataLength());
+        return buf->computeChainDataLength();
+      }));
+
+  RoutingData routingData(
+      HeaderForm::Short,
+      false,
+      false,
+      shortHeaderConnId.getConnectionId(),
+      std::nullopt);
+  worker_->dispatchPacketData(
+      kClientAddr, std::move(routingData), std::move(networkData), std::nullopt);
+  eventbase_.loopIgnoreKeepAlive();
+
+  ASSERT_EQ(resetSizes.size(), 2);
+  EXPECT_LT(resetSizes[0], packetSizes[0]);
+  EXPECT_EQ(resetSizes[1], packetSizes[1] - 1);
+}
+
 TEST_F(QuicServerWorkerTest, RateLimit) {
   worker_->setRateLimiter(
       std::make_unique<SlidingWindowRateLimiter>([]() { return 2; }, 60s));
@@ -1417,6 +1463,15 @@ TEST_F(QuicServerWorkerTest, AcceptObserverRemoveCallbackThenDestroyWorker) {
   worker_ = nullptr;
 }
 
+TEST_F(QuicServerWorkerTest, PacketsHandedOff) {
+  worker_->onPacketsHandedOff(3, 1);
+  auto stats = worker_->getPlacementStats();
+  EXPECT_EQ(stats.packetsHandedOff, 3);
+  // The worker isn't pinned, so its node is unknown.
+  EXPECT_EQ(worker_->getNumaNode(), -1);
+  EXPECT_EQ(stats.packetsHandedOffAcrossNodes, 0);
+}
+
 TEST_F(QuicServerWorkerTest, PacketWithZeroHostIdFromExistingConnection) {
   // create a connection with host id 0
   auto connId = getTestConnectionId(0);
@@ -2076,6 +2131,72 @@ TEST_F(QuicServerWorkerTakeoverTest, QuicServerTakeoverProcessForwardedPkt) {
   writeSock.release();
 }
 
+TEST_F(QuicServerWorkerTakeoverTest, LongHeaderRoutingDescriptor) {
+  ConnectionId connId = createConnIdForServer(ProcessId::ZERO),
+               clientConnId = getTestConnectionId(clientHostId_);
+  size_t len{0};
+  writeTestDataOnWorkersBuf(clientConnId, connId, len, takeoverWorker_.get());
+  auto cb = [&](const folly::SocketAddress& /* addr */,
+                std::unique_ptr<RoutingData>& /* routingData */,
+                std::unique_ptr<NetworkData>& networkData,
+                Optional<QuicVersion> /* quicVersion */,
+                bool /* isForwardedData */) {
+    ASSERT_EQ(networkData->getPackets().size(), 1);
+    const auto& descriptor = networkData->getPackets()[0].routingDescriptor;
+    EXPECT_TRUE(descriptor.longHeader);
+    EXPECT_EQ(descriptor.version, MVFST1);
+    EXPECT_EQ(descriptor.dstConnIdLength, connId.size());
+    EXPECT_EQ(descriptor.srcConnIdLength, clientConnId.size());
+  };
+  EXPECT_CALL(*takeoverWorkerCb_, routeDataToWorkerLong(_, _, _, _, _))
+      .WillOnce(Invoke(cb));
+  takeoverWorker_->onDataAvailable(
+      clientAddr, len, false, OnDataAvailableParams());
+}
+
+TEST_F(QuicServerWorkerTakeoverTest, GroSegmentsRoutedByConnectionId) {
+  DefaultConnectionIdAlgo connIdAlgo;
+  auto connId =
+      *connIdAlgo.encodeConnectionId(ServerConnectionIdParams(0, 0, 0));
+  auto otherConnId =
+      *connIdAlgo.encodeConnectionId(ServerConnectionIdParams(0, 0, 1));
+  std::vector<ConnectionId> segmentConnIds{
+      connId, connId, connId, otherConnId};
+  constexpr size_t kSegmentLen = 100;
+  uint8_t* workerBuf = nullptr;
+  size_t workerBufLen = 0;
+  takeoverWorker_->getReadBuffer((void**)&workerBuf, &workerBufLen);
+  ASSERT_GE(workerBufLen, kSegmentLen * segmentConnIds.size());
+  for (size_t i = 0; i < segmentConnIds.size(); i++) {
+    uint8_t* segment = workerBuf + i * kSegmentLen;
+    memset(segment, 0, kSegmentLen);
+    segment[0] = ShortHeader::kFixedBitMask;
+    memcpy(segment + 1, segmentConnIds[i].data(), segmentConnIds[i].size());
+  }
+
+  std::vector<std::pair<ConnectionId, size_t>> runs;
+  auto cb = [&](const folly::SocketAddress& /* addr */,
+                std::unique_ptr<RoutingData>& routingData,
+                std::unique_ptr<NetworkData>& networkData,
+                Optional<QuicVersion> /* quicVersion */,
+                bool /* isForwardedData */) {
+    runs.emplace_back(
+        routingData->destinationConnId, networkData->getPackets().size());
+  };
+  EXPECT_CALL(*takeoverWorkerCb_, routeDataToWorkerShort(_, _, _, _, _))
+      .Times(2)
+      .WillRepeatedly(Invoke(cb));
+  OnDataAvailableParams params;
+  params.gro = kSegmentLen;
+  takeoverWorker_->onDataAvailable(
+      clientAddr, kSegmentLen * segmentConnIds.size(), false, params);
+  ASSERT_EQ(runs.size(), 2);
+  EXPECT_EQ(runs[0].first, connId);
+  EXPECT_EQ(runs[0].second, 3);
+  EXPECT_EQ(runs[1].first, otherConnId);
+  EXPECT_EQ(runs[1].second, 1);
+}
+
 TEST_F(QuicServerWorkerTakeoverTest, QuicServerTakeoverCbReadClose) {
   FollyAsyncUDPSocketAlias::ReadCallback* takeoverCb =
       takeoverWorker_->getTakeoverHandlerCallback();
@@ -2432,6 +2553,111 @@ TEST_F(QuicServerTest, RouteDataFromDifferentThread) {
   t.join();
 }
 
+TEST_F(QuicServerTest, RouteDataFromDifferentThreadPastHandoffCapacity) {
+  folly::ScopedEventBaseThread evbThread;
+  std::vector<folly::EventBase*> evbs;
+  evbs.emplace_back(evbThread.getEventBase());
+  // Packets past the first may be handed over one by one while the queue is
+  // full. They must still reach the transport in the order they were routed.
+  server_->setWorkerHandoffQueueCapacity(1);
+  auto serverAddr = initializeServer(evbs);
+  auto client = makeUdpClient();
+  auto transport =
+      createNewTransport(evbThread.getEventBase(), *client, serverAddr);
+  EXPECT_CALL(*transport, setTransportStatsCallback(nullptr));
+  auto clientConnId = getTestConnectionId(clientHostId_);
+  auto serverConnId =
+      getTestConnectionId(serverHostId_, quic::ConnectionIdVersion::V2);
+  QuicVersion version = QuicVersion::MVFST;
+  LongHeader header(
+      LongHeader::Types::Initial, clientConnId, serverConnId, 1, version);
+
+  constexpr size_t kNumPackets = 5;
+  std::vector<uint8_t> received;
+  EXPECT_CALL(*transport, onNetworkData(_, _, _))
+      .Times(kNumPackets)
+      .WillRepeatedly(Invoke([&](auto, const auto& networkData, const auto&) {
+        ASSERT_EQ(networkData.getPackets().size(), 1);
+        received.push_back(*networkData.getPackets()[0].buf.front()->data());
+      }));
+
+  for (size_t i = 0; i < kNumPackets; i++) {
+    auto data = folly::IOBuf::create(kMinInitialPacketSize);
+    data->append(kMinInitialPacketSize);
+    memset(data->writableData(), static_cast<int>(i), kMinInitialPacketSize);
+    NetworkData networkData(std::move(data), Clock::now(), 0);
+    RoutingData routingData(
+        HeaderForm::Long,
+        true,
+        false,
+        header.getDestinationConnId(),
+        header.getSourceConnId());
+    static_cast<QuicServerWorker::WorkerCallback*>(server_.get())
+        ->routeDataToWorker(
+            client->address(),
+            std::move(routingData),
+            std::move(networkData),
+            version,
+            evbThread.getEventBase(),
+            /*isForwardedData=*/false);
+  }
+
+  // cleanup transport
+  transport->getEventBase()->runInEventBaseThreadAndWait(
+      [&] { transport.reset(); });
+  EXPECT_EQ(received, std::vector<uint8_t>({0, 1, 2, 3, 4}));
+  closeUdpClient(std::move(client));
+  std::thread t([&] { server_->shutdown(); });
+  t.join();
+}
+
+#if defined(__linux__) && !defined(ANDROID)
+TEST_F(QuicServerTest, WorkerPlacement) {
+  folly::ScopedEventBaseThread evbThread;
+  std::vector<folly::EventBase*> evbs;
+  evbs.emplace_back(evbThread.getEventBase());
+  // A cpu this process is allowed to run on.
+  int cpu = sched_getcpu();
+  ASSERT_GE(cpu, 0);
+  WorkerPlacementPolicy placement;
+  placement.cpus = {cpu};
+  placement.steerByReceiveCpu = true;
+  server_->setWorkerPlacementPolicy(placement);
+  initializeServer(evbs);
+
+  auto stats = server_->getWorkerPlacementStats();
+  ASSERT_EQ(stats.size(), 1);
+  EXPECT_EQ(stats[0].cpu, cpu);
+  EXPECT_TRUE(stats[0].steeredByReceiveCpu);
+  evbThread.getEventBase()->runInEventBaseThreadAndWait(
+      [&] { EXPECT_EQ(sched_getcpu(), cpu); });
+}
+#endif
+
+class DiscardingTelemetrySink : public TelemetrySink {
+ public:
+  void onRecord(TelemetryRecord /* record */) override {}
+};
+
+TEST_F(QuicServerTest, TelemetryProducerPerWorker) {
+  folly::ScopedEventBaseThread evbThread1;
+  folly::ScopedEventBaseThread evbThread2;
+  std::vector<folly::EventBase*> evbs{
+      evbThread1.getEventBase(), evbThread2.getEventBase()};
+  auto exporter = std::make_shared<TelemetryExporter>(
+      std::make_unique<DiscardingTelemetrySink>());
+  server_->setTelemetryExporter(exporter);
+  initializeServer(evbs);
+
+  auto producer1 = server_->getTelemetryProducer(evbs[0]);
+  auto producer2 = server_->getTelemetryProducer(evbs[1]);
+  ASSERT_NE(producer1, nullptr);
+  ASSERT_NE(producer2, nullptr);
+  EXPECT_NE(producer1, producer2);
+  folly::EventBase otherEvb;
+  EXPECT_EQ(server_->getTelemetryProducer(&otherEvb), nullptr);
+}
+
 TEST_F(QuicServerTest, OverrideTakeoverAddressTest) {
   folly::ScopedEventBaseThread evbThread;
   std::vector<folly::EventBase*> evbs;
@@ -275,6 +275,31 @@ TEST_F(QuicServerTransportTest, IdleTimerNotResetWhenDataOutstanding) {
   EXPECT_FALSE(server->keepaliveTimeout().isTimerCallbackScheduled());
 }
 
+TEST_F(QuicServerTransportTest, CorkFlushTimeoutSendsHeldData) {
+  server->getNonConstConn().transportSettings.corkMinFillBytes = 1000;
+  StreamId streamId = server->createBidirectionalStream().value();
+  ASSERT_FALSE(server->setStreamCorked(streamId, true).hasError());
+  auto stream = server->getNonConstConn()
+                    .streamManager->getStream(streamId)
+                    .value_or(nullptr);
+  ASSERT_NE(stream, nullptr);
+
+  ASSERT_FALSE(
+      server->writeChain(streamId, IOBuf::copyBuffer("hello"), false)
+          .hasError());
+  loopForWrites();
+  EXPECT_EQ(stream->currentWriteOffset, 0);
+  EXPECT_TRUE(server->corkFlushTimeout().isTimerCallbackScheduled());
+
+  server->corkFlushTimeout().cancelTimerCallback();
+  server->corkFlushTimeout().timeoutExpired();
+  loopForWrites();
+  EXPECT_EQ(stream->currentWriteOffset, 5);
+  EXPECT_FALSE(server->corkFlushTimeout().isTimerCallbackScheduled());
+  // The flush doesn't uncork the stream.
+  EXPECT_TRUE(stream->corked);
+}
+
 TEST_F(QuicServerTransportTest, TimeoutsNotSetAfterClose) {
   StreamId streamId = server->createBidirectionalStream().value();
 
@@ -2584,6 +2609,34 @@ TEST_F(QuicUnencryptedServerTransportTest, TestPendingOneRttData) {
   EXPECT_TRUE(server->getConn().pendingOneRttData->empty());
 }
 
+TEST_F(
+    QuicUnencryptedServerTransportTest,
+    TestPendingOneRttDataReleasedOnClose) {
+  auto budget = std::make_shared<PendingPacketBudget>(100);
+  server->setPendingPacketBudget(budget);
+  recvClientHello();
+  auto data = IOBuf::copyBuffer("bad data");
+  for (StreamId streamId : {2, 6}) {
+    auto packetData = packetToBuf(createStreamPacket(
+        *clientConnectionId,
+        *server->getConn().serverConnectionId,
+        clientNextAppDataPacketNum++,
+        streamId,
+        *data,
+        0 /* cipherOverhead */,
+        0 /* largestAcked */));
+    deliverData(std::move(packetData));
+  }
+  EXPECT_EQ(server->getConn().pendingOneRttData->size(), 2);
+  EXPECT_EQ(budget->inUse(), 2);
+
+  server->close(QuicError(
+      QuicErrorCode(TransportErrorCode::INTERNAL_ERROR),
+      std::string("how about no")));
+  EXPECT_EQ(server->getConn().pendingOneRttData, nullptr);
+  EXPECT_EQ(budget->inUse(), 0);
+}
+
 TEST_F(
     QuicUnencryptedServerTransportTest,
     TestReceiveClientFinishedFromChangedPeerAddress) {
@@ -3699,6 +3752,74 @@ TEST_P(
       server->getConn().qLogger->scid, server->getConn().serverConnectionId);
 }
 
+TEST_P(
+    QuicServerTransportPendingDataTest,
+    TestNoCipherProcessPendingOneRttDataWithWorkerBudget) {
+  auto budget = std::make_shared<PendingPacketBudget>(2);
+  server->setPendingPacketBudget(budget);
+  recvClientHello();
+  auto data = IOBuf::copyBuffer("bad data");
+  for (StreamId streamId : {2, 6, 10}) {
+    auto packetData = packetToBuf(createStreamPacket(
+        *clientConnectionId,
+        *server->getConn().serverConnectionId,
+        clientNextAppDataPacketNum++,
+        streamId,
+        *data,
+        0 /* cipherOverhead */,
+        0 /* largestAcked */,
+        std::nullopt,
+        false));
+    deliverData(std::move(packetData));
+  }
+  EXPECT_EQ(server->getConn().streamManager->streamCount(), 0);
+  EXPECT_EQ(server->getConn().pendingOneRttData->size(), 2);
+  EXPECT_EQ(budget->inUse(), 2);
+
+  EXPECT_CALL(handshakeFinishedCallback, onHandshakeFinished());
+  recvClientFinished();
+  EXPECT_EQ(server->getConn().streamManager->streamCount(), 2);
+  EXPECT_EQ(server->getConn().pendingOneRttData, nullptr);
+  EXPECT_EQ(budget->inUse(), 0);
+}
+
+TEST_P(
+    QuicServerTransportPendingDataTest,
+    TestNoCipherProcessPendingOneRttDataKeepsReceiveTimes) {
+  recvClientHello();
+  auto data = IOBuf::copyBuffer("bad data");
+  // The larger packet number arrives first.
+  auto firstPacketNum = clientNextAppDataPacketNum++;
+  auto secondPacketNum = clientNextAppDataPacketNum++;
+  auto receiveTime = Clock::now();
+  for (auto [packetNum, streamId] :
+       {std::make_pair(secondPacketNum, StreamId(2)),
+        std::make_pair(firstPacketNum, StreamId(6))}) {
+    auto packetData = packetToBuf(createStreamPacket(
+        *clientConnectionId,
+        *server->getConn().serverConnectionId,
+        packetNum,
+        streamId,
+        *data,
+        0 /* cipherOverhead */,
+        0 /* largestAcked */,
+        std::nullopt,
+        false));
+    packetData->coalesce();
+    deliverData(NetworkData(std::move(packetData), receiveTime, 0));
+    receiveTime += 10ms;
+  }
+  EXPECT_EQ(server->getConn().pendingOneRttData->size(), 2);
+
+  EXPECT_CALL(handshakeFinishedCallback, onHandshakeFinished());
+  recvClientFinished();
+  EXPECT_EQ(server->getConn().streamManager->streamCount(), 2);
+  // The largest packet keeps its own receive time rather than the batch's.
+  EXPECT_EQ(
+      server->getConn().ackStates.appDataAckState.largestRecvdPacketTime,
+      receiveTime - 20ms);
+}
+
 TEST_P(
     QuicServerTransportPendingDataTest,
     TestNoCipherProcessingZeroAndOneRttData) {
@@ -90,6 +90,10 @@ class TestingQuicServerTransport : public QuicServerTransport {
     return pathValidationTimeout_;
   }
 
+  auto& corkFlushTimeout() {
+    return corkFlushTimeout_;
+  }
+
   bool isClosed() {
     return closeState_ == CloseState::CLOSED;
   }
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <quic/server/TransportKnobTuner.h>
+
+#include <set>
+
+using namespace quic;
+
+namespace {
+
+std::vector<TransportKnobTuner::Arm> makeArms(size_t numArms) {
+  std::vector<TransportKnobTuner::Arm> arms;
+  for (size_t i = 0; i < numArms; i++) {
+    arms.push_back(
+        {"arm" + std::to_string(i),
+         {{static_cast<uint64_t>(TransportKnobParamId::CC_EXPERIMENTAL),
+           uint64_t(i)}}});
+  }
+  return arms;
+}
+
+KnobTunerOutcome goodput(double bytesPerSec) {
+  KnobTunerOutcome outcome;
+  outcome.goodputBytesPerSec = bytesPerSec;
+  return outcome;
+}
+
+const folly::SocketAddress kV4Client("1.2.3.4", 1234);
+const folly::SocketAddress kV6Client("::1", 1234);
+
+} // namespace
+
+TEST(TransportKnobTunerTest, TriesEveryArmFirst) {
+  TransportKnobTuner tuner(
+      makeArms(3), std::make_unique<Ucb1KnobTunerPolicy>());
+  std::set<size_t> assigned;
+  for (int i = 0; i < 3; i++) {
+    assigned.insert(tuner.assign(kV4Client).arm);
+  }
+  EXPECT_EQ(assigned.size(), 3);
+}
+
+TEST(TransportKnobTunerTest, ShiftsTrafficToBestArm) {
+  for (bool ucb : {false, true}) {
+    std::unique_ptr<TransportKnobTuner::Policy> policy;
+    if (ucb) {
+      policy = std::make_unique<Ucb1KnobTunerPolicy>(0.1);
+    } else {
+      policy = std::make_unique<EpsilonGreedyKnobTunerPolicy>(0.1);
+    }
+    TransportKnobTuner tuner(makeArms(3), std::move(policy));
+    std::vector<uint64_t> picks(3);
+    for (int i = 0; i < 1000; i++) {
+      auto assignment = tuner.assign(kV4Client);
+      picks[assignment.arm]++;
+      // Arm 2 has the best goodput.
+      tuner.onOutcome(assignment, goodput(100 * (assignment.arm + 1)));
+    }
+    EXPECT_GT(picks[2], picks[0] + picks[1]) << "ucb=" << ucb;
+  }
+}
+
+TEST(TransportKnobTunerTest, LearnsPerContext) {
+  TransportKnobTuner tuner(
+      makeArms(2), std::make_unique<EpsilonGreedyKnobTunerPolicy>(0));
+  for (int i = 0; i < 10; i++) {
+    auto v4 = tuner.assign(kV4Client);
+    EXPECT_EQ(tuner.getContextName(v4.context), "v4");
+    tuner.onOutcome(v4, goodput(v4.arm == 0 ? 100 : 1));
+    auto v6 = tuner.assign(kV6Client);
+    EXPECT_EQ(tuner.getContextName(v6.context), "v6");
+    tuner.onOutcome(v6, goodput(v6.arm == 1 ? 100 : 1));
+  }
+  EXPECT_EQ(tuner.assign(kV4Client).arm, 0);
+  EXPECT_EQ(tuner.assign(kV6Client).arm, 1);
+
+  tuner.setContextFn([](const folly::SocketAddress&) { return "all"; });
+  EXPECT_EQ(tuner.getContextName(tuner.assign(kV4Client).context), "all");
+}
+
+TEST(TransportKnobTunerTest, ExportAndImportState) {
+  TransportKnobTuner tuner(
+      makeArms(2), std::make_unique<EpsilonGreedyKnobTunerPolicy>(0));
+  for (int i = 0; i < 4; i++) {
+    auto assignment = tuner.assign(kV4Client);
+    tuner.onOutcome(assignment, goodput(assignment.arm == 1 ? 50 : 10));
+  }
+  auto state = tuner.exportState();
+  ASSERT_EQ(state.count("v4"), 1);
+  ASSERT_EQ(state["v4"].size(), 2);
+  EXPECT_EQ(state["v4"][0].assigned + state["v4"][1].assigned, 4);
+  EXPECT_EQ(state["v4"][1].meanReward(), 50);
+
+  TransportKnobTuner restored(
+      makeArms(2), std::make_unique<EpsilonGreedyKnobTunerPolicy>(0));
+  // Contexts that don't match the arms are dropped.
+  state["bad"].resize(3);
+  restored.importState(state);
+  auto restoredState = restored.exportState();
+  EXPECT_EQ(restoredState.count("bad"), 0);
+  EXPECT_EQ(restored.assign(kV4Client).arm, 1);
+}
+
+TEST(TransportKnobTunerTest, OutcomeAfterImportState) {
+  TransportKnobTuner tuner(
+      makeArms(2), std::make_unique<EpsilonGreedyKnobTunerPolicy>(0));
+  auto assignment = tuner.assign(kV4Client);
+  tuner.importState(TransportKnobTuner::State());
+  // The assignment still refers to the v4 context, whose stats were reset.
+  tuner.onOutcome(assignment, goodput(10));
+  auto state = tuner.exportState();
+  ASSERT_EQ(state.count("v4"), 1);
+  EXPECT_EQ(state["v4"][assignment.arm].outcomes, 1);
+  EXPECT_EQ(state["v4"][assignment.arm].assigned, 0);
+}
+
+TEST(TransportKnobTunerTest, OutcomeFromTransportInfo) {
+  TransportInfo info;
+  info.connectionTime = Clock::now();
+  info.totalNewStreamBytesSent = 2000;
+  info.srtt = std::chrono::microseconds(150);
+  info.maybeMinRtt = std::chrono::microseconds(100);
+  info.bytesSent = 1000;
+  info.totalBytesRetransmitted = 100;
+  auto outcome = KnobTunerOutcome::fromTransportInfo(
+      info, info.connectionTime + std::chrono::seconds(2));
+  EXPECT_DOUBLE_EQ(outcome.goodputBytesPerSec, 1000);
+  EXPECT_DOUBLE_EQ(outcome.rttInflation, 1.5);
+  EXPECT_DOUBLE_EQ(outcome.retransmissionRate, 0.1);
+  EXPECT_DOUBLE_EQ(
+      TransportKnobTuner::defaultReward(outcome), 1000 / 1.5 * 0.9);
+
+  // Time spent application limited doesn't count.
+  info.totalAppLimitedTime = std::chrono::seconds(1);
+  EXPECT_DOUBLE_EQ(
+      KnobTunerOutcome::fromTransportInfo(
+          info, info.connectionTime + std::chrono::seconds(2))
+          .goodputBytesPerSec,
+      2000);
+  // Nor is the time shorter than an RTT.
+  info.totalAppLimitedTime = std::chrono::seconds(2);
+  info.srtt = std::chrono::milliseconds(500);
+  EXPECT_DOUBLE_EQ(
+      KnobTunerOutcome::fromTransportInfo(
+          info, info.connectionTime + std::chrono::seconds(2))
+          .goodputBytesPerSec,
+      4000);
+}
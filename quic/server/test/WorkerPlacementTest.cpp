@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/server/WorkerPlacement.h>
+
+#include <folly/portability/Filesystem.h>
+#include <folly/portability/Sockets.h>
+#include <folly/portability/Unistd.h>
+#include <gtest/gtest.h>
+
+#if defined(__linux__) && !defined(ANDROID)
+#include <sched.h>
+#endif
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace quic::test {
+
+namespace {
+
+class WorkerPlacementTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    sysfsDir_ = folly::fs::temp_directory_path() /
+        folly::fs::unique_path("worker-placement-%%%%-%%%%");
+    folly::fs::create_directories(sysfsDir_);
+  }
+
+  void TearDown() override {
+    folly::fs::remove_all(sysfsDir_);
+  }
+
+  void addCpu(int cpu, std::vector<std::string> entries) {
+    auto cpuDir = sysfsDir_ / ("cpu" + std::to_string(cpu));
+    folly::fs::create_directories(cpuDir);
+    for (const auto& entry : entries) {
+      std::ofstream(cpuDir / entry).close();
+    }
+  }
+
+  folly::fs::path sysfsDir_;
+};
+
+} // namespace
+
+TEST_F(WorkerPlacementTest, NumaNodeOfCpu) {
+  addCpu(0, {"online", "node0"});
+  addCpu(1, {"topology", "node1", "online"});
+  addCpu(2, {"online"});
+  addCpu(3, {"nodeX"});
+
+  EXPECT_EQ(getNumaNodeOfCpu(0, sysfsDir_.string()).value_or(-1), 0);
+  EXPECT_EQ(getNumaNodeOfCpu(1, sysfsDir_.string()).value_or(-1), 1);
+  EXPECT_FALSE(getNumaNodeOfCpu(2, sysfsDir_.string()).has_value());
+  EXPECT_FALSE(getNumaNodeOfCpu(3, sysfsDir_.string()).has_value());
+  EXPECT_FALSE(getNumaNodeOfCpu(4, sysfsDir_.string()).has_value());
+}
+
+TEST_F(WorkerPlacementTest, InvalidCpu) {
+  EXPECT_FALSE(pinCurrentThreadToCpu(-1));
+}
+
+#if defined(__linux__) && !defined(ANDROID)
+TEST_F(WorkerPlacementTest, ReuseportCpuSteering) {
+  // Loopback packets are received on the sending cpu.
+  int cpu = sched_getcpu();
+  ASSERT_GE(cpu, 0);
+  ASSERT_TRUE(pinCurrentThreadToCpu(cpu));
+
+  std::vector<int> fds;
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t addrLen = sizeof(addr);
+  for (int i = 0; i < 2; i++) {
+    int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    ASSERT_GE(fd, 0);
+    fds.push_back(fd);
+    int one = 1;
+    ASSERT_EQ(
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)), 0);
+    ASSERT_EQ(::bind(fd, reinterpret_cast<sockaddr*>(&addr), addrLen), 0);
+    // The second socket joins the first one's port.
+    ASSERT_EQ(
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &addrLen), 0);
+  }
+  // Only the second socket is on a cpu, so all packets go there.
+  ASSERT_TRUE(attachReuseportCpuSteering(fds[0], {-1, cpu}));
+
+  constexpr int kNumPackets = 16;
+  for (int i = 0; i < kNumPackets; i++) {
+    // Different source ports hash to different sockets.
+    int client = ::socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(client, 0);
+    char data = 'a';
+    EXPECT_EQ(
+        ::sendto(
+            client,
+            &data,
+            sizeof(data),
+            0,
+            reinterpret_cast<sockaddr*>(&addr),
+            addrLen),
+        1);
+    ::close(client);
+  }
+
+  auto drain = [](int fd) {
+    int received = 0;
+    char data;
+    while (::recv(fd, &data, sizeof(data), 0) == 1) {
+      received++;
+    }
+    return received;
+  };
+  EXPECT_EQ(drain(fds[0]), 0);
+  EXPECT_EQ(drain(fds[1]), kNumPackets);
+  for (auto fd : fds) {
+    ::close(fd);
+  }
+}
+#endif
+
+} // namespace quic::test
@@ -603,15 +603,29 @@ void commonAckVisitorForAckFrame(
       return;
     }
 
-    for (auto recvdPacketInfoIt = ackState.recvdPacketInfos.begin();
-         recvdPacketInfoIt != ackState.recvdPacketInfos.end();) {
-      if (!ackState.acks.contains(
-              recvdPacketInfoIt->pktNum, recvdPacketInfoIt->pktNum)) {
-        recvdPacketInfoIt = ackState.recvdPacketInfos.erase(recvdPacketInfoIt);
-      } else {
-        ++recvdPacketInfoIt;
+    // Both the timestamps and the ACK intervals are sorted by packet number,
+    // so walk them together and compact the kept timestamps in place.
+    auto& recvdPacketInfos = ackState.recvdPacketInfos;
+    auto ackIt = ackState.acks.cbegin();
+    auto keepIt = recvdPacketInfos.begin();
+    for (auto recvdPacketInfoIt = recvdPacketInfos.begin();
+         recvdPacketInfoIt != recvdPacketInfos.end();
+         ++recvdPacketInfoIt) {
+      while (ackIt != ackState.acks.cend() &&
+             ackIt->end < recvdPacketInfoIt->pktNum) {
+        ++ackIt;
+      }
+      if (ackIt == ackState.acks.cend()) {
+        break;
+      }
+      if (ackIt->start <= recvdPacketInfoIt->pktNum) {
+        if (keepIt != recvdPacketInfoIt) {
+          *keepIt = std::move(*recvdPacketInfoIt);
+        }
+        ++keepIt;
       }
     }
+    recvdPacketInfos.erase(keepIt, recvdPacketInfos.end());
   };
 
   // Remove intervals when OutstandingPacket with a AckFrame is acked.
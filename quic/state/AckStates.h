@@ -11,6 +11,7 @@
 #include <quic/QuicConstants.h>
 #include <quic/codec/Types.h>
 #include <quic/common/IntervalSet.h>
+#include <quic/state/ReceivedPacketWindow.h>
 
 namespace quic {
 
@@ -24,6 +25,9 @@ struct AckState : WriteAckFrameState {
   Optional<TimePoint> largestRecvdPacketTime;
   // Largest received packet numbers on the connection.
   Optional<PacketNum> largestRecvdPacketNum;
+  // Recently received packet numbers, used to drop duplicates before they
+  // are decrypted. Only filled in with dropDuplicatePacketsBeforeDecryption.
+  ReceivedPacketWindow recvdPacketWindow;
   // Latest packet number acked by peer
   Optional<PacketNum> largestAckedByPeer;
   // Largest received packet number at the time we sent our last close message.
@@ -11,6 +11,7 @@
 #include <quic/codec/Types.h>
 #include <quic/state/ClonedPacketIdentifier.h>
 #include <quic/state/LossState.h>
+#include <algorithm>
 #include <chrono>
 
 namespace quic {
@@ -44,9 +45,10 @@ struct OutstandingPacketMetadata {
   // between this packet and the acknowleded packet when it was declared lost
   // due to reordering
   struct StreamDetails {
-    template <class T>
-    using IntervalSetVec = SmallVec<T, 1 /* stack size */>;
-    using StreamIntervals = IntervalSet<uint64_t, 1, IntervalSetVec>;
+    // Sorted disjoint ranges of the stream's data in the packet. A packet
+    // almost always carries a single range per stream, which is stored
+    // inline. Only further ranges spill to the heap.
+    using StreamIntervals = SmallVec<Interval<uint64_t>, 1 /* stack size */>;
     StreamIntervals streamIntervals;
 
     uint64_t streamBytesSent{0};
@@ -66,9 +68,10 @@ struct OutstandingPacketMetadata {
       auto& streamDetails = ret.first->second;
 
       if (frame.len) { // could be zero byte if just contains a fin
-        streamDetails.streamIntervals.insert(
-            StreamDetails::StreamIntervals::interval_type(
-                frame.offset, frame.offset + frame.len - 1));
+        addInterval(
+            streamDetails.streamIntervals,
+            frame.offset,
+            frame.offset + frame.len - 1);
       }
       streamDetails.streamBytesSent += frame.len;
       if (newData) {
@@ -96,6 +99,39 @@ struct OutstandingPacketMetadata {
     using MapType::mapped_type;
     using MapType::size;
     using MapType::value_type;
+
+   private:
+    static void addInterval(
+        StreamDetails::StreamIntervals& intervals,
+        uint64_t start,
+        uint64_t end) {
+      // Frames for a stream are usually written in order, extending the
+      // last range.
+      if (!intervals.empty() && intervals.back().start <= start &&
+          start <= intervals.back().end + 1) {
+        intervals.back().end = std::max(intervals.back().end, end);
+        return;
+      }
+      // Otherwise merge with every range the new one overlaps or touches.
+      auto first = std::lower_bound(
+          intervals.begin(),
+          intervals.end(),
+          start,
+          [](const Interval<uint64_t>& interval, uint64_t value) {
+            return interval.end + 1 < value;
+          });
+      auto last = first;
+      while (last != intervals.end() && last->start <= end + 1) {
+        ++last;
+      }
+      if (first == last) {
+        intervals.insert(first, Interval<uint64_t>(start, end));
+        return;
+      }
+      first->start = std::min(first->start, start);
+      first->end = std::max(std::prev(last)->end, end);
+      intervals.erase(std::next(first), last);
+    }
   };
 
   // Details about each stream with frames in this packet
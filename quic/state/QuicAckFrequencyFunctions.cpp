@@ -26,6 +26,7 @@ void requestPeerAckFrequencyChange(
   frame.reorderThreshold = reorderThreshold;
   frame.sequenceNumber = conn.nextAckFrequencyFrameSequenceNumber++;
   conn.pendingEvents.frames.emplace_back(frame);
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::SIMPLE_FRAME);
 }
 
 std::chrono::microseconds clampMaxAckDelay(
@@ -113,6 +113,7 @@ quic::Expected<void, QuicError> QuicPathManager::removePath(PathIdType pathId) {
   // Remove any pending path events
   conn_.pendingEvents.pathChallenges.erase(pathId);
   conn_.pendingEvents.pathResponses.erase(pathId);
+  conn_.pendingEvents.maybeClearPathValidationWrite();
 
   // Remove the path from the pending response list if present
   pathsPendingResponse_.erase(
@@ -415,6 +415,9 @@ Expected<uint64_t, IntervalSetError> addPacketToAckState(
   if (preInsertVersion == ackState.acks.insertVersion()) {
     QUIC_STATS(conn.statsCallback, onDuplicatedPacketReceived);
   }
+  if (conn.transportSettings.dropDuplicatePacketsBeforeDecryption) {
+    ackState.recvdPacketWindow.insert(packetNum);
+  }
   if (ackState.largestRecvdPacketNum == packetNum) {
     ackState.largestRecvdPacketTime = udpPacket.timings.receiveTimePoint;
   }
@@ -422,12 +425,19 @@ Expected<uint64_t, IntervalSetError> addPacketToAckState(
 
   ackState.lastRecvdPacketInfo = {packetNum, udpPacket.timings};
 
-  if (packetNum >= expectedNextPacket) {
-    if (ackState.recvdPacketInfos.size() ==
-        conn.transportSettings.maxReceiveTimestampsPerAckStored) {
-      ackState.recvdPacketInfos.pop_front();
+  const auto maxTimestampsStored =
+      conn.transportSettings.maxReceiveTimestampsPerAckStored;
+  if (packetNum >= expectedNextPacket && maxTimestampsStored > 0) {
+    auto& recvdPacketInfos = ackState.recvdPacketInfos;
+    if (recvdPacketInfos.max_size() < maxTimestampsStored) {
+      // Size the ring for all the stored timestamps up front, so that
+      // recording a timestamp never allocates.
+      recvdPacketInfos.resize(maxTimestampsStored);
+    }
+    while (recvdPacketInfos.size() >= maxTimestampsStored) {
+      recvdPacketInfos.pop_front();
     }
-    ackState.recvdPacketInfos.emplace_back(
+    recvdPacketInfos.emplace_back(
         WriteAckFrameState::ReceivedPacket{packetNum, udpPacket.timings});
   }
 
@@ -10,6 +10,7 @@
 #include <quic/QuicConstants.h>
 #include <quic/QuicException.h>
 #include <quic/flowcontrol/QuicFlowController.h>
+#include <quic/mvfst-features.h>
 
 #include <algorithm>
 
@@ -60,6 +61,14 @@ quic::Expected<void, QuicError> writeBufMetaToQuicStream(
     QuicStreamState& stream,
     const BufferMeta& data,
     bool eof) {
+#if !MVFST_ENABLE_DSR
+  (void)stream;
+  (void)data;
+  (void)eof;
+  return quic::make_unexpected(QuicError(
+      QuicErrorCode(LocalErrorCode::INTERNAL_ERROR),
+      "Buffer metas are compiled out"));
+#else
   if (data.length > 0) {
     maybeWriteBlockAfterAPIWrite(stream);
   }
@@ -86,9 +95,15 @@ quic::Expected<void, QuicError> writeBufMetaToQuicStream(
   }
   stream.conn.streamManager->updateWritableStreams(stream);
   return {};
+#endif
 }
 
 void writeDataToQuicStream(QuicCryptoStream& stream, BufPtr data) {
+  // Every frame of a flight gets an entry in the retransmission buffer, so
+  // size it for the flight instead of growing it frame by frame. Levels that
+  // are never written to don't pay for it, and it's a no-op after the first
+  // flight.
+  stream.retransmissionBuffer.reserve(kCryptoStreamReservedFrames);
   stream.pendingWrites.append(data);
   stream.writeBuffer.append(std::move(data));
 }
@@ -528,6 +543,7 @@ void appendPendingStreamReset(
       std::piecewise_construct,
       std::forward_as_tuple(stream.id),
       std::forward_as_tuple(stream.id, errorCode, finalSize, reliableSize));
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::RESET);
 }
 
 uint64_t getLargestWriteOffsetSeen(const QuicStreamState& stream) {
@@ -607,7 +623,7 @@ void processTxStopSending(QuicStreamState& stream) {
   auto& streamManager = stream.conn.streamManager;
   stream.recvState = StreamRecvState::Closed;
   stream.readBuffer.clear();
-  streamManager->readableStreams().erase(id);
+  streamManager->removeFromReadableStreams(stream);
   if (stream.inTerminalStates()) {
     streamManager->addClosed(id);
   }
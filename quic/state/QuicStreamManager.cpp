@@ -108,8 +108,8 @@ static LocalErrorCode openLocalStreamIfNotClosed(
 
 void QuicStreamManager::setWriteQueueMaxNextsPerStream(
     uint64_t maxNextsPerStream) {
-  if (oldWriteQueue_) {
-    oldWriteQueue_->setMaxNextsPerStream(maxNextsPerStream);
+  if (oldWriteQueue()) {
+    oldWriteQueue()->setMaxNextsPerStream(maxNextsPerStream);
   }
   dynamic_cast<HTTPPriorityQueue&>(writeQueue())
       .advanceAfterNext(maxNextsPerStream);
@@ -236,7 +236,7 @@ bool QuicStreamManager::consumeMaxLocalUnidirectionalStreamIdIncreased() {
 
 quic::Expected<void, LocalErrorCode> QuicStreamManager::setPriorityQueue(
     std::unique_ptr<PriorityQueue> queue) {
-  if (oldWriteQueue_) {
+  if (oldWriteQueue()) {
     LOG(ERROR) << "Cannot change priority queue when the old queue is in use";
     return quic::make_unexpected(LocalErrorCode::INTERNAL_ERROR);
   }
@@ -269,6 +269,71 @@ bool QuicStreamManager::setStreamPriority(
   return false;
 }
 
+bool QuicStreamManager::setStreamCorked(
+    StreamId id,
+    bool corked,
+    bool connFlowControlOpen) {
+  auto stream = findStream(id);
+  if (!stream) {
+    return false;
+  }
+  if (stream->corked != corked) {
+    stream->corked = corked;
+    updateWritableStreams(*stream, connFlowControlOpen);
+  }
+  return true;
+}
+
+void QuicStreamManager::setConnectionCorked(
+    bool corked,
+    bool connFlowControlOpen) {
+  if (connCorked_ == corked) {
+    return;
+  }
+  connCorked_ = corked;
+  if (corked) {
+    // Streams already in the write queue stay there. The cork applies the
+    // next time they are written to.
+    return;
+  }
+  flushCorkedStreams(connFlowControlOpen);
+}
+
+void QuicStreamManager::flushCorkedStreams(bool connFlowControlOpen) {
+  // updateWritableStreams mutates corkHeldStreams_, so iterate over a copy.
+  std::vector<StreamId> heldStreams(
+      corkHeldStreams_.begin(), corkHeldStreams_.end());
+  corkHeldStreams_.clear();
+  for (auto id : heldStreams) {
+    auto stream = findStream(id);
+    if (!stream) {
+      continue;
+    }
+    stream->corkFlushOffset =
+        stream->currentWriteOffset + stream->pendingWrites.chainLength();
+    updateWritableStreams(*stream, connFlowControlOpen);
+  }
+}
+
+bool QuicStreamManager::isHeldByCork(const QuicStreamState& stream) const {
+  if ((!stream.corked && !connCorked_) || stream.isControl) {
+    return false;
+  }
+  // Only fresh, non-DSR data without a FIN is subject to the cork. Loss data
+  // and the end of the stream are never held back.
+  if (stream.pendingWrites.empty() || stream.finalWriteOffset.has_value() ||
+      !stream.lossBuffer.empty() || stream.writeBufMeta.offset != 0) {
+    return false;
+  }
+  if (stream.currentWriteOffset < stream.corkFlushOffset) {
+    return false;
+  }
+  uint64_t fillThreshold = transportSettings_->corkMinFillBytes
+      ? transportSettings_->corkMinFillBytes
+      : conn_.udpSendPacketLen;
+  return stream.pendingWrites.chainLength() < fillThreshold;
+}
+
 quic::Expected<void, QuicError> QuicStreamManager::refreshTransportSettings(
     const TransportSettings& settings) {
   transportSettings_ = &settings;
@@ -295,6 +360,7 @@ quic::Expected<void, QuicError> QuicStreamManager::refreshTransportSettings(
 
 quic::Expected<void, QuicError> QuicStreamManager::updatePriorityQueueImpl(
     bool useNewPriorityQueue) {
+#if MVFST_ENABLE_DEPRECATED_PRIORITY_QUEUE
   if (!useNewPriorityQueue && !oldWriteQueue_) {
     if (writeQueue_->empty() && connFlowControlBlocked_.empty()) {
       oldWriteQueue_ = std::make_unique<deprecated::PriorityQueue>();
@@ -312,6 +378,10 @@ quic::Expected<void, QuicError> QuicStreamManager::updatePriorityQueueImpl(
           "Cannot change to new priority queue when the queue is not empty"));
     }
   } // else no change
+#else
+  // Streams always use the new PriorityQueue.
+  (void)useNewPriorityQueue;
+#endif
 
   return {};
 }
@@ -499,6 +569,9 @@ quic::Expected<StreamGroupId, LocalErrorCode>
 QuicStreamManager::createNextStreamGroup(
     StreamGroupId& groupId,
     StreamIdSet& streamGroups) {
+  if constexpr (!kStreamGroupsEnabled) {
+    return quic::make_unexpected(LocalErrorCode::STREAM_LIMIT_EXCEEDED);
+  }
   auto maxLocalStreamGroupId = std::min(
       transportSettings_->advertisedMaxStreamGroups *
           detail::kStreamGroupIncrement,
@@ -773,13 +846,11 @@ quic::Expected<void, QuicError> QuicStreamManager::removeClosedStream(
   // Clear from various tracking sets
   if (conn_.pendingEvents.resets.contains(streamId)) {
     conn_.pendingEvents.resets.erase(streamId);
+    if (conn_.pendingEvents.resets.empty()) {
+      conn_.pendingEvents.clearPendingWrite(PendingWriteReason::RESET);
+    }
   }
-  if (conn_.transportSettings.unidirectionalStreamsReadCallbacksFirst &&
-      isUnidirectionalStream(streamId)) {
-    unidirectionalReadableStreams_.erase(streamId);
-  } else {
-    readableStreams_.erase(streamId);
-  }
+  removeFromReadableStreams(it->second);
   peekableStreams_.erase(streamId);
   removeWritable(it->second); // Also removes from loss sets and write queue
   blockedStreams_.erase(streamId);
@@ -863,6 +934,9 @@ void QuicStreamManager::addToReadableStreams(const QuicStreamState& stream) {
   } else {
     readableStreams_.emplace(stream.id);
   }
+  if (stream.readWaiter && !stream.readWaiter->readyHook_.is_linked()) {
+    readyReadWaiters_.push_back(*stream.readWaiter);
+  }
 }
 
 void QuicStreamManager::removeFromReadableStreams(
@@ -873,6 +947,17 @@ void QuicStreamManager::removeFromReadableStreams(
   } else {
     readableStreams_.erase(stream.id);
   }
+  if (stream.readWaiter) {
+    stream.readWaiter->readyHook_.unlink();
+  }
+}
+
+void QuicStreamManager::queueReadyReadWaiter(const QuicStreamState& stream) {
+  if (stream.readWaiter && !stream.readWaiter->readyHook_.is_linked() &&
+      (readableStreams_.count(stream.id) ||
+       unidirectionalReadableStreams_.count(stream.id))) {
+    readyReadWaiters_.push_back(*stream.readWaiter);
+  }
 }
 
 void QuicStreamManager::updateReadableStreams(QuicStreamState& stream) {
@@ -898,12 +983,28 @@ void QuicStreamManager::updateWritableStreams(
   // Check if paused
   // pausedButDisabled adds a hard dep on writeQueue being an HTTPPriorityQueue.
   auto httpPri = HTTPPriorityQueue::Priority(stream.priority);
-  if (oldWriteQueue_ && httpPri->paused &&
+  if (oldWriteQueue() && httpPri->paused &&
       !transportSettings_->disablePausedPriority) {
     removeWritable(stream);
     return;
   }
 
+  // Check if the data is held back by a cork
+  if (isHeldByCork(stream)) {
+    removeWritable(stream);
+    corkHeldStreams_.insert(stream.id);
+    return;
+  }
+  corkHeldStreams_.erase(stream.id);
+  if ((stream.corked || connCorked_) && !stream.pendingWrites.empty() &&
+      stream.currentWriteOffset >= stream.corkFlushOffset) {
+    // The cork let go of the data. Everything buffered right now goes out,
+    // so a short tail left after the full packets doesn't wait for the cork
+    // deadline.
+    stream.corkFlushOffset =
+        stream.currentWriteOffset + stream.pendingWrites.chainLength();
+  }
+
   // Update writable/loss sets based on data/meta presence
   if (stream.hasWritableData()) {
     writableStreams_.emplace(stream.id);
@@ -927,19 +1028,19 @@ void QuicStreamManager::updateWritableStreams(
   }
 
   // Update the actual scheduling queues (PriorityQueue or control set)
-  connFlowControlOpen |= bool(oldWriteQueue_);
+  connFlowControlOpen |= bool(oldWriteQueue());
   if (stream.hasSchedulableData(connFlowControlOpen) ||
       stream.hasSchedulableDsr(connFlowControlOpen)) {
     if (stream.isControl) {
       controlWriteQueue_.emplace(stream.id);
     } else {
-      if (oldWriteQueue_) {
+      if (oldWriteQueue()) {
         const static deprecated::Priority kPausedDisabledPriority(7, true);
         auto oldPri = httpPri->paused
             ? kPausedDisabledPriority
             : deprecated::Priority(
                   httpPri->urgency, httpPri->incremental, httpPri->order);
-        oldWriteQueue_->insertOrUpdate(stream.id, oldPri);
+        oldWriteQueue()->insertOrUpdate(stream.id, oldPri);
       } else {
         const static PriorityQueue::Priority kPausedDisabledPriority(
             HTTPPriorityQueue::Priority(7, true));
@@ -955,8 +1056,8 @@ void QuicStreamManager::updateWritableStreams(
     if (stream.isControl) {
       controlWriteQueue_.erase(stream.id);
     } else {
-      if (oldWriteQueue_) {
-        oldWriteQueue_->erase(stream.id);
+      if (oldWriteQueue()) {
+        oldWriteQueue()->erase(stream.id);
       } else {
         writeQueue().erase(PriorityQueue::Identifier::fromStreamID(stream.id));
       }
@@ -12,10 +12,14 @@
 #include <quic/QuicConstants.h>
 #include <quic/codec/Types.h>
 #include <quic/common/Expected.h>
+#include <quic/mvfst-features.h>
 #include <quic/priority/PriorityQueue.h>
 #include <quic/state/QuicPriorityQueue.h>
+#include <quic/state/QuicStreamWaiter.h>
 #include <quic/state/StreamData.h>
 #include <quic/state/TransportSettings.h>
+#include <algorithm>
+#include <iterator>
 #include <numeric>
 #include <set>
 
@@ -35,6 +39,11 @@ constexpr uint64_t kMaxStreamGroupId = 128 * kStreamGroupIncrement;
  * This saves space when the set contains "contiguous" stream IDs for a given
  * type. For example, 0, 4, 8, ... 400 is internally represented by a single
  * entry, [0, 400].
+ *
+ * Peer streams that are opened implicitly, by the peer using a higher stream
+ * id of the same type, only live in such a set until a frame for them arrives
+ * or the application calls into them. Only then is their QuicStreamState
+ * created.
  */
 class StreamIdSet {
  public:
@@ -50,7 +59,10 @@ class StreamIdSet {
     id -= base_;
     CHECK_EQ(id % detail::kStreamIncrement, 0);
     id /= detail::kStreamIncrement;
-    streams_.withdraw(Interval<StreamId>(id, id));
+    if (streams_.contains(id, id)) {
+      streams_.withdraw(Interval<StreamId>(id, id));
+      size_--;
+    }
   }
 
   void add(StreamId first, StreamId last) {
@@ -60,7 +72,20 @@ class StreamIdSet {
     CHECK_EQ(last % detail::kStreamIncrement, 0);
     first /= detail::kStreamIncrement;
     last /= detail::kStreamIncrement;
+    // Count the ids that are already in the set so the size stays exact.
+    // Ids are usually added past the end of the set, so this only looks at
+    // the last interval.
+    size_t alreadyAdded = 0;
+    for (auto it = std::make_reverse_iterator(streams_.end());
+         it != std::make_reverse_iterator(streams_.begin()) && it->end >= first;
+         ++it) {
+      if (it->start <= last) {
+        alreadyAdded +=
+            std::min(it->end, last) - std::max(it->start, first) + 1;
+      }
+    }
     streams_.insert(first, last);
+    size_ += last - first + 1 - alreadyAdded;
   }
 
   [[nodiscard]] bool contains(StreamId id) const {
@@ -70,19 +95,20 @@ class StreamIdSet {
   }
 
   [[nodiscard]] size_t size() const {
-    size_t ret = 0;
-    for (const auto& [start, end] : streams_) {
-      ret += end - start + 1;
-    }
-    return ret;
+    return size_;
   }
 
   void clear() {
     streams_.clear();
+    size_ = 0;
   }
 
  private:
   IntervalSet<StreamId, 1, std::vector> streams_;
+  // Number of ids in the set. Kept up to date on every change rather than
+  // summed over the intervals, which fragment as streams from a burst of
+  // implicitly opened ones are closed out of order.
+  size_t size_{0};
   uint8_t base_;
 };
 
@@ -220,7 +246,9 @@ class QuicStreamManager {
     unidirectionalReadableStreams_ =
         std::move(other.unidirectionalReadableStreams_);
     peekableStreams_ = std::move(other.peekableStreams_);
+#if MVFST_ENABLE_DEPRECATED_PRIORITY_QUEUE
     oldWriteQueue_ = std::move(other.oldWriteQueue_);
+#endif
     writeQueue_ = std::move(other.writeQueue_);
     controlWriteQueue_ = std::move(other.controlWriteQueue_);
     writableStreams_ = std::move(other.writableStreams_);
@@ -228,7 +256,9 @@ class QuicStreamManager {
     txStreams_ = std::move(other.txStreams_);
     deliverableStreams_ = std::move(other.deliverableStreams_);
     closedStreams_ = std::move(other.closedStreams_);
+    corkHeldStreams_ = std::move(other.corkHeldStreams_);
     isAppIdle_ = other.isAppIdle_;
+    connCorked_ = other.connCorked_;
     maxLocalBidirectionalStreamIdIncreased_ =
         other.maxLocalBidirectionalStreamIdIncreased_;
     maxLocalUnidirectionalStreamIdIncreased_ =
@@ -458,6 +488,35 @@ class QuicStreamManager {
       bool connFlowControlOpen = true,
       const std::shared_ptr<QLogger>& qLogger = nullptr);
 
+  /**
+   * Cork or uncork the stream indicated by id. Uncorking releases any data
+   * held by the cork into the write queue. Returns false if the stream does
+   * not exist.
+   */
+  bool setStreamCorked(
+      StreamId id,
+      bool corked,
+      bool connFlowControlOpen = true);
+
+  /**
+   * Cork or uncork all non-control streams on the connection.
+   */
+  void setConnectionCorked(bool corked, bool connFlowControlOpen = true);
+
+  [[nodiscard]] bool isConnectionCorked() const {
+    return connCorked_;
+  }
+
+  /**
+   * Release all data currently held by corks into the write queue. Data
+   * written to the streams afterwards is subject to the cork again.
+   */
+  void flushCorkedStreams(bool connFlowControlOpen = true);
+
+  [[nodiscard]] bool hasCorkHeldStreams() const {
+    return !corkHeldStreams_.empty();
+  }
+
   auto& writableDSRStreams() {
     return writableDSRStreams_;
   }
@@ -470,12 +529,16 @@ class QuicStreamManager {
     return *writeQueue_;
   }
 
-  auto* oldWriteQueue() {
+  [[nodiscard]] deprecated::PriorityQueue* oldWriteQueue() const {
+#if MVFST_ENABLE_DEPRECATED_PRIORITY_QUEUE
     return oldWriteQueue_.get();
+#else
+    return nullptr;
+#endif
   }
 
   bool hasWritable() const {
-    return (oldWriteQueue_ && !oldWriteQueue_->empty()) ||
+    return (oldWriteQueue() && !oldWriteQueue()->empty()) ||
         !writeQueue_->empty() || !controlWriteQueue_.empty();
   }
 
@@ -491,7 +554,7 @@ class QuicStreamManager {
     if (stream.isControl) {
       controlWriteQueue_.erase(stream.id);
     } else {
-      if (oldWriteQueue_) {
+      if (oldWriteQueue()) {
         oldWriteQueue()->erase(stream.id);
       } else {
         writeQueue().erase(PriorityQueue::Identifier::fromStreamID(stream.id));
@@ -502,12 +565,14 @@ class QuicStreamManager {
     writableDSRStreams_.erase(stream.id);
     lossStreams_.erase(stream.id);
     lossDSRStreams_.erase(stream.id);
+    corkHeldStreams_.erase(stream.id);
   }
 
   void clearWritable() {
     writableStreams_.clear();
     writableDSRStreams_.clear();
-    if (oldWriteQueue_) {
+    corkHeldStreams_.clear();
+    if (oldWriteQueue()) {
       oldWriteQueue()->clear();
     }
     writeQueue().clear();
@@ -681,6 +746,27 @@ class QuicStreamManager {
     return unidirectionalReadableStreams_;
   }
 
+  /*
+   * Read waiters parked on a stream in one of the readable sets. A stream's
+   * waiter is linked in when the stream becomes readable, and unlinked when
+   * it stops being readable or the waiter is detached.
+   */
+  auto& readyReadWaiters() {
+    return readyReadWaiters_;
+  }
+
+  /*
+   * Links the stream's read waiter into the ready list if the stream is
+   * already readable, for a waiter parked after the stream became readable.
+   */
+  void queueReadyReadWaiter(const QuicStreamState& stream);
+
+  /*
+   * Removes the stream from the readable sets, along with its read waiter
+   * from the ready list.
+   */
+  void removeFromReadableStreams(const QuicStreamState& stream);
+
   auto& peekableStreams() {
     return peekableStreams_;
   }
@@ -796,6 +882,7 @@ class QuicStreamManager {
     txStreams_.clear();
     readableStreams_.clear();
     unidirectionalReadableStreams_.clear();
+    readyReadWaiters_.clear();
     peekableStreams_.clear();
     flowControlUpdated_.clear();
   }
@@ -822,13 +909,13 @@ class QuicStreamManager {
   void setWriteQueueMaxNextsPerStream(uint64_t maxNextsPerStream);
 
   void addConnFCBlockedStream(StreamId id) {
-    if (!oldWriteQueue_) {
+    if (!oldWriteQueue()) {
       connFlowControlBlocked_.insert(id);
     }
   }
 
   void onMaxData() {
-    if (!oldWriteQueue_) {
+    if (!oldWriteQueue()) {
       for (auto id : connFlowControlBlocked_) {
         auto stream = findStream(id);
         if (stream) {
@@ -864,7 +951,9 @@ class QuicStreamManager {
   createNextStreamGroup(StreamGroupId& groupId, StreamIdSet& streamGroups);
 
   void addToReadableStreams(const QuicStreamState& stream);
-  void removeFromReadableStreams(const QuicStreamState& stream);
+
+  // Whether the cork policy currently holds the stream's fresh data back.
+  [[nodiscard]] bool isHeldByCork(const QuicStreamState& stream) const;
 
   QuicConnectionStateBase& conn_;
   QuicNodeType nodeType_;
@@ -923,18 +1012,24 @@ class QuicStreamManager {
   UnorderedSet<StreamId> lossDSRStreams_;
   UnorderedSet<StreamId> readableStreams_;
   UnorderedSet<StreamId> unidirectionalReadableStreams_;
+  QuicStreamWaiter::ReadyList readyReadWaiters_;
   UnorderedSet<StreamId> peekableStreams_;
 
   std::unique_ptr<PriorityQueue> writeQueue_;
+#if MVFST_ENABLE_DEPRECATED_PRIORITY_QUEUE
   std::unique_ptr<deprecated::PriorityQueue> oldWriteQueue_;
+#endif
   std::set<StreamId> controlWriteQueue_;
   UnorderedSet<StreamId> writableStreams_;
   UnorderedSet<StreamId> writableDSRStreams_;
   UnorderedSet<StreamId> txStreams_;
   UnorderedSet<StreamId> deliverableStreams_;
   UnorderedSet<StreamId> closedStreams_;
+  // Streams with buffered data that is held back by a cork.
+  UnorderedSet<StreamId> corkHeldStreams_;
 
   bool isAppIdle_{false};
+  bool connCorked_{false};
   const TransportSettings* FOLLY_NONNULL transportSettings_;
   bool maxLocalBidirectionalStreamIdIncreased_{false};
   bool maxLocalUnidirectionalStreamIdIncreased_{false};
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/IntrusiveList.h>
+#include <quic/codec/Types.h>
+#include <quic/common/Optional.h>
+
+namespace quic {
+
+/**
+ * A one-shot readiness waiter parked on a single stream.
+ *
+ * Unlike read and write callbacks, which are looked up by stream id on every
+ * readiness pass, a waiter is stored in a slot on the stream state and linked
+ * into an intrusive list owned by the transport. Registering, readying and
+ * cancelling a waiter are all O(1) and allocation free. A read waiter is
+ * also linked into the stream manager's ready list while its stream is
+ * readable, so the transport only visits the waiters it can resume.
+ *
+ * A waiter fires exactly once, either onStreamReady() or onStreamWaitError(),
+ * after which it's unlinked and may be registered again. Waiters must be
+ * cancelled through the transport before they are destroyed while still
+ * waiting.
+ */
+class QuicStreamWaiter {
+ public:
+  virtual ~QuicStreamWaiter() = default;
+
+  /**
+   * The stream has data or EOF to read, or can be written to without blocking
+   * on flow control, depending on how the waiter was registered. A write
+   * waiter is also readied once the stream can't be written to anymore, so
+   * that the failing write surfaces the error.
+   */
+  virtual void onStreamReady(StreamId id) noexcept = 0;
+
+  /**
+   * The stream has a read error, or the stream or the connection went away
+   * before the stream became ready.
+   */
+  virtual void onStreamWaitError(StreamId id, QuicError error) noexcept = 0;
+
+  [[nodiscard]] bool isWaiting() const noexcept {
+    return hook_.is_linked();
+  }
+
+  [[nodiscard]] Optional<StreamId> waitingOn() const noexcept {
+    if (!isWaiting()) {
+      return std::nullopt;
+    }
+    return streamId_;
+  }
+
+ private:
+  friend class QuicTransportBaseLite;
+  friend class QuicStreamManager;
+
+  folly::IntrusiveListHook hook_;
+  folly::IntrusiveListHook readyHook_;
+  StreamId streamId_{0};
+
+ public:
+  using List = folly::IntrusiveList<QuicStreamWaiter, &QuicStreamWaiter::hook_>;
+  using ReadyList =
+      folly::IntrusiveList<QuicStreamWaiter, &QuicStreamWaiter::readyHook_>;
+};
+
+} // namespace quic
@@ -13,6 +13,7 @@
 
 #include <quic/QuicConstants.h>
 #include <quic/QuicException.h>
+#include <quic/common/WriteStageProfiler.h>
 
 namespace quic {
 
@@ -133,6 +134,10 @@ class QuicTransportStatsCallback {
 
   virtual void onStreamFlowControlBlocked() = 0;
 
+  // A packet was written that carries nothing but flow control and stream
+  // limit frames.
+  virtual void onControlFrameOnlyPacketSent() = 0;
+
   virtual void onCwndBlocked() = 0;
 
   virtual void onInflightBytesSample(uint64_t) = 0;
@@ -206,6 +211,15 @@ class QuicTransportStatsCallback {
 
   virtual void onKeyUpdateAttemptSucceeded() = 0;
 
+  // Cycles spent in each write loop stage during one sampled call to
+  // writeConnectionDataToSocket. Only invoked when write stage profiling is
+  // compiled in and TransportSettings::writeStageSampleInterval is set.
+  virtual void onWriteStageCycles(const WriteStageCycles& stageCycles) = 0;
+
+  // Number of packets handed to the socket in one successful batch write. With
+  // GSO this is the number of segments sent with a single syscall.
+  virtual void onPacketsBatchWritten(uint32_t numPackets) = 0;
+
   static const char* toString(SocketErrorType errorType) {
     switch (errorType) {
       case SocketErrorType::AGAIN:
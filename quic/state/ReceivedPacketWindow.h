@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/codec/PacketNumber.h>
+#include <quic/common/Optional.h>
+
+#include <array>
+
+namespace quic {
+
+/**
+ * Sliding window over the packet numbers received in one packet number space,
+ * like the IPsec anti-replay window (RFC 4303, section 3.4.3).
+ *
+ * The window keeps one bit for each of the kSize packet numbers ending at the
+ * largest one received, so a duplicate of a recent packet is found with a
+ * shift and a mask as soon as its packet number is decoded, without
+ * decrypting it. Packet numbers older than the window aren't tracked and are
+ * never reported as received.
+ *
+ * Only packets that were successfully decrypted should be inserted, so that a
+ * forged packet can't get a genuine one dropped.
+ */
+class ReceivedPacketWindow {
+ public:
+  static constexpr PacketNum kSize = 256;
+
+  [[nodiscard]] bool contains(PacketNum packetNum) const {
+    if (!largest_ || packetNum > *largest_) {
+      return false;
+    }
+    auto offset = *largest_ - packetNum;
+    if (offset >= kSize) {
+      return false;
+    }
+    return bits_[offset / kWordBits] & (uint64_t(1) << (offset % kWordBits));
+  }
+
+  void insert(PacketNum packetNum) {
+    if (!largest_ || packetNum > *largest_) {
+      shift(largest_ ? packetNum - *largest_ : kSize);
+      largest_ = packetNum;
+      bits_[0] |= 1;
+      return;
+    }
+    auto offset = *largest_ - packetNum;
+    if (offset < kSize) {
+      bits_[offset / kWordBits] |= uint64_t(1) << (offset % kWordBits);
+    }
+  }
+
+ private:
+  static constexpr size_t kWordBits = 64;
+  static constexpr size_t kNumWords = kSize / kWordBits;
+  static_assert(kSize % kWordBits == 0, "Window must be whole words");
+
+  // Moves every bit n packet numbers away from the largest one, dropping the
+  // bits that fall out of the window. Words are shifted from the top down so
+  // each one is read before it's overwritten.
+  void shift(PacketNum n) {
+    if (n >= kSize) {
+      bits_.fill(0);
+      return;
+    }
+    const size_t wordShift = n / kWordBits;
+    const size_t bitShift = n % kWordBits;
+    for (size_t i = kNumWords; i-- > 0;) {
+      uint64_t word = 0;
+      if (i >= wordShift) {
+        word = bits_[i - wordShift] << bitShift;
+        if (bitShift != 0 && i > wordShift) {
+          word |= bits_[i - wordShift - 1] >> (kWordBits - bitShift);
+        }
+      }
+      bits_[i] = word;
+    }
+  }
+
+  // Bit i is set if packet number largest_ - i was received.
+  std::array<uint64_t, kNumWords> bits_{};
+  Optional<PacketNum> largest_;
+};
+
+} // namespace quic
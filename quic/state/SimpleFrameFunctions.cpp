@@ -15,6 +15,7 @@ void sendSimpleFrame(QuicConnectionStateBase& conn, QuicSimpleFrame frame) {
   CHECK(frame.type() != QuicSimpleFrame::Type::PathChallengeFrame);
   CHECK(frame.type() != QuicSimpleFrame::Type::PathResponseFrame);
   conn.pendingEvents.frames.emplace_back(std::move(frame));
+  conn.pendingEvents.markPendingWrite(PendingWriteReason::SIMPLE_FRAME);
 }
 
 Optional<QuicSimpleFrame> updateSimpleFrameOnPacketClone(
@@ -81,6 +82,7 @@ void updateSimpleFrameOnPacketSent(
       if (it != conn.pendingEvents.pathChallenges.end() &&
           it->second.pathData == pathChallenge.pathData) {
         conn.pendingEvents.pathChallenges.erase(it);
+        conn.pendingEvents.maybeClearPathValidationWrite();
       }
       break;
     }
@@ -92,6 +94,7 @@ void updateSimpleFrameOnPacketSent(
       if (it != conn.pendingEvents.pathResponses.end() &&
           it->second.pathData == pathResponse.pathData) {
         conn.pendingEvents.pathResponses.erase(it);
+        conn.pendingEvents.maybeClearPathValidationWrite();
       }
       break;
     }
@@ -100,6 +103,9 @@ void updateSimpleFrameOnPacketSent(
       auto itr = std::find(frames.begin(), frames.end(), simpleFrame);
       CHECK(itr != frames.end());
       frames.erase(itr);
+      if (frames.empty()) {
+        conn.pendingEvents.clearPendingWrite(PendingWriteReason::SIMPLE_FRAME);
+      }
       break;
     }
   }
@@ -114,6 +120,7 @@ void updateSimpleFrameOnPacketLoss(
       const StopSendingFrame& stopSendingFrame = *frame.asStopSendingFrame();
       if (conn.streamManager->streamExists(stopSendingFrame.streamId)) {
         conn.pendingEvents.frames.emplace_back(stopSendingFrame);
+        conn.pendingEvents.markPendingWrite(PendingWriteReason::SIMPLE_FRAME);
       }
       break;
     }
@@ -129,6 +136,8 @@ void updateSimpleFrameOnPacketLoss(
         // challenge frame
         conn.pendingEvents.pathChallenges.insert_or_assign(
             maybePath->id, pathChallenge);
+        conn.pendingEvents.markPendingWrite(
+            PendingWriteReason::PATH_VALIDATION);
       }
       break;
     }
@@ -140,11 +149,14 @@ void updateSimpleFrameOnPacketLoss(
       if (maybePath && maybePath->status != PathStatus::NotValid) {
         const PathResponseFrame& pathResponse = *frame.asPathResponseFrame();
         conn.pendingEvents.pathResponses.insert_or_assign(pathId, pathResponse);
+        conn.pendingEvents.markPendingWrite(
+            PendingWriteReason::PATH_VALIDATION);
       }
       break;
     }
     case QuicSimpleFrame::Type::HandshakeDoneFrame: {
       conn.pendingEvents.frames.emplace_back(*frame.asHandshakeDoneFrame());
+      conn.pendingEvents.markPendingWrite(PendingWriteReason::SIMPLE_FRAME);
       break;
     }
     case QuicSimpleFrame::Type::NewConnectionIdFrame:
@@ -155,6 +167,7 @@ void updateSimpleFrameOnPacketLoss(
     case QuicSimpleFrame::Type::AckFrequencyFrame:
     case QuicSimpleFrame::Type::NewTokenFrame:
       conn.pendingEvents.frames.push_back(frame);
+      conn.pendingEvents.markPendingWrite(PendingWriteReason::SIMPLE_FRAME);
       break;
   }
 }
@@ -186,6 +199,7 @@ quic::Expected<bool, QuicError> updateSimpleFrameOnPacketReceived(
       const PathChallengeFrame& pathChallenge = *frame.asPathChallengeFrame();
       conn.pendingEvents.pathResponses.insert_or_assign(
           pathId, PathResponseFrame(pathChallenge.pathData));
+      conn.pendingEvents.markPendingWrite(PendingWriteReason::PATH_VALIDATION);
       return false;
     }
     case QuicSimpleFrame::Type::PathResponseFrame: {
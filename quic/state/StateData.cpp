@@ -153,6 +153,7 @@ void QuicConnectionStateBase::retirePeerConnectionId(ConnectionId peerCid) {
 
   pendingEvents.frames.push_back(
       RetireConnectionIdFrame(cidData->sequenceNumber));
+  pendingEvents.markPendingWrite(PendingWriteReason::SIMPLE_FRAME);
 
   peerConnectionIds.erase(cidData);
 
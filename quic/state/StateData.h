@@ -15,11 +15,13 @@
 #include <quic/common/BufAccessor.h>
 #include <quic/common/CircularDeque.h>
 #include <quic/common/Expected.h>
+#include <quic/common/WriteStageProfiler.h>
 #include <quic/congestion_control/CongestionController.h>
 #include <quic/congestion_control/PacketProcessor.h>
 #include <quic/congestion_control/ThrottlingSignalProvider.h>
 #include <quic/handshake/HandshakeLayer.h>
 #include <quic/logging/QLogger.h>
+#include <quic/mvfst-features.h>
 #include <quic/observer/SocketObserverTypes.h>
 #include <quic/state/AckEvent.h>
 #include <quic/state/AckStates.h>
@@ -275,6 +277,17 @@ using Resets = UnorderedMap<StreamId, RstStreamFrame>;
 
 using FrameList = std::vector<QuicSimpleFrame>;
 
+// Pending events, outside of the stream manager and the ack states, that give
+// the write looper a reason to run.
+enum class PendingWriteReason : uint8_t {
+  RESET = 1 << 0,
+  CONN_WINDOW_UPDATE = 1 << 1,
+  SIMPLE_FRAME = 1 << 2,
+  PATH_VALIDATION = 1 << 3,
+  PING = 1 << 4,
+  DATAGRAM = 1 << 5,
+};
+
 class CongestionControllerFactory;
 class LoopDetectorCallback;
 class EcnL4sTracker;
@@ -479,6 +492,11 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
     // Whether a connection level window update is due to send
     bool connWindowUpdate{false};
 
+    // Whether the pending window updates should be written without waiting
+    // for a packet to carry them. Only consulted with
+    // coalesceFlowControlUpdates.
+    bool urgentWindowUpdate{false};
+
     // If there is a pending loss detection alarm update
     bool setLossDetectionAlarm{false};
 
@@ -497,6 +515,32 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
 
     // Send an immediate ack frame (requesting an ack)
     bool requestImmediateAck{false};
+
+    // Bitmask of PendingWriteReason for the events above that have data to
+    // write. Producers mark an event when they queue it and consumers clear
+    // it when they drain the last of it, so the write looper reads a bit
+    // instead of inspecting the event. Debug builds cross-check the two.
+    uint8_t pendingWriteReasons{0};
+
+    void markPendingWrite(PendingWriteReason reason) {
+      pendingWriteReasons |= static_cast<uint8_t>(reason);
+    }
+
+    void clearPendingWrite(PendingWriteReason reason) {
+      pendingWriteReasons &= ~static_cast<uint8_t>(reason);
+    }
+
+    // Path challenges and responses share a bit, which is cleared once
+    // neither has anything left to write.
+    void maybeClearPathValidationWrite() {
+      if (pathChallenges.empty() && pathResponses.empty()) {
+        clearPendingWrite(PendingWriteReason::PATH_VALIDATION);
+      }
+    }
+
+    [[nodiscard]] bool hasPendingWrite(PendingWriteReason reason) const {
+      return pendingWriteReasons & static_cast<uint8_t>(reason);
+    }
   };
 
   PendingEvents pendingEvents;
@@ -513,6 +557,10 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
   // connection wide).
   uint64_t numWindowUpdateFramesSent{0};
 
+  // Number of packets sent whose only frames were flow control or stream
+  // limit frames (plus padding).
+  uint64_t numControlFrameOnlyPacketsSent{0};
+
   uint64_t numPingFramesSent{0};
 
   uint64_t eagainOrEwouldblockCount{0};
@@ -546,6 +594,11 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
     uint64_t peerAdvertisedInitialMaxStreamOffsetUni{0};
     // Time at which the last flow control update was sent by the transport.
     Optional<TimePoint> timeOfLastFlowControlUpdate;
+    // sumCurReadOffset when the last flow control update was sent.
+    uint64_t sumCurReadOffsetAtLastUpdate{0};
+    // Smoothed rate at which the application reads data off the connection,
+    // in bytes per second, sampled between flow control updates.
+    uint64_t drainRate{0};
   };
 
   // Current state of flow control.
@@ -612,6 +665,20 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
   WriteDebugState writeDebugState;
   ReadDebugState readDebugState;
 
+#if MVFST_WRITE_STAGE_PROFILING
+  // Cycle counts of the write loop stages, see WriteStageProfiler.h.
+  WriteStageProfile writeStageProfile;
+#endif
+
+  // The write stage profile, or nullptr when profiling is compiled out.
+  WriteStageProfile* FOLLY_NULLABLE getWriteStageProfile() {
+#if MVFST_WRITE_STAGE_PROFILING
+    return &writeStageProfile;
+#else
+    return nullptr;
+#endif
+  }
+
   std::shared_ptr<LoopDetectorCallback> loopDetectorCallback;
 
   /**
@@ -640,6 +707,9 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
    * Returns the SocketObserverContainer or nullptr if not available.
    */
   SocketObserverContainer* getSocketObserverContainer() const {
+    if constexpr (!kObserversEnabled) {
+      return nullptr;
+    }
     if (const auto observerContainerLocked = observerContainer.lock()) {
       return observerContainerLocked.get();
     }
@@ -13,12 +13,16 @@
 #include <quic/codec/Types.h>
 #include <quic/common/Expected.h>
 #include <quic/common/IntervalSet.h>
+#include <quic/common/PrefixIntervalSet.h>
 #include <quic/dsr/DSRPacketizationRequestSender.h>
 #include <quic/mvfst-config.h>
+#include <quic/mvfst-features.h>
 #include <quic/priority/PriorityQueue.h>
 
 namespace quic {
 
+class QuicStreamWaiter;
+
 /**
  * A buffer representation without the actual data. This is part of the public
  * facing interface.
@@ -144,10 +148,9 @@ struct QuicStreamLike {
   // Tracks intervals which we have received ACKs for. E.g. in the case of all
   // data being acked this would contain one internval from 0 -> the largest
   // offset ACKed. This allows us to track which delivery callbacks can be
-  // called.
-  template <class T>
-  using IntervalSetVec = SmallVec<T, 3>;
-  using AckedIntervals = IntervalSet<uint64_t, 1, IntervalSetVec>;
+  // called. Data is mostly acked in order, so only the ranges acked past a gap
+  // take extra space.
+  using AckedIntervals = PrefixIntervalSet<uint64_t>;
   AckedIntervals ackedIntervals;
 
   // Stores a list of buffers which have been marked as loss by loss detector.
@@ -435,14 +438,18 @@ struct QuicStreamState : public QuicStreamLike {
     sendState = other.sendState;
     recvState = other.recvState;
     isControl = other.isControl;
+    corked = other.corked;
+    corkFlushOffset = other.corkFlushOffset;
     lastHolbTime = other.lastHolbTime;
     totalHolbTime = other.totalHolbTime;
     holbCount = other.holbCount;
     priority = other.priority;
+#if MVFST_ENABLE_DSR
     dsrSender = std::move(other.dsrSender);
     writeBufMeta = other.writeBufMeta;
     retransmissionBufMetas = std::move(other.retransmissionBufMetas);
     lossBufMetas = std::move(other.lossBufMetas);
+#endif
     streamLossCount = other.streamLossCount;
   }
 
@@ -490,6 +497,16 @@ struct QuicStreamState : public QuicStreamLike {
   // congestion control with control streams still active.
   bool isControl{false};
 
+  // Set by the app via setStreamCorked. While corked, fresh data smaller than
+  // the cork fill threshold is held out of the write queue until more data
+  // arrives, the cork deadline fires, the stream is uncorked or a FIN is
+  // written.
+  bool corked{false};
+
+  // Write offset up to which buffered data has been flushed past the cork.
+  // Data below this offset is schedulable regardless of the fill threshold.
+  uint64_t corkFlushOffset{0};
+
   // The last time we detected we were head of line blocked on the stream.
   Optional<Clock::time_point> lastHolbTime;
 
@@ -507,6 +524,12 @@ struct QuicStreamState : public QuicStreamLike {
   // that this is only used for DSR and facilitates loss detection.
   uint64_t streamPacketIdx{0};
 
+  // Readiness waiters parked on this stream by the app API. These are owned
+  // and kept in sync by the transport; they aren't carried over when the
+  // stream migrates to another connection.
+  QuicStreamWaiter* readWaiter{nullptr};
+  QuicStreamWaiter* writeWaiter{nullptr};
+
   // Returns true if both send and receive state machines are in a terminal
   // state
   bool inTerminalStates() const {
@@ -552,7 +575,12 @@ struct QuicStreamState : public QuicStreamLike {
   }
 
   [[nodiscard]] bool hasSchedulableDsr(bool connFlowControlOpen = true) const {
+#if MVFST_ENABLE_DSR
     return hasWritableBufMeta(connFlowControlOpen) || !lossBufMetas.empty();
+#else
+    (void)connFlowControlOpen;
+    return false;
+#endif
   }
 
   [[nodiscard]] bool hasWritableBufMeta(bool connFlowControlOpen = true) const {
@@ -607,6 +635,7 @@ struct QuicStreamState : public QuicStreamLike {
   }
 
   void removeFromWriteBufMetaStartingAtOffset(uint64_t startingOffset) {
+#if MVFST_ENABLE_DSR
     if (startingOffset <= writeBufMeta.offset) {
       writeBufMeta.length = 0;
       return;
@@ -616,10 +645,14 @@ struct QuicStreamState : public QuicStreamLike {
         startingOffset <= writeBufMeta.offset + writeBufMeta.length) {
       writeBufMeta.length = uint32_t(startingOffset - writeBufMeta.offset);
     }
+#else
+    (void)startingOffset;
+#endif
   }
 
   void removeFromRetransmissionBufMetasStartingAtOffset(
       uint64_t startingOffset) {
+#if MVFST_ENABLE_DSR
     UnorderedSet<uint64_t> offsetsToRemove;
 
     for (auto& [offset, buf] : retransmissionBufMetas) {
@@ -633,9 +666,13 @@ struct QuicStreamState : public QuicStreamLike {
     for (auto offset : offsetsToRemove) {
       retransmissionBufMetas.erase(offset);
     }
+#else
+    (void)startingOffset;
+#endif
   }
 
   void removeFromLossBufMetasStartingAtOffset(uint64_t startingOffset) {
+#if MVFST_ENABLE_DSR
     if (lossBufMetas.empty()) {
       // Nothing to do.
       return;
@@ -652,6 +689,9 @@ struct QuicStreamState : public QuicStreamLike {
         return;
       }
     }
+#else
+    (void)startingOffset;
+#endif
   }
 
   void removeFromReadBufferStartingAtOffset(uint64_t startingOffset) {
@@ -671,6 +711,7 @@ struct QuicStreamState : public QuicStreamLike {
     }
   }
 
+#if MVFST_ENABLE_DSR
   std::unique_ptr<DSRPacketizationRequestSender> dsrSender;
 
   // BufferMeta that has been written to the QUIC layer.
@@ -683,6 +724,17 @@ struct QuicStreamState : public QuicStreamLike {
 
   // WriteBufferMetas that's already marked lost. They will be retransmitted.
   CircularDeque<WriteBufferMeta> lossBufMetas;
+#else
+  // DSR is compiled out. Streams don't store any of its state, these shared
+  // constants stay empty so that the code reading them still builds. Code
+  // writing them must be compiled out as well.
+  static inline const std::unique_ptr<DSRPacketizationRequestSender>
+      dsrSender{};
+  static inline const WriteBufferMeta writeBufMeta{};
+  static inline const UnorderedMap<uint64_t, WriteBufferMeta>
+      retransmissionBufMetas{};
+  static inline const CircularDeque<WriteBufferMeta> lossBufMetas{};
+#endif
 
   uint64_t streamLossCount{0};
 
@@ -694,6 +746,7 @@ struct QuicStreamState : public QuicStreamLike {
    * between 2 existing WriteBufferMetas.
    */
   void insertIntoLossBufMeta(WriteBufferMeta bufMeta) {
+#if MVFST_ENABLE_DSR
     auto lossItr = std::upper_bound(
         lossBufMetas.begin(),
         lossBufMetas.end(),
@@ -709,6 +762,9 @@ struct QuicStreamState : public QuicStreamLike {
     } else {
       lossBufMetas.insert(lossItr, bufMeta);
     }
+#else
+    (void)bufMeta;
+#endif
   }
 };
 } // namespace quic
@@ -177,6 +177,10 @@ struct TransportSettings {
   uint64_t advertisedInitialMaxStreamsUni{kDefaultMaxStreamsUnidirectional};
   // Maximum number of packets to buffer while cipher is unavailable.
   uint32_t maxPacketsToBuffer{kDefaultMaxBufferedPackets};
+  // Maximum number of packets all the connections of a server worker may
+  // buffer while their ciphers are unavailable. 0 means no limit besides
+  // maxPacketsToBuffer for every connection.
+  uint32_t maxPacketsToBufferPerWorker{0};
   // Idle timeout to advertise to the peer.
   std::chrono::milliseconds idleTimeout{kDefaultIdleTimeout};
   // Ack delay exponent to use.
@@ -231,12 +235,23 @@ struct TransportSettings {
       kDefaultWriteConnectionDataPacketLimit};
   // Fraction of RTT that is used to limit how long a write function can loop
   DurationRep writeLimitRttFraction{kDefaultWriteLimitRttFraction};
+  // Measure per-stage cycle counts for one in every writeStageSampleInterval
+  // calls to writeConnectionDataToSocket. 0 disables sampling. Has no effect
+  // unless built with MVFST_WRITE_STAGE_PROFILING.
+  uint64_t writeStageSampleInterval{0};
   // Frequency of sending flow control updates. We can send one update every
   // flowControlRttFrequency * RTT if the flow control changes.
   uint16_t flowControlRttFrequency{2};
   // Frequency of sending flow control updates. We can send one update every
   // flowControlWindowFrequency * window if the flow control changes.
   uint16_t flowControlWindowFrequency{2};
+  // Don't write a packet just for MAX_DATA, MAX_STREAM_DATA or MAX_STREAMS
+  // while the peer is owed an ACK; the updates go out with the ACK instead.
+  // Updates are still written right away when the peer is blocked, when they
+  // were lost, or when the peer is close to running out of credit. The
+  // connection window advertised in MAX_DATA is also sized to cover
+  // 2 * SRTT of the application's drain rate.
+  bool coalesceFlowControlUpdates{false};
   // batching mode
   QuicBatchingMode batchingMode{QuicBatchingMode::BATCHING_MODE_NONE};
   // maximum number of packets we can batch. This does not apply to
@@ -300,6 +315,12 @@ struct TransportSettings {
   // Whether or not we should stop writing a packet after writing a single
   // stream frame to it.
   bool streamFramePerPacket{false};
+  // Whether to schedule stream data so that a write produces a train of
+  // equally sized packets that GSO can send in a single call. Stream frames
+  // from several streams share a packet, overriding streamFramePerPacket, and
+  // a packet is padded to full size when the congestion window, flow control
+  // and packet limit leave room for another one in the train.
+  bool gsoTrainScheduling{false};
   // Ensure read callbacks are ordered by Stream ID.
   bool orderedReadCallbacks{false};
   // Quic knobs
@@ -342,7 +363,9 @@ struct TransportSettings {
   // Whether or not to remove data from the loss buffer on spurious loss.
   bool removeFromLossBufferOnSpurious{false};
   // If set to true, the users won't get new stream notification until an
-  // actual stream frame with the new stream id arrives.
+  // actual stream frame with the new stream id arrives. Streams opened
+  // implicitly by a higher stream id are then kept as ids only, without a
+  // notification per id.
   bool notifyOnNewStreamsExplicitly{false};
   // Both peers must support stream groups; negotiated during handshake.
   // 0 means stream groups are disabled.
@@ -402,6 +425,9 @@ struct TransportSettings {
   // are enabled or not and should not a part of
   //  maybeAckReceiveTimestampsConfigSentToPeer optional.
   uint64_t maxReceiveTimestampsPerAckStored{kMaxReceivedPktsTimestampsStored};
+  // Drop packets whose packet number was recently received once the header
+  // protection is removed, without decrypting or processing them again.
+  bool dropDuplicatePacketsBeforeDecryption{false};
   // Close the connection completely if a migration occurs during the handshake.
   bool closeIfMigrationDuringHandshake{true};
   // Whether to use writable bytes to apply app backpressure via the callbacks
@@ -509,6 +535,13 @@ struct TransportSettings {
   // TODO: Remove this after testing the underlying change.
   bool allowDuplicateProbesInSameWrite{true};
 
+  // Minimum number of buffered bytes a corked stream needs before it is put
+  // back in the write queue. 0 means a full UDP packet worth of data.
+  uint64_t corkMinFillBytes{0};
+
+  // Maximum time data can be held back by a cork before it is flushed.
+  std::chrono::microseconds corkFlushTimeout{kDefaultCorkFlushTimeout};
+
   // Whether a ConnectionClose frame should be sent on IdleTimeout
   bool alwaysSendConnectionCloseOnIdleTimeout{false};
 
@@ -8,6 +8,7 @@
 #include <quic/state/stream/StreamSendHandlers.h>
 
 #include <quic/flowcontrol/QuicFlowController.h>
+#include <quic/mvfst-features.h>
 #include <quic/state/QuicStreamFunctions.h>
 
 namespace quic {
@@ -157,6 +158,7 @@ quic::Expected<void, QuicError> sendAckSMHandler(
           stream.retransmissionBuffer.erase(ackedBuffer);
         }
       } else {
+#if MVFST_ENABLE_DSR
         auto ackedBuffer =
             stream.retransmissionBufMetas.find(ackedFrame.offset);
         if (ackedBuffer != stream.retransmissionBufMetas.end()) {
@@ -178,6 +180,7 @@ quic::Expected<void, QuicError> sendAckSMHandler(
           }
           stream.retransmissionBufMetas.erase(ackedBuffer);
         }
+#endif
       }
 
       // This stream may be able to invoke some deliveryCallbacks:
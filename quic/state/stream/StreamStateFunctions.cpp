@@ -8,6 +8,7 @@
 #include <quic/state/stream/StreamStateFunctions.h>
 
 #include <quic/flowcontrol/QuicFlowController.h>
+#include <quic/mvfst-features.h>
 
 namespace quic {
 quic::Expected<void, QuicError> resetQuicStream(
@@ -36,6 +37,7 @@ quic::Expected<void, QuicError> resetQuicStream(
     ChainedByteRangeHead(std::move(stream.pendingWrites)); // Will be destructed
     stream.lossBuffer.clear();
     stream.streamWriteError = error;
+#if MVFST_ENABLE_DSR
     stream.writeBufMeta.length = 0;
     stream.retransmissionBufMetas.clear();
     stream.lossBufMetas.clear();
@@ -43,6 +45,7 @@ quic::Expected<void, QuicError> resetQuicStream(
       stream.dsrSender->release();
       stream.dsrSender.reset();
     }
+#endif
   }
   stream.conn.streamManager->updateReadableStreams(stream);
   stream.conn.streamManager->updateWritableStreams(stream);
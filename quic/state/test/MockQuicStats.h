@@ -49,6 +49,7 @@ class MockQuicStats : public QuicTransportStatsCallback {
   MOCK_METHOD(void, onStatelessReset, ());
   MOCK_METHOD(void, onStreamFlowControlUpdate, ());
   MOCK_METHOD(void, onStreamFlowControlBlocked, ());
+  MOCK_METHOD(void, onControlFrameOnlyPacketSent, ());
   MOCK_METHOD(void, onCwndBlocked, ());
   MOCK_METHOD(void, onInflightBytesSample, (uint64_t));
   MOCK_METHOD(void, onRttSample, (uint64_t));
@@ -77,6 +78,7 @@ class MockQuicStats : public QuicTransportStatsCallback {
   MOCK_METHOD(void, onNewTokenIssued, ());
   MOCK_METHOD(void, onTokenDecryptFailure, ());
   MOCK_METHOD(void, onShortHeaderPadding, (size_t));
+  MOCK_METHOD(void, onPacketsBatchWritten, (uint32_t));
   MOCK_METHOD(void, onPacerTimerLagged, ());
   MOCK_METHOD(void, onPeerMaxUniStreamsLimitSaturated, ());
   MOCK_METHOD(void, onPeerMaxBidiStreamsLimitSaturated, ());
@@ -86,6 +88,7 @@ class MockQuicStats : public QuicTransportStatsCallback {
   MOCK_METHOD(void, onKeyUpdateAttemptSucceeded, ());
   MOCK_METHOD(void, onBBR1ExitStartup, ());
   MOCK_METHOD(void, onBBR2ExitStartup, ());
+  MOCK_METHOD(void, onWriteStageCycles, (const WriteStageCycles&));
 };
 
 class MockQuicStatsFactory : public QuicTransportStatsCallbackFactory {
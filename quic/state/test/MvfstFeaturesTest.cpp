@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <quic/congestion_control/CongestionControllerFactory.h>
+#include <quic/fizz/server/handshake/FizzServerQuicHandshakeContext.h>
+#include <quic/handshake/TransportParameters.h>
+#include <quic/mvfst-features.h>
+#include <quic/server/state/ServerStateMachine.h>
+#include <quic/state/QuicStreamFunctions.h>
+#include <quic/state/QuicStreamManager.h>
+
+#include <algorithm>
+
+// Checks the features selected in mvfst-features.h. These tests pass in
+// every configuration, and are the ones built with MVFST_LITE.
+
+namespace quic::test {
+
+class MvfstFeaturesTest : public testing::Test {
+ public:
+  MvfstFeaturesTest()
+      : conn(FizzServerQuicHandshakeContext::Builder().build()) {}
+
+  void SetUp() override {
+    conn.flowControlState.peerAdvertisedInitialMaxStreamOffsetBidiLocal =
+        kDefaultStreamFlowControlWindow;
+    conn.flowControlState.peerAdvertisedInitialMaxStreamOffsetBidiRemote =
+        kDefaultStreamFlowControlWindow;
+    conn.flowControlState.peerAdvertisedMaxOffset =
+        kDefaultConnectionFlowControlWindow;
+    ASSERT_TRUE(
+        conn.streamManager
+            ->setMaxLocalBidirectionalStreams(kDefaultMaxStreamsBidirectional)
+            .has_value());
+  }
+
+  QuicServerConnectionState conn;
+};
+
+TEST_F(MvfstFeaturesTest, LiteTurnsOffEveryFeature) {
+  EXPECT_EQ(kQLogEnabled, !MVFST_LITE);
+  EXPECT_EQ(kObserversEnabled, !MVFST_LITE);
+  EXPECT_EQ(kKnobsEnabled, !MVFST_LITE);
+  EXPECT_EQ(kDSREnabled, !MVFST_LITE);
+  EXPECT_EQ(kStreamGroupsEnabled, !MVFST_LITE);
+  EXPECT_EQ(kDeprecatedPriorityQueueEnabled, !MVFST_LITE);
+  EXPECT_EQ(kAllCongestionControllersEnabled, !MVFST_LITE);
+}
+
+TEST_F(MvfstFeaturesTest, CongestionControllers) {
+  DefaultCongestionControllerFactory factory;
+  auto cubic =
+      factory.makeCongestionController(conn, CongestionControlType::Cubic);
+  ASSERT_NE(cubic, nullptr);
+  EXPECT_EQ(cubic->type(), CongestionControlType::Cubic);
+
+  // Without the other controllers the factory falls back to Cubic.
+  auto bbr = factory.makeCongestionController(conn, CongestionControlType::BBR);
+  ASSERT_NE(bbr, nullptr);
+  EXPECT_EQ(
+      bbr->type(),
+      kAllCongestionControllersEnabled ? CongestionControlType::BBR
+                                       : CongestionControlType::Cubic);
+
+  EXPECT_EQ(
+      factory.makeCongestionController(conn, CongestionControlType::None),
+      nullptr);
+  EXPECT_THROW(
+      factory.makeCongestionController(conn, CongestionControlType::StaticCwnd),
+      QuicInternalException);
+  EXPECT_THROW(
+      factory.makeCongestionController(conn, CongestionControlType::MAX),
+      QuicInternalException);
+}
+
+TEST_F(MvfstFeaturesTest, DeprecatedPriorityQueue) {
+  conn.transportSettings.useNewPriorityQueue = false;
+  ASSERT_TRUE(
+      conn.streamManager->refreshTransportSettings(conn.transportSettings)
+          .has_value());
+  EXPECT_EQ(
+      conn.streamManager->oldWriteQueue() != nullptr,
+      kDeprecatedPriorityQueueEnabled);
+}
+
+TEST_F(MvfstFeaturesTest, StreamGroups) {
+  conn.transportSettings.advertisedMaxStreamGroups = 16;
+  ASSERT_TRUE(
+      conn.streamManager->refreshTransportSettings(conn.transportSettings)
+          .has_value());
+  EXPECT_EQ(
+      conn.streamManager->createNextBidirectionalStreamGroup().has_value(),
+      kStreamGroupsEnabled);
+}
+
+TEST_F(MvfstFeaturesTest, Knobs) {
+  conn.transportSettings.advertisedKnobFrameSupport = true;
+  auto params = getSupportedExtTransportParams(conn);
+  auto knobParam =
+      std::find_if(params.begin(), params.end(), [](const auto& p) {
+        return p.parameter == TransportParameterId::knob_frames_supported;
+      });
+  EXPECT_EQ(knobParam != params.end(), kKnobsEnabled);
+}
+
+TEST_F(MvfstFeaturesTest, BufMetas) {
+  auto stream = conn.streamManager->createNextBidirectionalStream();
+  ASSERT_TRUE(stream.has_value());
+  ASSERT_TRUE(writeDataToQuicStream(
+                  **stream, folly::IOBuf::copyBuffer("hello"), false)
+                  .has_value());
+  EXPECT_EQ(
+      writeBufMetaToQuicStream(**stream, BufferMeta(100), false).has_value(),
+      kDSREnabled);
+  EXPECT_EQ((*stream)->hasSchedulableDsr(), kDSREnabled);
+}
+
+} // namespace quic::test
@@ -360,4 +360,32 @@ TEST(OutstandingPacketTest, DequeMoveAssignPacketDestructionCallback) {
   EXPECT_EQ(numDestroyCallbacks, maxPackets);
 }
 
+TEST(OutstandingPacketTest, DetailsPerStreamMergesFrameRanges) {
+  OutstandingPacketMetadata::DetailsPerStream details;
+  StreamId id = 4;
+  // In order frames extend a single inline range.
+  details.addFrame(WriteStreamFrame(id, 0, 10, false), true);
+  details.addFrame(WriteStreamFrame(id, 10, 10, false), true);
+  EXPECT_THAT(
+      details.at(id).streamIntervals,
+      ElementsAre(Interval<uint64_t>(0, 19)));
+
+  // Disjoint frames spill into further ranges, which are kept sorted and
+  // merged once they touch.
+  details.addFrame(WriteStreamFrame(id, 50, 10, false), false);
+  details.addFrame(WriteStreamFrame(id, 30, 10, false), false);
+  EXPECT_THAT(
+      details.at(id).streamIntervals,
+      ElementsAre(
+          Interval<uint64_t>(0, 19),
+          Interval<uint64_t>(30, 39),
+          Interval<uint64_t>(50, 59)));
+  details.addFrame(WriteStreamFrame(id, 20, 30, false), false);
+  EXPECT_THAT(
+      details.at(id).streamIntervals,
+      ElementsAre(Interval<uint64_t>(0, 59)));
+  EXPECT_EQ(details.at(id).streamBytesSent, 70);
+  EXPECT_EQ(details.at(id).newStreamBytesSent, 20);
+}
+
 } // namespace quic::test
@@ -838,6 +838,7 @@ TEST_F(QuicPathManagerTest, RemovePath_RetiresPeerConnectionId) {
 
   // Clear pending frames before deletion
   connState_->pendingEvents.frames.clear();
+  connState_->pendingEvents.clearPendingWrite(PendingWriteReason::SIMPLE_FRAME);
 
   // Remove the path
   auto removeResult = manager_->removePath(pathId);
@@ -871,6 +872,7 @@ TEST_F(QuicPathManagerTest, RemovePath_WithoutDestinationCid) {
 
   // Clear pending frames before deletion
   connState_->pendingEvents.frames.clear();
+  connState_->pendingEvents.clearPendingWrite(PendingWriteReason::SIMPLE_FRAME);
 
   // Remove the path - should succeed without retiring CID
   auto removeResult = manager_->removePath(pathId);
@@ -973,6 +975,7 @@ TEST_F(QuicPathManagerTest, SwitchCurrentPath_WithoutDestinationCid) {
 
   // Clear pending frames
   connState_->pendingEvents.frames.clear();
+  connState_->pendingEvents.clearPendingWrite(PendingWriteReason::SIMPLE_FRAME);
 
   // Switch to the new path - should succeed without retiring CID
   auto switchResult = manager_->switchCurrentPath(newPathId);
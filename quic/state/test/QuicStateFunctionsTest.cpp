@@ -266,6 +266,49 @@ TEST_P(UpdateReceivedUdpPacketTimestampsTest, TestUpdatePktReceiveTimestamps) {
       conn.transportSettings.maxReceiveTimestampsPerAckStored + 1);
 }
 
+TEST_P(
+    UpdateReceivedUdpPacketTimestampsTest,
+    TestPktReceiveTimestampsRingDoesNotGrow) {
+  QuicServerConnectionState conn(
+      FizzServerQuicHandshakeContext::Builder().build());
+
+  PacketNum nextPacketNum = 0;
+  TimePoint latestTimeStamp = Clock::now();
+  conn.ackStates = AckStates(nextPacketNum);
+  auto& ackState = getAckState(conn, PacketNumberSpace::AppData);
+  for (uint64_t i = 0;
+       i < conn.transportSettings.maxReceiveTimestampsPerAckStored * 3;
+       i++) {
+    updateAckState(
+        conn,
+        PacketNumberSpace::AppData,
+        nextPacketNum++,
+        true /* pktHasRetransmattableData */,
+        false /* pktHasCryptoData */,
+        latestTimeStamp);
+    latestTimeStamp += 1ms;
+    // The ring is sized once, on the first timestamp.
+    EXPECT_EQ(
+        ackState.recvdPacketInfos.max_size(),
+        conn.transportSettings.maxReceiveTimestampsPerAckStored);
+  }
+  EXPECT_EQ(
+      ackState.recvdPacketInfos.back().pktNum,
+      conn.transportSettings.maxReceiveTimestampsPerAckStored * 3 - 1);
+
+  // Not storing timestamps at all leaves the ring alone.
+  conn.transportSettings.maxReceiveTimestampsPerAckStored = 0;
+  ackState.recvdPacketInfos.clear();
+  updateAckState(
+      conn,
+      PacketNumberSpace::AppData,
+      nextPacketNum++,
+      true /* pktHasRetransmattableData */,
+      false /* pktHasCryptoData */,
+      latestTimeStamp);
+  EXPECT_TRUE(ackState.recvdPacketInfos.empty());
+}
+
 TEST_P(
     UpdateReceivedUdpPacketTimestampsTest,
     TestUpdateOutOfOrderPktReceiveTimestamps) {
@@ -2626,6 +2626,54 @@ TEST_P(QuicStreamFunctionsTestBase, AckCryptoStreamOffsetLengthMismatch) {
   EXPECT_EQ(cryptoStream.retransmissionBuffer.size(), 1);
 }
 
+TEST_P(QuicStreamFunctionsTestBase, CryptoStreamWriteReservesFlight) {
+  auto& cryptoStream = conn.cryptoState->handshakeStream;
+  auto data = IOBuf::copyBuffer("EE");
+  data->appendToChain(IOBuf::copyBuffer("Certificate"));
+  const auto* firstRange = data->data();
+  writeDataToQuicStream(cryptoStream, std::move(data));
+
+  // The pending writes reference the data handed over by the handshake.
+  EXPECT_EQ(
+      cryptoStream.pendingWrites.getHead()->getRange().data(), firstRange);
+  EXPECT_EQ(cryptoStream.pendingWrites.chainLength(), 13);
+
+  auto capacity = cryptoStream.retransmissionBuffer.bucket_count();
+  EXPECT_GE(capacity, kCryptoStreamReservedFrames);
+  for (uint64_t i = 0; i < kCryptoStreamReservedFrames; i++) {
+    cryptoStream.retransmissionBuffer.emplace(
+        i,
+        std::make_unique<WriteStreamBuffer>(
+            ChainedByteRangeHead(IOBuf::copyBuffer("x")), i));
+  }
+  EXPECT_EQ(cryptoStream.retransmissionBuffer.bucket_count(), capacity);
+
+  // Other levels haven't been written to and stay empty.
+  EXPECT_EQ(
+      conn.cryptoState->oneRttStream.retransmissionBuffer.bucket_count(), 0);
+}
+
+TEST_P(QuicStreamFunctionsTestBase, CryptoStreamReadDoesNotCopy) {
+  auto& cryptoStream = conn.cryptoState->initialStream;
+  auto first = IOBuf::copyBuffer("Client");
+  auto second = IOBuf::copyBuffer("Hello");
+  const auto* firstData = first->data();
+  const auto* secondData = second->data();
+  ASSERT_FALSE(
+      appendDataToReadBuffer(cryptoStream, StreamBuffer(std::move(second), 6))
+          .hasError());
+  ASSERT_FALSE(
+      appendDataToReadBuffer(cryptoStream, StreamBuffer(std::move(first), 0))
+          .hasError());
+
+  auto data = readDataFromCryptoStream(cryptoStream);
+  ASSERT_TRUE(data);
+  EXPECT_EQ(data->computeChainDataLength(), 11);
+  EXPECT_EQ(data->data(), firstData);
+  EXPECT_EQ(data->next()->data(), secondData);
+  EXPECT_TRUE(cryptoStream.readBuffer.empty());
+}
+
 TEST_P(QuicStreamFunctionsTestBase, CryptoStreamBufferLimitExceeded) {
   auto& cryptoStream = conn.cryptoState->handshakeStream;
 
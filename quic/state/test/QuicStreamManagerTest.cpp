@@ -857,6 +857,155 @@ TEST_P(QuicStreamManagerTest, TestReliableResetBasic) {
   EXPECT_EQ(quicStreamState->conn.flowControlState.sumCurStreamBufferLen, 0);
 }
 
+TEST_P(QuicStreamManagerTest, CorkHoldsSubPacketData) {
+  auto& manager = *conn.streamManager;
+  conn.transportSettings.corkMinFillBytes = 100;
+  auto streamResult = manager.createNextBidirectionalStream();
+  ASSERT_TRUE(streamResult.has_value());
+  auto* stream = streamResult.value();
+  EXPECT_TRUE(manager.setStreamCorked(stream->id, true));
+
+  ASSERT_FALSE(
+      writeDataToQuicStream(*stream, createBuffer(50), false).hasError());
+  EXPECT_FALSE(manager.hasWritable());
+  EXPECT_TRUE(manager.hasCorkHeldStreams());
+
+  // Crossing the fill threshold releases the data.
+  ASSERT_FALSE(
+      writeDataToQuicStream(*stream, createBuffer(50), false).hasError());
+  EXPECT_TRUE(manager.hasWritable());
+  EXPECT_FALSE(manager.hasCorkHeldStreams());
+}
+
+TEST_P(QuicStreamManagerTest, CorkReleaseSendsShortTail) {
+  auto& manager = *conn.streamManager;
+  conn.transportSettings.corkMinFillBytes = 100;
+  auto streamResult = manager.createNextBidirectionalStream();
+  ASSERT_TRUE(streamResult.has_value());
+  auto* stream = streamResult.value();
+  EXPECT_TRUE(manager.setStreamCorked(stream->id, true));
+
+  ASSERT_FALSE(
+      writeDataToQuicStream(*stream, createBuffer(150), false).hasError());
+  EXPECT_TRUE(manager.hasWritable());
+  EXPECT_EQ(stream->corkFlushOffset, 150);
+
+  // A full packet goes out. The 50 byte tail was part of the release and
+  // stays writable.
+  stream->pendingWrites.trimStartAtMost(100);
+  stream->currentWriteOffset += 100;
+  manager.updateWritableStreams(*stream);
+  EXPECT_TRUE(manager.hasWritable());
+  EXPECT_FALSE(manager.hasCorkHeldStreams());
+
+  // Data written after the tail is sent is corked again.
+  stream->pendingWrites.trimStartAtMost(50);
+  stream->currentWriteOffset += 50;
+  ASSERT_FALSE(
+      writeDataToQuicStream(*stream, createBuffer(10), false).hasError());
+  EXPECT_FALSE(manager.hasWritable());
+  EXPECT_TRUE(manager.hasCorkHeldStreams());
+}
+
+TEST_P(QuicStreamManagerTest, CorkReleasedByFinAndUncork) {
+  auto& manager = *conn.streamManager;
+  conn.transportSettings.corkMinFillBytes = 100;
+  auto streamResult = manager.createNextBidirectionalStream();
+  ASSERT_TRUE(streamResult.has_value());
+  auto* stream = streamResult.value();
+  auto streamResult2 = manager.createNextBidirectionalStream();
+  ASSERT_TRUE(streamResult2.has_value());
+  auto* stream2 = streamResult2.value();
+  EXPECT_TRUE(manager.setStreamCorked(stream->id, true));
+  EXPECT_TRUE(manager.setStreamCorked(stream2->id, true));
+
+  ASSERT_FALSE(
+      writeDataToQuicStream(*stream, createBuffer(10), true).hasError());
+  EXPECT_TRUE(manager.hasWritable());
+  EXPECT_FALSE(manager.hasCorkHeldStreams());
+
+  manager.removeWritable(*stream);
+  ASSERT_FALSE(
+      writeDataToQuicStream(*stream2, createBuffer(10), false).hasError());
+  EXPECT_FALSE(manager.hasWritable());
+  EXPECT_TRUE(manager.setStreamCorked(stream2->id, false));
+  EXPECT_TRUE(manager.hasWritable());
+  EXPECT_FALSE(manager.hasCorkHeldStreams());
+}
+
+TEST_P(QuicStreamManagerTest, ConnectionCorkFlush) {
+  auto& manager = *conn.streamManager;
+  conn.transportSettings.corkMinFillBytes = 100;
+  manager.setConnectionCorked(true);
+  EXPECT_TRUE(manager.isConnectionCorked());
+  auto streamResult = manager.createNextBidirectionalStream();
+  ASSERT_TRUE(streamResult.has_value());
+  auto* stream = streamResult.value();
+
+  ASSERT_FALSE(
+      writeDataToQuicStream(*stream, createBuffer(10), false).hasError());
+  EXPECT_FALSE(manager.hasWritable());
+  EXPECT_TRUE(manager.hasCorkHeldStreams());
+
+  // A flush releases what is buffered, but the connection stays corked.
+  manager.flushCorkedStreams();
+  EXPECT_TRUE(manager.hasWritable());
+  EXPECT_FALSE(manager.hasCorkHeldStreams());
+  EXPECT_TRUE(manager.isConnectionCorked());
+  EXPECT_EQ(stream->corkFlushOffset, 10);
+}
+
+TEST_P(QuicStreamManagerTest, ImplicitlyOpenedPeerStreamsStayLazy) {
+  auto& manager = *conn.streamManager;
+  constexpr StreamId kNumStreams = 1000;
+  StreamId lastId = (kNumStreams - 1) * detail::kStreamIncrement;
+  auto streamResult = manager.getStream(lastId);
+  ASSERT_FALSE(streamResult.hasError());
+  ASSERT_NE(streamResult.value(), nullptr);
+
+  // Only the stream that was used has state, the others are ids in a set.
+  EXPECT_EQ(manager.streamCount(), 1);
+  EXPECT_EQ(manager.openBidirectionalPeerStreams().size(), kNumStreams);
+  EXPECT_EQ(
+      manager.newPeerStreams().size(),
+      GetParam().notifyOnNewStreamsExplicitly ? 1 : kNumStreams);
+
+  // Closing streams out of order fragments the set without losing count.
+  for (StreamId i : {500, 10, 700, 20}) {
+    auto result = manager.getStream(i * detail::kStreamIncrement);
+    ASSERT_FALSE(result.hasError());
+    auto* stream = result.value();
+    ASSERT_NE(stream, nullptr);
+    stream->sendState = StreamSendState::Closed;
+    stream->recvState = StreamRecvState::Closed;
+    ASSERT_FALSE(manager.removeClosedStream(stream->id).hasError());
+  }
+  EXPECT_EQ(manager.streamCount(), 1);
+  EXPECT_EQ(manager.openBidirectionalPeerStreams().size(), kNumStreams - 4);
+  EXPECT_TRUE(manager.streamExists(30 * detail::kStreamIncrement));
+  EXPECT_FALSE(manager.streamExists(20 * detail::kStreamIncrement));
+}
+
+TEST(StreamIdSetTest, SizeTracksAddsAndRemoves) {
+  StreamIdSet set(0x01);
+  set.add(0x01, 0x25);
+  EXPECT_EQ(set.size(), 10);
+  // Overlapping and repeated adds don't double count.
+  set.add(0x21, 0x2d);
+  EXPECT_EQ(set.size(), 12);
+  set.add(0x05);
+  EXPECT_EQ(set.size(), 12);
+  set.remove(0x09);
+  set.remove(0x09);
+  EXPECT_EQ(set.size(), 11);
+  // An add bridging a gap only counts the ids that were missing.
+  set.add(0x41);
+  set.add(0x05, 0x45);
+  EXPECT_EQ(set.size(), 18);
+  set.clear();
+  EXPECT_EQ(set.size(), 0);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     QuicStreamManagerTest,
     QuicStreamManagerTest,
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/state/ReceivedPacketWindow.h>
+
+#include <gtest/gtest.h>
+
+using namespace quic;
+
+TEST(ReceivedPacketWindowTest, Empty) {
+  ReceivedPacketWindow window;
+  EXPECT_FALSE(window.contains(0));
+  EXPECT_FALSE(window.contains(100));
+}
+
+TEST(ReceivedPacketWindowTest, InOrder) {
+  ReceivedPacketWindow window;
+  for (PacketNum packetNum = 0; packetNum < 1000; packetNum++) {
+    EXPECT_FALSE(window.contains(packetNum));
+    window.insert(packetNum);
+    EXPECT_TRUE(window.contains(packetNum));
+  }
+  // Everything still in the window is known, older packets are not tracked.
+  EXPECT_TRUE(window.contains(999 - ReceivedPacketWindow::kSize + 1));
+  EXPECT_FALSE(window.contains(999 - ReceivedPacketWindow::kSize));
+  EXPECT_FALSE(window.contains(1000));
+}
+
+TEST(ReceivedPacketWindowTest, OutOfOrderAndGaps) {
+  ReceivedPacketWindow window;
+  window.insert(10);
+  window.insert(75);
+  window.insert(12);
+  window.insert(200);
+  EXPECT_TRUE(window.contains(10));
+  EXPECT_FALSE(window.contains(11));
+  EXPECT_TRUE(window.contains(12));
+  EXPECT_TRUE(window.contains(75));
+  EXPECT_FALSE(window.contains(76));
+  EXPECT_TRUE(window.contains(200));
+
+  // Shifts that don't fall on word boundaries keep every bit in place.
+  window.insert(263);
+  EXPECT_TRUE(window.contains(12));
+  EXPECT_TRUE(window.contains(75));
+  EXPECT_TRUE(window.contains(200));
+  EXPECT_FALSE(window.contains(201));
+  EXPECT_TRUE(window.contains(263));
+}
+
+TEST(ReceivedPacketWindowTest, JumpPastWindow) {
+  ReceivedPacketWindow window;
+  window.insert(5);
+  window.insert(6);
+  window.insert(6 + ReceivedPacketWindow::kSize * 2);
+  EXPECT_FALSE(window.contains(5));
+  EXPECT_FALSE(window.contains(6));
+  EXPECT_TRUE(window.contains(6 + ReceivedPacketWindow::kSize * 2));
+
+  // Packets older than the window are ignored.
+  window.insert(7);
+  EXPECT_FALSE(window.contains(7));
+}
@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/tools/trace_replay/TraceFormat.h>
+
+#include <quic/codec/QuicInteger.h>
+#include <quic/common/BufUtil.h>
+#include <quic/common/ContiguousCursor.h>
+
+namespace quic {
+
+namespace {
+
+constexpr size_t kTraceAppendLen = 4096;
+
+enum class TraceRecordType : uint8_t {
+  Packet = 1,
+  AppWrite = 2,
+  AppClose = 3,
+};
+
+enum class TraceFrameType : uint8_t {
+  Ack = 1,
+  Stream = 2,
+  MaxData = 3,
+  MaxStreamData = 4,
+  Ping = 5,
+};
+
+QuicError traceError(std::string message) {
+  return QuicError(LocalErrorCode::INTERNAL_ERROR, std::move(message));
+}
+
+class TraceDecoder {
+ public:
+  explicit TraceDecoder(ContiguousReadCursor& cursor) : cursor_(cursor) {}
+
+  quic::Expected<uint64_t, QuicError> varint() {
+    auto val = decodeQuicInteger(cursor_);
+    if (!val) {
+      return quic::make_unexpected(traceError("Truncated trace integer"));
+    }
+    return val->first;
+  }
+
+  quic::Expected<uint8_t, QuicError> byte() {
+    uint8_t val;
+    if (!cursor_.tryRead(val)) {
+      return quic::make_unexpected(traceError("Truncated trace"));
+    }
+    return val;
+  }
+
+  quic::Expected<TraceFrame, QuicError> frame() {
+    auto type = byte();
+    if (!type.has_value()) {
+      return quic::make_unexpected(type.error());
+    }
+    switch (static_cast<TraceFrameType>(*type)) {
+      case TraceFrameType::Ack: {
+        TraceAckFrame ack;
+        auto ackDelay = varint();
+        auto numBlocks = varint();
+        if (!ackDelay.has_value() || !numBlocks.has_value()) {
+          return quic::make_unexpected(traceError("Truncated ack frame"));
+        }
+        ack.ackDelay = std::chrono::microseconds(*ackDelay);
+        // Blocks are encoded as in an ACK frame: the largest acked, then the
+        // first block length, then (gap, length) pairs going down.
+        PacketNum nextEnd = 0;
+        for (uint64_t i = 0; i < *numBlocks; i++) {
+          auto gapOrLargest = varint();
+          auto length = varint();
+          if (!gapOrLargest.has_value() || !length.has_value()) {
+            return quic::make_unexpected(traceError("Truncated ack block"));
+          }
+          if (i > 0 && nextEnd < *gapOrLargest) {
+            return quic::make_unexpected(traceError("Invalid ack block"));
+          }
+          PacketNum end = i == 0 ? *gapOrLargest : nextEnd - *gapOrLargest;
+          if (end < *length) {
+            return quic::make_unexpected(traceError("Invalid ack block"));
+          }
+          PacketNum start = end - *length;
+          ack.ackBlocks.emplace_back(start, end);
+          nextEnd = start;
+        }
+        return ack;
+      }
+      case TraceFrameType::Stream: {
+        auto streamId = varint();
+        auto offset = varint();
+        auto length = varint();
+        auto fin = byte();
+        if (!streamId.has_value() || !offset.has_value() ||
+            !length.has_value() || !fin.has_value()) {
+          return quic::make_unexpected(traceError("Truncated stream frame"));
+        }
+        return TraceStreamFrame{*streamId, *offset, *length, *fin != 0};
+      }
+      case TraceFrameType::MaxData: {
+        auto maximumData = varint();
+        if (!maximumData.has_value()) {
+          return quic::make_unexpected(traceError("Truncated max data frame"));
+        }
+        return TraceMaxDataFrame{*maximumData};
+      }
+      case TraceFrameType::MaxStreamData: {
+        auto streamId = varint();
+        auto maximumData = varint();
+        if (!streamId.has_value() || !maximumData.has_value()) {
+          return quic::make_unexpected(
+              traceError("Truncated max stream data frame"));
+        }
+        return TraceMaxStreamDataFrame{*streamId, *maximumData};
+      }
+      case TraceFrameType::Ping:
+        return TracePingFrame{};
+    }
+    return quic::make_unexpected(traceError("Unknown trace frame type"));
+  }
+
+ private:
+  ContiguousReadCursor& cursor_;
+};
+
+} // namespace
+
+TraceWriter::TraceWriter(QuicNodeType vantagePoint)
+    : vantagePoint_(vantagePoint),
+      buf_(BufHelpers::create(kTraceAppendLen)),
+      appender_(buf_.get(), kTraceAppendLen) {
+  writeHeader();
+}
+
+void TraceWriter::writeVarint(uint64_t value) {
+  QuicInteger(value).encode([&](auto val) { appender_.writeBE(val); });
+}
+
+void TraceWriter::writeByte(uint8_t value) {
+  appender_.writeBE(value);
+}
+
+void TraceWriter::writeHeader() {
+  appender_.writeBE(kTraceMagic);
+  writeVarint(kTraceVersion);
+  writeByte(static_cast<uint8_t>(vantagePoint_));
+}
+
+void TraceWriter::append(const TraceEvent& event) {
+  CHECK_GE(event.time, lastEventTime_);
+  auto timeDelta = event.time - lastEventTime_;
+  lastEventTime_ = event.time;
+  if (auto packet = std::get_if<TracePacketEvent>(&event.event)) {
+    writeByte(static_cast<uint8_t>(TraceRecordType::Packet));
+    writeVarint(timeDelta.count());
+    writeByte(static_cast<uint8_t>(packet->pnSpace));
+    writeVarint(packet->packetNum);
+    writeVarint(packet->packetSize);
+    writeVarint(packet->frames.size());
+    for (const auto& frame : packet->frames) {
+      appendFrame(frame);
+    }
+  } else if (auto write = std::get_if<TraceAppWriteEvent>(&event.event)) {
+    writeByte(static_cast<uint8_t>(TraceRecordType::AppWrite));
+    writeVarint(timeDelta.count());
+    writeVarint(write->streamId);
+    writeVarint(write->length);
+    writeByte(write->eof ? 1 : 0);
+  } else {
+    writeByte(static_cast<uint8_t>(TraceRecordType::AppClose));
+    writeVarint(timeDelta.count());
+  }
+}
+
+void TraceWriter::appendFrame(const TraceFrame& frame) {
+  if (auto ack = std::get_if<TraceAckFrame>(&frame)) {
+    writeByte(static_cast<uint8_t>(TraceFrameType::Ack));
+    writeVarint(ack->ackDelay.count());
+    writeVarint(ack->ackBlocks.size());
+    PacketNum prevStart = 0;
+    for (size_t i = 0; i < ack->ackBlocks.size(); i++) {
+      const auto& block = ack->ackBlocks[i];
+      writeVarint(i == 0 ? block.endPacket : prevStart - block.endPacket);
+      writeVarint(block.endPacket - block.startPacket);
+      prevStart = block.startPacket;
+    }
+  } else if (auto stream = std::get_if<TraceStreamFrame>(&frame)) {
+    writeByte(static_cast<uint8_t>(TraceFrameType::Stream));
+    writeVarint(stream->streamId);
+    writeVarint(stream->offset);
+    writeVarint(stream->length);
+    writeByte(stream->fin ? 1 : 0);
+  } else if (auto maxData = std::get_if<TraceMaxDataFrame>(&frame)) {
+    writeByte(static_cast<uint8_t>(TraceFrameType::MaxData));
+    writeVarint(maxData->maximumData);
+  } else if (
+      auto maxStreamData = std::get_if<TraceMaxStreamDataFrame>(&frame)) {
+    writeByte(static_cast<uint8_t>(TraceFrameType::MaxStreamData));
+    writeVarint(maxStreamData->streamId);
+    writeVarint(maxStreamData->maximumData);
+  } else {
+    writeByte(static_cast<uint8_t>(TraceFrameType::Ping));
+  }
+}
+
+BufPtr TraceWriter::finish() {
+  auto result = std::move(buf_);
+  buf_ = BufHelpers::create(kTraceAppendLen);
+  appender_ = BufAppender(buf_.get(), kTraceAppendLen);
+  lastEventTime_ = 0us;
+  writeHeader();
+  return result;
+}
+
+quic::Expected<Trace, QuicError> decodeTrace(const folly::IOBuf& data) {
+  auto coalesced = data.cloneCoalescedAsValue();
+  ContiguousReadCursor cursor(coalesced.data(), coalesced.length());
+  TraceDecoder decoder(cursor);
+
+  uint32_t magic;
+  if (!cursor.tryReadBE(magic) || magic != kTraceMagic) {
+    return quic::make_unexpected(traceError("Not a trace"));
+  }
+  auto version = decoder.varint();
+  if (!version.has_value() || *version != kTraceVersion) {
+    return quic::make_unexpected(traceError("Unsupported trace version"));
+  }
+  auto vantagePoint = decoder.byte();
+  if (!vantagePoint.has_value()) {
+    return quic::make_unexpected(vantagePoint.error());
+  }
+
+  Trace trace;
+  trace.vantagePoint = static_cast<QuicNodeType>(*vantagePoint);
+  std::chrono::microseconds time = 0us;
+  while (!cursor.isAtEnd()) {
+    auto type = decoder.byte();
+    auto timeDelta = decoder.varint();
+    if (!type.has_value() || !timeDelta.has_value()) {
+      return quic::make_unexpected(traceError("Truncated trace record"));
+    }
+    time += std::chrono::microseconds(*timeDelta);
+    TraceEvent event;
+    event.time = time;
+    switch (static_cast<TraceRecordType>(*type)) {
+      case TraceRecordType::Packet: {
+        auto pnSpace = decoder.byte();
+        auto packetNum = decoder.varint();
+        auto packetSize = decoder.varint();
+        auto numFrames = decoder.varint();
+        if (!pnSpace.has_value() || !packetNum.has_value() ||
+            !packetSize.has_value() || !numFrames.has_value() ||
+            *pnSpace > static_cast<uint8_t>(PacketNumberSpace::MAX)) {
+          return quic::make_unexpected(traceError("Invalid packet record"));
+        }
+        TracePacketEvent packet;
+        packet.pnSpace = static_cast<PacketNumberSpace>(*pnSpace);
+        packet.packetNum = *packetNum;
+        packet.packetSize = *packetSize;
+        for (uint64_t i = 0; i < *numFrames; i++) {
+          auto frame = decoder.frame();
+          if (!frame.has_value()) {
+            return quic::make_unexpected(frame.error());
+          }
+          packet.frames.push_back(std::move(*frame));
+        }
+        event.event = std::move(packet);
+        break;
+      }
+      case TraceRecordType::AppWrite: {
+        auto streamId = decoder.varint();
+        auto length = decoder.varint();
+        auto eof = decoder.byte();
+        if (!streamId.has_value() || !length.has_value() || !eof.has_value()) {
+          return quic::make_unexpected(traceError("Invalid app write record"));
+        }
+        event.event = TraceAppWriteEvent{*streamId, *length, *eof != 0};
+        break;
+      }
+      case TraceRecordType::AppClose:
+        event.event = TraceAppCloseEvent{};
+        break;
+      default:
+        return quic::make_unexpected(traceError("Unknown trace record type"));
+    }
+    trace.events.push_back(std::move(event));
+  }
+  return trace;
+}
+
+} // namespace quic
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/QuicConstants.h>
+#include <quic/QuicException.h>
+#include <quic/codec/Types.h>
+#include <quic/common/BufUtil.h>
+#include <quic/common/Expected.h>
+
+#include <variant>
+#include <vector>
+
+namespace quic {
+
+/**
+ * A trace is a compact binary record of what a single connection received
+ * from its peer (decrypted frames, with their receive times) and what the
+ * application asked it to send. Payload bytes are not recorded, only their
+ * lengths, so a trace reproduces the shape of the traffic (ACK patterns, loss,
+ * reordering, app writes) without the content.
+ *
+ * Encoding: a header of the magic "MVTR", a version varint and the vantage
+ * point, followed by records. Each record is a type byte, the time since the
+ * previous record in microseconds as a varint, and a type-specific body. All
+ * integers are QUIC variable length integers.
+ */
+
+constexpr uint32_t kTraceMagic = 0x4d565452; // "MVTR"
+constexpr uint64_t kTraceVersion = 1;
+
+struct TraceAckFrame {
+  std::chrono::microseconds ackDelay{0us};
+  // Ordered in descending order by start packet, like ReadAckFrame.
+  std::vector<AckBlock> ackBlocks;
+};
+
+struct TraceStreamFrame {
+  StreamId streamId;
+  uint64_t offset;
+  uint64_t length;
+  bool fin;
+};
+
+struct TraceMaxDataFrame {
+  uint64_t maximumData;
+};
+
+struct TraceMaxStreamDataFrame {
+  StreamId streamId;
+  uint64_t maximumData;
+};
+
+struct TracePingFrame {};
+
+using TraceFrame = std::variant<
+    TraceAckFrame,
+    TraceStreamFrame,
+    TraceMaxDataFrame,
+    TraceMaxStreamDataFrame,
+    TracePingFrame>;
+
+// A packet received from the peer. Frames that can't be replayed (crypto,
+// padding, connection id management, ...) are not recorded.
+struct TracePacketEvent {
+  PacketNumberSpace pnSpace;
+  PacketNum packetNum;
+  uint64_t packetSize;
+  std::vector<TraceFrame> frames;
+};
+
+// Application called writeChain with length bytes.
+struct TraceAppWriteEvent {
+  StreamId streamId;
+  uint64_t length;
+  bool eof;
+};
+
+// Application closed the connection.
+struct TraceAppCloseEvent {};
+
+struct TraceEvent {
+  // Time since the first event of the trace.
+  std::chrono::microseconds time{0us};
+  std::variant<TracePacketEvent, TraceAppWriteEvent, TraceAppCloseEvent> event;
+};
+
+struct Trace {
+  QuicNodeType vantagePoint{QuicNodeType::Server};
+  std::vector<TraceEvent> events;
+};
+
+/**
+ * Incrementally encodes trace events. The time of each event is taken
+ * relative to the previous one, so events must be appended in time order.
+ */
+class TraceWriter {
+ public:
+  explicit TraceWriter(QuicNodeType vantagePoint);
+
+  void append(const TraceEvent& event);
+
+  // Returns the encoded trace so far and resets the writer to an empty trace
+  // with the same vantage point.
+  BufPtr finish();
+
+ private:
+  void writeHeader();
+  void appendFrame(const TraceFrame& frame);
+  void writeVarint(uint64_t value);
+  void writeByte(uint8_t value);
+
+  QuicNodeType vantagePoint_;
+  BufPtr buf_;
+  BufAppender appender_;
+  std::chrono::microseconds lastEventTime_{0us};
+};
+
+[[nodiscard]] quic::Expected<Trace, QuicError> decodeTrace(
+    const folly::IOBuf& data);
+
+} // namespace quic
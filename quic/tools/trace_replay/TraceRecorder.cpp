@@ -0,0 +1,364 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/tools/trace_replay/TraceRecorder.h>
+
+#include <quic/logging/QLoggerConstants.h>
+
+namespace quic {
+
+TraceRecorder::TraceRecorder(
+    VantagePoint vantagePointIn,
+    std::shared_ptr<QLogger> wrapped)
+    : QLogger(
+          vantagePointIn,
+          wrapped ? wrapped->protocolType : std::string(kHTTP3ProtocolType)),
+      wrapped_(std::move(wrapped)),
+      writer_(vantagePointIn) {}
+
+std::chrono::microseconds TraceRecorder::eventTime(TimePoint time) {
+  if (!startTime_) {
+    startTime_ = time;
+  }
+  lastEventTime_ = std::max(
+      lastEventTime_,
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          time - *startTime_));
+  return lastEventTime_;
+}
+
+void TraceRecorder::recordAppWrite(
+    StreamId streamId,
+    uint64_t length,
+    bool eof) {
+  TraceEvent event;
+  event.time = eventTime(Clock::now());
+  event.event = TraceAppWriteEvent{streamId, length, eof};
+  writer_.append(event);
+}
+
+void TraceRecorder::recordAppClose() {
+  TraceEvent event;
+  event.time = eventTime(Clock::now());
+  event.event = TraceAppCloseEvent{};
+  writer_.append(event);
+}
+
+BufPtr TraceRecorder::finish() {
+  startTime_.reset();
+  lastEventTime_ = std::chrono::microseconds(0);
+  return writer_.finish();
+}
+
+void TraceRecorder::addPacket(
+    const RegularQuicPacket& regularPacket,
+    uint64_t packetSize) {
+  recordPacket(regularPacket, packetSize, Clock::now());
+  if (wrapped_) {
+    wrapped_->addPacket(regularPacket, packetSize);
+  }
+}
+
+void TraceRecorder::addPacket(
+    const RegularQuicPacket& regularPacket,
+    uint64_t packetSize,
+    TimePoint receiveTime) {
+  // Packets the socket didn't timestamp are recorded as received now.
+  recordPacket(
+      regularPacket,
+      packetSize,
+      receiveTime == TimePoint() ? Clock::now() : receiveTime);
+  if (wrapped_) {
+    wrapped_->addPacket(regularPacket, packetSize, receiveTime);
+  }
+}
+
+void TraceRecorder::recordPacket(
+    const RegularQuicPacket& regularPacket,
+    uint64_t packetSize,
+    TimePoint receiveTime) {
+  TracePacketEvent packet;
+  packet.pnSpace = regularPacket.header.getPacketNumberSpace();
+  packet.packetNum = regularPacket.header.getPacketSequenceNum();
+  packet.packetSize = packetSize;
+  for (const auto& quicFrame : regularPacket.frames) {
+    switch (quicFrame.type()) {
+      case QuicFrame::Type::ReadAckFrame: {
+        const auto& frame = *quicFrame.asReadAckFrame();
+        TraceAckFrame ack;
+        ack.ackDelay = frame.ackDelay;
+        ack.ackBlocks.assign(frame.ackBlocks.begin(), frame.ackBlocks.end());
+        packet.frames.emplace_back(std::move(ack));
+        break;
+      }
+      case QuicFrame::Type::ReadStreamFrame: {
+        const auto& frame = *quicFrame.asReadStreamFrame();
+        packet.frames.emplace_back(TraceStreamFrame{
+            frame.streamId,
+            frame.offset,
+            frame.data ? frame.data->computeChainDataLength() : 0,
+            frame.fin});
+        break;
+      }
+      case QuicFrame::Type::MaxDataFrame: {
+        const auto& frame = *quicFrame.asMaxDataFrame();
+        packet.frames.emplace_back(TraceMaxDataFrame{frame.maximumData});
+        break;
+      }
+      case QuicFrame::Type::MaxStreamDataFrame: {
+        const auto& frame = *quicFrame.asMaxStreamDataFrame();
+        packet.frames.emplace_back(
+            TraceMaxStreamDataFrame{frame.streamId, frame.maximumData});
+        break;
+      }
+      case QuicFrame::Type::PingFrame:
+        packet.frames.emplace_back(TracePingFrame{});
+        break;
+      default:
+        break;
+    }
+  }
+  TraceEvent event;
+  event.time = eventTime(receiveTime);
+  event.event = std::move(packet);
+  writer_.append(event);
+}
+
+void TraceRecorder::addPacket(
+    const VersionNegotiationPacket& versionPacket,
+    uint64_t packetSize,
+    bool isPacketRecvd) {
+  if (wrapped_) {
+    wrapped_->addPacket(versionPacket, packetSize, isPacketRecvd);
+  }
+}
+
+void TraceRecorder::addPacket(
+    const RegularQuicWritePacket& writePacket,
+    uint64_t packetSize) {
+  if (wrapped_) {
+    wrapped_->addPacket(writePacket, packetSize);
+  }
+}
+
+void TraceRecorder::addPacket(
+    const RetryPacket& retryPacket,
+    uint64_t packetSize,
+    bool isPacketRecvd) {
+  if (wrapped_) {
+    wrapped_->addPacket(retryPacket, packetSize, isPacketRecvd);
+  }
+}
+
+void TraceRecorder::addConnectionClose(
+    std::string error,
+    std::string reason,
+    bool drainConnection,
+    bool sendCloseImmediately) {
+  if (wrapped_) {
+    wrapped_->addConnectionClose(
+        std::move(error),
+        std::move(reason),
+        drainConnection,
+        sendCloseImmediately);
+  }
+}
+
+void TraceRecorder::addTransportSummary(const TransportSummaryArgs& args) {
+  if (wrapped_) {
+    wrapped_->addTransportSummary(args);
+  }
+}
+
+void TraceRecorder::addCongestionMetricUpdate(
+    uint64_t bytesInFlight,
+    uint64_t currentCwnd,
+    std::string congestionEvent,
+    std::string state,
+    std::string recoveryState) {
+  if (wrapped_) {
+    wrapped_->addCongestionMetricUpdate(
+        bytesInFlight,
+        currentCwnd,
+        std::move(congestionEvent),
+        std::move(state),
+        std::move(recoveryState));
+  }
+}
+
+void TraceRecorder::addBandwidthEstUpdate(
+    uint64_t bytes,
+    std::chrono::microseconds interval) {
+  if (wrapped_) {
+    wrapped_->addBandwidthEstUpdate(bytes, interval);
+  }
+}
+
+void TraceRecorder::addAppLimitedUpdate() {
+  if (wrapped_) {
+    wrapped_->addAppLimitedUpdate();
+  }
+}
+
+void TraceRecorder::addAppUnlimitedUpdate() {
+  if (wrapped_) {
+    wrapped_->addAppUnlimitedUpdate();
+  }
+}
+
+void TraceRecorder::addPacingMetricUpdate(
+    uint64_t pacingBurstSizeIn,
+    std::chrono::microseconds pacingIntervalIn) {
+  if (wrapped_) {
+    wrapped_->addPacingMetricUpdate(pacingBurstSizeIn, pacingIntervalIn);
+  }
+}
+
+void TraceRecorder::addPacingObservation(
+    std::string actual,
+    std::string expected,
+    std::string conclusion) {
+  if (wrapped_) {
+    wrapped_->addPacingObservation(
+        std::move(actual), std::move(expected), std::move(conclusion));
+  }
+}
+
+void TraceRecorder::addAppIdleUpdate(std::string idleEvent, bool idle) {
+  if (wrapped_) {
+    wrapped_->addAppIdleUpdate(std::move(idleEvent), idle);
+  }
+}
+
+void TraceRecorder::addPacketDrop(size_t packetSize, std::string dropReasonIn) {
+  if (wrapped_) {
+    wrapped_->addPacketDrop(packetSize, std::move(dropReasonIn));
+  }
+}
+
+void TraceRecorder::addDatagramReceived(uint64_t dataLen) {
+  if (wrapped_) {
+    wrapped_->addDatagramReceived(dataLen);
+  }
+}
+
+void TraceRecorder::addLossAlarm(
+    PacketNum largestSent,
+    uint64_t alarmCount,
+    uint64_t outstandingPackets,
+    std::string type) {
+  if (wrapped_) {
+    wrapped_->addLossAlarm(
+        largestSent, alarmCount, outstandingPackets, std::move(type));
+  }
+}
+
+void TraceRecorder::addPacketsLost(
+    PacketNum largestLostPacketNum,
+    uint64_t lostBytes,
+    uint64_t lostPackets) {
+  if (wrapped_) {
+    wrapped_->addPacketsLost(largestLostPacketNum, lostBytes, lostPackets);
+  }
+}
+
+void TraceRecorder::addTransportStateUpdate(std::string update) {
+  if (wrapped_) {
+    wrapped_->addTransportStateUpdate(std::move(update));
+  }
+}
+
+void TraceRecorder::addPacketBuffered(
+    ProtectionType protectionType,
+    uint64_t packetSize) {
+  if (wrapped_) {
+    wrapped_->addPacketBuffered(protectionType, packetSize);
+  }
+}
+
+void TraceRecorder::addMetricUpdate(
+    std::chrono::microseconds latestRtt,
+    std::chrono::microseconds mrtt,
+    std::chrono::microseconds srtt,
+    std::chrono::microseconds ackDelay) {
+  if (wrapped_) {
+    wrapped_->addMetricUpdate(latestRtt, mrtt, srtt, ackDelay);
+  }
+}
+
+void TraceRecorder::addStreamStateUpdate(
+    quic::StreamId streamId,
+    std::string update,
+    Optional<std::chrono::milliseconds> timeSinceStreamCreation) {
+  if (wrapped_) {
+    wrapped_->addStreamStateUpdate(
+        streamId, std::move(update), timeSinceStreamCreation);
+  }
+}
+
+void TraceRecorder::addConnectionMigrationUpdate(bool intentionalMigration) {
+  if (wrapped_) {
+    wrapped_->addConnectionMigrationUpdate(intentionalMigration);
+  }
+}
+
+void TraceRecorder::addPathValidationEvent(bool success) {
+  if (wrapped_) {
+    wrapped_->addPathValidationEvent(success);
+  }
+}
+
+void TraceRecorder::addPriorityUpdate(
+    quic::StreamId streamId,
+    PriorityQueue::PriorityLogFields priority) {
+  if (wrapped_) {
+    wrapped_->addPriorityUpdate(streamId, std::move(priority));
+  }
+}
+
+void TraceRecorder::addL4sWeightUpdate(
+    double l4sWeight,
+    uint32_t newEct1,
+    uint32_t newCe) {
+  if (wrapped_) {
+    wrapped_->addL4sWeightUpdate(l4sWeight, newEct1, newCe);
+  }
+}
+
+void TraceRecorder::addNetworkPathModelUpdate(
+    uint64_t inflightHi,
+    uint64_t inflightLo,
+    uint64_t bandwidthHiBytes,
+    std::chrono::microseconds bandwidthHiInterval,
+    uint64_t bandwidthLoBytes,
+    std::chrono::microseconds bandwidthLoInterval) {
+  if (wrapped_) {
+    wrapped_->addNetworkPathModelUpdate(
+        inflightHi,
+        inflightLo,
+        bandwidthHiBytes,
+        bandwidthHiInterval,
+        bandwidthLoBytes,
+        bandwidthLoInterval);
+  }
+}
+
+void TraceRecorder::setDcid(Optional<ConnectionId> connID) {
+  dcid = connID;
+  if (wrapped_) {
+    wrapped_->setDcid(connID);
+  }
+}
+
+void TraceRecorder::setScid(Optional<ConnectionId> connID) {
+  scid = connID;
+  if (wrapped_) {
+    wrapped_->setScid(connID);
+  }
+}
+
+} // namespace quic
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/logging/QLogger.h>
+#include <quic/tools/trace_replay/TraceFormat.h>
+
+namespace quic {
+
+/**
+ * Records a connection's ingress into a trace (see TraceFormat.h).
+ *
+ * Received packets are captured from the parsed, decrypted packets the
+ * transport logs to its QLogger, so the recorder is installed as the
+ * connection's QLogger with setQLogger(). Packets are timestamped with the
+ * time the transport received them, not the time they were processed. Every
+ * QLogger call is forwarded to the optional wrapped logger, so existing
+ * qlogging keeps working.
+ *
+ * The transport does not see application intent, so the application reports
+ * its writes and close with recordAppWrite() and recordAppClose() next to the
+ * corresponding transport calls.
+ */
+class TraceRecorder : public QLogger {
+ public:
+  explicit TraceRecorder(
+      VantagePoint vantagePointIn,
+      std::shared_ptr<QLogger> wrapped = nullptr);
+
+  ~TraceRecorder() override = default;
+
+  void recordAppWrite(StreamId streamId, uint64_t length, bool eof);
+
+  void recordAppClose();
+
+  // Returns the trace recorded so far and starts a new one.
+  BufPtr finish();
+
+  // QLogger
+  void addPacket(const RegularQuicPacket& regularPacket, uint64_t packetSize)
+      override;
+  void addPacket(
+      const RegularQuicPacket& regularPacket,
+      uint64_t packetSize,
+      TimePoint receiveTime) override;
+  void addPacket(
+      const VersionNegotiationPacket& versionPacket,
+      uint64_t packetSize,
+      bool isPacketRecvd) override;
+  void addPacket(const RegularQuicWritePacket& writePacket, uint64_t packetSize)
+      override;
+  void addPacket(
+      const RetryPacket& retryPacket,
+      uint64_t packetSize,
+      bool isPacketRecvd) override;
+  void addConnectionClose(
+      std::string error,
+      std::string reason,
+      bool drainConnection,
+      bool sendCloseImmediately) override;
+  void addTransportSummary(const TransportSummaryArgs& args) override;
+  void addCongestionMetricUpdate(
+      uint64_t bytesInFlight,
+      uint64_t currentCwnd,
+      std::string congestionEvent,
+      std::string state = "",
+      std::string recoveryState = "") override;
+  void addBandwidthEstUpdate(uint64_t bytes, std::chrono::microseconds interval)
+      override;
+  void addAppLimitedUpdate() override;
+  void addAppUnlimitedUpdate() override;
+  void addPacingMetricUpdate(
+      uint64_t pacingBurstSizeIn,
+      std::chrono::microseconds pacingIntervalIn) override;
+  void addPacingObservation(
+      std::string actual,
+      std::string expected,
+      std::string conclusion) override;
+  void addAppIdleUpdate(std::string idleEvent, bool idle) override;
+  void addPacketDrop(size_t packetSize, std::string dropReasonIn) override;
+  void addDatagramReceived(uint64_t dataLen) override;
+  void addLossAlarm(
+      PacketNum largestSent,
+      uint64_t alarmCount,
+      uint64_t outstandingPackets,
+      std::string type) override;
+  void addPacketsLost(
+      PacketNum largestLostPacketNum,
+      uint64_t lostBytes,
+      uint64_t lostPackets) override;
+  void addTransportStateUpdate(std::string update) override;
+  void addPacketBuffered(ProtectionType protectionType, uint64_t packetSize)
+      override;
+  void addMetricUpdate(
+      std::chrono::microseconds latestRtt,
+      std::chrono::microseconds mrtt,
+      std::chrono::microseconds srtt,
+      std::chrono::microseconds ackDelay) override;
+  void addStreamStateUpdate(
+      quic::StreamId streamId,
+      std::string update,
+      Optional<std::chrono::milliseconds> timeSinceStreamCreation) override;
+  void addConnectionMigrationUpdate(bool intentionalMigration) override;
+  void addPathValidationEvent(bool success) override;
+  void addPriorityUpdate(
+      quic::StreamId streamId,
+      PriorityQueue::PriorityLogFields priority) override;
+  void addL4sWeightUpdate(double l4sWeight, uint32_t newEct1, uint32_t newCe)
+      override;
+  void addNetworkPathModelUpdate(
+      uint64_t inflightHi,
+      uint64_t inflightLo,
+      uint64_t bandwidthHiBytes,
+      std::chrono::microseconds bandwidthHiInterval,
+      uint64_t bandwidthLoBytes,
+      std::chrono::microseconds bandwidthLoInterval) override;
+  void setDcid(Optional<ConnectionId> connID) override;
+  void setScid(Optional<ConnectionId> connID) override;
+
+ private:
+  // Returns the trace time of an event that happened at time. Trace times
+  // don't go backwards, a packet received before the last recorded event is
+  // recorded at the time of that event.
+  std::chrono::microseconds eventTime(TimePoint time);
+
+  void recordPacket(
+      const RegularQuicPacket& regularPacket,
+      uint64_t packetSize,
+      TimePoint receiveTime);
+
+  std::shared_ptr<QLogger> wrapped_;
+  TraceWriter writer_;
+  Optional<TimePoint> startTime_;
+  std::chrono::microseconds lastEventTime_{0};
+};
+
+} // namespace quic
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/FileUtil.h>
+#include <folly/portability/GFlags.h>
+#include <quic/tools/trace_replay/TraceReplayer.h>
+
+DEFINE_string(trace, "", "Path to a trace recorded with TraceRecorder");
+
+using namespace quic;
+using namespace quic::test;
+
+namespace {
+
+const Trace& getTrace() {
+  static const Trace trace = [] {
+    std::string contents;
+    CHECK(folly::readFile(FLAGS_trace.c_str(), contents))
+        << "Unable to read trace " << FLAGS_trace;
+    auto decoded =
+        decodeTrace(*BufHelpers::wrapBuffer(contents.data(), contents.size()));
+    CHECK(decoded.has_value()) << decoded.error().message;
+    return std::move(decoded.value());
+  }();
+  return trace;
+}
+
+template <typename Replayer>
+void replayTrace(size_t iters) {
+  folly::BenchmarkSuspender suspender;
+  const auto& trace = getTrace();
+  for (size_t i = 0; i < iters; i++) {
+    auto replayer = std::make_unique<Replayer>(trace);
+    suspender.dismissing([&] {
+      auto result = replayer->replay();
+      CHECK(result.has_value()) << toString(result.error().code);
+      folly::doNotOptimizeAway(result->packetsReplayed);
+    });
+    replayer.reset();
+  }
+}
+
+} // namespace
+
+BENCHMARK(ReplayTrace, iters) {
+  // Replays at the endpoint the trace was recorded at.
+  if (getTrace().vantagePoint == QuicNodeType::Server) {
+    replayTrace<ServerTraceReplayer>(iters);
+  } else {
+    replayTrace<ClientTraceReplayer>(iters);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  CHECK(!FLAGS_trace.empty()) << "--trace is required";
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/codec/QuicWriteCodec.h>
+#include <quic/fizz/client/test/QuicClientTransportTestUtil.h>
+#include <quic/server/test/QuicServerTransportTestUtil.h>
+#include <quic/state/QuicStreamUtilities.h>
+#include <quic/tools/trace_replay/TraceFormat.h>
+#include <quic/tools/trace_replay/VirtualQuicEventBase.h>
+
+namespace quic::test {
+
+namespace detail {
+
+// Virtual time the replay starts at. Any fixed point works, it only has to
+// be far enough from the clock's epoch that nothing mistakes it for unset.
+constexpr TimePoint kReplayStartTime{std::chrono::hours(1)};
+
+// Hosts a server transport on a virtual clock.
+class ServerReplayFixture : public QuicServerTransportAfterStartTestBase {
+ public:
+  static constexpr QuicNodeType kNodeType = QuicNodeType::Server;
+
+  ServerReplayFixture()
+      : virtualEvb_(
+            std::make_shared<VirtualQuicEventBase>(&evb, kReplayStartTime)) {
+    qEvb_ = virtualEvb_;
+  }
+
+  void TestBody() override {}
+
+  // Public, the replayer tears the fixture down.
+  void TearDown() override {
+    QuicServerTransportAfterStartTestBase::TearDown();
+  }
+
+  uint16_t getSkipOneInNPacketSequenceNumber() override {
+    // Skipped packet numbers can't be acked, keep the sequence dense so that
+    // recorded ACK blocks stay valid.
+    return 0;
+  }
+
+  VirtualQuicEventBase& virtualEvb() {
+    return *virtualEvb_;
+  }
+
+  QuicSocketLite& transport() {
+    return *server;
+  }
+
+  const QuicConnectionStateBase& conn() const {
+    return server->getConn();
+  }
+
+  ShortHeader makeHeader(PacketNum packetNum) const {
+    return ShortHeader(
+        ProtectionType::KeyPhaseZero, *serverConnectionId, packetNum);
+  }
+
+  void deliver(BufPtr packet) {
+    deliverDataWithoutErrorCheck(
+        NetworkData(std::move(packet), Clock::now(), 0 /* tosValue */),
+        false /* writes */);
+  }
+
+ private:
+  std::shared_ptr<VirtualQuicEventBase> virtualEvb_;
+};
+
+// Hosts a client transport on a virtual clock.
+class ClientReplayFixture : public QuicClientTransportAfterStartTestBase {
+ public:
+  static constexpr QuicNodeType kNodeType = QuicNodeType::Client;
+
+  ClientReplayFixture()
+      : virtualEvb_(std::make_shared<VirtualQuicEventBase>(
+            eventbase_.get(),
+            kReplayStartTime)) {
+    qEvb_ = virtualEvb_;
+  }
+
+  void TestBody() override {}
+
+  // Public, the replayer tears the fixture down.
+  void TearDown() override {
+    QuicClientTransportAfterStartTestBase::TearDown();
+  }
+
+  void SetUpChild() override {
+    // See ServerReplayFixture::getSkipOneInNPacketSequenceNumber().
+    getNonConstConn().transportSettings.skipOneInNPacketSequenceNumber = 0;
+    startTransport();
+  }
+
+  VirtualQuicEventBase& virtualEvb() {
+    return *virtualEvb_;
+  }
+
+  QuicSocketLite& transport() {
+    return *client;
+  }
+
+  const QuicConnectionStateBase& conn() const {
+    return getConn();
+  }
+
+  ShortHeader makeHeader(PacketNum packetNum) const {
+    return ShortHeader(
+        ProtectionType::KeyPhaseZero, *originalConnId, packetNum);
+  }
+
+  // The client timestamps packets when it reads them, which is the current
+  // virtual time.
+  void deliver(BufPtr packet) {
+    deliverDataWithoutErrorCheck(
+        serverAddr, packet->coalesce(), false /* writes */);
+  }
+
+ private:
+  std::shared_ptr<VirtualQuicEventBase> virtualEvb_;
+};
+
+} // namespace detail
+
+/**
+ * Replays a trace against an in-process transport of the trace's vantage
+ * point, using the transport test fixtures to host it.
+ *
+ * The handshake is synthesized by the fixture, so only application data
+ * packets from the trace are replayed. Each recorded packet is rebuilt with
+ * the same packet number and frames (stream payloads are zero-filled).
+ *
+ * The transport runs on a VirtualQuicEventBase: before each event, virtual
+ * time is advanced to the event's recorded time, firing the transport's
+ * timers (loss detection, pacing, delayed ACKs, idle) at their deadlines on
+ * the way. Packets are received at their recorded times. A replay is
+ * therefore deterministic and takes the same path through the transport as
+ * the recording, however long it takes on the wall clock.
+ *
+ * Recorded ACKs refer to the packet numbers of the recording transport.
+ * Blocks above the largest packet the replaying transport has sent are
+ * trimmed, so the replay keeps the recorded ACK shape without acknowledging
+ * packets that were never sent.
+ */
+template <typename Fixture>
+class TraceReplayer {
+ public:
+  struct Stats {
+    uint64_t packetsReplayed{0};
+    uint64_t packetsSkipped{0};
+    uint64_t appWritesReplayed{0};
+  };
+
+  explicit TraceReplayer(const Trace& trace)
+      : trace_(trace), fixture_(std::make_unique<Fixture>()) {
+    CHECK(trace_.vantagePoint == Fixture::kNodeType)
+        << "Trace was recorded at the other endpoint";
+    fixture_->SetUp();
+  }
+
+  ~TraceReplayer() {
+    fixture_->TearDown();
+    fixture_.reset();
+  }
+
+  TraceReplayer(const TraceReplayer&) = delete;
+  TraceReplayer& operator=(const TraceReplayer&) = delete;
+
+  // Returns an error if the transport closed the connection with an error
+  // while replaying.
+  quic::Expected<Stats, QuicError> replay() {
+    Stats stats;
+    auto& evb = fixture_->virtualEvb();
+    auto replayStart = evb.now();
+    for (const auto& event : trace_.events) {
+      evb.advanceTo(replayStart + event.time);
+      if (auto packet = std::get_if<TracePacketEvent>(&event.event)) {
+        if (packet->pnSpace != PacketNumberSpace::AppData) {
+          stats.packetsSkipped++;
+          continue;
+        }
+        replayPacket(*packet);
+        stats.packetsReplayed++;
+      } else if (auto write = std::get_if<TraceAppWriteEvent>(&event.event)) {
+        if (!replayAppWrite(*write)) {
+          continue;
+        }
+        stats.appWritesReplayed++;
+      } else {
+        fixture_->transport().close(std::nullopt);
+        break;
+      }
+      if (conn().localConnectionError) {
+        return quic::make_unexpected(*conn().localConnectionError);
+      }
+    }
+    return stats;
+  }
+
+ private:
+  const QuicConnectionStateBase& conn() const {
+    return fixture_->conn();
+  }
+
+  // Payloads reference a shared zero-filled chunk so that the replay harness
+  // itself doesn't allocate payload memory.
+  static BufPtr zeroes(uint64_t length) {
+    static const std::array<uint8_t, 64 * 1024> kZeroes{};
+    BufPtr result;
+    while (length > 0) {
+      auto chunkLen = std::min<uint64_t>(length, kZeroes.size());
+      auto chunk = BufHelpers::wrapBuffer(kZeroes.data(), chunkLen);
+      if (result) {
+        result->appendToChain(std::move(chunk));
+      } else {
+        result = std::move(chunk);
+      }
+      length -= chunkLen;
+    }
+    return result ? std::move(result) : BufHelpers::create(0);
+  }
+
+  void replayPacket(const TracePacketEvent& packet) {
+    RegularQuicPacketBuilder builder(
+        std::max<uint64_t>(packet.packetSize, kDefaultMaxUDPPayload),
+        fixture_->makeHeader(packet.packetNum),
+        0 /* largestAcked */);
+    CHECK(!builder.encodePacketHeader().hasError());
+    for (const auto& frame : packet.frames) {
+      if (auto ack = std::get_if<TraceAckFrame>(&frame)) {
+        auto largestSent = conn().lossState.largestSent;
+        if (!largestSent) {
+          continue;
+        }
+        WriteAckFrameState ackState;
+        for (const auto& block : ack->ackBlocks) {
+          if (block.startPacket <= *largestSent) {
+            ackState.acks.insert(
+                block.startPacket, std::min(block.endPacket, *largestSent));
+          }
+        }
+        if (ackState.acks.empty()) {
+          continue;
+        }
+        WriteAckFrameMetaData meta = {
+            ackState, ack->ackDelay, kDefaultAckDelayExponent, TimePoint()};
+        CHECK(!writeAckFrame(meta, builder).hasError());
+      } else if (auto stream = std::get_if<TraceStreamFrame>(&frame)) {
+        auto dataLen = writeStreamFrameHeader(
+            builder,
+            stream->streamId,
+            stream->offset,
+            stream->length,
+            stream->length,
+            stream->fin,
+            std::nullopt /* skipLenHint */);
+        CHECK(dataLen.has_value());
+        if (dataLen->has_value()) {
+          writeStreamFrameData(builder, zeroes(**dataLen), **dataLen);
+        }
+      } else if (auto maxData = std::get_if<TraceMaxDataFrame>(&frame)) {
+        CHECK(!writeFrame(MaxDataFrame(maxData->maximumData), builder)
+                   .hasError());
+      } else if (
+          auto maxStreamData = std::get_if<TraceMaxStreamDataFrame>(&frame)) {
+        CHECK(!writeFrame(
+                   MaxStreamDataFrame(
+                       maxStreamData->streamId, maxStreamData->maximumData),
+                   builder)
+                   .hasError());
+      } else {
+        CHECK(!writeFrame(PingFrame(), builder).hasError());
+      }
+    }
+    fixture_->deliver(packetToBuf(std::move(builder).buildPacket()));
+    fixture_->loopForWrites();
+  }
+
+  bool replayAppWrite(const TraceAppWriteEvent& write) {
+    auto& transport = fixture_->transport();
+    auto streamId = write.streamId;
+    if (!conn().streamManager->streamExists(streamId)) {
+      if (!isLocalStream(Fixture::kNodeType, streamId)) {
+        // Peer streams are opened by the replayed peer packets.
+        return false;
+      }
+      // Open local streams in order up to the recorded one.
+      while (!conn().streamManager->streamExists(streamId)) {
+        auto newStream = isBidirectionalStream(streamId)
+            ? transport.createBidirectionalStream()
+            : transport.createUnidirectionalStream();
+        if (!newStream.has_value() || *newStream > streamId) {
+          return false;
+        }
+      }
+    }
+    auto res = transport.writeChain(streamId, zeroes(write.length), write.eof);
+    fixture_->loopForWrites();
+    return res.has_value();
+  }
+
+  const Trace& trace_;
+  std::unique_ptr<Fixture> fixture_;
+};
+
+using ServerTraceReplayer = TraceReplayer<detail::ServerReplayFixture>;
+using ClientTraceReplayer = TraceReplayer<detail::ClientReplayFixture>;
+
+} // namespace quic::test
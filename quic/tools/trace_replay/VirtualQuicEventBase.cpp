@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/tools/trace_replay/VirtualQuicEventBase.h>
+
+namespace quic {
+
+VirtualQuicEventBase::VirtualQuicEventBase(
+    folly::EventBase* evb,
+    TimePoint start)
+    : FollyQuicEventBase(evb),
+      now_(start),
+      previousVirtualNow_(Clock::getThreadVirtualTime()) {
+  Clock::setThreadVirtualTime(&now_);
+}
+
+VirtualQuicEventBase::~VirtualQuicEventBase() {
+  // Callbacks that outlive the event base keep their handle, which must not
+  // point back at it.
+  for (auto& [key, entry] : timers_) {
+    if (entry.timer) {
+      entry.timer->evb_ = nullptr;
+      entry.timer->key_.reset();
+    }
+  }
+  timers_.clear();
+  Clock::setThreadVirtualTime(previousVirtualNow_);
+}
+
+void VirtualQuicEventBase::advanceTo(TimePoint time) {
+  while (!timers_.empty() && timers_.begin()->first.first <= time) {
+    auto it = timers_.begin();
+    now_ = std::max(now_, it->first.first);
+    auto entry = std::move(it->second);
+    timers_.erase(it);
+    if (entry.timer) {
+      entry.timer->key_.reset();
+      entry.timer->callback_->timeoutExpired();
+    } else {
+      entry.fn();
+    }
+    // Run the loop callbacks the timer scheduled, such as writes, before the
+    // next timer fires.
+    getBackingEventBase()->loopOnce(EVLOOP_NONBLOCK);
+  }
+  now_ = std::max(now_, time);
+}
+
+Optional<TimePoint> VirtualQuicEventBase::nextTimerDeadline() const {
+  if (timers_.empty()) {
+    return std::nullopt;
+  }
+  return timers_.begin()->first.first;
+}
+
+void VirtualQuicEventBase::runAfterDelay(
+    std::function<void()> cb,
+    uint32_t milliseconds) {
+  TimerEntry entry;
+  entry.fn = std::move(cb);
+  insert(now_ + std::chrono::milliseconds(milliseconds), std::move(entry));
+}
+
+bool VirtualQuicEventBase::scheduleTimeoutHighRes(
+    QuicTimerCallback* callback,
+    std::chrono::microseconds timeout) {
+  if (!callback) {
+    return false;
+  }
+  schedule(callback, timeout);
+  return true;
+}
+
+void VirtualQuicEventBase::scheduleTimeout(
+    QuicTimerCallback* callback,
+    std::chrono::milliseconds timeout) {
+  if (!callback) {
+    return;
+  }
+  schedule(callback, timeout);
+}
+
+void VirtualQuicEventBase::schedule(
+    QuicTimerCallback* callback,
+    std::chrono::microseconds timeout) {
+  auto handle = getImplHandle(callback);
+  auto timer = dynamic_cast<VirtualTimer*>(handle);
+  if (handle == nullptr) {
+    timer = new VirtualTimer(this, callback);
+    setImplHandle(callback, timer);
+  }
+  CHECK(timer && timer->evb_ == this)
+      << "Timer callback scheduled on more than one event base";
+  timer->cancelImpl();
+  TimerEntry entry;
+  entry.timer = timer;
+  timer->key_ = insert(now_ + timeout, std::move(entry));
+}
+
+VirtualQuicEventBase::TimerKey VirtualQuicEventBase::insert(
+    TimePoint deadline,
+    TimerEntry entry) {
+  TimerKey key{deadline, nextTimerSeq_++};
+  timers_.emplace(key, std::move(entry));
+  return key;
+}
+
+void VirtualQuicEventBase::VirtualTimer::cancelImpl() noexcept {
+  if (key_ && evb_) {
+    evb_->timers_.erase(*key_);
+  }
+  key_.reset();
+}
+
+bool VirtualQuicEventBase::VirtualTimer::isScheduledImpl() const noexcept {
+  return key_.has_value();
+}
+
+std::chrono::milliseconds
+VirtualQuicEventBase::VirtualTimer::getTimeRemainingImpl() const noexcept {
+  if (!key_ || !evb_ || key_->first <= evb_->now_) {
+    return std::chrono::milliseconds(0);
+  }
+  return std::chrono::ceil<std::chrono::milliseconds>(
+      key_->first - evb_->now_);
+}
+
+} // namespace quic
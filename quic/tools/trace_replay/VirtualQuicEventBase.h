@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <map>
+
+#include <quic/QuicConstants.h>
+#include <quic/common/Optional.h>
+#include <quic/common/events/FollyQuicEventBase.h>
+
+namespace quic {
+
+/**
+ * A FollyQuicEventBase whose timers run on virtual time.
+ *
+ * While it exists, Clock::now() on the constructing thread returns the
+ * virtual time, which only moves when advanceTo() is called. Timers scheduled
+ * through this event base fire from advanceTo(), in deadline order, with the
+ * virtual time set to each timer's deadline. Loop callbacks and socket events
+ * still run on the backing folly::EventBase.
+ *
+ * Used by the trace replayers so that loss detection, pacing and idle timers
+ * fire in step with the recorded timestamps, independent of how long the
+ * replay takes on the wall clock.
+ */
+class VirtualQuicEventBase : public FollyQuicEventBase {
+ public:
+  VirtualQuicEventBase(folly::EventBase* evb, TimePoint start);
+  ~VirtualQuicEventBase() override;
+
+  [[nodiscard]] TimePoint now() const {
+    return now_;
+  }
+
+  // Fires the timers due at or before time, then sets the virtual time to
+  // time. Time never moves backwards.
+  void advanceTo(TimePoint time);
+
+  [[nodiscard]] Optional<TimePoint> nextTimerDeadline() const;
+
+  void runAfterDelay(std::function<void()> cb, uint32_t milliseconds) override;
+
+  bool scheduleTimeoutHighRes(
+      QuicTimerCallback* callback,
+      std::chrono::microseconds timeout) override;
+
+  void scheduleTimeout(
+      QuicTimerCallback* callback,
+      std::chrono::milliseconds timeout) override;
+
+ private:
+  // Timers are ordered by deadline, then by scheduling order.
+  using TimerKey = std::pair<TimePoint, uint64_t>;
+
+  class VirtualTimer : public QuicTimerCallback::TimerCallbackImpl {
+   public:
+    VirtualTimer(VirtualQuicEventBase* evb, QuicTimerCallback* callback)
+        : evb_(evb), callback_(callback) {}
+
+    void cancelImpl() noexcept override;
+    [[nodiscard]] bool isScheduledImpl() const noexcept override;
+    [[nodiscard]] std::chrono::milliseconds getTimeRemainingImpl()
+        const noexcept override;
+
+   private:
+    friend class VirtualQuicEventBase;
+
+    VirtualQuicEventBase* evb_;
+    QuicTimerCallback* callback_;
+    Optional<TimerKey> key_;
+  };
+
+  struct TimerEntry {
+    // Exactly one of these is set.
+    VirtualTimer* timer{nullptr};
+    std::function<void()> fn;
+  };
+
+  void schedule(QuicTimerCallback* callback, std::chrono::microseconds timeout);
+
+  TimerKey insert(TimePoint deadline, TimerEntry entry);
+
+  TimePoint now_;
+  const TimePoint* previousVirtualNow_;
+  uint64_t nextTimerSeq_{0};
+  std::map<TimerKey, TimerEntry> timers_;
+};
+
+} // namespace quic
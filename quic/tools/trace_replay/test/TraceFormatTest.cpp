@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/tools/trace_replay/TraceFormat.h>
+
+#include <gtest/gtest.h>
+
+namespace quic::test {
+
+TEST(TraceFormatTest, RoundTrip) {
+  TraceWriter writer(QuicNodeType::Server);
+
+  TraceEvent writeEvent;
+  writeEvent.time = 10us;
+  writeEvent.event = TraceAppWriteEvent{1, 5000, false};
+  writer.append(writeEvent);
+
+  TracePacketEvent packet;
+  packet.pnSpace = PacketNumberSpace::AppData;
+  packet.packetNum = 7;
+  packet.packetSize = 1200;
+  TraceAckFrame ack;
+  ack.ackDelay = 25us;
+  ack.ackBlocks.emplace_back(10, 20);
+  ack.ackBlocks.emplace_back(3, 5);
+  ack.ackBlocks.emplace_back(0, 0);
+  packet.frames.emplace_back(std::move(ack));
+  packet.frames.emplace_back(TraceStreamFrame{0, 100, 1000, true});
+  packet.frames.emplace_back(TraceMaxDataFrame{1 << 20});
+  packet.frames.emplace_back(TraceMaxStreamDataFrame{4, 1 << 16});
+  packet.frames.emplace_back(TracePingFrame{});
+  TraceEvent packetEvent;
+  packetEvent.time = 1500us;
+  packetEvent.event = std::move(packet);
+  writer.append(packetEvent);
+
+  TraceEvent closeEvent;
+  closeEvent.time = 1500us;
+  closeEvent.event = TraceAppCloseEvent{};
+  writer.append(closeEvent);
+
+  auto trace = decodeTrace(*writer.finish());
+  ASSERT_TRUE(trace.has_value());
+  EXPECT_EQ(trace->vantagePoint, QuicNodeType::Server);
+  ASSERT_EQ(trace->events.size(), 3);
+
+  EXPECT_EQ(trace->events[0].time, 10us);
+  auto write = std::get_if<TraceAppWriteEvent>(&trace->events[0].event);
+  ASSERT_NE(write, nullptr);
+  EXPECT_EQ(write->streamId, 1);
+  EXPECT_EQ(write->length, 5000);
+  EXPECT_FALSE(write->eof);
+
+  EXPECT_EQ(trace->events[1].time, 1500us);
+  auto decodedPacket = std::get_if<TracePacketEvent>(&trace->events[1].event);
+  ASSERT_NE(decodedPacket, nullptr);
+  EXPECT_EQ(decodedPacket->pnSpace, PacketNumberSpace::AppData);
+  EXPECT_EQ(decodedPacket->packetNum, 7);
+  EXPECT_EQ(decodedPacket->packetSize, 1200);
+  ASSERT_EQ(decodedPacket->frames.size(), 5);
+  auto decodedAck = std::get_if<TraceAckFrame>(&decodedPacket->frames[0]);
+  ASSERT_NE(decodedAck, nullptr);
+  EXPECT_EQ(decodedAck->ackDelay, 25us);
+  ASSERT_EQ(decodedAck->ackBlocks.size(), 3);
+  EXPECT_EQ(decodedAck->ackBlocks[0].startPacket, 10);
+  EXPECT_EQ(decodedAck->ackBlocks[0].endPacket, 20);
+  EXPECT_EQ(decodedAck->ackBlocks[1].startPacket, 3);
+  EXPECT_EQ(decodedAck->ackBlocks[1].endPacket, 5);
+  EXPECT_EQ(decodedAck->ackBlocks[2].startPacket, 0);
+  EXPECT_EQ(decodedAck->ackBlocks[2].endPacket, 0);
+  auto stream = std::get_if<TraceStreamFrame>(&decodedPacket->frames[1]);
+  ASSERT_NE(stream, nullptr);
+  EXPECT_EQ(stream->offset, 100);
+  EXPECT_EQ(stream->length, 1000);
+  EXPECT_TRUE(stream->fin);
+  EXPECT_NE(
+      std::get_if<TraceMaxStreamDataFrame>(&decodedPacket->frames[3]), nullptr);
+  EXPECT_NE(std::get_if<TracePingFrame>(&decodedPacket->frames[4]), nullptr);
+
+  EXPECT_NE(std::get_if<TraceAppCloseEvent>(&trace->events[2].event), nullptr);
+}
+
+TEST(TraceFormatTest, Truncated) {
+  TraceWriter writer(QuicNodeType::Client);
+  TraceEvent event;
+  event.event = TraceAppWriteEvent{0, 100, true};
+  writer.append(event);
+  auto buf = writer.finish();
+  buf->coalesce();
+  buf->trimEnd(1);
+  EXPECT_FALSE(decodeTrace(*buf).has_value());
+}
+
+TEST(TraceFormatTest, BadMagic) {
+  auto buf = folly::IOBuf::copyBuffer("not a trace");
+  EXPECT_FALSE(decodeTrace(*buf).has_value());
+}
+
+} // namespace quic::test
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/tools/trace_replay/VirtualQuicEventBase.h>
+
+#include <gtest/gtest.h>
+
+namespace quic::test {
+
+namespace {
+
+class RecordingTimer : public QuicTimerCallback {
+ public:
+  explicit RecordingTimer(std::vector<TimePoint>& fired) : fired_(fired) {}
+
+  void timeoutExpired() noexcept override {
+    fired_.push_back(Clock::now());
+  }
+
+  void callbackCanceled() noexcept override {}
+
+ private:
+  std::vector<TimePoint>& fired_;
+};
+
+const TimePoint kStart{std::chrono::seconds(10)};
+
+} // namespace
+
+TEST(VirtualQuicEventBaseTest, ClockFollowsVirtualTime) {
+  folly::EventBase backingEvb;
+  {
+    VirtualQuicEventBase evb(&backingEvb, kStart);
+    EXPECT_EQ(Clock::now(), kStart);
+    evb.advanceTo(kStart + 5ms);
+    EXPECT_EQ(Clock::now(), kStart + 5ms);
+    // Time doesn't go backwards.
+    evb.advanceTo(kStart);
+    EXPECT_EQ(Clock::now(), kStart + 5ms);
+  }
+  EXPECT_EQ(Clock::getThreadVirtualTime(), nullptr);
+}
+
+TEST(VirtualQuicEventBaseTest, TimersFireAtTheirDeadlines) {
+  folly::EventBase backingEvb;
+  VirtualQuicEventBase evb(&backingEvb, kStart);
+  std::vector<TimePoint> fired;
+  RecordingTimer late(fired);
+  RecordingTimer early(fired);
+  std::vector<TimePoint> ranAfterDelay;
+  evb.scheduleTimeout(&late, 30ms);
+  evb.scheduleTimeoutHighRes(&early, 1500us);
+  evb.runAfterDelay([&] { ranAfterDelay.push_back(Clock::now()); }, 10);
+  EXPECT_TRUE(late.isTimerCallbackScheduled());
+  EXPECT_EQ(late.getTimerCallbackTimeRemaining(), 30ms);
+  ASSERT_TRUE(evb.nextTimerDeadline().has_value());
+  EXPECT_EQ(*evb.nextTimerDeadline(), kStart + 1500us);
+
+  evb.advanceTo(kStart + 20ms);
+  ASSERT_EQ(fired.size(), 1);
+  EXPECT_EQ(fired[0], kStart + 1500us);
+  ASSERT_EQ(ranAfterDelay.size(), 1);
+  EXPECT_EQ(ranAfterDelay[0], kStart + 10ms);
+  EXPECT_FALSE(early.isTimerCallbackScheduled());
+  EXPECT_EQ(late.getTimerCallbackTimeRemaining(), 10ms);
+
+  evb.advanceTo(kStart + 30ms);
+  ASSERT_EQ(fired.size(), 2);
+  EXPECT_EQ(fired[1], kStart + 30ms);
+  EXPECT_FALSE(evb.nextTimerDeadline().has_value());
+}
+
+TEST(VirtualQuicEventBaseTest, RescheduleAndCancel) {
+  folly::EventBase backingEvb;
+  VirtualQuicEventBase evb(&backingEvb, kStart);
+  std::vector<TimePoint> fired;
+  RecordingTimer timer(fired);
+  RecordingTimer canceled(fired);
+  evb.scheduleTimeout(&timer, 10ms);
+  evb.scheduleTimeout(&timer, 20ms);
+  evb.scheduleTimeout(&canceled, 5ms);
+  canceled.cancelTimerCallback();
+  EXPECT_FALSE(canceled.isTimerCallbackScheduled());
+
+  evb.advanceTo(kStart + 1s);
+  ASSERT_EQ(fired.size(), 1);
+  EXPECT_EQ(fired[0], kStart + 20ms);
+}
+
+TEST(VirtualQuicEventBaseTest, CallbackOutlivesEventBase) {
+  std::vector<TimePoint> fired;
+  RecordingTimer timer(fired);
+  {
+    folly::EventBase backingEvb;
+    VirtualQuicEventBase evb(&backingEvb, kStart);
+    evb.scheduleTimeout(&timer, 10ms);
+  }
+  EXPECT_FALSE(timer.isTimerCallbackScheduled());
+  timer.cancelTimerCallback();
+  EXPECT_TRUE(fired.empty());
+}
+
+} // namespace quic::test